@@ -4,11 +4,11 @@ function(add_pathway_target)
     message(FATAL_ERROR "Missing 'ptc' executable.")
   endif(NOT TARGET ptc)
 
-  set(options)
+  set(options INSTRUMENT)
 
-  set(single_value_options OUTPUT_FILE DIRECTORY LANGUAGE)
+  set(single_value_options OUTPUT_FILE SOURCE_FILE INTERFACE_FILE DIRECTORY LANGUAGE MATH)
 
-  set(multi_value_options)
+  set(multi_value_options MODULE_PATHS DEPENDS INSTANTIATE)
 
   cmake_parse_arguments(ptc_opts
     "${options}"
@@ -28,20 +28,88 @@ function(add_pathway_target)
     set(ptc_opts_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/${ptc_opts_DIRECTORY}")
   endif(NOT IS_ABSOLUTE "${ptc_opts_DIRECTORY}")
 
-  if(NOT DEFINED ptc_opts_OUTPUT_FILE)
+  if((NOT DEFINED ptc_opts_OUTPUT_FILE) AND (NOT DEFINED ptc_opts_INTERFACE_FILE))
     message(FATAL_ERROR "Specify the output path with 'OUTPUT_FILE'")
-  endif(NOT DEFINED ptc_opts_OUTPUT_FILE)
+  endif((NOT DEFINED ptc_opts_OUTPUT_FILE) AND (NOT DEFINED ptc_opts_INTERFACE_FILE))
 
-  if(NOT IS_ABSOLUTE "${ptc_opts_OUTPUT_FILE}")
-    set(ptc_opts_OUTPUT_FILE "${CMAKE_CURRENT_BINARY_DIR}/${ptc_opts_OUTPUT_FILE}")
-  endif(NOT IS_ABSOLUTE "${ptc_opts_OUTPUT_FILE}")
+  set(outputs)
+
+  set(extra_args)
+
+  # Modules that are only imported by other modules only need an interface.
+  if(DEFINED ptc_opts_OUTPUT_FILE)
+
+    if(NOT IS_ABSOLUTE "${ptc_opts_OUTPUT_FILE}")
+      set(ptc_opts_OUTPUT_FILE "${CMAKE_CURRENT_BINARY_DIR}/${ptc_opts_OUTPUT_FILE}")
+    endif(NOT IS_ABSOLUTE "${ptc_opts_OUTPUT_FILE}")
+
+    list(APPEND outputs "${ptc_opts_OUTPUT_FILE}")
+
+    list(APPEND extra_args -o "${ptc_opts_OUTPUT_FILE}")
+
+  endif(DEFINED ptc_opts_OUTPUT_FILE)
+
+  # The function definitions go into a source file that is compiled once,
+  # instead of into every file that includes the header.
+  if(DEFINED ptc_opts_SOURCE_FILE)
+
+    if(NOT DEFINED ptc_opts_OUTPUT_FILE)
+      message(FATAL_ERROR "'SOURCE_FILE' requires 'OUTPUT_FILE'")
+    endif(NOT DEFINED ptc_opts_OUTPUT_FILE)
+
+    if(NOT IS_ABSOLUTE "${ptc_opts_SOURCE_FILE}")
+      set(ptc_opts_SOURCE_FILE "${CMAKE_CURRENT_BINARY_DIR}/${ptc_opts_SOURCE_FILE}")
+    endif(NOT IS_ABSOLUTE "${ptc_opts_SOURCE_FILE}")
+
+    list(APPEND outputs "${ptc_opts_SOURCE_FILE}")
+
+    list(APPEND extra_args --source-output "${ptc_opts_SOURCE_FILE}")
+
+    # Each instantiation is a pair of types, such as 'float,int'.
+    foreach(types ${ptc_opts_INSTANTIATE})
+      list(APPEND extra_args --instantiate "${types}")
+    endforeach(types ${ptc_opts_INSTANTIATE})
+
+  endif(DEFINED ptc_opts_SOURCE_FILE)
+
+  if(DEFINED ptc_opts_INTERFACE_FILE)
+
+    if(NOT IS_ABSOLUTE "${ptc_opts_INTERFACE_FILE}")
+      set(ptc_opts_INTERFACE_FILE "${CMAKE_CURRENT_BINARY_DIR}/${ptc_opts_INTERFACE_FILE}")
+    endif(NOT IS_ABSOLUTE "${ptc_opts_INTERFACE_FILE}")
+
+    list(APPEND outputs "${ptc_opts_INTERFACE_FILE}")
+
+    list(APPEND extra_args --emit-interface "${ptc_opts_INTERFACE_FILE}")
+
+  endif(DEFINED ptc_opts_INTERFACE_FILE)
+
+  # The interfaces of the imported modules are listed in 'DEPENDS', so that
+  # the build tool compiles the modules that don't depend on each other in
+  # parallel, and each module after the ones it imports.
+  foreach(module_path ${ptc_opts_MODULE_PATHS})
+    list(APPEND extra_args --module-path "${module_path}")
+  endforeach(module_path ${ptc_opts_MODULE_PATHS})
+
+  if(ptc_opts_INSTRUMENT)
+    list(APPEND extra_args --instrument)
+  endif(ptc_opts_INSTRUMENT)
+
+  if(DEFINED ptc_opts_MATH)
+    list(APPEND extra_args --math "${ptc_opts_MATH}")
+  endif(DEFINED ptc_opts_MATH)
+
+  if(PATHWAY_CACHE_DIR)
+    list(APPEND extra_args --cache-dir "${PATHWAY_CACHE_DIR}")
+  endif(PATHWAY_CACHE_DIR)
 
   string(TOLOWER "${ptc_opts_LANGUAGE}" lang)
 
   if(lang STREQUAL cxx)
 
-    add_custom_command(OUTPUT "${ptc_opts_OUTPUT_FILE}"
-      COMMAND $<TARGET_FILE:ptc> "${ptc_opts_DIRECTORY}" --language "c++" -o "${ptc_opts_OUTPUT_FILE}")
+    add_custom_command(OUTPUT ${outputs}
+      COMMAND $<TARGET_FILE:ptc> "${ptc_opts_DIRECTORY}" --language cxx ${extra_args}
+      DEPENDS ${ptc_opts_DEPENDS})
 
   else(lang STREQUAL cxx)
     message(FATAL_ERROR "'${ptc_opts_LANGUAGE}' is not a supported language.")
@@ -0,0 +1,239 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gRepeatCount = 3;
+
+/// @brief A module that the tests or examples are built from.
+struct Program final
+{
+  const char* name;
+
+  /// @brief The directory with the module's sources.
+  std::filesystem::path moduleDir;
+
+  /// @brief The file that is compiled with the module's header.
+  std::filesystem::path mainSource;
+
+  /// @brief Whether the main source includes the header named by 'HEADER',
+  /// like the tests do, instead of including it by the module's name.
+  bool headerMacro;
+};
+
+std::string
+Quote(const std::string& arg)
+{
+  std::string quoted = "'";
+
+  for (char c : arg) {
+    if (c == '\'')
+      quoted += "'\\''";
+    else
+      quoted += c;
+  }
+
+  return quoted + "'";
+}
+
+bool
+Run(const std::string& command)
+{
+  return std::system(command.c_str()) == 0;
+}
+
+/// @brief Runs a command a few times.
+///
+/// @return The time of the fastest run, in milliseconds.
+double
+Time(const std::string& command)
+{
+  double best = 0;
+
+  for (size_t i = 0; i < gRepeatCount; i++) {
+
+    auto start = Clock::now();
+
+    if (!Run(command)) {
+      std::cerr << "failed to run: " << command << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+    if ((i == 0) || (elapsed.count() < best))
+      best = elapsed.count();
+  }
+
+  return best;
+}
+
+/// @brief Gets the flags that build like the tests and examples do, without
+/// the runtime.
+std::string
+GetCommonFlags(const std::filesystem::path& workDir)
+{
+  return std::string(" -std=c++17 -I ") + Quote(RUNTIME_DIR) + " -I " +
+         Quote(TESTS_DIR) + " -I " + Quote(workDir.string());
+}
+
+/// @brief Precompiles the runtime header.
+///
+/// @return The flags that use the precompiled header, or nothing if the
+/// compiler isn't supported.
+std::optional<std::string>
+PrecompileRuntime(const std::filesystem::path& workDir, double& time)
+{
+  std::string compilerID = CXX_COMPILER_ID;
+
+  auto pchDir = workDir / "pch";
+
+  std::filesystem::create_directories(pchDir);
+
+  // The header that is precompiled only includes the runtime, since a header
+  // that is compiled on its own is warned about for having '#pragma once'.
+  auto header = pchDir / "pathway_pch.h";
+
+  std::ofstream(header) << "#include <pathway.h>\n";
+
+  auto command = Quote(CXX_COMPILER) + GetCommonFlags(workDir) +
+                 " -x c++-header " + Quote(header.string()) + " -o ";
+
+  if (compilerID == "GNU") {
+
+    // GCC looks for the precompiled header next to the header it replaces.
+    time = Time(command + Quote(header.string() + ".gch"));
+
+    return " -Winvalid-pch -include " + Quote(header.string());
+  }
+
+  if ((compilerID == "Clang") || (compilerID == "AppleClang")) {
+
+    auto pch = pchDir / "pathway_pch.pch";
+
+    time = Time(command + Quote(pch.string()));
+
+    return " -include-pch " + Quote(pch.string());
+  }
+
+  return std::nullopt;
+}
+
+std::string
+MakeCompileCommand(const std::filesystem::path& workDir,
+                   const std::filesystem::path& source,
+                   const std::string& extraFlags)
+{
+  auto object = workDir / (source.stem().string() + ".o");
+
+  return Quote(CXX_COMPILER) + GetCommonFlags(workDir) + extraFlags + " -c " +
+         Quote(source.string()) + " -o " + Quote(object.string());
+}
+
+void
+PrintRow(const std::string& name, double plain, std::optional<double> pch)
+{
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << plain;
+
+  if (pch)
+    std::cout << std::setw(14) << *pch << std::setw(10) << (plain / *pch)
+              << "x";
+
+  std::cout << std::endl;
+}
+
+} // namespace
+
+int
+main()
+{
+  std::filesystem::path workDir(WORK_DIR);
+
+  std::filesystem::create_directories(workDir);
+
+  std::filesystem::path testsDir(TESTS_DIR);
+
+  std::filesystem::path examplesDir(EXAMPLES_DIR);
+
+  const Program programs[]{
+    { "test_1", testsDir / "test_1", testsDir / "main.cpp", true },
+    { "test_2", testsDir / "test_2", testsDir / "main.cpp", true },
+    { "rtweekend",
+      examplesDir / "rtweekend",
+      examplesDir / "rtweekend" / "main.cpp",
+      false }
+  };
+
+  double pchTime = 0;
+
+  auto pchFlags = PrecompileRuntime(workDir, pchTime);
+
+  if (!pchFlags)
+    std::cout << "precompiled headers aren't supported by '" << CXX_COMPILER_ID
+              << "'" << std::endl;
+
+  std::cout << "translation unit                 plain   precompiled   speedup"
+            << std::endl;
+
+  std::cout << "                                  (ms)          (ms)"
+            << std::endl;
+
+  for (const auto& program : programs) {
+
+    auto header = workDir / (std::string(program.name) + ".h");
+
+    if (!Run(Quote(PTC_PATH) + " " + Quote(program.moduleDir.string()) +
+             " -o " + Quote(header.string()))) {
+      std::cout << program.name << ": skipped, failed to transpile"
+                << std::endl;
+      continue;
+    }
+
+    // Only includes the generated header, which is mostly the runtime.
+    auto headerSource = workDir / (std::string(program.name) + "_header.cpp");
+
+    std::ofstream(headerSource) << "#include \"" << program.name << ".h\"\n";
+
+    std::string defines;
+
+    if (program.headerMacro) {
+      defines += " " + Quote("-DHEADER=\"" + header.string() + "\"");
+      defines += " -DGOOD_IMAGE_PATH=\\\"\\\" -DDIFF_IMAGE_PATH=\\\"\\\"";
+      defines += " -DTEST_IMAGE_PATH=\\\"\\\"";
+    }
+
+    const std::pair<const char*, std::filesystem::path> sources[]{
+      { "header", headerSource }, { "main.cpp", program.mainSource }
+    };
+
+    for (const auto& [label, source] : sources) {
+
+      auto plain = Time(MakeCompileCommand(workDir, source, defines));
+
+      std::optional<double> pch;
+
+      if (pchFlags)
+        pch = Time(MakeCompileCommand(workDir, source, defines + *pchFlags));
+
+      PrintRow(std::string(program.name) + " " + label, plain, pch);
+    }
+  }
+
+  if (pchFlags) {
+    std::cout << std::endl
+              << "precompiling pathway.h: " << std::fixed
+              << std::setprecision(1) << pchTime << " ms" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "lexer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gRepeatCount = 10;
+
+/// @brief Makes about 100k lines of source code, with the mix of keywords,
+/// identifiers, literals and indentation that generated modules have.
+std::string
+MakeSource()
+{
+  std::ostringstream stream;
+
+  stream << "export module bench;\n"
+         << "\n"
+         << "uniform float scale;\n"
+         << "\n"
+         << "varying vec3 color;\n";
+
+  for (size_t i = 0; i < 10000; i++) {
+    stream << "\n"
+           << "vec3 shade_" << i << "(vec3 normal, vec2 uv) {\n"
+           << "  float brightness = normal.x * 0.5 + " << i << ".25e-1;\n"
+           << "  vec3 tint = vec3(uv.x, uv.y, brightness * scale);\n"
+           << "  int index = " << i << ";\n"
+           << "  float falloff = (1.0 - uv.x) * (1.0 - uv.y);\n"
+           << "  vec3 result = tint * falloff + normal * pi;\n"
+           << "  return result;\n"
+           << "}\n";
+  }
+
+  return stream.str();
+}
+
+size_t
+LexAll(Lexer& lexer)
+{
+  size_t tokenCount = 0;
+
+  while (lexer.Lex())
+    tokenCount++;
+
+  return tokenCount;
+}
+
+template<typename Func>
+double
+Time(Func func)
+{
+  auto start = Clock::now();
+
+  func();
+
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  return elapsed.count();
+}
+
+void
+Report(const char* name, size_t byteCount, size_t tokenCount, double seconds)
+{
+  std::cout << std::setw(8) << name << std::fixed << std::setprecision(1)
+            << std::setw(12) << (tokenCount / seconds) * 1e-6
+            << std::setw(12) << (byteCount / seconds) * 1e-6 << std::endl;
+}
+
+} // namespace
+
+int
+main()
+{
+  auto source = MakeSource();
+
+  auto path = std::filesystem::temp_directory_path() / "pathway_lex_bench.pt";
+
+  std::ofstream(path, std::ios::binary) << source;
+
+  auto pathString = path.string();
+
+  size_t tokenCount = 0;
+
+  // The fastest run is the one least disturbed by the rest of the system.
+  double memoryTime = 1e9;
+
+  double fileTime = 1e9;
+
+  for (size_t i = 0; i < gRepeatCount; i++) {
+
+    memoryTime = std::min(memoryTime, Time([&]() {
+                            Lexer lexer;
+                            lexer.PushFile("bench/main.pt", source);
+                            tokenCount = LexAll(lexer);
+                          }));
+
+    fileTime = std::min(fileTime, Time([&]() {
+                          Lexer lexer;
+                          if (!lexer.PushFile(pathString.c_str()))
+                            std::exit(EXIT_FAILURE);
+                          LexAll(lexer);
+                        }));
+  }
+
+  std::filesystem::remove(path);
+
+  std::cout << "lexing " << tokenCount << " tokens, " << source.size()
+            << " bytes" << std::endl;
+
+  std::cout << "  source   Mtokens/s        MB/s" << std::endl;
+
+  Report("memory", source.size(), tokenCount, memoryTime);
+
+  Report("file", source.size(), tokenCount, fileTime);
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include <pathway.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gInputCount = 1 << 16;
+
+const size_t gRepeatCount = 200;
+
+/// @brief Times a function over the input set and returns the average number
+/// of nanoseconds per call. The results are stored rather than accumulated, so
+/// that the loop is free to be vectorized.
+template<typename Func>
+double
+Time(const std::vector<float>& a, const std::vector<float>& b, Func func)
+{
+  std::vector<float> out(a.size());
+
+  volatile float sink = 0;
+
+  auto start = Clock::now();
+
+  for (size_t j = 0; j < gRepeatCount; j++) {
+
+    for (size_t i = 0; i < a.size(); i++)
+      out[i] = func(a[i], b[i]);
+
+    sink = sink + out[j % out.size()];
+  }
+
+  auto end = Clock::now();
+
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+
+  return elapsed.count() / double(a.size() * gRepeatCount);
+}
+
+std::vector<float>
+MakeInputs(float lo, float hi, unsigned seed)
+{
+  std::mt19937 rng(seed);
+
+  std::uniform_real_distribution<float> dist(lo, hi);
+
+  std::vector<float> inputs(gInputCount);
+
+  for (auto& x : inputs)
+    x = dist(rng);
+
+  return inputs;
+}
+
+template<typename PreciseFunc, typename FastFunc>
+void
+Run(const char* name,
+    const std::vector<float>& a,
+    const std::vector<float>& b,
+    PreciseFunc preciseFunc,
+    FastFunc fastFunc)
+{
+  auto preciseTime = Time(a, b, preciseFunc);
+
+  auto fastTime = Time(a, b, fastFunc);
+
+  std::cout << std::left << std::setw(8) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << preciseTime
+            << std::setw(10) << fastTime << std::setw(9)
+            << (preciseTime / fastTime) << 'x' << std::endl;
+}
+
+} // namespace
+
+int
+main()
+{
+  using precise = pathway::precise_math;
+
+  using fast = pathway::fast_math;
+
+  auto angles = MakeInputs(-10.0f, 10.0f, 1);
+
+  auto exponents = MakeInputs(-20.0f, 20.0f, 2);
+
+  auto positives = MakeInputs(0.001f, 100.0f, 3);
+
+  auto powers = MakeInputs(0.1f, 3.0f, 4);
+
+  std::cout << "function  precise      fast  speedup" << std::endl;
+
+  std::cout << "(ns/call)" << std::endl;
+
+  Run(
+    "exp",
+    exponents,
+    exponents,
+    [](float x, float) { return precise::exp(x); },
+    [](float x, float) { return fast::exp(x); });
+
+  Run(
+    "log",
+    positives,
+    positives,
+    [](float x, float) { return precise::log(x); },
+    [](float x, float) { return fast::log(x); });
+
+  Run(
+    "pow",
+    positives,
+    powers,
+    [](float x, float y) { return precise::pow(x, y); },
+    [](float x, float y) { return fast::pow(x, y); });
+
+  Run(
+    "sin",
+    angles,
+    angles,
+    [](float x, float) { return precise::sin(x); },
+    [](float x, float) { return fast::sin(x); });
+
+  Run(
+    "cos",
+    angles,
+    angles,
+    [](float x, float) { return precise::cos(x); },
+    [](float x, float) { return fast::cos(x); });
+
+  Run(
+    "atan2",
+    angles,
+    exponents,
+    [](float y, float x) { return precise::atan2(y, x); },
+    [](float y, float x) { return fast::atan2(y, x); });
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "matrices.h"
+#include "matrices_no_hints.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gWidth = 256;
+
+const size_t gHeight = 256;
+
+const size_t gRepeatCount = 20;
+
+/// @brief Renders frames of a module and returns the average number of
+/// nanoseconds per pixel.
+template<typename UniformData, typename VaryingData>
+double
+Time()
+{
+  pathway::frame<UniformData, VaryingData, float> frame;
+
+  frame.resize(gWidth, gHeight);
+
+  std::vector<unsigned char> rgb(gWidth * gHeight * 3);
+
+  // The first frame warms up the caches and isn't counted.
+  frame.sample_pixels();
+
+  frame.encode_rgb(rgb.data());
+
+  auto start = Clock::now();
+
+  for (size_t i = 0; i < gRepeatCount; i++) {
+
+    frame.sample_pixels();
+
+    frame.encode_rgb(rgb.data());
+  }
+
+  auto end = Clock::now();
+
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+
+  return elapsed.count() / double(gWidth * gHeight * gRepeatCount);
+}
+
+} // namespace
+
+int
+main()
+{
+  auto plainTime = Time<matrices_no_hints::uniform_data<float, int>,
+                        matrices_no_hints::varying_data<float, int>>();
+
+  auto hintedTime = Time<matrices::uniform_data<float, int>,
+                         matrices::varying_data<float, int>>();
+
+  std::cout << "  no hints     hints  speedup" << std::endl;
+
+  std::cout << "(ns/pixel)" << std::endl;
+
+  std::cout << std::fixed << std::setprecision(2) << std::setw(10)
+            << plainTime << std::setw(10) << hintedTime << std::setw(8)
+            << (plainTime / hintedTime) << 'x' << std::endl;
+
+  return 0;
+}
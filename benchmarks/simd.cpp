@@ -0,0 +1,93 @@
+#include <pathway_simd.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+extern "C" const pathway_simd_module shade_module;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gWidth = 512;
+
+const size_t gHeight = 512;
+
+const size_t gRepeatCount = 20;
+
+/// @brief Renders frames with the programs of one instruction set and
+/// returns the average number of nanoseconds per pixel.
+double
+Time(pathway_simd_isa isa)
+{
+  pathway::simd::frame frame(shade_module, isa);
+
+  frame.resize(gWidth, gHeight);
+
+  std::vector<unsigned char> rgb(gWidth * gHeight * 3);
+
+  // The first frame warms up the caches and isn't counted.
+  frame.sample_pixels();
+
+  frame.encode_rgb(rgb.data());
+
+  auto start = Clock::now();
+
+  for (size_t i = 0; i < gRepeatCount; i++) {
+
+    frame.sample_pixels();
+
+    frame.encode_rgb(rgb.data());
+  }
+
+  auto end = Clock::now();
+
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+
+  return elapsed.count() / double(gWidth * gHeight * gRepeatCount);
+}
+
+} // namespace
+
+int
+main()
+{
+  auto cpuIsa = pathway_simd_detect_isa();
+
+  std::cout << "cpu: " << pathway_simd_isa_name(cpuIsa) << std::endl;
+
+  std::cout << "lanes: " << shade_module.lane_count << std::endl;
+
+  std::cout << "variant  ns/pixel  speedup" << std::endl;
+
+  double baselineTime = 0;
+
+  // Only the variants that this CPU can run are timed.
+  for (int i = 0; i <= int(cpuIsa); i++) {
+
+    auto isa = pathway_simd_isa(i);
+
+    {
+      // A variant that the module wasn't compiled for falls back to an older
+      // one, which was already timed.
+      pathway::simd::frame frame(shade_module, isa);
+
+      if (frame.get_isa() != isa)
+        continue;
+    }
+
+    auto time = Time(isa);
+
+    if (isa == PATHWAY_SIMD_ISA_BASELINE)
+      baselineTime = time;
+
+    std::cout << std::left << std::setw(8) << pathway_simd_isa_name(isa)
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << time << std::setw(8)
+              << (baselineTime / time) << 'x' << std::endl;
+  }
+
+  return 0;
+}
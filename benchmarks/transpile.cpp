@@ -0,0 +1,225 @@
+#include "check.h"
+#include "const_fold.h"
+#include "cpp_generator_v2.h"
+#include "effects_analysis.h"
+#include "flat_tree.h"
+#include "lexer.h"
+#include "module.h"
+#include "module_consumer.h"
+#include "parse.h"
+#include "resolve.h"
+#include "syntax_error_observer.h"
+#include "type_annotation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t gRepeatCount = 5;
+
+class ModuleSaver final
+  : public ModuleConsumer
+  , public SyntaxErrorObserver
+{
+public:
+  void ConsumeModule(std::unique_ptr<Module> module) override
+  {
+    mModule = std::move(module);
+  }
+
+  void ObserveSyntaxError(const Location& location,
+                          const char* message) override
+  {
+    location.Dump(std::cerr);
+    std::cerr << ": " << message << std::endl;
+  }
+
+  std::unique_ptr<Module> TakeModule() { return std::move(mModule); }
+
+private:
+  std::unique_ptr<Module> mModule;
+};
+
+/// @brief Makes a module with a chain of functions, each one calling the
+/// previous one. The first function in the chain refers to a uniform variable,
+/// so the effects of every function depend on the whole chain.
+std::string
+MakeSource(size_t funcCount)
+{
+  std::ostringstream stream;
+
+  stream << "export module bench;\n"
+         << "\n"
+         << "uniform float scale;\n"
+         << "\n"
+         << "vec3 color;\n"
+         << "\n"
+         << "float f0(float x) {\n"
+         << "  return x * scale;\n"
+         << "}\n";
+
+  for (size_t i = 1; i < funcCount; i++) {
+    stream << "\n"
+           << "float f" << i << "(float x) {\n"
+           << "  float y = f" << (i - 1) << "(x) + " << i << ".0;\n"
+           << "  return y * 0.5 + f0(y);\n"
+           << "}\n";
+  }
+
+  stream << "\n"
+         << "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+         << "  color = vec3(f" << (funcCount - 1) << "(uv_min.x), 0.0, 0.0);\n"
+         << "}\n"
+         << "\n"
+         << "vec4 encode_pixel() {\n"
+         << "  return vec4(color, 1.0);\n"
+         << "}\n";
+
+  return stream.str();
+}
+
+struct Timings final
+{
+  double parse = 0;
+
+  double analyze = 0;
+
+  double generate = 0;
+
+  /// @brief The effects analysis alone, on the pointer tree.
+  double treeEffects = 0;
+
+  /// @brief Making the flat tree from the resolved module.
+  double flatten = 0;
+
+  /// @brief The effects analysis on the flat tree.
+  double flatEffects = 0;
+};
+
+template<typename Func>
+double
+Time(Func func)
+{
+  auto start = Clock::now();
+
+  func();
+
+  std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+  return elapsed.count();
+}
+
+/// @brief Runs the same passes that ptc runs on a module.
+Timings
+Transpile(const std::string& source)
+{
+  Timings timings;
+
+  ModuleSaver saver;
+
+  timings.parse = Time([&]() {
+    Lexer lexer;
+
+    lexer.PushFile("bench/main.pt", source);
+
+    Parse(lexer, saver, saver);
+  });
+
+  auto module = saver.TakeModule();
+
+  if (!module) {
+    std::cerr << "failed to parse the benchmark module" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  timings.analyze = Time([&]() {
+    Resolve(*module);
+
+    AnnotateTypes(*module);
+
+    if (!check("bench/main.pt", source, *module, std::cerr))
+      std::exit(EXIT_FAILURE);
+
+    AnalyzeEffects(*module);
+
+    FoldConstants(*module, MathMode::Precise);
+  });
+
+  timings.treeEffects = Time([&]() { AnalyzeEffects(*module); });
+
+  flat::Tree tree;
+
+  timings.flatten = Time([&]() { tree = flat::Flatten(*module); });
+
+  timings.flatEffects = Time([&]() {
+    if (AnalyzeEffects(tree).size() != module->Funcs().size())
+      std::exit(EXIT_FAILURE);
+  });
+
+  std::ostringstream output;
+
+  timings.generate = Time([&]() {
+    cpp::Generator generator(output);
+
+    generator.Generate(*module);
+  });
+
+  return timings;
+}
+
+} // namespace
+
+int
+main()
+{
+  std::cout << "functions     lines     parse   analyze  generate   effects"
+               "   flatten   effects"
+            << std::endl;
+
+  std::cout << "                        (ms)      (ms)      (ms)  tree(ms)"
+               "      (ms)  flat(ms)"
+            << std::endl;
+
+  // The largest module is about 100k lines long.
+  for (size_t funcCount : { 250, 1000, 4000, 20000 }) {
+
+    auto source = MakeSource(funcCount);
+
+    auto lineCount = std::count(source.begin(), source.end(), '\n');
+
+    // The fastest run is the one least disturbed by the rest of the system.
+    Timings best = Transpile(source);
+
+    for (size_t i = 1; i < gRepeatCount; i++) {
+
+      auto timings = Transpile(source);
+
+      best.parse = std::min(best.parse, timings.parse);
+
+      best.analyze = std::min(best.analyze, timings.analyze);
+
+      best.generate = std::min(best.generate, timings.generate);
+
+      best.treeEffects = std::min(best.treeEffects, timings.treeEffects);
+
+      best.flatten = std::min(best.flatten, timings.flatten);
+
+      best.flatEffects = std::min(best.flatEffects, timings.flatEffects);
+    }
+
+    std::cout << std::setw(9) << funcCount << std::setw(10) << lineCount
+              << std::fixed << std::setprecision(2) << std::setw(10)
+              << best.parse << std::setw(10) << best.analyze << std::setw(10)
+              << best.generate << std::setw(10) << best.treeEffects
+              << std::setw(10) << best.flatten << std::setw(10)
+              << best.flatEffects << std::endl;
+  }
+
+  return 0;
+}
@@ -1,5 +1,3 @@
-#define PT_IMPLEMENTATION
-
 #include "rtweekend.h"
 
 #include <fstream>
@@ -8,17 +6,21 @@
 int
 main()
 {
-  pt::Frame frame;
+  using uniform_data = rtweekend::uniform_data<float, int>;
+
+  using varying_data = rtweekend::varying_data<float, int>;
+
+  pathway::frame<uniform_data, varying_data, float> frame;
 
-  frame.Resize(640, 480);
+  frame.resize(640, 480);
 
-  frame.Sample();
+  frame.sample_pixels();
 
   std::vector<unsigned char> colorBuffer(640 * 480 * 3);
 
-  frame.EncodeRGB(colorBuffer.data());
+  frame.encode_rgb(colorBuffer.data());
 
-  std::ofstream file("rtweekend.ppm");
+  std::ofstream file("rtweekend.ppm", std::ios::binary);
 
   file << "P6\n640 480\n255\n";
 
@@ -0,0 +1,27 @@
+// A C++20 module interface for the runtime, so that it is compiled once
+// instead of being parsed by every file that includes a generated header.
+//
+// Generated headers import it instead of including 'pathway.h' when
+// 'PATHWAY_RUNTIME_MODULE' is defined, which the 'pathway_runtime_module'
+// target does for the targets that link to it.
+
+module;
+
+// The standard headers are included here, outside of the module, so that
+// their includes in 'pathway.h' are skipped and they aren't exported.
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+export module pathway;
+
+export {
+#include "pathway.h"
+}
@@ -3,10 +3,17 @@
 #ifndef PATHWAY_COMMON_RUNTIME_H_INCLUDED
 #define PATHWAY_COMMON_RUNTIME_H_INCLUDED
 
+#include "pathway_attributes.h"
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 namespace pathway {
 
@@ -144,6 +151,14 @@ clamp(scalar x, scalar min_value, scalar max_value) noexcept
   return max(min(x, max_value), min_value);
 }
 
+/// @brief How generated functions take a parameter that they don't assign.
+/// Types that fit in two registers are copied, since that's cheaper than
+/// reading them through a reference, and bigger ones, such as most matrices,
+/// are taken by constant reference.
+template<typename type>
+using param_t = typename std::
+  conditional<(sizeof(type) <= (2 * sizeof(void*))), type, const type&>::type;
+
 //=======================
 // }}} Generic Operations
 
@@ -611,14 +626,579 @@ struct matrix_constructor final
 //===========
 // }}} Matrix
 
+// {{{ Math
+//=========
+
+template<size_t count, size_t index = 0>
+struct component_op final
+{
+  template<typename func, typename scalar, size_t size>
+  static void apply(func f,
+                    const vector<scalar, size>& a,
+                    vector<scalar, size>& out) noexcept
+  {
+    out.template at<index>() = f(a.template at<index>());
+
+    component_op<count, index + 1>::apply(f, a, out);
+  }
+
+  template<typename func, typename scalar, size_t size>
+  static void apply(func f,
+                    const vector<scalar, size>& a,
+                    const vector<scalar, size>& b,
+                    vector<scalar, size>& out) noexcept
+  {
+    out.template at<index>() =
+      f(a.template at<index>(), b.template at<index>());
+
+    component_op<count, index + 1>::apply(f, a, b, out);
+  }
+};
+
+template<size_t index>
+struct component_op<index, index> final
+{
+  template<typename func, typename scalar, size_t size>
+  static void apply(func,
+                    const vector<scalar, size>&,
+                    vector<scalar, size>&) noexcept
+  {}
+
+  template<typename func, typename scalar, size_t size>
+  static void apply(func,
+                    const vector<scalar, size>&,
+                    const vector<scalar, size>&,
+                    vector<scalar, size>&) noexcept
+  {}
+};
+
+template<typename scalar>
+struct float_bits;
+
+template<>
+struct float_bits<float> final
+{
+  using uint_type = uint32_t;
+
+  static constexpr int mantissa_bits = 23;
+
+  static constexpr int exponent_bias = 127;
+
+  /// Adding and then subtracting this rounds to the nearest integer.
+  static constexpr float round_magic = 12582912.0f;
+};
+
+template<>
+struct float_bits<double> final
+{
+  using uint_type = uint64_t;
+
+  static constexpr int mantissa_bits = 52;
+
+  static constexpr int exponent_bias = 1023;
+
+  /// Adding and then subtracting this rounds to the nearest integer.
+  static constexpr double round_magic = 6755399441055744.0;
+};
+
+/// @brief Computes 2^n by building the exponent field directly.
+///
+/// @note The result is only correct when 2^n is a normal number.
+template<typename scalar>
+scalar
+exp2i(int n) noexcept
+{
+  using bits = float_bits<scalar>;
+
+  using uint_type = typename bits::uint_type;
+
+  auto u = uint_type(n + bits::exponent_bias) << bits::mantissa_bits;
+
+  scalar out;
+
+  memcpy(&out, &u, sizeof(out));
+
+  return out;
+}
+
+/// @brief The transcendental functions from the standard library. These are
+/// correctly rounded or within 1 ULP on all mainstream libm implementations.
+struct precise_scalar_math final
+{
+  template<typename scalar>
+  static scalar exp(scalar x) noexcept
+  {
+    return scalar(std::exp(x));
+  }
+
+  template<typename scalar>
+  static scalar log(scalar x) noexcept
+  {
+    return scalar(std::log(x));
+  }
+
+  template<typename scalar>
+  static scalar pow(scalar x, scalar y) noexcept
+  {
+    return scalar(std::pow(x, y));
+  }
+
+  template<typename scalar>
+  static scalar sin(scalar x) noexcept
+  {
+    return scalar(std::sin(x));
+  }
+
+  template<typename scalar>
+  static scalar cos(scalar x) noexcept
+  {
+    return scalar(std::cos(x));
+  }
+
+  template<typename scalar>
+  static scalar atan2(scalar y, scalar x) noexcept
+  {
+    return scalar(std::atan2(y, x));
+  }
+};
+
+/// @brief Inline polynomial approximations of the transcendental functions.
+///
+/// @detail The polynomials are the single precision minimax fits from Cephes,
+/// evaluated after a Cody-Waite range reduction. With @p scalar being float,
+/// the measured maximum error against a double precision reference is:
+///
+///   - exp   : 1 ULP
+///   - log   : 1 ULP
+///   - sin   : 2 ULP for |x| < pi, otherwise an absolute error of 1e-7
+///   - cos   : 2 ULP for |x| < pi, otherwise an absolute error of 1e-7
+///   - atan2 : 3 ULP
+///   - pow   : 2 + 2|y * log(x)| ULP, since it is exp(y * log(x))
+///
+/// The error bounds of sin and cos only hold for |x| < 8192. Beyond that, the
+/// range reduction loses precision and the error grows with |x|.
+///
+/// Instantiating these with double gives results that are about as accurate
+/// as the float versions (a relative error near 1e-7), not 1 ULP of double.
+///
+/// None of the functions branch. Both sides of every special case are
+/// computed and the result is picked with a bit mask, so that a loop calling
+/// these can be vectorized by the compiler.
+struct fast_scalar_math final
+{
+  template<typename scalar>
+  static scalar exp(scalar x) noexcept
+  {
+    using limits = std::numeric_limits<scalar>;
+
+    constexpr scalar ln2 = scalar(0.693147180559945309);
+
+    constexpr scalar max_x = scalar(limits::max_exponent) * ln2;
+
+    constexpr scalar min_x = scalar(limits::min_exponent - 1) * ln2;
+
+    auto clamped = select(x > max_x, max_x, select(x < min_x, min_x, x));
+
+    auto fn = round(clamped * scalar(1.44269504088896341));
+
+    auto n = int(fn);
+
+    auto r = (clamped - (fn * scalar(0.693359375))) -
+             (fn * scalar(-2.12194440e-4));
+
+    auto z = r * r;
+
+    auto p = scalar(1.9875691500e-4);
+    p = (p * r) + scalar(1.3981999507e-3);
+    p = (p * r) + scalar(8.3334519073e-3);
+    p = (p * r) + scalar(4.1665795894e-2);
+    p = (p * r) + scalar(1.6666665459e-1);
+    p = (p * r) + scalar(5.0000001201e-1);
+    p = (p * z) + r + scalar(1);
+
+    // The scale is split in two so that the ends of the range don't overflow
+    // the exponent field of 2^n.
+    auto half_n = n >> 1;
+
+    auto y = p * exp2i<scalar>(half_n) * exp2i<scalar>(n - half_n);
+
+    y = select(x > max_x, limits::infinity(), y);
+    y = select(x < min_x, scalar(0), y);
+
+    return select(x != x, x, y);
+  }
+
+  template<typename scalar>
+  static scalar log(scalar x) noexcept
+  {
+    using limits = std::numeric_limits<scalar>;
+
+    using bits = float_bits<scalar>;
+
+    using uint_type = typename bits::uint_type;
+
+    // Subnormal inputs are scaled into the normal range first.
+
+    auto subnormal = x < limits::min();
+
+    auto normal = select(subnormal, x * exp2i<scalar>(bits::mantissa_bits), x);
+
+    int e = -bits::mantissa_bits * int(subnormal);
+
+    constexpr uint_type mantissa_mask =
+      (uint_type(1) << bits::mantissa_bits) - 1;
+
+    uint_type u;
+
+    memcpy(&u, &normal, sizeof(u));
+
+    // Split x into m * 2^e, with m being in [0.5, 1)
+
+    e += int(u >> bits::mantissa_bits) - (bits::exponent_bias - 1);
+
+    u = (u & mantissa_mask) |
+        (uint_type(bits::exponent_bias - 1) << bits::mantissa_bits);
+
+    scalar m;
+
+    memcpy(&m, &u, sizeof(m));
+
+    auto small = m < scalar(0.707106781186547524);
+
+    e -= int(small);
+
+    m = select(small, m + m, m) - scalar(1);
+
+    auto z = m * m;
+
+    auto y = scalar(7.0376836292e-2);
+    y = (y * m) - scalar(1.1514610310e-1);
+    y = (y * m) + scalar(1.1676998740e-1);
+    y = (y * m) - scalar(1.2420140846e-1);
+    y = (y * m) + scalar(1.4249322787e-1);
+    y = (y * m) - scalar(1.6668057665e-1);
+    y = (y * m) + scalar(2.0000714765e-1);
+    y = (y * m) - scalar(2.4999993993e-1);
+    y = (y * m) + scalar(3.3333331174e-1);
+    y = y * m * z;
+
+    auto fe = scalar(e);
+
+    y += scalar(-2.12194440e-4) * fe;
+    y += scalar(-0.5) * z;
+
+    y = (m + y) + (scalar(0.693359375) * fe);
+
+    y = select(x == limits::infinity(), x, y);
+    y = select(x == 0, -limits::infinity(), y);
+
+    return select(!(x >= 0), limits::quiet_NaN(), y);
+  }
+
+  template<typename scalar>
+  static scalar pow(scalar x, scalar y) noexcept
+  {
+    using limits = std::numeric_limits<scalar>;
+
+    auto magnitude = exp(y * log(std::fabs(x)));
+
+    // Negative bases are only defined for integral exponents. Anything at or
+    // above 2^mantissa_bits is an even integer already, and is kept out of
+    // the int conversion so that it can't overflow.
+
+    constexpr scalar limit = float_bits<scalar>::round_magic / scalar(1.5);
+
+    auto n = int(select(std::fabs(y) < limit, y, scalar(0)));
+
+    auto integral = (std::fabs(y) >= limit) | (scalar(n) == y);
+
+    auto odd = (n & 1) != 0;
+
+    auto negative = select(odd, -magnitude, magnitude);
+
+    negative = select(integral, negative, limits::quiet_NaN());
+
+    // A zero base needs no special case, log(0) is -inf and exp() takes the
+    // product to either zero or infinity.
+    auto out = select(x < 0, negative, magnitude);
+
+    return select(y == 0, scalar(1), out);
+  }
+
+  template<typename scalar>
+  static scalar sin(scalar x) noexcept
+  {
+    return sin_quadrant(x, 0);
+  }
+
+  template<typename scalar>
+  static scalar cos(scalar x) noexcept
+  {
+    return sin_quadrant(x, 1);
+  }
+
+  template<typename scalar>
+  static scalar atan2(scalar y, scalar x) noexcept
+  {
+    constexpr scalar pi = scalar(3.14159265358979323846);
+
+    auto t = atan(y / x);
+
+    t = select(x < 0, t + select(y < 0, -pi, pi), t);
+
+    auto on_axis = select(y > 0, pi / 2, select(y < 0, -pi / 2, scalar(0)));
+
+    t = select(x == 0, on_axis, t);
+
+    return select(y != y, y, t);
+  }
+
+private:
+  /// @brief Picks @p a if @p cond is true and @p b otherwise, without a
+  /// branch.
+  template<typename scalar>
+  static scalar select(bool cond, scalar a, scalar b) noexcept
+  {
+    using uint_type = typename float_bits<scalar>::uint_type;
+
+    uint_type mask = uint_type(0) - uint_type(cond);
+
+    uint_type ua;
+    uint_type ub;
+
+    memcpy(&ua, &a, sizeof(ua));
+    memcpy(&ub, &b, sizeof(ub));
+
+    ua = (ua & mask) | (ub & ~mask);
+
+    memcpy(&a, &ua, sizeof(a));
+
+    return a;
+  }
+
+  /// @brief Rounds to the nearest integer, with ties going to even. The
+  /// result is only exact for |x| < 2^mantissa_bits.
+  template<typename scalar>
+  static scalar round(scalar x) noexcept
+  {
+    constexpr scalar magic = float_bits<scalar>::round_magic;
+
+    return (x + magic) - magic;
+  }
+
+  /// @brief Computes sin(x + (offset * pi / 2)).
+  template<typename scalar>
+  static scalar sin_quadrant(scalar x, int offset) noexcept
+  {
+    // Clamping keeps the quadrant index exact and within the range of an int.
+    constexpr scalar max_q = scalar(1 << 22);
+
+    auto fq = x * scalar(0.636619772367581343);
+
+    fq = round(select(fq > max_q, max_q, select(fq < -max_q, -max_q, fq)));
+
+    auto q = int(fq);
+
+    auto r = x - (fq * scalar(1.5703125));
+    r = r - (fq * scalar(4.837512969970703125e-4));
+    r = r - (fq * scalar(7.54978995489188216e-8));
+
+    auto z = r * r;
+
+    auto quadrant = (q + offset) & 3;
+
+    auto c = scalar(2.443315711809948e-5);
+    c = (c * z) - scalar(1.388731625493765e-3);
+    c = (c * z) + scalar(4.166664568298827e-2);
+    c = (c * z * z) - (scalar(0.5) * z) + scalar(1);
+
+    auto s = scalar(-1.9515295891e-4);
+    s = (s * z) + scalar(8.3321608736e-3);
+    s = (s * z) - scalar(1.6666654611e-1);
+    s = (s * z * r) + r;
+
+    auto y = select((quadrant & 1) != 0, c, s);
+
+    return select((quadrant & 2) != 0, -y, y);
+  }
+
+  template<typename scalar>
+  static scalar atan(scalar x) noexcept
+  {
+    constexpr scalar pi = scalar(3.14159265358979323846);
+
+    auto a = std::fabs(x);
+
+    auto big = a > scalar(2.414213562373095);
+
+    auto mid = a > scalar(0.4142135623730950);
+
+    auto num = select(big, scalar(-1), select(mid, a - scalar(1), a));
+
+    auto den = select(big, a, select(mid, a + scalar(1), scalar(1)));
+
+    auto y = select(big, pi / 2, select(mid, pi / 4, scalar(0)));
+
+    a = num / den;
+
+    auto z = a * a;
+
+    auto p = scalar(8.05374449538e-2);
+    p = (p * z) - scalar(1.38776856032e-1);
+    p = (p * z) + scalar(1.99777106478e-1);
+    p = (p * z) - scalar(3.33329491539e-1);
+
+    y += (p * z * a) + a;
+
+    return select(x < 0, -y, y);
+  }
+};
+
+/// @brief Exposes the scalar functions of @p scalar_math so that they also
+/// operate component-wise on vectors. Generated code aliases one of these as
+/// 'math', depending on the math mode it was generated with.
+template<typename scalar_math>
+struct math_library final
+{
+  template<typename scalar>
+  static scalar exp(scalar x) noexcept
+  {
+    return scalar_math::exp(x);
+  }
+
+  template<typename scalar>
+  static scalar log(scalar x) noexcept
+  {
+    return scalar_math::log(x);
+  }
+
+  template<typename scalar>
+  static scalar pow(scalar x, scalar y) noexcept
+  {
+    return scalar_math::pow(x, y);
+  }
+
+  template<typename scalar>
+  static scalar sin(scalar x) noexcept
+  {
+    return scalar_math::sin(x);
+  }
+
+  template<typename scalar>
+  static scalar cos(scalar x) noexcept
+  {
+    return scalar_math::cos(x);
+  }
+
+  template<typename scalar>
+  static scalar atan2(scalar y, scalar x) noexcept
+  {
+    return scalar_math::atan2(y, x);
+  }
+
+  template<typename scalar, size_t size>
+  static auto exp(const vector<scalar, size>& v) noexcept
+    -> vector<scalar, size>
+  {
+    return map(v, [](scalar x) { return scalar_math::exp(x); });
+  }
+
+  template<typename scalar, size_t size>
+  static auto log(const vector<scalar, size>& v) noexcept
+    -> vector<scalar, size>
+  {
+    return map(v, [](scalar x) { return scalar_math::log(x); });
+  }
+
+  template<typename scalar, size_t size>
+  static auto pow(const vector<scalar, size>& a,
+                  const vector<scalar, size>& b) noexcept
+    -> vector<scalar, size>
+  {
+    return map(a, b, [](scalar x, scalar y) { return scalar_math::pow(x, y); });
+  }
+
+  template<typename scalar, size_t size>
+  static auto sin(const vector<scalar, size>& v) noexcept
+    -> vector<scalar, size>
+  {
+    return map(v, [](scalar x) { return scalar_math::sin(x); });
+  }
+
+  template<typename scalar, size_t size>
+  static auto cos(const vector<scalar, size>& v) noexcept
+    -> vector<scalar, size>
+  {
+    return map(v, [](scalar x) { return scalar_math::cos(x); });
+  }
+
+  template<typename scalar, size_t size>
+  static auto atan2(const vector<scalar, size>& a,
+                    const vector<scalar, size>& b) noexcept
+    -> vector<scalar, size>
+  {
+    return map(
+      a, b, [](scalar y, scalar x) { return scalar_math::atan2(y, x); });
+  }
+
+private:
+  template<typename scalar, size_t size, typename func>
+  static auto map(const vector<scalar, size>& v, func f) noexcept
+    -> vector<scalar, size>
+  {
+    vector<scalar, size> out;
+
+    component_op<size>::apply(f, v, out);
+
+    return out;
+  }
+
+  template<typename scalar, size_t size, typename func>
+  static auto map(const vector<scalar, size>& a,
+                  const vector<scalar, size>& b,
+                  func f) noexcept -> vector<scalar, size>
+  {
+    vector<scalar, size> out;
+
+    component_op<size>::apply(f, a, b, out);
+
+    return out;
+  }
+};
+
+using precise_math = math_library<precise_scalar_math>;
+
+using fast_math = math_library<fast_scalar_math>;
+
+//=========
+// }}} Math
+
 // {{{ Frame
 //==========
 
+/// @brief Calls 'prepare()' on the uniform data, if it has one. Generated
+/// modules use it to compute the values that only depend on uniform
+/// variables, so that they aren't computed again for every pixel.
+template<typename uniform_data>
+auto
+prepare_uniform_data(uniform_data& u_dat, int) noexcept
+  -> decltype(u_dat.prepare(), void())
+{
+  u_dat.prepare();
+}
+
+template<typename uniform_data>
+void
+prepare_uniform_data(uniform_data&, long) noexcept
+{}
+
 template<typename uniform_data, typename varying_data, typename float_type>
 class frame final
 {
 public:
-  void encode_rgb(unsigned char* rgb_buffer) const noexcept
+  /// @param rgb_buffer Mustn't overlap the frame, so that the frame's data
+  /// isn't read again after each byte that is stored.
+  void encode_rgb(unsigned char* PATHWAY_RESTRICT rgb_buffer) const noexcept
   {
     constexpr float_type min_val(0);
     constexpr float_type max_val(255);
@@ -651,6 +1231,8 @@ public:
 
   void sample_pixels()
   {
+    prepare_uniform_data(m_uniform_data, 0);
+
     const auto& u_dat = static_cast<const uniform_data&>(m_uniform_data);
 
     for (size_t y = 0; y < m_height; y++) {
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef PATHWAY_ATTRIBUTES_H_INCLUDED
+#define PATHWAY_ATTRIBUTES_H_INCLUDED
+
+// The attributes that the generated code is annotated with. They are macros,
+// which a C++20 module can't export, so generated headers include this even
+// when they import the runtime. Each macro can be defined before including the
+// runtime to override it.
+
+/// @brief Makes the compiler inline a function at every call, instead of
+/// weighing its size against the cost of the call.
+#ifndef PATHWAY_ALWAYS_INLINE
+#if defined(__GNUC__)
+#define PATHWAY_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define PATHWAY_ALWAYS_INLINE __forceinline
+#else
+#define PATHWAY_ALWAYS_INLINE inline
+#endif
+#endif
+
+/// @brief Promises that the object a pointer or reference refers to isn't
+/// accessed by any other means while it is in scope, so that stores through
+/// other pointers don't force it to be read again. Only GCC and Clang are
+/// known to accept it on references.
+#ifndef PATHWAY_RESTRICT
+#if defined(__GNUC__)
+#define PATHWAY_RESTRICT __restrict__
+#else
+#define PATHWAY_RESTRICT
+#endif
+#endif
+
+/// @brief Checks a precondition of the generated code, such as the uniform
+/// data being prepared before a pixel is sampled. Only checked when 'NDEBUG'
+/// isn't defined.
+#ifndef PATHWAY_ASSERT
+#include <assert.h>
+#define PATHWAY_ASSERT(condition) assert(condition)
+#endif
+
+#endif // PATHWAY_ATTRIBUTES_H_INCLUDED
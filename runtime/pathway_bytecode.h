@@ -0,0 +1,169 @@
+#pragma once
+
+#ifndef PATHWAY_BYTECODE_H_INCLUDED
+#define PATHWAY_BYTECODE_H_INCLUDED
+
+// The format of the bytecode that 'ptc --language bytecode' generates and
+// that the virtual machine in 'pathway_vm.h' runs. It has no dependencies, so
+// that the transpiler can share it with the runtime.
+//
+// A module is a sequence of 32-bit little endian words:
+//
+//   magic, version, math mode, register count,
+//   uniform slot count, varying slot count,
+//   uniform variable count, then each variable:
+//     scalar kind, component count, first slot, name length, name bytes
+//     (padded to a whole word),
+//   then each of the programs, in the order of @ref program_id:
+//     word count, then the instructions.
+//
+// Each instruction is an opcode followed by its operands, as given by the
+// opcode's @ref format. Every register holds one scalar for each pixel of a
+// batch, so vectors and matrices take one register per component.
+
+#include <stdint.h>
+
+namespace pathway {
+
+namespace bytecode {
+
+constexpr uint32_t magic = 0x43425750; // "PWBC"
+
+constexpr uint32_t version = 1;
+
+/// @brief The programs of a module.
+enum class program_id : uint32_t
+{
+  /// Computes the default values of the uniform variables, once.
+  init,
+  /// Computes the values that only depend on uniform variables, once per
+  /// frame.
+  prepare,
+  /// The pixel sampler, which is given 'uv_min' and 'uv_max' as inputs.
+  sample,
+  /// The pixel encoder, which outputs the color of the pixel.
+  encode,
+  count
+};
+
+enum class math_mode : uint32_t
+{
+  precise,
+  fast
+};
+
+/// @brief How the 32 bits of a register or slot are interpreted.
+enum class scalar_kind : uint32_t
+{
+  float32,
+  /// Booleans are integers that are either zero or one.
+  int32
+};
+
+enum class opcode : uint32_t
+{
+  f_const,
+  i_const,
+  f_add,
+  f_sub,
+  f_mul,
+  f_div,
+  f_mod,
+  f_neg,
+  i_add,
+  i_sub,
+  i_mul,
+  i_div,
+  i_mod,
+  i_neg,
+  i_not,
+  b_not,
+  i_to_f,
+  f_to_i,
+  i_to_b,
+  f_to_b,
+  f_exp,
+  f_log,
+  f_pow,
+  f_sin,
+  f_cos,
+  f_atan2,
+  load_uniform,
+  store_uniform,
+  load_varying,
+  store_varying,
+  load_input,
+  store_output,
+  count
+};
+
+/// @brief The operands of an instruction.
+enum class format : uint32_t
+{
+  /// A register that is written and a 32-bit constant.
+  dst_imm,
+  /// A register that is written and one that is read.
+  dst_a,
+  /// A register that is written and two that are read.
+  dst_a_b,
+  /// A register that is written and the index of a slot, input or output.
+  dst_index,
+  /// The index of a slot, input or output, and a register that is read.
+  index_src
+};
+
+/// @brief The number of inputs of the sample program, which are the
+/// components of 'uv_min' and then 'uv_max'.
+constexpr uint32_t input_count = 4;
+
+/// @brief The number of outputs of the encode program, which are the
+/// components of the color.
+constexpr uint32_t output_count = 4;
+
+constexpr auto
+get_format(opcode op) noexcept -> format
+{
+  switch (op) {
+    case opcode::f_const:
+    case opcode::i_const:
+      return format::dst_imm;
+    case opcode::f_add:
+    case opcode::f_sub:
+    case opcode::f_mul:
+    case opcode::f_div:
+    case opcode::f_mod:
+    case opcode::i_add:
+    case opcode::i_sub:
+    case opcode::i_mul:
+    case opcode::i_div:
+    case opcode::i_mod:
+    case opcode::f_pow:
+    case opcode::f_atan2:
+      return format::dst_a_b;
+    case opcode::load_uniform:
+    case opcode::load_varying:
+    case opcode::load_input:
+      return format::dst_index;
+    case opcode::store_uniform:
+    case opcode::store_varying:
+    case opcode::store_output:
+      return format::index_src;
+    default:
+      break;
+  }
+
+  return format::dst_a;
+}
+
+/// @brief Gets the number of words that follow the opcode.
+constexpr auto
+get_operand_count(format f) noexcept -> uint32_t
+{
+  return (f == format::dst_a_b) ? 3 : 2;
+}
+
+} // namespace bytecode
+
+} // namespace pathway
+
+#endif // PATHWAY_BYTECODE_H_INCLUDED
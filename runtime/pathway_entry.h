@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef PATHWAY_ENTRY_H_INCLUDED
+#define PATHWAY_ENTRY_H_INCLUDED
+
+// The C interface of a module that is compiled into a shared object, which is
+// generated by 'ptc --entry-table'. The host looks up the function named by
+// PATHWAY_ENTRY_TABLE_SYMBOL and only uses the module through the table it
+// returns, so that it doesn't depend on the layout of the module's data. See
+// 'pathway_jit.h' for a host that builds and loads these at run time.
+
+#include <new>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PATHWAY_ENTRY_TABLE_SYMBOL "pathway_get_entry_table"
+
+/// This is changed whenever the layout of the table changes.
+#define PATHWAY_ENTRY_TABLE_VERSION 1
+
+#if defined(_WIN32)
+#define PATHWAY_ENTRY_EXPORT __declspec(dllexport)
+#else
+#define PATHWAY_ENTRY_EXPORT __attribute__((visibility("default")))
+#endif
+
+extern "C" {
+
+/// @brief The functions of a module. Each one takes the frame that
+/// 'create_frame' returned, which holds the uniform and varying data.
+struct pathway_entry_table
+{
+  uint32_t version;
+
+  /// @return Null if the frame couldn't be allocated.
+  void* (*create_frame)();
+
+  void (*destroy_frame)(void* frame);
+
+  /// @return Zero if the pixels couldn't be allocated.
+  int (*resize)(void* frame, size_t width, size_t height);
+
+  void (*sample_pixels)(void* frame);
+
+  void (*encode_rgb)(const void* frame, unsigned char* rgb_buffer);
+
+  /// @brief Sets each component of a uniform variable. Matrices are given
+  /// column by column. Integer and boolean components are converted from the
+  /// given values.
+  ///
+  /// @return Zero if the module has no uniform variable of this name, or if
+  /// the count doesn't match the number of components of its type.
+  int (*set_uniform)(void* frame,
+                     const char* name,
+                     const float* values,
+                     size_t count);
+};
+
+typedef const pathway_entry_table* (*pathway_get_entry_table_fn)();
+
+} // extern "C"
+
+#endif // PATHWAY_ENTRY_H_INCLUDED
@@ -0,0 +1,407 @@
+#pragma once
+
+#ifndef PATHWAY_JIT_H_INCLUDED
+#define PATHWAY_JIT_H_INCLUDED
+
+// Builds modules into shared objects with the system's C++ compiler while a
+// program is running, and swaps them into a frame, so that a preview can pick
+// up the edits to a module without restarting. The modules have to be
+// generated with 'ptc --entry-table', or with the entry table enabled in the
+// options of 'TranspileString'. Only available where 'dlopen' is.
+
+#include "pathway_entry.h"
+
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace pathway {
+
+namespace jit {
+
+/// @brief Hashes data with 64-bit FNV-1a, which is enough to tell the
+/// sources of a cache apart.
+inline auto
+hash_data(const std::string& data, uint64_t h = 0xcbf29ce484222325) noexcept
+  -> uint64_t
+{
+  for (unsigned char c : data) {
+    h ^= c;
+    h *= 0x100000001b3;
+  }
+
+  return h;
+}
+
+/// @brief A module that was loaded from a shared object. It is unloaded when
+/// the last reference to it is released, so frames keep a reference to the
+/// module they were created by.
+class library final
+{
+public:
+  /// @param error Set to the reason the module couldn't be loaded.
+  ///
+  /// @return Null if the shared object couldn't be loaded, or if it doesn't
+  /// have an entry table of this version.
+  static auto open(const std::string& path, std::string& error)
+    -> std::shared_ptr<library>
+  {
+    auto* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+    if (!handle) {
+      error = dlerror();
+      return nullptr;
+    }
+
+    std::shared_ptr<library> lib(new library(handle));
+
+    auto get_entry_table = reinterpret_cast<pathway_get_entry_table_fn>(
+      dlsym(handle, PATHWAY_ENTRY_TABLE_SYMBOL));
+
+    if (!get_entry_table) {
+      error = "'" + path + "' has no entry table";
+      return nullptr;
+    }
+
+    lib->m_entry_table = get_entry_table();
+
+    if (lib->m_entry_table->version != PATHWAY_ENTRY_TABLE_VERSION) {
+      error = "'" + path + "' has an entry table of another version";
+      return nullptr;
+    }
+
+    return lib;
+  }
+
+  library(const library&) = delete;
+
+  ~library() { dlclose(m_handle); }
+
+  auto get_entry_table() const noexcept -> const pathway_entry_table&
+  {
+    return *m_entry_table;
+  }
+
+private:
+  explicit library(void* handle) noexcept
+    : m_handle(handle)
+  {}
+
+  void* m_handle;
+
+  const pathway_entry_table* m_entry_table = nullptr;
+};
+
+struct compiler_options final
+{
+  /// @brief The compiler command. Defaults to the 'CXX' environment
+  /// variable, or 'c++' if it isn't set.
+  ///
+  /// @note This is passed to the shell as it is, without quoting, so that a
+  /// command such as 'ccache g++' works. It has to come from a trusted
+  /// source, since the shell runs anything in it.
+  std::string command;
+
+  /// @brief The compiler flags, which are passed to the shell like the
+  /// command, so they have to be trusted and quoted by the caller.
+  std::string flags = "-std=c++17 -O2";
+
+  /// @brief The directory of the runtime headers.
+  std::string include_dir;
+
+  /// @brief The directory that the sources and shared objects are kept in.
+  /// It has to exist.
+  std::string cache_dir;
+};
+
+/// @brief Compiles modules into shared objects, which are named by the hash
+/// of the source, the compiler options and the runtime. A module is only
+/// compiled again when one of these changes, including across runs of the
+/// program.
+class compiler final
+{
+public:
+  explicit compiler(compiler_options options)
+    : m_options(std::move(options))
+  {
+    if (m_options.command.empty()) {
+      const auto* cxx = getenv("CXX");
+      m_options.command = cxx ? cxx : "c++";
+    }
+
+    // The runtime is part of the key, so that a cache outlives an update of
+    // the runtime without loading stale modules.
+    std::ostringstream stream;
+
+    for (const auto* name : { "/pathway.h", "/pathway_attributes.h" }) {
+
+      std::ifstream runtime(m_options.include_dir + name);
+
+      stream << runtime.rdbuf();
+    }
+
+    m_key_seed = hash_data(m_options.command + '\n' + m_options.flags + '\n' +
+                           m_options.include_dir + '\n' +
+                           std::to_string(PATHWAY_ENTRY_TABLE_VERSION) + '\n' +
+                           stream.str());
+  }
+
+  /// @brief Loads the module generated from a source, compiling it first if
+  /// it isn't cached.
+  ///
+  /// @param error Set to the reason the module couldn't be loaded, which
+  /// includes the output of the compiler.
+  ///
+  /// @return Null if the module couldn't be compiled or loaded.
+  auto build(const std::string& source, std::string& error)
+    -> std::shared_ptr<library>
+  {
+    auto key = hash_data(source, m_key_seed);
+
+    auto it = m_loaded.find(key);
+
+    if (it != m_loaded.end()) {
+      if (auto lib = it->second.lock())
+        return lib;
+    }
+
+    char name[17];
+
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+
+    auto base = m_options.cache_dir + "/" + name;
+
+    auto object_path = base + ".so";
+
+    if (access(object_path.c_str(), R_OK) != 0) {
+      if (!compile(source, base, object_path, error))
+        return nullptr;
+    }
+
+    auto lib = library::open(object_path, error);
+
+    if (lib)
+      m_loaded[key] = lib;
+
+    return lib;
+  }
+
+private:
+  static auto quote(const std::string& arg) -> std::string
+  {
+    std::string quoted("'");
+
+    for (auto c : arg) {
+      if (c == '\'')
+        quoted += "'\\''";
+      else
+        quoted += c;
+    }
+
+    return quoted + "'";
+  }
+
+  static auto read_file(const std::string& path) -> std::string
+  {
+    std::ifstream file(path);
+
+    std::ostringstream stream;
+
+    stream << file.rdbuf();
+
+    return stream.str();
+  }
+
+  bool compile(const std::string& source,
+               const std::string& base,
+               const std::string& object_path,
+               std::string& error)
+  {
+    // Other processes may share the cache, so each one compiles to its own
+    // files and only the finished object is renamed into place.
+    auto temp_base = base + "." + std::to_string(getpid());
+
+    auto source_path = temp_base + ".cpp";
+
+    auto temp_object_path = temp_base + ".so";
+
+    auto log_path = temp_base + ".log";
+
+    {
+      std::ofstream file(source_path);
+
+      file << source;
+
+      if (!file.good()) {
+        error = "failed to write '" + source_path + "'";
+        return false;
+      }
+    }
+
+    auto command = m_options.command + " " + m_options.flags +
+                   " -shared -fPIC -I" + quote(m_options.include_dir) +
+                   " -o " + quote(temp_object_path) + " " +
+                   quote(source_path) + " > " + quote(log_path) + " 2>&1";
+
+    auto status = system(command.c_str());
+
+    auto log = read_file(log_path);
+
+    remove(source_path.c_str());
+
+    remove(log_path.c_str());
+
+    if (status != 0) {
+      remove(temp_object_path.c_str());
+      error = "failed to compile the module:\n" + log;
+      return false;
+    }
+
+    if (rename(temp_object_path.c_str(), object_path.c_str()) != 0) {
+      remove(temp_object_path.c_str());
+      error = "failed to write '" + object_path + "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  compiler_options m_options;
+
+  uint64_t m_key_seed = 0;
+
+  std::map<uint64_t, std::weak_ptr<library>> m_loaded;
+};
+
+/// @brief A frame of a module that can be replaced while the program runs.
+///
+/// @detail The frame remembers its size and the uniform values that were set
+/// on it, and gives them to each module it loads, so that the scene doesn't
+/// have to be set up again after a reload. Uniform variables that the new
+/// module doesn't have, or that changed type, are left at their defaults.
+class frame final
+{
+public:
+  frame() = default;
+
+  frame(const frame&) = delete;
+
+  ~frame() { release(); }
+
+  /// @brief Replaces the module of the frame. This should be called between
+  /// frames, when no other thread is using it.
+  ///
+  /// @return False if the new module couldn't allocate the frame, in which
+  /// case the previous module is kept.
+  bool load(std::shared_ptr<library> lib)
+  {
+    const auto& table = lib->get_entry_table();
+
+    auto* data = table.create_frame();
+
+    if (!data)
+      return false;
+
+    if (!table.resize(data, m_width, m_height)) {
+      table.destroy_frame(data);
+      return false;
+    }
+
+    for (const auto& uniform : m_uniforms) {
+      table.set_uniform(data,
+                        uniform.first.c_str(),
+                        uniform.second.data(),
+                        uniform.second.size());
+    }
+
+    release();
+
+    m_library = std::move(lib);
+
+    m_data = data;
+
+    return true;
+  }
+
+  bool loaded() const noexcept { return !!m_library; }
+
+  /// @return False if the pixels couldn't be allocated.
+  bool resize(size_t w, size_t h)
+  {
+    if (m_library && !table().resize(m_data, w, h))
+      return false;
+
+    m_width = w;
+    m_height = h;
+
+    return true;
+  }
+
+  /// @brief Sets a uniform variable of the module, which is kept for the
+  /// modules that are loaded later.
+  ///
+  /// @return False if the current module has no uniform variable of this
+  /// name and type.
+  bool set_uniform(const char* name, std::initializer_list<float> values)
+  {
+    m_uniforms[name].assign(values.begin(), values.end());
+
+    if (!m_library)
+      return false;
+
+    return !!table().set_uniform(m_data, name, values.begin(), values.size());
+  }
+
+  void sample_pixels()
+  {
+    if (m_library)
+      table().sample_pixels(m_data);
+  }
+
+  void encode_rgb(unsigned char* rgb_buffer) const
+  {
+    if (m_library)
+      table().encode_rgb(m_data, rgb_buffer);
+  }
+
+private:
+  auto table() const noexcept -> const pathway_entry_table&
+  {
+    return m_library->get_entry_table();
+  }
+
+  void release()
+  {
+    if (m_library)
+      table().destroy_frame(m_data);
+
+    m_library.reset();
+
+    m_data = nullptr;
+  }
+
+  std::shared_ptr<library> m_library;
+
+  void* m_data = nullptr;
+
+  size_t m_width = 0;
+
+  size_t m_height = 0;
+
+  std::map<std::string, std::vector<float>> m_uniforms;
+};
+
+} // namespace jit
+
+} // namespace pathway
+
+#endif // PATHWAY_JIT_H_INCLUDED
@@ -0,0 +1,282 @@
+#pragma once
+
+#ifndef PATHWAY_PROFILE_RUNTIME_H_INCLUDED
+#define PATHWAY_PROFILE_RUNTIME_H_INCLUDED
+
+// The profiler used by the code that 'ptc --instrument' generates. It is kept
+// out of 'pathway.h', so that code that isn't instrumented doesn't pay for
+// the headers it needs.
+
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif !defined(__aarch64__)
+#include <chrono>
+#endif
+
+namespace pathway {
+
+/// @brief Reads a counter that increases at a constant rate, which is the
+/// time stamp counter on x86 and the virtual counter on ARM.
+inline auto
+read_cycle_counter() noexcept -> uint64_t
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t value;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// @brief Counts the calls and cycles of each function of a module.
+///
+/// @detail Each thread counts into its own @ref profile::counters, so the
+/// instrumented functions don't contend with each other. The counters of all
+/// the threads are added up by @ref profile::merge, which should be called
+/// between frames, when no thread is rendering.
+class profile final
+{
+public:
+  class scope;
+
+  struct entry final
+  {
+    const char* name = "";
+
+    uint64_t calls = 0;
+
+    /// @brief The cycles spent in the function, including its callees.
+    uint64_t total_cycles = 0;
+
+    /// @brief The cycles spent in the function, excluding its callees.
+    uint64_t self_cycles = 0;
+  };
+
+  /// @brief The counters of one thread.
+  class counters final
+  {
+  public:
+    explicit counters(profile& owner)
+      : m_owner(owner)
+      , m_entries(new counter_entry[owner.m_names.size()])
+    {
+      m_owner.attach(this);
+    }
+
+    counters(const counters&) = delete;
+
+    ~counters() { m_owner.detach(this); }
+
+  private:
+    friend profile;
+
+    friend scope;
+
+    struct counter_entry final
+    {
+      // Only the owning thread writes these, so they are atomic only so that
+      // the profile can read them without a data race.
+      std::atomic<uint64_t> calls{ 0 };
+      std::atomic<uint64_t> total_cycles{ 0 };
+      std::atomic<uint64_t> self_cycles{ 0 };
+    };
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+    }
+
+    profile& m_owner;
+
+    std::unique_ptr<counter_entry[]> m_entries;
+
+    /// @brief The innermost function being timed on this thread.
+    scope* m_current = nullptr;
+  };
+
+  /// @brief Times a call to a function, from construction to destruction.
+  class scope final
+  {
+  public:
+    scope(counters& c, size_t function) noexcept
+      : m_counters(c)
+      , m_function(function)
+      , m_parent(c.m_current)
+      , m_start(read_cycle_counter())
+    {
+      c.m_current = this;
+    }
+
+    scope(const scope&) = delete;
+
+    ~scope()
+    {
+      auto cycles = read_cycle_counter() - m_start;
+
+      auto& e = m_counters.m_entries[m_function];
+
+      counters::add(e.calls, 1);
+      counters::add(e.total_cycles, cycles);
+      counters::add(e.self_cycles, cycles - m_callee_cycles);
+
+      if (m_parent)
+        m_parent->m_callee_cycles += cycles;
+
+      m_counters.m_current = m_parent;
+    }
+
+  private:
+    counters& m_counters;
+
+    size_t m_function;
+
+    scope* m_parent;
+
+    uint64_t m_start;
+
+    uint64_t m_callee_cycles = 0;
+  };
+
+  /// @param names The name of each function, by index.
+  profile(std::initializer_list<const char*> names)
+    : m_names(names)
+    , m_retired(names.size())
+  {
+    for (size_t i = 0; i < m_names.size(); i++)
+      m_retired[i].name = m_names[i];
+  }
+
+  profile(const profile&) = delete;
+
+  /// @brief Adds up the counters of every thread, including the threads that
+  /// have exited.
+  auto merge() const -> std::vector<entry>
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entries = m_retired;
+
+    for (const auto* c : m_threads)
+      add_counters(*c, entries);
+
+    return entries;
+  }
+
+  /// @brief Sets every counter back to zero, to profile the next frame on its
+  /// own.
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& e : m_retired)
+      e = entry{ e.name, 0, 0, 0 };
+
+    for (auto* c : m_threads) {
+      for (size_t i = 0; i < m_names.size(); i++) {
+        c->m_entries[i].calls.store(0, std::memory_order_relaxed);
+        c->m_entries[i].total_cycles.store(0, std::memory_order_relaxed);
+        c->m_entries[i].self_cycles.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @brief Prints a flat profile of the merged counters, with the functions
+  /// that took the most cycles first.
+  void dump(std::ostream& stream) const
+  {
+    auto entries = merge();
+
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const entry& a, const entry& b) {
+                return a.self_cycles > b.self_cycles;
+              });
+
+    uint64_t total = 0;
+
+    for (const auto& e : entries)
+      total += e.self_cycles;
+
+    stream << "  self %         calls   self cycles  total cycles  "
+              "cycles/call  function"
+           << std::endl;
+
+    for (const auto& e : entries) {
+
+      if (e.calls == 0)
+        continue;
+
+      double percent = total ? (100.0 * double(e.self_cycles) / double(total))
+                             : 0.0;
+
+      stream << std::fixed << std::setprecision(2) << std::setw(8) << percent
+             << std::setw(14) << e.calls << std::setw(14) << e.self_cycles
+             << std::setw(14) << e.total_cycles << std::setw(13)
+             << (e.total_cycles / e.calls) << "  " << e.name << std::endl;
+    }
+  }
+
+private:
+  static void add_counters(const counters& c, std::vector<entry>& entries)
+  {
+    for (size_t i = 0; i < entries.size(); i++) {
+
+      const auto& ce = c.m_entries[i];
+
+      auto& e = entries[i];
+
+      e.calls += ce.calls.load(std::memory_order_relaxed);
+      e.total_cycles += ce.total_cycles.load(std::memory_order_relaxed);
+      e.self_cycles += ce.self_cycles.load(std::memory_order_relaxed);
+    }
+  }
+
+  void attach(counters* c)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_threads.emplace_back(c);
+  }
+
+  /// @brief Keeps the counts of a thread that is exiting.
+  void detach(counters* c)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    add_counters(*c, m_retired);
+
+    m_threads.erase(std::find(m_threads.begin(), m_threads.end(), c));
+  }
+
+  std::vector<const char*> m_names;
+
+  mutable std::mutex m_mutex;
+
+  std::vector<counters*> m_threads;
+
+  std::vector<entry> m_retired;
+};
+
+} // namespace pathway
+
+#endif // PATHWAY_PROFILE_RUNTIME_H_INCLUDED
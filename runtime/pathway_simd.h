@@ -0,0 +1,551 @@
+#pragma once
+
+#ifndef PATHWAY_SIMD_H_INCLUDED
+#define PATHWAY_SIMD_H_INCLUDED
+
+/* The support code of the C modules that 'ptc --language c-simd' generates,
+ * and a frame that renders them from C++.
+ *
+ * Each value of a generated function is a GCC or Clang vector, with one lane
+ * for each pixel of a batch, so the arithmetic maps directly to SIMD
+ * instructions instead of relying on the optimizer to vectorize a loop over
+ * pixels. The number of lanes is chosen when the module is compiled, by
+ * defining PATHWAY_SIMD_LANES, and is recorded in the module's descriptor so
+ * that the frame doesn't have to agree with it at compile time.
+ *
+ * Modules generated with '--isa-variants' also have their programs compiled
+ * for newer x86 instruction sets. The frame asks the CPU which of them it
+ * supports when it is created, so a module that is built for the oldest
+ * machines of a fleet still uses the wider vectors of the newer ones. */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PATHWAY_SIMD_LANES
+#define PATHWAY_SIMD_LANES 8
+#endif
+
+#if (PATHWAY_SIMD_LANES & (PATHWAY_SIMD_LANES - 1)) != 0 ||                    \
+  PATHWAY_SIMD_LANES > 16
+#error "PATHWAY_SIMD_LANES must be a power of two, up to 16."
+#endif
+
+/* This is changed whenever the layout of the descriptor changes. */
+#define PATHWAY_SIMD_VERSION 2
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PATHWAY_SIMD_X86 1
+#else
+#define PATHWAY_SIMD_X86 0
+#endif
+
+/* The attributes of the variants of a program. FMA isn't enabled, so that
+ * multiplications and additions aren't contracted, and every variant gives
+ * the same results as the baseline. */
+#define PATHWAY_SIMD_TARGET_SSE4 __attribute__((target("sse4.2")))
+#define PATHWAY_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define PATHWAY_SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+
+/* The helpers below are always inlined, since vectors are passed in other
+ * registers depending on the instruction set, and a call from a variant to a
+ * helper compiled for the baseline wouldn't agree on where they are. */
+#define PATHWAY_SIMD_HELPER static inline __attribute__((always_inline))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef float pw_f32 __attribute__((vector_size(PATHWAY_SIMD_LANES * 4)));
+
+typedef int32_t pw_i32 __attribute__((vector_size(PATHWAY_SIMD_LANES * 4)));
+
+typedef uint32_t pw_u32 __attribute__((vector_size(PATHWAY_SIMD_LANES * 4)));
+
+/* A uniform slot, which holds one component of a uniform variable or of a
+ * value that only depends on uniform variables. */
+typedef union pathway_simd_scalar
+{
+  float f;
+  int32_t i;
+} pathway_simd_scalar;
+
+/* A varying slot of a batch of pixels. */
+typedef union pw_lanes
+{
+  pw_f32 f;
+  pw_i32 i;
+} pw_lanes;
+
+enum pathway_simd_program_id
+{
+  /* Computes the default values of the uniform variables, once. */
+  PATHWAY_SIMD_INIT,
+  /* Computes the values that only depend on uniform variables, once per
+   * frame. */
+  PATHWAY_SIMD_PREPARE,
+  /* Samples a batch, from 'uv_min' and 'uv_max' in the four inputs. */
+  PATHWAY_SIMD_SAMPLE,
+  /* Encodes a batch, into the color in the four outputs. */
+  PATHWAY_SIMD_ENCODE,
+  PATHWAY_SIMD_PROGRAM_COUNT
+};
+
+/* The inputs and outputs hold one vector for each component, and the
+ * varyings hold one vector for each varying slot. Programs that don't use
+ * them are given null pointers. */
+typedef void (*pathway_simd_program)(pathway_simd_scalar* uniforms,
+                                     void* varyings,
+                                     const void* inputs,
+                                     void* outputs);
+
+/* The instruction sets that programs may be compiled for, from the oldest
+ * to the newest. The baseline is whatever the module was compiled for. */
+enum pathway_simd_isa
+{
+  PATHWAY_SIMD_ISA_BASELINE,
+  PATHWAY_SIMD_ISA_SSE4,
+  PATHWAY_SIMD_ISA_AVX2,
+  PATHWAY_SIMD_ISA_AVX512,
+  PATHWAY_SIMD_ISA_COUNT
+};
+
+/* Samples every pixel of a frame, with the varyings of each batch of pixels
+ * following the previous one. */
+typedef void (*pathway_simd_sample_fn)(pathway_simd_scalar* uniforms,
+                                       void* varyings,
+                                       size_t width,
+                                       size_t height);
+
+/* Encodes every pixel of a frame, into three bytes each. */
+typedef void (*pathway_simd_encode_fn)(pathway_simd_scalar* uniforms,
+                                       void* varyings,
+                                       size_t width,
+                                       size_t height,
+                                       unsigned char* rgb_buffer);
+
+/* The code of a module, compiled for one instruction set. The loops over the
+ * batches of a frame are compiled with the programs, so that they use the
+ * same instructions and the programs can be inlined into them. */
+struct pathway_simd_variant
+{
+  uint32_t isa;
+  pathway_simd_program programs[PATHWAY_SIMD_PROGRAM_COUNT];
+  pathway_simd_sample_fn sample_pixels;
+  pathway_simd_encode_fn encode_rgb;
+};
+
+struct pathway_simd_uniform
+{
+  const char* name;
+  /* Zero for floats, one for integers and booleans. */
+  uint32_t is_int;
+  uint32_t component_count;
+  uint32_t first_slot;
+};
+
+struct pathway_simd_module
+{
+  uint32_t version;
+  uint32_t lane_count;
+  uint32_t uniform_slot_count;
+  uint32_t varying_slot_count;
+  uint32_t uniform_count;
+  const struct pathway_simd_uniform* uniforms;
+  /* Ordered from the oldest instruction set to the newest. The first one is
+   * always the baseline. */
+  uint32_t variant_count;
+  const struct pathway_simd_variant* variants;
+};
+
+static inline const char*
+pathway_simd_isa_name(enum pathway_simd_isa isa)
+{
+  switch (isa) {
+    case PATHWAY_SIMD_ISA_BASELINE:
+      return "baseline";
+    case PATHWAY_SIMD_ISA_SSE4:
+      return "sse4";
+    case PATHWAY_SIMD_ISA_AVX2:
+      return "avx2";
+    case PATHWAY_SIMD_ISA_AVX512:
+      return "avx512";
+    case PATHWAY_SIMD_ISA_COUNT:
+      break;
+  }
+  return "unknown";
+}
+
+/* Finds the newest instruction set that the CPU supports, with 'cpuid'. */
+static inline enum pathway_simd_isa
+pathway_simd_detect_isa(void)
+{
+#if PATHWAY_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return PATHWAY_SIMD_ISA_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return PATHWAY_SIMD_ISA_AVX2;
+  if (__builtin_cpu_supports("sse4.2"))
+    return PATHWAY_SIMD_ISA_SSE4;
+#endif
+  return PATHWAY_SIMD_ISA_BASELINE;
+}
+
+/* Selects the newest variant that doesn't need more than 'max_isa'. */
+static inline const struct pathway_simd_variant*
+pathway_simd_select(const struct pathway_simd_module* m,
+                    enum pathway_simd_isa max_isa)
+{
+  const struct pathway_simd_variant* variant = &m->variants[0];
+  for (uint32_t i = 1; i < m->variant_count; i++) {
+    if (m->variants[i].isa <= (uint32_t)max_isa)
+      variant = &m->variants[i];
+  }
+  return variant;
+}
+
+PATHWAY_SIMD_HELPER pw_f32
+pw_splat_f32(float x)
+{
+  pw_f32 v;
+  for (int l = 0; l < PATHWAY_SIMD_LANES; l++)
+    v[l] = x;
+  return v;
+}
+
+PATHWAY_SIMD_HELPER pw_i32
+pw_splat_i32(int32_t x)
+{
+  pw_i32 v;
+  for (int l = 0; l < PATHWAY_SIMD_LANES; l++)
+    v[l] = x;
+  return v;
+}
+
+/* Comparisons give -1 in the lanes where they hold, which booleans store as
+ * one. */
+PATHWAY_SIMD_HELPER pw_i32
+pw_to_bool(pw_i32 mask)
+{
+  return mask & 1;
+}
+
+/* Integers wrap around on overflow, which is done in unsigned arithmetic
+ * since overflowing a signed integer is undefined. */
+PATHWAY_SIMD_HELPER pw_i32
+pw_add_i32(pw_i32 a, pw_i32 b)
+{
+  return (pw_i32)((pw_u32)a + (pw_u32)b);
+}
+
+PATHWAY_SIMD_HELPER pw_i32
+pw_sub_i32(pw_i32 a, pw_i32 b)
+{
+  return (pw_i32)((pw_u32)a - (pw_u32)b);
+}
+
+PATHWAY_SIMD_HELPER pw_i32
+pw_mul_i32(pw_i32 a, pw_i32 b)
+{
+  return (pw_i32)((pw_u32)a * (pw_u32)b);
+}
+
+PATHWAY_SIMD_HELPER pw_i32
+pw_neg_i32(pw_i32 a)
+{
+  return (pw_i32)(-(pw_u32)a);
+}
+
+/* Dividing by zero, or the one quotient that overflows, gives zero. There is
+ * no vector instruction for integer division, so it is done lane by lane. */
+PATHWAY_SIMD_HELPER pw_i32
+pw_div_i32(pw_i32 a, pw_i32 b)
+{
+  pw_i32 d;
+  for (int l = 0; l < PATHWAY_SIMD_LANES; l++) {
+    int valid = (b[l] != 0) && !((a[l] == INT32_MIN) && (b[l] == -1));
+    d[l] = valid ? (a[l] / b[l]) : 0;
+  }
+  return d;
+}
+
+PATHWAY_SIMD_HELPER pw_i32
+pw_mod_i32(pw_i32 a, pw_i32 b)
+{
+  pw_i32 d;
+  for (int l = 0; l < PATHWAY_SIMD_LANES; l++) {
+    int valid = (b[l] != 0) && !((a[l] == INT32_MIN) && (b[l] == -1));
+    d[l] = valid ? (a[l] % b[l]) : 0;
+  }
+  return d;
+}
+
+PATHWAY_SIMD_HELPER pw_f32
+pw_to_f32(pw_i32 a)
+{
+  return __builtin_convertvector(a, pw_f32);
+}
+
+/* Values that don't fit in an integer, including NaN, become zero. They are
+ * masked out before the conversion, which is undefined for them. */
+PATHWAY_SIMD_HELPER pw_i32
+pw_to_i32(pw_f32 a)
+{
+  pw_i32 in_range = (a > -2147483648.0f) & (a < 2147483648.0f);
+  pw_f32 safe = (pw_f32)((pw_i32)a & in_range);
+  return __builtin_convertvector(safe, pw_i32) & in_range;
+}
+
+#define PATHWAY_SIMD_MAP_1(name, func)                                         \
+  PATHWAY_SIMD_HELPER pw_f32 name(pw_f32 a)                                    \
+  {                                                                            \
+    pw_f32 d;                                                                  \
+    for (int l = 0; l < PATHWAY_SIMD_LANES; l++)                               \
+      d[l] = func(a[l]);                                                       \
+    return d;                                                                  \
+  }
+
+#define PATHWAY_SIMD_MAP_2(name, func)                                         \
+  PATHWAY_SIMD_HELPER pw_f32 name(pw_f32 a, pw_f32 b)                          \
+  {                                                                            \
+    pw_f32 d;                                                                  \
+    for (int l = 0; l < PATHWAY_SIMD_LANES; l++)                               \
+      d[l] = func(a[l], b[l]);                                                 \
+    return d;                                                                  \
+  }
+
+/* The transcendental functions call the C library for each lane, which gives
+ * the same results as the C++ runtime's precise math. */
+PATHWAY_SIMD_MAP_1(pw_exp, expf)
+PATHWAY_SIMD_MAP_1(pw_log, logf)
+PATHWAY_SIMD_MAP_1(pw_sin, sinf)
+PATHWAY_SIMD_MAP_1(pw_cos, cosf)
+PATHWAY_SIMD_MAP_2(pw_pow, powf)
+PATHWAY_SIMD_MAP_2(pw_atan2, atan2f)
+PATHWAY_SIMD_MAP_2(pw_fmod, fmodf)
+
+#undef PATHWAY_SIMD_MAP_1
+#undef PATHWAY_SIMD_MAP_2
+
+/* The loops that the generated 'sample_pixels' of each variant runs.
+ *
+ * The position of each lane is advanced instead of being divided out of the
+ * pixel index, and the inputs are computed with the same arithmetic as the
+ * C++ frame, so that the results match. Lanes past the last pixel are
+ * sampled like any other, and ignored. */
+PATHWAY_SIMD_HELPER void
+pathway_simd_sample_pixels(pathway_simd_program sample,
+                           pathway_simd_scalar* u,
+                           void* varyings,
+                           size_t varying_slot_count,
+                           size_t width,
+                           size_t height)
+{
+  size_t pixel_count = width * height;
+  size_t x = 0;
+  size_t y = 0;
+  pw_f32 w = pw_splat_f32((float)width);
+  pw_f32 h = pw_splat_f32((float)height);
+  pw_f32 zero = pw_splat_f32(0.0f);
+  pw_f32 one = pw_splat_f32(1.0f);
+  pw_lanes* v = (pw_lanes*)varyings;
+  pw_f32 in[4];
+  for (size_t i = 0; i < pixel_count; i += PATHWAY_SIMD_LANES) {
+    pw_f32 xs;
+    pw_f32 ys;
+    for (int l = 0; l < PATHWAY_SIMD_LANES; l++) {
+      xs[l] = (float)x;
+      ys[l] = (float)y;
+      if (++x == width) {
+        x = 0;
+        y++;
+      }
+    }
+    in[0] = (xs + zero) / w;
+    in[1] = (ys + zero) / h;
+    in[2] = (xs + one) / w;
+    in[3] = (ys + one) / h;
+    sample(u, v, in, NULL);
+    v += varying_slot_count;
+  }
+}
+
+/* The loop that the generated 'encode_rgb' of each variant runs. The colors
+ * are clamped like 'std::min(std::max(x, 0.0f), 255.0f)' in the C++ frame,
+ * except that NaN, which it can't convert, becomes zero. */
+PATHWAY_SIMD_HELPER void
+pathway_simd_encode_rgb(pathway_simd_program encode,
+                        pathway_simd_scalar* u,
+                        void* varyings,
+                        size_t varying_slot_count,
+                        size_t width,
+                        size_t height,
+                        unsigned char* rgb_buffer)
+{
+  size_t pixel_count = width * height;
+  pw_f32 zero = pw_splat_f32(0.0f);
+  pw_f32 max = pw_splat_f32(255.0f);
+  pw_lanes* v = (pw_lanes*)varyings;
+  pw_f32 out[4];
+  pw_i32 q[3];
+  for (size_t i = 0; i < pixel_count; i += PATHWAY_SIMD_LANES) {
+    size_t n = pixel_count - i;
+    if (n > PATHWAY_SIMD_LANES)
+      n = PATHWAY_SIMD_LANES;
+    encode(u, v, NULL, out);
+    for (int c = 0; c < 3; c++) {
+      pw_f32 x = out[c] * max;
+      pw_i32 in_range = (x > zero) & (x <= max);
+      pw_i32 over = x > max;
+      x = (pw_f32)(((pw_i32)x & in_range) | ((pw_i32)max & over));
+      q[c] = __builtin_convertvector(x, pw_i32);
+    }
+    for (size_t l = 0; l < n; l++) {
+      unsigned char* dst = rgb_buffer + ((i + l) * 3);
+      dst[0] = (unsigned char)q[0][l];
+      dst[1] = (unsigned char)q[1][l];
+      dst[2] = (unsigned char)q[2][l];
+    }
+    v += varying_slot_count;
+  }
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pathway {
+
+namespace simd {
+
+/// @brief Renders a module generated by 'ptc --language c-simd', like @ref
+/// pathway::frame renders a module compiled to C++.
+class frame final
+{
+public:
+  /// @param m The module to render, which must outlive the frame.
+  ///
+  /// @param max_isa The newest instruction set whose variant may be used.
+  /// Benchmarks lower it to compare the variants of a module.
+  explicit frame(const pathway_simd_module& m,
+                 pathway_simd_isa max_isa = pathway_simd_detect_isa())
+    : m_module(m)
+    , m_variant(*pathway_simd_select(&m, max_isa))
+    , m_uniforms(std::max<uint32_t>(m.uniform_slot_count, 1))
+    , m_varyings(1)
+  {
+    run(PATHWAY_SIMD_INIT);
+  }
+
+  /// @return The instruction set of the variant that the frame runs.
+  auto get_isa() const noexcept -> pathway_simd_isa
+  {
+    return pathway_simd_isa(m_variant.isa);
+  }
+
+  void resize(size_t w, size_t h)
+  {
+    m_width = w;
+    m_height = h;
+
+    auto batch_count =
+      ((w * h) + m_module.lane_count - 1) / m_module.lane_count;
+
+    auto batch_size = size_t(m_module.varying_slot_count) * m_module.lane_count;
+
+    // At least one block, so that the varyings are never null.
+    auto block_count = get_block_count(batch_count * batch_size);
+
+    m_varyings.assign(std::max<size_t>(block_count, 1), lane_block{});
+  }
+
+  /// @brief Sets the value of a uniform variable. Integer and boolean
+  /// components are converted from the given values.
+  ///
+  /// @return False if the module has no such variable, or if it has another
+  /// number of components.
+  bool set_uniform(const std::string& name, std::initializer_list<float> v)
+  {
+    for (uint32_t i = 0; i < m_module.uniform_count; i++) {
+
+      const auto& uniform = m_module.uniforms[i];
+
+      if ((name != uniform.name) || (v.size() != uniform.component_count))
+        continue;
+
+      auto slot = uniform.first_slot;
+
+      for (auto x : v) {
+        if (uniform.is_int)
+          m_uniforms[slot++].i = int32_t(x);
+        else
+          m_uniforms[slot++].f = x;
+      }
+
+      return true;
+    }
+
+    return false;
+  }
+
+  void sample_pixels()
+  {
+    run(PATHWAY_SIMD_PREPARE);
+
+    m_variant.sample_pixels(
+      m_uniforms.data(), m_varyings.data(), m_width, m_height);
+  }
+
+  /// @note This runs the pixel encoder, which may assign varying variables,
+  /// so it can't be const like @ref pathway::frame::encode_rgb.
+  void encode_rgb(unsigned char* rgb_buffer)
+  {
+    m_variant.encode_rgb(
+      m_uniforms.data(), m_varyings.data(), m_width, m_height, rgb_buffer);
+  }
+
+private:
+  /// @brief Storage that is aligned for the widest vectors. Since the lane
+  /// count divides the size of a block, every vector in a run of blocks is
+  /// aligned too.
+  struct alignas(64) lane_block final
+  {
+    float lanes[16];
+  };
+
+  static size_t get_block_count(size_t float_count) noexcept
+  {
+    return (float_count + 15) / 16;
+  }
+
+  void run(pathway_simd_program_id id) noexcept
+  {
+    m_variant.programs[id](m_uniforms.data(), nullptr, nullptr, nullptr);
+  }
+
+  const pathway_simd_module& m_module;
+
+  const pathway_simd_variant& m_variant;
+
+  std::vector<pathway_simd_scalar> m_uniforms;
+
+  std::vector<lane_block> m_varyings;
+
+  size_t m_width = 0;
+
+  size_t m_height = 0;
+};
+
+} // namespace simd
+
+} // namespace pathway
+
+#endif /* __cplusplus */
+
+#endif /* PATHWAY_SIMD_H_INCLUDED */
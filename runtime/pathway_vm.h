@@ -0,0 +1,680 @@
+#pragma once
+
+#ifndef PATHWAY_VM_H_INCLUDED
+#define PATHWAY_VM_H_INCLUDED
+
+// The virtual machine that runs the bytecode generated by
+// 'ptc --language bytecode'. A module can be rendered as soon as it is
+// transpiled, without compiling it, which makes it quick to try changes.
+// Modules that are compiled to C++ run much faster.
+
+#include "pathway.h"
+#include "pathway_bytecode.h"
+
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pathway {
+
+namespace vm {
+
+/// @brief The contents of a register or slot, which is always read as the
+/// type it was written as.
+union value
+{
+  float f;
+  int32_t i;
+};
+
+/// @brief The programs and variables of a bytecode module.
+class program final
+{
+public:
+  struct instruction final
+  {
+    bytecode::opcode op;
+
+    uint32_t operands[3];
+  };
+
+  struct variable final
+  {
+    std::string name;
+
+    bytecode::scalar_kind kind;
+
+    uint32_t component_count;
+
+    uint32_t first_slot;
+  };
+
+  /// @brief Reads a module and checks that every operand is in range.
+  ///
+  /// @return Null if the module is malformed.
+  static auto parse(const unsigned char* data, size_t size)
+    -> std::unique_ptr<program>
+  {
+    std::unique_ptr<program> p(new program());
+
+    reader r{ data, size };
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t math_mode = 0;
+    uint32_t uniform_count = 0;
+
+    if (!r.read(magic) || (magic != bytecode::magic))
+      return nullptr;
+
+    if (!r.read(version) || (version != bytecode::version))
+      return nullptr;
+
+    if (!r.read(math_mode) ||
+        (math_mode > uint32_t(bytecode::math_mode::fast)) ||
+        !r.read(p->m_register_count) || !r.read(p->m_uniform_slot_count) ||
+        !r.read(p->m_varying_slot_count) || !r.read(uniform_count))
+      return nullptr;
+
+    p->m_math_mode = bytecode::math_mode(math_mode);
+
+    for (uint32_t i = 0; i < uniform_count; i++) {
+
+      variable var;
+
+      uint32_t kind = 0;
+
+      if (!r.read(kind) || (kind > uint32_t(bytecode::scalar_kind::int32)) ||
+          !r.read(var.component_count) || !r.read(var.first_slot) ||
+          !r.read_string(var.name))
+        return nullptr;
+
+      var.kind = bytecode::scalar_kind(kind);
+
+      if ((uint64_t(var.first_slot) + var.component_count) >
+          p->m_uniform_slot_count)
+        return nullptr;
+
+      p->m_uniforms.emplace_back(std::move(var));
+    }
+
+    for (auto& code : p->m_programs) {
+      if (!p->parse_program(r, code))
+        return nullptr;
+    }
+
+    return p;
+  }
+
+  /// @return Null if the file can't be read or is malformed.
+  static auto load(const char* path) -> std::unique_ptr<program>
+  {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.good())
+      return nullptr;
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+
+    return parse(data.data(), data.size());
+  }
+
+  auto get_code(bytecode::program_id id) const noexcept
+    -> const std::vector<instruction>&
+  {
+    return m_programs[size_t(id)];
+  }
+
+  auto get_math_mode() const noexcept -> bytecode::math_mode
+  {
+    return m_math_mode;
+  }
+
+  uint32_t get_register_count() const noexcept { return m_register_count; }
+
+  uint32_t get_uniform_slot_count() const noexcept
+  {
+    return m_uniform_slot_count;
+  }
+
+  uint32_t get_varying_slot_count() const noexcept
+  {
+    return m_varying_slot_count;
+  }
+
+  /// @return Null if the module has no uniform variable with this name.
+  const variable* find_uniform(const std::string& name) const noexcept
+  {
+    for (const auto& var : m_uniforms) {
+      if (var.name == name)
+        return &var;
+    }
+
+    return nullptr;
+  }
+
+private:
+  class reader final
+  {
+  public:
+    reader(const unsigned char* data, size_t size) noexcept
+      : m_data(data)
+      , m_size(size)
+    {}
+
+    bool read(uint32_t& word) noexcept
+    {
+      if ((m_size - m_offset) < 4)
+        return false;
+
+      const auto* bytes = m_data + m_offset;
+
+      word = uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) |
+             (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+
+      m_offset += 4;
+
+      return true;
+    }
+
+    bool read_string(std::string& str)
+    {
+      uint32_t length = 0;
+
+      if (!read(length))
+        return false;
+
+      auto padded = (size_t(length) + 3) & ~size_t(3);
+
+      if ((m_size - m_offset) < padded)
+        return false;
+
+      str.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+
+      m_offset += padded;
+
+      return true;
+    }
+
+  private:
+    const unsigned char* m_data;
+
+    size_t m_size;
+
+    size_t m_offset = 0;
+  };
+
+  program() = default;
+
+  bool parse_program(reader& r, std::vector<instruction>& code)
+  {
+    uint32_t word_count = 0;
+
+    if (!r.read(word_count))
+      return false;
+
+    uint32_t words_read = 0;
+
+    while (words_read < word_count) {
+
+      uint32_t op = 0;
+
+      if (!r.read(op) || (op >= uint32_t(bytecode::opcode::count)))
+        return false;
+
+      instruction in{ bytecode::opcode(op), { 0, 0, 0 } };
+
+      auto f = bytecode::get_format(in.op);
+
+      auto operand_count = bytecode::get_operand_count(f);
+
+      for (uint32_t i = 0; i < operand_count; i++) {
+        if (!r.read(in.operands[i]))
+          return false;
+      }
+
+      if (!is_valid(in, f))
+        return false;
+
+      code.emplace_back(in);
+
+      words_read += 1 + operand_count;
+    }
+
+    return words_read == word_count;
+  }
+
+  bool is_valid(const instruction& in, bytecode::format f) const noexcept
+  {
+    const auto* o = in.operands;
+
+    switch (f) {
+      case bytecode::format::dst_imm:
+        return o[0] < m_register_count;
+      case bytecode::format::dst_a:
+        return (o[0] < m_register_count) && (o[1] < m_register_count);
+      case bytecode::format::dst_a_b:
+        return (o[0] < m_register_count) && (o[1] < m_register_count) &&
+               (o[2] < m_register_count);
+      case bytecode::format::dst_index:
+        return (o[0] < m_register_count) && (o[1] < get_index_limit(in.op));
+      case bytecode::format::index_src:
+        return (o[0] < get_index_limit(in.op)) && (o[1] < m_register_count);
+    }
+
+    return false;
+  }
+
+  uint32_t get_index_limit(bytecode::opcode op) const noexcept
+  {
+    switch (op) {
+      case bytecode::opcode::load_uniform:
+      case bytecode::opcode::store_uniform:
+        return m_uniform_slot_count;
+      case bytecode::opcode::load_varying:
+      case bytecode::opcode::store_varying:
+        return m_varying_slot_count;
+      case bytecode::opcode::load_input:
+        return bytecode::input_count;
+      case bytecode::opcode::store_output:
+        return bytecode::output_count;
+      default:
+        break;
+    }
+
+    return 0;
+  }
+
+  bytecode::math_mode m_math_mode = bytecode::math_mode::precise;
+
+  uint32_t m_register_count = 0;
+
+  uint32_t m_uniform_slot_count = 0;
+
+  uint32_t m_varying_slot_count = 0;
+
+  std::vector<variable> m_uniforms;
+
+  std::vector<instruction> m_programs[size_t(bytecode::program_id::count)];
+};
+
+/// @brief Renders a bytecode module, like @ref pathway::frame renders a
+/// module compiled to C++.
+///
+/// @detail The pixels are run in batches of @ref frame::lane_count, with each
+/// instruction applied to the whole batch before the next one. This spreads
+/// the cost of decoding an instruction over many pixels, and each instruction
+/// is a simple loop that the compiler can vectorize.
+class frame final
+{
+public:
+  static constexpr size_t lane_count = 64;
+
+  /// @param p The module to render, which must outlive the frame.
+  explicit frame(const program& p)
+    : m_program(p)
+    , m_registers(size_t(p.get_register_count()) * lane_count)
+    , m_uniforms(p.get_uniform_slot_count())
+  {
+    run(bytecode::program_id::init, 0);
+  }
+
+  void resize(size_t w, size_t h)
+  {
+    m_width = w;
+    m_height = h;
+
+    auto batch_count = ((w * h) + lane_count - 1) / lane_count;
+
+    m_varyings.assign(
+      batch_count * m_program.get_varying_slot_count() * lane_count, value{});
+
+  }
+
+  /// @brief Sets the value of a uniform variable of float type.
+  ///
+  /// @return False if the module has no such variable, or its type is
+  /// different.
+  bool set_uniform(const std::string& name, std::initializer_list<float> v)
+  {
+    const auto* var = m_program.find_uniform(name);
+
+    if (!var || (var->kind != bytecode::scalar_kind::float32) ||
+        (v.size() != var->component_count))
+      return false;
+
+    auto slot = var->first_slot;
+
+    for (auto x : v)
+      m_uniforms[slot++].f = x;
+
+    return true;
+  }
+
+  /// @brief Sets the value of a uniform variable of integer or boolean type.
+  bool set_uniform(const std::string& name, std::initializer_list<int32_t> v)
+  {
+    const auto* var = m_program.find_uniform(name);
+
+    if (!var || (var->kind != bytecode::scalar_kind::int32) ||
+        (v.size() != var->component_count))
+      return false;
+
+    auto slot = var->first_slot;
+
+    for (auto x : v)
+      m_uniforms[slot++].i = x;
+
+    return true;
+  }
+
+  void sample_pixels()
+  {
+    run(bytecode::program_id::prepare, 0);
+
+    auto batch_count = ((m_width * m_height) + lane_count - 1) / lane_count;
+
+    for (size_t batch = 0; batch < batch_count; batch++) {
+
+      for (size_t lane = 0; lane < lane_count; lane++) {
+
+        // Lanes past the last pixel are sampled like any other, and ignored.
+        auto i = (batch * lane_count) + lane;
+
+        auto x = (m_width > 0) ? (i % m_width) : 0;
+        auto y = (m_width > 0) ? (i / m_width) : 0;
+
+        // The same arithmetic as the C++ frame, so that the results match.
+        m_inputs[0][lane].f = (x + float(0)) / float(m_width);
+        m_inputs[1][lane].f = (y + float(0)) / float(m_height);
+        m_inputs[2][lane].f = (x + float(1)) / float(m_width);
+        m_inputs[3][lane].f = (y + float(1)) / float(m_height);
+      }
+
+      run(bytecode::program_id::sample, batch);
+    }
+  }
+
+  /// @note This runs the pixel encoder, which needs the registers of the
+  /// frame, so it can't be const like @ref pathway::frame::encode_rgb.
+  void encode_rgb(unsigned char* rgb_buffer)
+  {
+    constexpr float min_val(0);
+    constexpr float max_val(255);
+
+    auto pixel_count = m_width * m_height;
+
+    for (size_t batch = 0; (batch * lane_count) < pixel_count; batch++) {
+
+      run(bytecode::program_id::encode, batch);
+
+      const auto* outputs = m_outputs;
+
+      for (size_t lane = 0; lane < lane_count; lane++) {
+
+        auto i = (batch * lane_count) + lane;
+
+        if (i >= pixel_count)
+          break;
+
+        auto dst = rgb_buffer + (i * 3);
+
+        for (size_t c = 0; c < 3; c++)
+          dst[c] = clamp(outputs[c][lane].f * 255, min_val, max_val);
+      }
+    }
+  }
+
+private:
+  void run(bytecode::program_id id, size_t batch) noexcept
+  {
+    if (m_program.get_math_mode() == bytecode::math_mode::fast)
+      execute<fast_scalar_math>(m_program.get_code(id), batch);
+    else
+      execute<precise_scalar_math>(m_program.get_code(id), batch);
+  }
+
+  template<typename func>
+  static void map(value* d, const value* a, func f) noexcept
+  {
+    for (size_t l = 0; l < lane_count; l++)
+      d[l] = f(a[l]);
+  }
+
+  template<typename func>
+  static void map(value* d, const value* a, const value* b, func f) noexcept
+  {
+    for (size_t l = 0; l < lane_count; l++)
+      d[l] = f(a[l], b[l]);
+  }
+
+  static value make_float(float x) noexcept
+  {
+    value v;
+    v.f = x;
+    return v;
+  }
+
+  static value make_int(int32_t x) noexcept
+  {
+    value v;
+    v.i = x;
+    return v;
+  }
+
+  /// @brief Adds, subtracts or multiplies integers with wrapping, since
+  /// overflowing a signed integer is undefined.
+  static int32_t wrap(uint32_t x) noexcept
+  {
+    int32_t out;
+    memcpy(&out, &x, sizeof(out));
+    return out;
+  }
+
+  static bool can_divide(int32_t a, int32_t b) noexcept
+  {
+    using limits = std::numeric_limits<int32_t>;
+
+    return (b != 0) && !((a == limits::min()) && (b == -1));
+  }
+
+  template<typename scalar_math>
+  void execute(const std::vector<program::instruction>& code,
+               size_t batch) noexcept
+  {
+    using bytecode::opcode;
+
+    auto* varyings =
+      m_varyings.data() +
+      (batch * m_program.get_varying_slot_count() * lane_count);
+
+    for (const auto& in : code) {
+
+      const auto* o = in.operands;
+
+      // Stores have an index where other instructions have a register.
+      auto* d = (bytecode::get_format(in.op) == bytecode::format::index_src)
+                  ? nullptr
+                  : reg(o[0]);
+
+      switch (in.op) {
+        case opcode::f_const:
+        case opcode::i_const: {
+          value v;
+          memcpy(&v, &o[1], sizeof(v));
+          for (size_t l = 0; l < lane_count; l++)
+            d[l] = v;
+        } break;
+        case opcode::f_add:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(a.f + b.f);
+          });
+          break;
+        case opcode::f_sub:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(a.f - b.f);
+          });
+          break;
+        case opcode::f_mul:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(a.f * b.f);
+          });
+          break;
+        case opcode::f_div:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(a.f / b.f);
+          });
+          break;
+        case opcode::f_mod:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(std::fmod(a.f, b.f));
+          });
+          break;
+        case opcode::f_neg:
+          map(d, reg(o[1]), [](value a) { return make_float(-a.f); });
+          break;
+        case opcode::i_add:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_int(wrap(uint32_t(a.i) + uint32_t(b.i)));
+          });
+          break;
+        case opcode::i_sub:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_int(wrap(uint32_t(a.i) - uint32_t(b.i)));
+          });
+          break;
+        case opcode::i_mul:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_int(wrap(uint32_t(a.i) * uint32_t(b.i)));
+          });
+          break;
+        case opcode::i_div:
+          // Dividing by zero gives zero, rather than stopping the program.
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_int(can_divide(a.i, b.i) ? (a.i / b.i) : 0);
+          });
+          break;
+        case opcode::i_mod:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_int(can_divide(a.i, b.i) ? (a.i % b.i) : 0);
+          });
+          break;
+        case opcode::i_neg:
+          map(d, reg(o[1]), [](value a) {
+            return make_int(wrap(0u - uint32_t(a.i)));
+          });
+          break;
+        case opcode::i_not:
+          map(d, reg(o[1]), [](value a) { return make_int(~a.i); });
+          break;
+        case opcode::b_not:
+          map(d, reg(o[1]), [](value a) { return make_int(a.i == 0); });
+          break;
+        case opcode::i_to_f:
+          map(d, reg(o[1]), [](value a) { return make_float(float(a.i)); });
+          break;
+        case opcode::f_to_i:
+          // Values that don't fit in an integer, including NaN, become zero.
+          map(d, reg(o[1]), [](value a) {
+            auto in_range = (a.f > -2147483648.0f) && (a.f < 2147483648.0f);
+            return make_int(in_range ? int32_t(a.f) : 0);
+          });
+          break;
+        case opcode::i_to_b:
+          map(d, reg(o[1]), [](value a) { return make_int(a.i != 0); });
+          break;
+        case opcode::f_to_b:
+          map(d, reg(o[1]), [](value a) { return make_int(a.f != 0); });
+          break;
+        case opcode::f_exp:
+          map(d, reg(o[1]), [](value a) {
+            return make_float(scalar_math::exp(a.f));
+          });
+          break;
+        case opcode::f_log:
+          map(d, reg(o[1]), [](value a) {
+            return make_float(scalar_math::log(a.f));
+          });
+          break;
+        case opcode::f_pow:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(scalar_math::pow(a.f, b.f));
+          });
+          break;
+        case opcode::f_sin:
+          map(d, reg(o[1]), [](value a) {
+            return make_float(scalar_math::sin(a.f));
+          });
+          break;
+        case opcode::f_cos:
+          map(d, reg(o[1]), [](value a) {
+            return make_float(scalar_math::cos(a.f));
+          });
+          break;
+        case opcode::f_atan2:
+          map(d, reg(o[1]), reg(o[2]), [](value a, value b) {
+            return make_float(scalar_math::atan2(a.f, b.f));
+          });
+          break;
+        case opcode::load_uniform:
+          for (size_t l = 0; l < lane_count; l++)
+            d[l] = m_uniforms[o[1]];
+          break;
+        case opcode::store_uniform:
+          // Uniform values are computed once, in the first lane.
+          m_uniforms[o[0]] = reg(o[1])[0];
+          break;
+        case opcode::load_varying:
+          memcpy(d, varyings + (o[1] * lane_count), sizeof(value) * lane_count);
+          break;
+        case opcode::store_varying:
+          memcpy(varyings + (o[0] * lane_count),
+                 reg(o[1]),
+                 sizeof(value) * lane_count);
+          break;
+        case opcode::load_input:
+          memcpy(d, m_inputs[o[1]], sizeof(value) * lane_count);
+          break;
+        case opcode::store_output:
+          memcpy(m_outputs[o[0]], reg(o[1]), sizeof(value) * lane_count);
+          break;
+        case opcode::count:
+          break;
+      }
+    }
+  }
+
+  value* reg(uint32_t index) noexcept
+  {
+    return m_registers.data() + (size_t(index) * lane_count);
+  }
+
+  const program& m_program;
+
+  /// @brief Each register has a value for every lane.
+  std::vector<value> m_registers;
+
+  std::vector<value> m_uniforms;
+
+  /// @brief The varying slots of each batch, with a value for every lane.
+  std::vector<value> m_varyings;
+
+  value m_inputs[bytecode::input_count][lane_count]{};
+
+  /// @brief The color of each pixel of the batch being encoded.
+  value m_outputs[bytecode::output_count][lane_count]{};
+
+  size_t m_width = 0;
+
+  size_t m_height = 0;
+};
+
+} // namespace vm
+
+} // namespace pathway
+
+#endif // PATHWAY_VM_H_INCLUDED
@@ -1,6 +1,17 @@
 #include <pathway.h>
 
+// The tests are also run with the virtual machine, from the bytecode of the
+// module, and with the module compiled to C with vector extensions, to check
+// that they render the same images as the C++ code.
+#if defined(BYTECODE_PATH)
+#include <pathway_vm.h>
+#elif defined(SIMD_MODULE)
+#include <pathway_simd.h>
+
+extern "C" const pathway_simd_module SIMD_MODULE;
+#else
 #include HEADER
+#endif
 
 #include <limits>
 #include <vector>
@@ -96,11 +107,24 @@ GetDifference()
 int
 main()
 {
+#ifdef BYTECODE_PATH
+  auto program = pathway::vm::program::load(BYTECODE_PATH);
+
+  if (!program) {
+    std::cerr << "Failed to load '" << BYTECODE_PATH << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  pathway::vm::frame frame(*program);
+#elif defined(SIMD_MODULE)
+  pathway::simd::frame frame(SIMD_MODULE);
+#else
   using uniform_data = example::uniform_data<float, int>;
 
   using varying_data = example::varying_data<float, int>;
 
   pathway::frame<uniform_data, varying_data, float> frame;
+#endif
 
   frame.resize(width, height);
 
@@ -32,6 +32,18 @@ AnalysisPass::Invoke(const Module& module, DiagObserver& diagObserver)
   return success;
 }
 
+bool
+AnalysisPass::Invoke(const Module& module)
+{
+  SetModule(&module);
+
+  auto success = AnalyzeModule();
+
+  SetModule(nullptr);
+
+  return success;
+}
+
 DiagObserver&
 AnalysisPass::GetDiagObserver() noexcept
 {
@@ -13,6 +13,9 @@ public:
 
   bool Invoke(const Module& module, DiagObserver& diagObserver);
 
+  /// @brief Runs a pass that does not emit diagnostics.
+  bool Invoke(const Module& module);
+
 protected:
   void SetDiagObserver(DiagObserver* diagObserver) noexcept;
 
@@ -0,0 +1,70 @@
+#include "builtins.h"
+
+#include <array>
+
+namespace {
+
+struct BuiltinInfo final
+{
+  BuiltinID id;
+
+  std::string_view name;
+
+  size_t paramCount;
+};
+
+const std::array<BuiltinInfo, 6> gBuiltinTable{
+  { { BuiltinID::Exp, "exp", 1 },
+    { BuiltinID::Log, "log", 1 },
+    { BuiltinID::Pow, "pow", 2 },
+    { BuiltinID::Sin, "sin", 1 },
+    { BuiltinID::Cos, "cos", 1 },
+    { BuiltinID::Atan2, "atan2", 2 } }
+};
+
+/// @brief The types that the runtime has an overload of each builtin for.
+const std::array<TypeID, 4> gBuiltinArgTypes{
+  { TypeID::Float, TypeID::Vec2, TypeID::Vec3, TypeID::Vec4 }
+};
+
+const BuiltinInfo&
+GetBuiltinInfo(BuiltinID builtinID) noexcept
+{
+  return gBuiltinTable[size_t(builtinID)];
+}
+
+} // namespace
+
+auto
+FindBuiltin(const std::string& name) -> std::optional<BuiltinID>
+{
+  for (const auto& info : gBuiltinTable) {
+    if (info.name == name)
+      return info.id;
+  }
+
+  return {};
+}
+
+std::string_view
+GetBuiltinName(BuiltinID builtinID) noexcept
+{
+  return GetBuiltinInfo(builtinID).name;
+}
+
+size_t
+GetBuiltinParamCount(BuiltinID builtinID) noexcept
+{
+  return GetBuiltinInfo(builtinID).paramCount;
+}
+
+bool
+IsBuiltinArgType(TypeID typeID) noexcept
+{
+  for (auto argType : gBuiltinArgTypes) {
+    if (argType == typeID)
+      return true;
+  }
+
+  return false;
+}
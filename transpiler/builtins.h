@@ -0,0 +1,34 @@
+#pragma once
+
+#include "type.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+/// @brief Functions that are provided by the runtime rather than declared in
+/// the module. They operate on floats and, component-wise, on float vectors.
+enum class BuiltinID
+{
+  Exp,
+  Log,
+  Pow,
+  Sin,
+  Cos,
+  Atan2
+};
+
+auto
+FindBuiltin(const std::string& name) -> std::optional<BuiltinID>;
+
+std::string_view
+GetBuiltinName(BuiltinID builtinID) noexcept;
+
+size_t
+GetBuiltinParamCount(BuiltinID builtinID) noexcept;
+
+/// @brief Indicates whether the arguments of a builtin function can be of a
+/// type. All the arguments of a call have to be of the same type, which is
+/// also the type of the result.
+bool
+IsBuiltinArgType(TypeID typeID) noexcept;
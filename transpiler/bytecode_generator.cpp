@@ -0,0 +1,193 @@
+#include "bytecode_generator.h"
+
+#include "bytecode_lowering.h"
+#include "decl.h"
+#include "module.h"
+
+#include <algorithm>
+
+namespace bytecode {
+
+namespace {
+
+using pathway::bytecode::format;
+using pathway::bytecode::opcode;
+using pathway::bytecode::program_id;
+using pathway::bytecode::scalar_kind;
+
+/// @brief Renames the registers of a program so that a register is reused
+/// once the value it holds is no longer read, which keeps the registers of a
+/// batch small enough to stay in cache.
+///
+/// @return The number of registers the program needs.
+uint32_t
+AllocateRegisters(std::vector<Instruction>& instructions)
+{
+  const size_t none = size_t(-1);
+
+  uint32_t valueCount = 0;
+
+  for (const auto& instruction : instructions) {
+    if (get_format(instruction.op) != format::index_src)
+      valueCount = std::max(valueCount, instruction.operands[0] + 1);
+  }
+
+  std::vector<size_t> lastRead(valueCount, none);
+
+  auto forEachRead = [](const Instruction& instruction, auto func) {
+    switch (get_format(instruction.op)) {
+      case format::dst_imm:
+      case format::dst_index:
+        break;
+      case format::dst_a:
+      case format::index_src:
+        func(instruction.operands[1]);
+        break;
+      case format::dst_a_b:
+        func(instruction.operands[1]);
+        if (instruction.operands[2] != instruction.operands[1])
+          func(instruction.operands[2]);
+        break;
+    }
+  };
+
+  for (size_t i = 0; i < instructions.size(); i++)
+    forEachRead(instructions[i], [&](uint32_t reg) { lastRead[reg] = i; });
+
+  std::vector<uint32_t> physical(valueCount);
+
+  std::vector<uint32_t> freeRegs;
+
+  uint32_t registerCount = 0;
+
+  for (size_t i = 0; i < instructions.size(); i++) {
+
+    auto& instruction = instructions[i];
+
+    // An instruction only reads the lane it writes, so it may write the same
+    // register as the one it last reads.
+    forEachRead(instruction, [&](uint32_t reg) {
+      if (lastRead[reg] == i)
+        freeRegs.emplace_back(physical[reg]);
+    });
+
+    auto f = get_format(instruction.op);
+
+    if (f != format::index_src) {
+
+      auto value = instruction.operands[0];
+
+      if (freeRegs.empty()) {
+        physical[value] = registerCount++;
+      } else {
+        physical[value] = freeRegs.back();
+        freeRegs.pop_back();
+      }
+
+      instruction.operands[0] = physical[value];
+
+      if (lastRead[value] == none)
+        freeRegs.emplace_back(physical[value]);
+    }
+
+    if ((f == format::dst_a) || (f == format::dst_a_b))
+      instruction.operands[1] = physical[instruction.operands[1]];
+
+    if (f == format::dst_a_b)
+      instruction.operands[2] = physical[instruction.operands[2]];
+
+    if (f == format::index_src)
+      instruction.operands[1] = physical[instruction.operands[1]];
+  }
+
+  return registerCount;
+}
+
+void
+WriteWord(std::ostream& stream, uint32_t word)
+{
+  char bytes[4]{ char(word & 0xff),
+                 char((word >> 8) & 0xff),
+                 char((word >> 16) & 0xff),
+                 char((word >> 24) & 0xff) };
+
+  stream.write(bytes, sizeof(bytes));
+}
+
+void
+WriteString(std::ostream& stream, const std::string& str)
+{
+  WriteWord(stream, uint32_t(str.size()));
+
+  stream.write(str.data(), std::streamsize(str.size()));
+
+  // Padded to a whole word.
+  for (size_t i = str.size(); (i % 4) != 0; i++)
+    stream.put('\0');
+}
+
+void
+WriteProgram(std::ostream& stream, const std::vector<Instruction>& program)
+{
+  uint32_t wordCount = 0;
+
+  for (const auto& instruction : program)
+    wordCount += 1 + get_operand_count(get_format(instruction.op));
+
+  WriteWord(stream, wordCount);
+
+  for (const auto& instruction : program) {
+
+    WriteWord(stream, uint32_t(instruction.op));
+
+    auto operandCount = get_operand_count(get_format(instruction.op));
+
+    for (uint32_t i = 0; i < operandCount; i++)
+      WriteWord(stream, instruction.operands[i]);
+  }
+}
+
+} // namespace
+
+void
+Generator::Generate(const Module& module)
+{
+  if (!module.HasModuleExportDecl())
+    return;
+
+  auto lowered = Lower(module);
+
+  uint32_t registerCount = 0;
+
+  for (auto& program : lowered.programs) {
+    registerCount = std::max(registerCount,
+                             AllocateRegisters(program.instructions));
+  }
+
+  auto mathMode = (GetOptions().mathMode == MathMode::Fast)
+                    ? pathway::bytecode::math_mode::fast
+                    : pathway::bytecode::math_mode::precise;
+
+  WriteWord(os, pathway::bytecode::magic);
+  WriteWord(os, pathway::bytecode::version);
+  WriteWord(os, uint32_t(mathMode));
+  WriteWord(os, registerCount);
+  WriteWord(os, uint32_t(lowered.uniformSlotKinds.size()));
+  WriteWord(os, uint32_t(lowered.varyingSlotKinds.size()));
+
+  // Only the variables are named, so that they can be set by the host.
+  WriteWord(os, uint32_t(lowered.uniformVars.size()));
+
+  for (const auto& uniformVar : lowered.uniformVars) {
+
+    WriteWord(os, uint32_t(lowered.uniformSlotKinds[uniformVar.firstSlot]));
+    WriteWord(os, uniformVar.componentCount);
+    WriteWord(os, uniformVar.firstSlot);
+    WriteString(os, uniformVar.var->Identifier());
+  }
+
+  for (const auto& program : lowered.programs)
+    WriteProgram(os, program.instructions);
+}
+
+} // namespace bytecode
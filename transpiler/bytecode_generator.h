@@ -0,0 +1,24 @@
+#pragma once
+
+#include "generator.h"
+
+namespace bytecode {
+
+/// @brief Generates the bytecode that the virtual machine in the runtime
+/// runs, so that a module can be rendered without compiling C++.
+///
+/// @detail Every function call is inlined and every vector is split into its
+/// components, so each program is a straight sequence of scalar instructions
+/// that the machine runs on a batch of pixels at a time. The format is
+/// described in 'pathway_bytecode.h'.
+class Generator final : public ::Generator
+{
+public:
+  Generator(std::ostream& os, const GeneratorOptions& options = {})
+    : ::Generator(os, options)
+  {}
+
+  void Generate(const Module& module) override;
+};
+
+} // namespace bytecode
@@ -0,0 +1,939 @@
+#include "bytecode_lowering.h"
+
+#include "abort.h"
+#include "decl.h"
+#include "module.h"
+#include "stmt.h"
+#include "uniform_expr_analysis.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+
+namespace bytecode {
+
+namespace {
+
+using pathway::bytecode::opcode;
+using pathway::bytecode::program_id;
+using pathway::bytecode::scalar_kind;
+
+/// @brief The registers that hold a value, one for each component.
+struct Value final
+{
+  std::vector<uint32_t> regs;
+
+  /// @brief Either float, int or bool.
+  TypeID scalarType = TypeID::Float;
+};
+
+TypeID
+GetScalarType(TypeID typeID) noexcept
+{
+  switch (typeID) {
+    case TypeID::Int:
+    case TypeID::Vec2i:
+    case TypeID::Vec3i:
+    case TypeID::Vec4i:
+      return TypeID::Int;
+    case TypeID::Bool:
+      return TypeID::Bool;
+    default:
+      break;
+  }
+
+  return TypeID::Float;
+}
+
+size_t
+GetComponentCount(TypeID typeID) noexcept
+{
+  switch (typeID) {
+    case TypeID::Void:
+      return 0;
+    case TypeID::Mat2:
+      return 4;
+    case TypeID::Mat3:
+      return 9;
+    case TypeID::Mat4:
+      return 16;
+    default:
+      break;
+  }
+
+  return GetVectorComponentCount(typeID).value_or(1);
+}
+
+auto
+GetMatrixSize(TypeID typeID) noexcept -> std::optional<size_t>
+{
+  switch (typeID) {
+    case TypeID::Mat2:
+      return 2;
+    case TypeID::Mat3:
+      return 3;
+    case TypeID::Mat4:
+      return 4;
+    default:
+      break;
+  }
+
+  return std::nullopt;
+}
+
+/// @brief Gets how the register that an instruction writes is interpreted,
+/// for the instructions that don't load a slot.
+scalar_kind
+GetResultKind(opcode op) noexcept
+{
+  switch (op) {
+    case opcode::i_const:
+    case opcode::i_add:
+    case opcode::i_sub:
+    case opcode::i_mul:
+    case opcode::i_div:
+    case opcode::i_mod:
+    case opcode::i_neg:
+    case opcode::i_not:
+    case opcode::b_not:
+    case opcode::f_to_i:
+    case opcode::i_to_b:
+    case opcode::f_to_b:
+      return scalar_kind::int32;
+    default:
+      break;
+  }
+
+  return scalar_kind::float32;
+}
+
+scalar_kind
+GetScalarKind(TypeID scalarType) noexcept
+{
+  return (scalarType == TypeID::Float) ? scalar_kind::float32
+                                       : scalar_kind::int32;
+}
+
+/// @brief Builds the instructions of one program, with a new register for
+/// each value.
+class ProgramBuilder final
+{
+public:
+  auto TakeProgram() noexcept -> Program { return std::move(mProgram); }
+
+  /// @brief Emits an instruction that writes a new register.
+  ///
+  /// @return The register that is written.
+  uint32_t Emit(opcode op, uint32_t a, uint32_t b = 0)
+  {
+    return Emit(op, a, b, GetResultKind(op));
+  }
+
+  /// @brief Emits an instruction that loads a slot into a new register.
+  uint32_t EmitLoad(opcode op, uint32_t index, scalar_kind kind)
+  {
+    return Emit(op, index, 0, kind);
+  }
+
+  /// @brief Emits an instruction that stores a register.
+  void EmitStore(opcode op, uint32_t index, uint32_t src)
+  {
+    mProgram.instructions.emplace_back(Instruction{ op, { index, src, 0 } });
+  }
+
+  uint32_t FloatConst(float value)
+  {
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return Const(opcode::f_const, bits, mFloatConsts);
+  }
+
+  uint32_t IntConst(int32_t value)
+  {
+    return Const(opcode::i_const, uint32_t(value), mIntConsts);
+  }
+
+private:
+  uint32_t Emit(opcode op, uint32_t a, uint32_t b, scalar_kind kind)
+  {
+    auto dst = uint32_t(mProgram.registerKinds.size());
+
+    mProgram.instructions.emplace_back(Instruction{ op, { dst, a, b } });
+
+    mProgram.registerKinds.emplace_back(kind);
+
+    return dst;
+  }
+
+  uint32_t Const(opcode op, uint32_t bits, std::map<uint32_t, uint32_t>& regs)
+  {
+    auto it = regs.find(bits);
+    if (it != regs.end())
+      return it->second;
+
+    auto reg = Emit(op, bits);
+
+    regs.emplace(bits, reg);
+
+    return reg;
+  }
+
+  Program mProgram;
+
+  /// @brief Maps the bits of each constant to the register holding it.
+  std::map<uint32_t, uint32_t> mFloatConsts;
+
+  std::map<uint32_t, uint32_t> mIntConsts;
+};
+
+
+/// @brief Where the values of the uniform variables, the hoisted
+/// expressions and the varying variables are kept.
+struct SlotLayout final
+{
+  std::map<const VarDecl*, uint32_t> uniformSlots;
+
+  std::vector<uint32_t> hoistedSlots;
+
+  std::map<const VarDecl*, uint32_t> varyingSlots;
+};
+
+/// @brief The state shared by the functions inlined into a program.
+struct ProgramState final
+{
+  ProgramState(const SlotLayout& l)
+    : layout(l)
+  {}
+
+  ProgramBuilder builder;
+
+  const SlotLayout& layout;
+
+  /// @brief Null if the hoisted expressions are computed by this program,
+  /// rather than loaded.
+  const UniformExprAnalysis* uniformExprs = nullptr;
+
+  std::map<const VarDecl*, Value> uniformValues;
+
+  /// @brief The current value of each varying variable that was read or
+  /// assigned.
+  std::map<const VarDecl*, Value> varyingValues;
+
+  std::set<const VarDecl*> assignedVaryings;
+
+  std::set<const FuncDecl*> callStack;
+};
+
+/// @brief Compiles the body of a function, or an expression, into the
+/// program.
+class FuncCompiler final
+  : public StmtVisitor
+  , public ExprVisitor
+{
+public:
+  FuncCompiler(ProgramState& state)
+    : mState(state)
+    , mBuilder(state.builder)
+  {}
+
+  void BindLocal(const VarDecl& varDecl, const Value& value)
+  {
+    mLocals[&varDecl] = Convert(value, GetScalarType(varDecl.GetTypeID()));
+  }
+
+  auto ReturnValue() const noexcept -> const Value& { return mReturnValue; }
+
+  Value Compile(const Expr& expr)
+  {
+    if (mState.uniformExprs) {
+
+      auto index = FindHoistedIndex(expr);
+
+      if (index) {
+        auto type = expr.GetType().value().ID();
+        return LoadSlots(opcode::load_uniform,
+                         mState.layout.hoistedSlots.at(*index),
+                         type);
+      }
+    }
+
+    expr.AcceptVisitor(*this);
+
+    return std::move(mResult);
+  }
+
+  /// @brief Converts each component of a value to another scalar type.
+  Value Convert(const Value& value, TypeID scalarType)
+  {
+    if (value.scalarType == scalarType)
+      return value;
+
+    auto op = opcode::i_to_f;
+
+    if (scalarType == TypeID::Int) {
+      // Booleans are already zero or one.
+      if (value.scalarType == TypeID::Bool)
+        return Value{ value.regs, TypeID::Int };
+      op = opcode::f_to_i;
+    } else if (scalarType == TypeID::Bool) {
+      op = (value.scalarType == TypeID::Int) ? opcode::i_to_b : opcode::f_to_b;
+    }
+
+    Value out{ {}, scalarType };
+
+    for (auto reg : value.regs)
+      out.regs.emplace_back(mBuilder.Emit(op, reg));
+
+    return out;
+  }
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    if (mReturned)
+      return;
+
+    auto value = Compile(assignmentStmt.RValue());
+
+    auto type = assignmentStmt.LValue().GetType();
+
+    if (type)
+      value = Convert(value, GetScalarType(type->ID()));
+
+    Assign(assignmentStmt.LValue(), value);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    if (mReturned)
+      return;
+
+    const auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr()) {
+      BindLocal(varDecl, Compile(varDecl.InitExpr()));
+      return;
+    }
+
+    auto scalarType = GetScalarType(varDecl.GetTypeID());
+
+    auto zero = (scalarType == TypeID::Float) ? mBuilder.FloatConst(0)
+                                              : mBuilder.IntConst(0);
+
+    auto count = GetComponentCount(varDecl.GetTypeID());
+
+    mLocals[&varDecl] = Value{ std::vector<uint32_t>(count, zero), scalarType };
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    if (mReturned)
+      return;
+
+    mReturnValue = Compile(returnStmt.ReturnValue());
+
+    mReturned = true;
+  }
+
+  void Visit(const IntLiteral& intLiteral) override
+  {
+    mResult = Value{ { mBuilder.IntConst(int32_t(intLiteral.Value())) },
+                     TypeID::Int };
+  }
+
+  void Visit(const BoolLiteral& boolLiteral) override
+  {
+    mResult = Value{ { mBuilder.IntConst(boolLiteral.Value() ? 1 : 0) },
+                     TypeID::Bool };
+  }
+
+  void Visit(const FloatLiteral& floatLiteral) override
+  {
+    mResult = Value{ { mBuilder.FloatConst(float(floatLiteral.Value())) },
+                     TypeID::Float };
+  }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    auto left = Compile(binaryExpr.LeftExpr());
+
+    auto right = Compile(binaryExpr.RightExpr());
+
+    auto leftType = binaryExpr.LeftExpr().GetType().value().ID();
+
+    auto rightType = binaryExpr.RightExpr().GetType().value().ID();
+
+    auto scalarType = GetScalarType(binaryExpr.GetType().value().ID());
+
+    left = Convert(left, scalarType);
+
+    right = Convert(right, scalarType);
+
+    auto matrixSize = GetMatrixSize(leftType);
+
+    if ((binaryExpr.GetKind() == BinaryExpr::Kind::Mul) && matrixSize &&
+        (leftType == rightType)) {
+      mResult = MultiplyMatrices(left, right, *matrixSize);
+      return;
+    }
+
+    auto isFloat = scalarType == TypeID::Float;
+
+    auto op = opcode::f_add;
+
+    switch (binaryExpr.GetKind()) {
+      case BinaryExpr::Kind::Add:
+        op = isFloat ? opcode::f_add : opcode::i_add;
+        break;
+      case BinaryExpr::Kind::Sub:
+        op = isFloat ? opcode::f_sub : opcode::i_sub;
+        break;
+      case BinaryExpr::Kind::Mul:
+        op = isFloat ? opcode::f_mul : opcode::i_mul;
+        break;
+      case BinaryExpr::Kind::Div:
+        op = isFloat ? opcode::f_div : opcode::i_div;
+        break;
+      case BinaryExpr::Kind::Mod:
+        op = isFloat ? opcode::f_mod : opcode::i_mod;
+        break;
+    }
+
+    mResult = ComponentWise(op, left, right);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    auto value = Compile(unaryExpr.BaseExpr());
+
+    auto op = opcode::f_neg;
+
+    switch (unaryExpr.GetKind()) {
+      case UnaryExpr::Kind::LogicalNot:
+        op = opcode::b_not;
+        break;
+      case UnaryExpr::Kind::BitwiseNot:
+        op = opcode::i_not;
+        break;
+      case UnaryExpr::Kind::Negate:
+        if (value.scalarType != TypeID::Float)
+          op = opcode::i_neg;
+        break;
+    }
+
+    mResult = Value{ {}, value.scalarType };
+
+    for (auto reg : value.regs)
+      mResult.regs.emplace_back(mBuilder.Emit(op, reg));
+  }
+
+  void Visit(const GroupExpr& groupExpr) override
+  {
+    groupExpr.Recurse(*this);
+  }
+
+  void Visit(const VarRef& varRef) override
+  {
+    const auto& var = varRef.ResolvedVar();
+
+    auto localIt = mLocals.find(&var);
+    if (localIt != mLocals.end()) {
+      mResult = localIt->second;
+      return;
+    }
+
+    if (var.IsUniformGlobal()) {
+      mResult = LoadGlobal(var,
+                           opcode::load_uniform,
+                           mState.layout.uniformSlots,
+                           mState.uniformValues);
+    } else {
+      mResult = LoadGlobal(var,
+                           opcode::load_varying,
+                           mState.layout.varyingSlots,
+                           mState.varyingValues);
+    }
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    std::vector<Value> args;
+
+    for (const auto& arg : funcCall.Args())
+      args.emplace_back(Compile(*arg));
+
+    if (funcCall.IsBuiltin()) {
+      mResult = CallBuiltin(funcCall.GetBuiltinID(), args);
+      return;
+    }
+
+    const auto& funcDecl = funcCall.GetFuncDecl();
+
+    if (!mState.callStack.emplace(&funcDecl).second) {
+      ABORT("'",
+            funcDecl.Identifier(),
+            "' calls itself, which never returns without control flow");
+    }
+
+    FuncCompiler callee(mState);
+
+    const auto& params = funcDecl.GetParamList();
+
+    for (size_t i = 0; i < params.size(); i++)
+      callee.BindLocal(*params[i], args.at(i));
+
+    funcDecl.AcceptBodyVisitor(callee);
+
+    mState.callStack.erase(&funcDecl);
+
+    mResult = Convert(callee.ReturnValue(),
+                      GetScalarType(funcDecl.ReturnType().ID()));
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    auto typeID = typeConstructor.GetType().value().ID();
+
+    auto scalarType = GetScalarType(typeID);
+
+    auto count = GetComponentCount(typeID);
+
+    Value components{ {}, scalarType };
+
+    for (const auto& arg : typeConstructor.Args()) {
+
+      auto value = Convert(Compile(*arg), scalarType);
+
+      for (auto reg : value.regs)
+        components.regs.emplace_back(reg);
+    }
+
+    mResult = Value{ {}, scalarType };
+
+    if (components.regs.size() == 1) {
+
+      auto matrixSize = GetMatrixSize(typeID);
+
+      // A matrix made from a scalar is a diagonal matrix, while a vector
+      // made from a scalar has it in every component.
+      for (size_t i = 0; i < count; i++) {
+        if (matrixSize && ((i % (*matrixSize + 1)) != 0))
+          mResult.regs.emplace_back(mBuilder.FloatConst(0));
+        else
+          mResult.regs.emplace_back(components.regs[0]);
+      }
+
+      return;
+    }
+
+    components.regs.resize(count);
+
+    mResult.regs = std::move(components.regs);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    auto base = Compile(memberExpr.BaseExpr());
+
+    auto swizzle = GetSwizzle(memberExpr);
+
+    mResult = Value{ {}, base.scalarType };
+
+    for (auto index : swizzle.Indices())
+      mResult.regs.emplace_back(base.regs.at(index));
+  }
+
+private:
+  auto FindHoistedIndex(const Expr& expr) const -> std::optional<size_t>
+  {
+    auto name = mState.uniformExprs->FindHoistedName(expr);
+    if (!name)
+      return std::nullopt;
+
+    const auto& hoistedExprs = mState.uniformExprs->HoistedExprs();
+
+    for (size_t i = 0; i < hoistedExprs.size(); i++) {
+      if (hoistedExprs[i].name == *name)
+        return i;
+    }
+
+    return std::nullopt;
+  }
+
+  static Swizzle GetSwizzle(const MemberExpr& memberExpr)
+  {
+    auto baseType = memberExpr.BaseExpr().GetType().value().ID();
+
+    auto swizzle = Swizzle::Make(memberExpr.MemberName().Identifier(),
+                                 GetComponentCount(baseType));
+
+    if (!swizzle)
+      ABORT("'", memberExpr.MemberName().Identifier(), "' is not a swizzle");
+
+    return *swizzle;
+  }
+
+  Value LoadSlots(opcode op, uint32_t firstSlot, TypeID typeID)
+  {
+    Value value{ {}, GetScalarType(typeID) };
+
+    auto kind = GetScalarKind(value.scalarType);
+
+    for (size_t i = 0; i < GetComponentCount(typeID); i++) {
+      value.regs.emplace_back(
+        mBuilder.EmitLoad(op, firstSlot + uint32_t(i), kind));
+    }
+
+    return value;
+  }
+
+  Value LoadGlobal(const VarDecl& var,
+                   opcode op,
+                   const std::map<const VarDecl*, uint32_t>& slots,
+                   std::map<const VarDecl*, Value>& values)
+  {
+    auto it = values.find(&var);
+    if (it != values.end())
+      return it->second;
+
+    auto value = LoadSlots(op, slots.at(&var), var.GetTypeID());
+
+    values.emplace(&var, value);
+
+    return value;
+  }
+
+  void Assign(const Expr& lValue, const Value& value)
+  {
+    if (const auto* varRef = dynamic_cast<const VarRef*>(&lValue)) {
+
+      const auto* var = &varRef->ResolvedVar();
+
+      if (mLocals.count(var) != 0) {
+        mLocals[var] = value;
+      } else if (var->IsVaryingGlobal()) {
+        mState.varyingValues[var] = value;
+        mState.assignedVaryings.emplace(var);
+      } else {
+        ABORT("uniform variable '", var->Identifier(), "' is assigned");
+      }
+
+      return;
+    }
+
+    if (const auto* memberExpr = dynamic_cast<const MemberExpr*>(&lValue)) {
+
+      auto base = Compile(memberExpr->BaseExpr());
+
+      auto swizzle = GetSwizzle(*memberExpr);
+
+      for (size_t i = 0; i < swizzle.Size(); i++) {
+        auto src = value.regs.at((value.regs.size() == 1) ? 0 : i);
+        base.regs.at(swizzle.At(i)) = src;
+      }
+
+      Assign(memberExpr->BaseExpr(), base);
+
+      return;
+    }
+
+    ABORT("an expression that isn't a variable is assigned");
+  }
+
+  /// @brief Applies an operation to each component of two values. A scalar
+  /// is applied to each component of the other value.
+  Value ComponentWise(opcode op, const Value& a, const Value& b)
+  {
+    auto count = std::max(a.regs.size(), b.regs.size());
+
+    Value out{ {}, a.scalarType };
+
+    for (size_t i = 0; i < count; i++) {
+      auto aReg = a.regs.at((a.regs.size() == 1) ? 0 : i);
+      auto bReg = b.regs.at((b.regs.size() == 1) ? 0 : i);
+      out.regs.emplace_back(mBuilder.Emit(op, aReg, bReg));
+    }
+
+    return out;
+  }
+
+  /// @brief Multiplies two square matrices, which are stored by column.
+  Value MultiplyMatrices(const Value& a, const Value& b, size_t n)
+  {
+    Value out{ {}, TypeID::Float };
+
+    for (size_t column = 0; column < n; column++) {
+
+      for (size_t row = 0; row < n; row++) {
+
+        auto sum = mBuilder.Emit(
+          opcode::f_mul, a.regs.at(row), b.regs.at(column * n));
+
+        for (size_t k = 1; k < n; k++) {
+          auto product = mBuilder.Emit(opcode::f_mul,
+                                       a.regs.at((k * n) + row),
+                                       b.regs.at((column * n) + k));
+          sum = mBuilder.Emit(opcode::f_add, sum, product);
+        }
+
+        out.regs.emplace_back(sum);
+      }
+    }
+
+    return out;
+  }
+
+  Value CallBuiltin(BuiltinID builtinID, std::vector<Value>& args)
+  {
+    for (auto& arg : args)
+      arg = Convert(arg, TypeID::Float);
+
+    auto op = opcode::f_exp;
+
+    switch (builtinID) {
+      case BuiltinID::Exp:
+        op = opcode::f_exp;
+        break;
+      case BuiltinID::Log:
+        op = opcode::f_log;
+        break;
+      case BuiltinID::Pow:
+        return ComponentWise(opcode::f_pow, args.at(0), args.at(1));
+      case BuiltinID::Sin:
+        op = opcode::f_sin;
+        break;
+      case BuiltinID::Cos:
+        op = opcode::f_cos;
+        break;
+      case BuiltinID::Atan2:
+        return ComponentWise(opcode::f_atan2, args.at(0), args.at(1));
+    }
+
+    Value out{ {}, TypeID::Float };
+
+    for (auto reg : args.at(0).regs)
+      out.regs.emplace_back(mBuilder.Emit(op, reg));
+
+    return out;
+  }
+
+  ProgramState& mState;
+
+  ProgramBuilder& mBuilder;
+
+  /// @brief The value of each parameter and local variable.
+  std::map<const VarDecl*, Value> mLocals;
+
+  Value mResult;
+
+  Value mReturnValue;
+
+  /// @brief Whether a return statement was compiled, after which the rest of
+  /// the function is never run.
+  bool mReturned = false;
+};
+
+void
+StoreSlots(ProgramBuilder& builder,
+           opcode op,
+           uint32_t firstSlot,
+           const Value& value)
+{
+  for (size_t i = 0; i < value.regs.size(); i++)
+    builder.EmitStore(op, firstSlot + uint32_t(i), value.regs[i]);
+}
+
+/// @brief Stores the varying variables that were assigned, once the pixel
+/// sampler or encoder is done.
+void
+StoreVaryings(ProgramState& state)
+{
+  for (const auto* var : state.assignedVaryings) {
+    StoreSlots(state.builder,
+               opcode::store_varying,
+               state.layout.varyingSlots.at(var),
+               state.varyingValues.at(var));
+  }
+}
+
+const FuncDecl*
+FindEntryPoint(const Module& module, bool pixelSampler)
+{
+  for (const auto& func : module.Funcs()) {
+    if (pixelSampler ? func->IsPixelSampler() : func->IsPixelEncoder())
+      return func.get();
+  }
+
+  return nullptr;
+}
+
+void
+CompileInit(const Module& module, ProgramState& state)
+{
+  for (const auto* var : module.UniformGlobalVars()) {
+
+    if (!var->HasInitExpr())
+      continue;
+
+    FuncCompiler compiler(state);
+
+    auto value = compiler.Convert(compiler.Compile(var->InitExpr()),
+                                  GetScalarType(var->GetTypeID()));
+
+    StoreSlots(state.builder,
+               opcode::store_uniform,
+               state.layout.uniformSlots.at(var),
+               value);
+  }
+}
+
+void
+CompilePrepare(const UniformExprAnalysis& uniformExprs, ProgramState& state)
+{
+  const auto& hoistedExprs = uniformExprs.HoistedExprs();
+
+  for (size_t i = 0; i < hoistedExprs.size(); i++) {
+
+    FuncCompiler compiler(state);
+
+    StoreSlots(state.builder,
+               opcode::store_uniform,
+               state.layout.hoistedSlots[i],
+               compiler.Compile(*hoistedExprs[i].expr));
+  }
+}
+
+void
+CompileSample(const FuncDecl& sampler, ProgramState& state)
+{
+  FuncCompiler compiler(state);
+
+  const auto& params = sampler.GetParamList();
+
+  for (uint32_t i = 0; (i < params.size()) && (i < 2); i++) {
+
+    Value value{ {}, TypeID::Float };
+
+    value.regs.emplace_back(
+      state.builder.Emit(opcode::load_input, (i * 2) + 0));
+
+    value.regs.emplace_back(
+      state.builder.Emit(opcode::load_input, (i * 2) + 1));
+
+    compiler.BindLocal(*params[i], value);
+  }
+
+  sampler.AcceptBodyVisitor(compiler);
+
+  StoreVaryings(state);
+}
+
+void
+CompileEncode(const FuncDecl& encoder, ProgramState& state)
+{
+  FuncCompiler compiler(state);
+
+  encoder.AcceptBodyVisitor(compiler);
+
+  auto color = compiler.Convert(compiler.ReturnValue(), TypeID::Float);
+
+  for (uint32_t i = 0; i < pathway::bytecode::output_count; i++) {
+    if (i < color.regs.size())
+      state.builder.EmitStore(opcode::store_output, i, color.regs[i]);
+  }
+
+  StoreVaryings(state);
+}
+
+
+/// @brief Adds the slots of a value to a layout.
+///
+/// @return The first of the slots.
+uint32_t
+AddSlots(std::vector<scalar_kind>& slotKinds, TypeID typeID)
+{
+  auto firstSlot = uint32_t(slotKinds.size());
+
+  slotKinds.insert(slotKinds.end(),
+                   GetComponentCount(typeID),
+                   GetScalarKind(GetScalarType(typeID)));
+
+  return firstSlot;
+}
+
+} // namespace
+
+auto
+Lower(const Module& module) -> LoweredModule
+{
+  LoweredModule lowered;
+
+  UniformExprAnalysis uniformExprs;
+
+  uniformExprs.Invoke(module);
+
+  SlotLayout layout;
+
+  for (const auto* var : module.UniformGlobalVars()) {
+
+    auto firstSlot = AddSlots(lowered.uniformSlotKinds, var->GetTypeID());
+
+    layout.uniformSlots.emplace(var, firstSlot);
+
+    auto componentCount = uint32_t(GetComponentCount(var->GetTypeID()));
+
+    lowered.uniformVars.emplace_back(
+      UniformVar{ var, firstSlot, componentCount });
+  }
+
+  for (const auto& hoistedExpr : uniformExprs.HoistedExprs()) {
+    auto typeID = hoistedExpr.expr->GetType().value().ID();
+    layout.hoistedSlots.emplace_back(
+      AddSlots(lowered.uniformSlotKinds, typeID));
+  }
+
+  for (const auto* var : module.VaryingGlobalVars()) {
+    layout.varyingSlots.emplace(
+      var, AddSlots(lowered.varyingSlotKinds, var->GetTypeID()));
+  }
+
+  ProgramState init(layout);
+
+  CompileInit(module, init);
+
+  ProgramState prepare(layout);
+
+  CompilePrepare(uniformExprs, prepare);
+
+  ProgramState sample(layout);
+
+  sample.uniformExprs = &uniformExprs;
+
+  if (const auto* sampler = FindEntryPoint(module, true))
+    CompileSample(*sampler, sample);
+
+  ProgramState encode(layout);
+
+  if (const auto* encoder = FindEntryPoint(module, false))
+    CompileEncode(*encoder, encode);
+
+  ProgramState* programs[]{ &init, &prepare, &sample, &encode };
+
+  static_assert(sizeof(programs) / sizeof(programs[0]) ==
+                  size_t(program_id::count),
+                "Every program must be lowered.");
+
+  for (auto* program : programs)
+    lowered.programs.emplace_back(program->builder.TakeProgram());
+
+  return lowered;
+}
+
+} // namespace bytecode
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <pathway_bytecode.h>
+
+#include <vector>
+
+class Module;
+class VarDecl;
+
+namespace bytecode {
+
+struct Instruction final
+{
+  pathway::bytecode::opcode op;
+
+  uint32_t operands[3];
+};
+
+/// @brief One of the programs of a lowered module.
+///
+/// @detail Each instruction that writes a register writes a new one, and the
+/// registers are numbered in the order they are written, so the program is
+/// in SSA form until its registers are allocated.
+struct Program final
+{
+  std::vector<Instruction> instructions;
+
+  /// @brief How each register is interpreted.
+  std::vector<pathway::bytecode::scalar_kind> registerKinds;
+};
+
+struct UniformVar final
+{
+  const VarDecl* var;
+
+  uint32_t firstSlot;
+
+  uint32_t componentCount;
+};
+
+/// @brief A module lowered to straight sequences of scalar instructions,
+/// which the bytecode and C backends both generate their code from.
+struct LoweredModule final
+{
+  /// @brief The uniform variables, in the order they are declared.
+  std::vector<UniformVar> uniformVars;
+
+  /// @brief How each uniform slot is interpreted. The slots of the hoisted
+  /// expressions follow those of the uniform variables.
+  std::vector<pathway::bytecode::scalar_kind> uniformSlotKinds;
+
+  std::vector<pathway::bytecode::scalar_kind> varyingSlotKinds;
+
+  /// @brief The programs, indexed by @ref pathway::bytecode::program_id.
+  std::vector<Program> programs;
+};
+
+/// @brief Lowers a module whose types are annotated.
+///
+/// @detail Every function call is inlined and every vector and matrix is
+/// split into its components. Recursive functions can't be inlined, so they
+/// abort.
+auto
+Lower(const Module& module) -> LoweredModule;
+
+} // namespace bytecode
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "generator.h"
+#include "line_directives.h"
 #include "module.h"
 
 #include <sstream>
@@ -8,8 +9,8 @@
 class CBasedGenerator : public Generator
 {
 public:
-  CBasedGenerator(std::ostream& os_)
-    : Generator(os_)
+  CBasedGenerator(std::ostream& os_, const GeneratorOptions& options = {})
+    : Generator(os_, options)
   {}
 
   virtual ~CBasedGenerator() = default;
@@ -25,4 +26,20 @@ protected:
   std::ostream& Blank() { return this->os << std::endl; }
 
   std::ostream& Comment() { return this->os << "// "; }
+
+  /// @brief Attributes the lines that follow to the source line of a
+  /// location, if line directives are enabled.
+  void LineDirective(const Location& location)
+  {
+    if (GetLineDirectives())
+      GetLineDirectives()->Write(this->os, location.begin);
+  }
+
+  /// @brief Attributes the lines that follow back to the generated file, if
+  /// line directives are enabled.
+  void EndLineDirective()
+  {
+    if (GetLineDirectives())
+      GetLineDirectives()->WriteReset(this->os);
+  }
 };
@@ -0,0 +1,503 @@
+#include "c_simd_generator.h"
+
+#include "bytecode_lowering.h"
+#include "decl.h"
+#include "module.h"
+
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <sstream>
+
+#include <stdio.h>
+
+namespace csimd {
+
+namespace {
+
+using bytecode::Instruction;
+using bytecode::Program;
+using pathway::bytecode::format;
+using pathway::bytecode::opcode;
+using pathway::bytecode::program_id;
+using pathway::bytecode::scalar_kind;
+
+const char* gProgramNames[]{ "init", "prepare", "sample", "encode" };
+
+static_assert(sizeof(gProgramNames) / sizeof(gProgramNames[0]) ==
+                size_t(program_id::count),
+              "Every program must be named.");
+
+/// @brief An instruction set that the programs are compiled for.
+struct IsaVariant final
+{
+  /// The suffix of the functions that are compiled for it.
+  const char* name;
+
+  /// The suffix of its macro and enumerator in 'pathway_simd.h'.
+  const char* macroSuffix;
+};
+
+/// @brief The variant that every module has, which is compiled for the
+/// target of the compiler, with no suffix.
+const IsaVariant gBaseline{ "", "BASELINE" };
+
+const IsaVariant gIsaVariants[]{ { "sse4", "SSE4" },
+                                 { "avx2", "AVX2" },
+                                 { "avx512", "AVX512" } };
+
+std::string
+GetFunctionName(const std::string& prefix,
+                const char* name,
+                const IsaVariant& variant)
+{
+  auto functionName = prefix + name;
+
+  if (*variant.name != '\0')
+    functionName += std::string("_") + variant.name;
+
+  return functionName;
+}
+
+std::string
+FloatLiteral(uint32_t bits)
+{
+  float value;
+
+  memcpy(&value, &bits, sizeof(value));
+
+  if (std::isnan(value))
+    return "NAN";
+
+  if (std::isinf(value))
+    return (value < 0) ? "-INFINITY" : "INFINITY";
+
+  // Hexadecimal literals are exact, so constants are never rounded twice.
+  char buffer[32];
+
+  snprintf(buffer, sizeof(buffer), "%af", double(value));
+
+  return buffer;
+}
+
+std::string
+IntLiteral(uint32_t bits)
+{
+  auto value = int32_t(bits);
+
+  if (value == INT32_MIN)
+    return "INT32_MIN";
+
+  return std::to_string(value);
+}
+
+/// @brief Finds the instructions whose results are used, which are the
+/// stores and everything they read from. The lowering leaves some values
+/// unused, such as the components of a vector that a swizzle drops.
+std::vector<bool>
+FindLiveInstructions(const Program& program)
+{
+  const auto& instructions = program.instructions;
+
+  std::vector<bool> liveRegs(program.registerKinds.size());
+
+  std::vector<bool> live(instructions.size());
+
+  for (size_t i = instructions.size(); i-- > 0;) {
+
+    const auto& instruction = instructions[i];
+
+    auto f = get_format(instruction.op);
+
+    if (f == format::index_src) {
+      live[i] = true;
+      liveRegs[instruction.operands[1]] = true;
+      continue;
+    }
+
+    if (!liveRegs[instruction.operands[0]])
+      continue;
+
+    live[i] = true;
+
+    if ((f == format::dst_a) || (f == format::dst_a_b))
+      liveRegs[instruction.operands[1]] = true;
+
+    if (f == format::dst_a_b)
+      liveRegs[instruction.operands[2]] = true;
+  }
+
+  return live;
+}
+
+class ProgramPrinter final
+{
+public:
+  ProgramPrinter(std::ostream& os,
+                 const Program& program,
+                 const std::vector<scalar_kind>& uniformSlotKinds,
+                 const std::vector<scalar_kind>& varyingSlotKinds)
+    : mOs(os)
+    , mProgram(program)
+    , mUniformSlotKinds(uniformSlotKinds)
+    , mVaryingSlotKinds(varyingSlotKinds)
+  {}
+
+  /// @param attributes Written before the name of the function, if it
+  /// isn't empty.
+  void Print(const std::string& name, const std::string& attributes = "")
+  {
+    auto live = FindLiveInstructions(mProgram);
+
+    std::set<const char*> usedPointers;
+
+    for (size_t i = 0; i < mProgram.instructions.size(); i++) {
+      if (live[i])
+        usedPointers.emplace(GetPointer(mProgram.instructions[i].op));
+    }
+
+    mOs << "static void";
+
+    if (!attributes.empty())
+      mOs << ' ' << attributes;
+
+    mOs << std::endl;
+    mOs << name << "(pathway_simd_scalar* u, void* varyings, "
+        << "const void* inputs, void* outputs)" << std::endl;
+    mOs << '{' << std::endl;
+
+    mOs << "  pw_lanes* v = (pw_lanes*)varyings;" << std::endl;
+    mOs << "  const pw_f32* in = (const pw_f32*)inputs;" << std::endl;
+    mOs << "  pw_f32* out = (pw_f32*)outputs;" << std::endl;
+
+    for (const auto* pointer : { "u", "v", "in", "out" }) {
+      if (usedPointers.count(pointer) == 0)
+        mOs << "  (void)" << pointer << ';' << std::endl;
+    }
+
+    for (size_t i = 0; i < mProgram.instructions.size(); i++) {
+      if (live[i])
+        PrintInstruction(mProgram.instructions[i]);
+    }
+
+    mOs << '}' << std::endl;
+  }
+
+private:
+  /// @brief Gets the pointer an instruction accesses, if any.
+  static const char* GetPointer(opcode op) noexcept
+  {
+    switch (op) {
+      case opcode::load_uniform:
+      case opcode::store_uniform:
+        return "u";
+      case opcode::load_varying:
+      case opcode::store_varying:
+        return "v";
+      case opcode::load_input:
+        return "in";
+      case opcode::store_output:
+        return "out";
+      default:
+        break;
+    }
+
+    return "";
+  }
+
+  static const char* GetMember(scalar_kind kind) noexcept
+  {
+    return (kind == scalar_kind::float32) ? "f" : "i";
+  }
+
+  std::string Reg(uint32_t reg) const { return "r" + std::to_string(reg); }
+
+  void PrintInstruction(const Instruction& instruction)
+  {
+    const auto* o = instruction.operands;
+
+    switch (instruction.op) {
+      case opcode::store_uniform:
+        mOs << "  u[" << o[0] << "]."
+            << GetMember(mProgram.registerKinds[o[1]]) << " = " << Reg(o[1])
+            << "[0];" << std::endl;
+        return;
+      case opcode::store_varying:
+        mOs << "  v[" << o[0] << "]."
+            << GetMember(mProgram.registerKinds[o[1]]) << " = " << Reg(o[1])
+            << ';' << std::endl;
+        return;
+      case opcode::store_output:
+        mOs << "  out[" << o[0] << "] = " << Reg(o[1]) << ';' << std::endl;
+        return;
+      default:
+        break;
+    }
+
+    auto kind = mProgram.registerKinds[o[0]];
+
+    mOs << "  const " << ((kind == scalar_kind::float32) ? "pw_f32" : "pw_i32")
+        << ' ' << Reg(o[0]) << " = " << GetExpr(instruction) << ';'
+        << std::endl;
+  }
+
+  std::string GetExpr(const Instruction& instruction) const
+  {
+    const auto* o = instruction.operands;
+
+    auto a = Reg(o[1]);
+
+    auto b = Reg(o[2]);
+
+    switch (instruction.op) {
+      case opcode::f_const:
+        return "pw_splat_f32(" + FloatLiteral(o[1]) + ")";
+      case opcode::i_const:
+        return "pw_splat_i32(" + IntLiteral(o[1]) + ")";
+      case opcode::f_add:
+        return a + " + " + b;
+      case opcode::f_sub:
+        return a + " - " + b;
+      case opcode::f_mul:
+        return a + " * " + b;
+      case opcode::f_div:
+        return a + " / " + b;
+      case opcode::f_mod:
+        return "pw_fmod(" + a + ", " + b + ")";
+      case opcode::f_neg:
+        return "-" + a;
+      case opcode::i_add:
+        return "pw_add_i32(" + a + ", " + b + ")";
+      case opcode::i_sub:
+        return "pw_sub_i32(" + a + ", " + b + ")";
+      case opcode::i_mul:
+        return "pw_mul_i32(" + a + ", " + b + ")";
+      case opcode::i_div:
+        return "pw_div_i32(" + a + ", " + b + ")";
+      case opcode::i_mod:
+        return "pw_mod_i32(" + a + ", " + b + ")";
+      case opcode::i_neg:
+        return "pw_neg_i32(" + a + ")";
+      case opcode::i_not:
+        return "~" + a;
+      case opcode::b_not:
+        return "pw_to_bool(" + a + " == pw_splat_i32(0))";
+      case opcode::i_to_f:
+        return "pw_to_f32(" + a + ")";
+      case opcode::f_to_i:
+        return "pw_to_i32(" + a + ")";
+      case opcode::i_to_b:
+        return "pw_to_bool(" + a + " != pw_splat_i32(0))";
+      case opcode::f_to_b:
+        return "pw_to_bool(" + a + " != pw_splat_f32(0.0f))";
+      case opcode::f_exp:
+        return "pw_exp(" + a + ")";
+      case opcode::f_log:
+        return "pw_log(" + a + ")";
+      case opcode::f_pow:
+        return "pw_pow(" + a + ", " + b + ")";
+      case opcode::f_sin:
+        return "pw_sin(" + a + ")";
+      case opcode::f_cos:
+        return "pw_cos(" + a + ")";
+      case opcode::f_atan2:
+        return "pw_atan2(" + a + ", " + b + ")";
+      case opcode::load_uniform: {
+        auto slot = std::to_string(o[1]);
+        if (mUniformSlotKinds.at(o[1]) == scalar_kind::float32)
+          return "pw_splat_f32(u[" + slot + "].f)";
+        return "pw_splat_i32(u[" + slot + "].i)";
+      }
+      case opcode::load_varying:
+        return "v[" + std::to_string(o[1]) + "]." +
+               GetMember(mVaryingSlotKinds.at(o[1]));
+      case opcode::load_input:
+        return "in[" + std::to_string(o[1]) + "]";
+      case opcode::store_uniform:
+      case opcode::store_varying:
+      case opcode::store_output:
+      case opcode::count:
+        break;
+    }
+
+    return "";
+  }
+
+  std::ostream& mOs;
+
+  const Program& mProgram;
+
+  const std::vector<scalar_kind>& mUniformSlotKinds;
+
+  const std::vector<scalar_kind>& mVaryingSlotKinds;
+};
+
+/// @brief Prints the programs of a variant, and the loops over the batches
+/// of a frame that run them.
+void
+PrintVariant(std::ostream& os,
+             const bytecode::LoweredModule& lowered,
+             const std::string& prefix,
+             const IsaVariant& variant)
+{
+  std::string attributes;
+
+  if (&variant != &gBaseline)
+    attributes = std::string("PATHWAY_SIMD_TARGET_") + variant.macroSuffix;
+
+  for (size_t i = 0; i < lowered.programs.size(); i++) {
+
+    os << std::endl;
+
+    ProgramPrinter printer(os,
+                           lowered.programs[i],
+                           lowered.uniformSlotKinds,
+                           lowered.varyingSlotKinds);
+
+    printer.Print(GetFunctionName(prefix, gProgramNames[i], variant),
+                  attributes);
+  }
+
+  auto attributeSuffix = attributes.empty() ? "" : " " + attributes;
+
+  auto varyingSlotCount = lowered.varyingSlotKinds.size();
+
+  os << std::endl;
+  os << "static void" << attributeSuffix << std::endl;
+  os << GetFunctionName(prefix, "sample_pixels", variant)
+     << "(pathway_simd_scalar* u, void* varyings, size_t width, "
+     << "size_t height)" << std::endl;
+  os << '{' << std::endl;
+  os << "  pathway_simd_sample_pixels("
+     << GetFunctionName(prefix, "sample", variant) << ", u, varyings, "
+     << varyingSlotCount << ", width, height);" << std::endl;
+  os << '}' << std::endl;
+
+  os << std::endl;
+  os << "static void" << attributeSuffix << std::endl;
+  os << GetFunctionName(prefix, "encode_rgb", variant)
+     << "(pathway_simd_scalar* u, void* varyings, size_t width, "
+     << "size_t height, unsigned char* rgb_buffer)" << std::endl;
+  os << '{' << std::endl;
+  os << "  pathway_simd_encode_rgb("
+     << GetFunctionName(prefix, "encode", variant) << ", u, varyings, "
+     << varyingSlotCount << ", width, height, rgb_buffer);" << std::endl;
+  os << '}' << std::endl;
+}
+
+void
+PrintVariantEntry(std::ostream& os,
+                  const std::string& prefix,
+                  const IsaVariant& variant)
+{
+  os << "  { PATHWAY_SIMD_ISA_" << variant.macroSuffix << ", {";
+
+  for (size_t i = 0; i < size_t(program_id::count); i++) {
+    os << ((i == 0) ? " " : ", ")
+       << GetFunctionName(prefix, gProgramNames[i], variant);
+  }
+
+  os << " }, " << GetFunctionName(prefix, "sample_pixels", variant) << ", "
+     << GetFunctionName(prefix, "encode_rgb", variant) << " }," << std::endl;
+}
+
+} // namespace
+
+void
+Generator::Generate(const Module& module)
+{
+  if (!module.HasModuleExportDecl())
+    return;
+
+  auto lowered = bytecode::Lower(module);
+
+  std::ostringstream prefixStream;
+
+  const auto& moduleName = module.GetModuleExportDecl().GetModuleName();
+
+  for (const auto& id : moduleName.Identifiers())
+    prefixStream << id << '_';
+
+  auto prefix = prefixStream.str();
+
+  os << "#include <pathway_simd.h>" << std::endl;
+
+  PrintVariant(os, lowered, prefix, gBaseline);
+
+  // The other variants are only compiled for x86, where the runtime can tell
+  // which of them the CPU supports.
+  if (GetOptions().isaVariants) {
+
+    os << std::endl;
+
+    os << "#if PATHWAY_SIMD_X86" << std::endl;
+
+    for (const auto& variant : gIsaVariants)
+      PrintVariant(os, lowered, prefix, variant);
+
+    os << std::endl;
+
+    os << "#endif" << std::endl;
+  }
+
+  os << std::endl;
+
+  if (!lowered.uniformVars.empty()) {
+
+    os << "static const struct pathway_simd_uniform " << prefix
+       << "uniforms[] = {" << std::endl;
+
+    for (const auto& uniformVar : lowered.uniformVars) {
+
+      auto kind = lowered.uniformSlotKinds.at(uniformVar.firstSlot);
+
+      os << "  { \"" << uniformVar.var->Identifier() << "\", "
+         << ((kind == scalar_kind::float32) ? 0 : 1) << ", "
+         << uniformVar.componentCount << ", " << uniformVar.firstSlot << " },"
+         << std::endl;
+    }
+
+    os << "};" << std::endl;
+
+    os << std::endl;
+  }
+
+  os << "static const struct pathway_simd_variant " << prefix
+     << "variants[] = {" << std::endl;
+
+  PrintVariantEntry(os, prefix, gBaseline);
+
+  if (GetOptions().isaVariants) {
+
+    os << "#if PATHWAY_SIMD_X86" << std::endl;
+
+    for (const auto& variant : gIsaVariants)
+      PrintVariantEntry(os, prefix, variant);
+
+    os << "#endif" << std::endl;
+  }
+
+  os << "};" << std::endl;
+
+  os << std::endl;
+
+  os << "const struct pathway_simd_module " << prefix << "module = {"
+     << std::endl;
+  os << "  PATHWAY_SIMD_VERSION," << std::endl;
+  os << "  PATHWAY_SIMD_LANES," << std::endl;
+  os << "  " << lowered.uniformSlotKinds.size() << ',' << std::endl;
+  os << "  " << lowered.varyingSlotKinds.size() << ',' << std::endl;
+  os << "  " << lowered.uniformVars.size() << ',' << std::endl;
+
+  if (lowered.uniformVars.empty())
+    os << "  NULL," << std::endl;
+  else
+    os << "  " << prefix << "uniforms," << std::endl;
+
+  os << "  sizeof(" << prefix << "variants) / sizeof(" << prefix
+     << "variants[0])," << std::endl;
+  os << "  " << prefix << "variants" << std::endl;
+  os << "};" << std::endl;
+}
+
+} // namespace csimd
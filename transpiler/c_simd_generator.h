@@ -0,0 +1,25 @@
+#pragma once
+
+#include "generator.h"
+
+namespace csimd {
+
+/// @brief Generates a C module for the support code in 'pathway_simd.h',
+/// with each value held in a GCC or Clang vector of one lane per pixel.
+///
+/// @detail The module is lowered the same way as for the bytecode, so every
+/// function call is inlined and every vector and matrix is split into its
+/// components. Each component then becomes a vector variable, which makes
+/// each function process a whole batch of pixels per call, with the SIMD
+/// instructions written out explicitly.
+class Generator final : public ::Generator
+{
+public:
+  Generator(std::ostream& os, const GeneratorOptions& options = {})
+    : ::Generator(os, options)
+  {}
+
+  void Generate(const Module& module) override;
+};
+
+} // namespace csimd
@@ -0,0 +1,111 @@
+#include "call_convention_analysis.h"
+
+#include "decl.h"
+#include "module.h"
+
+namespace {
+
+/// @brief Finds the variables that the statements of a function assign to.
+class AssignmentFinder final : public StmtVisitor
+{
+public:
+  explicit AssignmentFinder(std::set<const VarDecl*>& assignedVars)
+    : mAssignedVars(assignedVars)
+  {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    if (const auto* var = FindAssignedVar(assignmentStmt.LValue()))
+      mAssignedVars.emplace(var);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt&) override {}
+
+  void Visit(const ReturnStmt&) override {}
+
+private:
+  static const VarDecl* FindAssignedVar(const Expr& lValue)
+  {
+    if (const auto* varRef = dynamic_cast<const VarRef*>(&lValue))
+      return varRef->HasResolvedVar() ? &varRef->ResolvedVar() : nullptr;
+
+    if (const auto* memberExpr = dynamic_cast<const MemberExpr*>(&lValue))
+      return FindAssignedVar(memberExpr->BaseExpr());
+
+    return nullptr;
+  }
+
+  std::set<const VarDecl*>& mAssignedVars;
+};
+
+} // namespace
+
+bool
+CallConventionAnalysis::IsAssigned(const VarDecl& param) const
+{
+  return mAssignedParams.count(&param) != 0;
+}
+
+bool
+CallConventionAnalysis::IsAlwaysInlined(const FuncDecl& funcDecl) const
+{
+  return mInlinedFuncs.count(&funcDecl) != 0;
+}
+
+bool
+CallConventionAnalysis::AnalyzeModule()
+{
+  mAssignedParams.clear();
+
+  mInlinedFuncs.clear();
+
+  mCosts.Invoke(GetModule());
+
+  return AnalysisPass::AnalyzeModule();
+}
+
+bool
+CallConventionAnalysis::AnalyzeVarDecl(const VarDecl&)
+{
+  return true;
+}
+
+bool
+CallConventionAnalysis::AnalyzeFuncDecl(const FuncDecl& funcDecl)
+{
+  // Only the parameters are kept, since the other variables are declared
+  // the same way either way.
+  std::set<const VarDecl*> assignedVars;
+
+  AssignmentFinder finder(assignedVars);
+
+  funcDecl.AcceptBodyVisitor(finder);
+
+  for (const auto& param : funcDecl.GetParamList()) {
+    if (assignedVars.count(param.get()) != 0)
+      mAssignedParams.emplace(param.get());
+  }
+
+  if (funcDecl.IsEntryPoint())
+    return true;
+
+  for (const auto& funcCost : mCosts.FuncCosts()) {
+
+    if (funcCost.funcDecl != &funcDecl)
+      continue;
+
+    const auto& cost = funcCost.self;
+
+    auto ops = cost.Flops() + cost.intOps + cost.transcendentals;
+
+    if ((cost.calls == 0) && (ops <= maxInlineOps))
+      mInlinedFuncs.emplace(&funcDecl);
+  }
+
+  return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "analysis_pass.h"
+#include "cost_analysis.h"
+
+#include <set>
+
+/// @brief Finds how the generated C++ code should call each function: which
+/// parameters can be taken by reference, and which functions are small
+/// enough to always be inlined.
+///
+/// @detail A parameter that the body assigns to needs its own copy, so it is
+/// always taken by value. The others are taken in whichever way suits the
+/// size of their type, which the runtime decides with 'pathway::param_t',
+/// since the size depends on the scalar types of the instantiation.
+///
+/// A function is always inlined when it doesn't call other functions of the
+/// module, and does few enough operations that the copies and the call cost
+/// about as much as its body. Entry points are never inlined, since the host
+/// calls them.
+///
+/// @note This should be called on a module that is ready to be generated,
+/// like @ref CostAnalysis.
+class CallConventionAnalysis final : public AnalysisPass
+{
+public:
+  /// @brief The most operations that a function does, excluding loads and
+  /// stores, for it to always be inlined.
+  static constexpr size_t maxInlineOps = 64;
+
+  /// @brief Indicates whether the body of a function assigns to one of its
+  /// parameters, or to a component of it.
+  bool IsAssigned(const VarDecl& param) const;
+
+  bool IsAlwaysInlined(const FuncDecl& funcDecl) const;
+
+protected:
+  bool AnalyzeModule() override;
+
+  bool AnalyzeVarDecl(const VarDecl&) override;
+
+  bool AnalyzeFuncDecl(const FuncDecl&) override;
+
+private:
+  CostAnalysis mCosts;
+
+  std::set<const VarDecl*> mAssignedParams;
+
+  std::set<const FuncDecl*> mInlinedFuncs;
+};
@@ -1,7 +1,10 @@
 #include "check.h"
 
+#include "builtins.h"
+#include "line_table.h"
 #include "module.h"
 
+#include <optional>
 #include <ostream>
 
 namespace {
@@ -15,10 +18,12 @@ struct check_context final
   check_context(const check_context&) = delete;
 
   check_context(const std::string& path_,
+                std::string_view source_,
                 const Module& module_,
                 std::ostream& es_)
     : path(path_)
     , module(module_)
+    , source(source_)
     , es(es_)
   {}
 
@@ -28,7 +33,11 @@ struct check_context final
   {
     this->error_count++;
 
-    this->es << this->path << ':' << l << ": ";
+    // The line table is only needed once there is an error to print.
+    if (!this->line_table)
+      this->line_table.emplace(this->source);
+
+    this->es << this->path << ':' << this->line_table->Expand(l) << ": ";
 
     return this->es;
   }
@@ -50,6 +59,10 @@ struct check_context final
 private:
   size_t error_count = 0;
 
+  std::string_view source;
+
+  std::optional<LineTable> line_table;
+
   std::ostream& es;
 };
 
@@ -74,10 +87,19 @@ public:
   {
     const auto& ret_value = s.ReturnValue();
 
-    if (ret_value.GetType() != mExpectedReturnType) {
-      this->ctx.emit_error(ret_value.GetLocation())
-        << "expression should return type '" << mExpectedReturnType << "' not '"
-        << *ret_value.GetType() << "'" << std::endl;
+    // Uniform values can be returned from any function, so only the type ID
+    // has to match.
+    auto ret_type = ret_value.GetType();
+
+    if (!ret_type || (ret_type->ID() != mExpectedReturnType.ID())) {
+      auto& os = this->ctx.emit_error(ret_value.GetLocation());
+
+      os << "expression should return type '" << mExpectedReturnType << "'";
+
+      if (ret_type)
+        os << " not '" << *ret_type << "'";
+
+      os << std::endl;
     }
   }
 
@@ -87,11 +109,108 @@ private:
   check_context& ctx;
 };
 
+/// @brief Checks the types of the arguments of builtin function calls, which
+/// are only resolved by their name and number of arguments.
+class BuiltinCallChecker final
+  : public StmtVisitor
+  , public ExprVisitor
+{
+public:
+  BuiltinCallChecker(check_context& ctx_)
+    : ctx(ctx_)
+  {}
+
+  void Visit(const AssignmentStmt& s) override
+  {
+    s.LValue().AcceptVisitor(*this);
+    s.RValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const CompoundStmt& s) override { s.Recurse(*this); }
+
+  void Visit(const DeclStmt& s) override
+  {
+    const auto& varDecl = s.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      varDecl.InitExpr().AcceptVisitor(*this);
+  }
+
+  void Visit(const ReturnStmt& s) override
+  {
+    s.ReturnValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    funcCall.Recurse(*this);
+
+    if (funcCall.IsBuiltin())
+      CheckArgs(funcCall);
+  }
+
+  void Visit(const IntLiteral&) override {}
+
+  void Visit(const BoolLiteral&) override {}
+
+  void Visit(const FloatLiteral&) override {}
+
+  void Visit(const BinaryExpr& e) override { e.Recurse(*this); }
+
+  void Visit(const UnaryExpr& e) override { e.Recurse(*this); }
+
+  void Visit(const GroupExpr& e) override { e.Recurse(*this); }
+
+  void Visit(const VarRef&) override {}
+
+  void Visit(const TypeConstructor& e) override { e.Recurse(*this); }
+
+  void Visit(const MemberExpr& e) override { e.Recurse(*this); }
+
+private:
+  void CheckArgs(const FuncCall& funcCall)
+  {
+    const auto& args = funcCall.Args();
+
+    std::optional<TypeID> firstType;
+
+    for (const auto& arg : args) {
+
+      auto argType = arg->GetType();
+
+      // Arguments whose type isn't known can't be checked.
+      if (!argType)
+        return;
+
+      if (!IsBuiltinArgType(argType->ID())) {
+        this->ctx.emit_error(arg->GetLocation())
+          << "argument of '" << funcCall.Identifier()
+          << "' should be type 'float', 'vec2', 'vec3' or 'vec4' not '"
+          << argType->ID() << "'" << std::endl;
+        return;
+      }
+
+      if (!firstType) {
+        firstType = argType->ID();
+      } else if (argType->ID() != *firstType) {
+        this->ctx.emit_error(arg->GetLocation())
+          << "argument of '" << funcCall.Identifier() << "' should be type '"
+          << *firstType << "' like the first one, not '" << argType->ID()
+          << "'" << std::endl;
+        return;
+      }
+    }
+  }
+
+  check_context& ctx;
+};
+
 class checker final
 {
 public:
-  checker(check_context& ctx_)
+  checker(check_context& ctx_, bool requireEntryPoints)
     : ctx(ctx_)
+    , mRequireEntryPoints(requireEntryPoints)
   {}
 
   void run_all_checks()
@@ -106,7 +225,14 @@ public:
     for (const auto& fn : ctx.module.Funcs())
       this->type_check(*fn);
 
-    // TODO : global vars
+    BuiltinCallChecker builtinCallChecker(this->ctx);
+
+    for (const auto& var : ctx.module.GlobalVars()) {
+      if (var->HasInitExpr())
+        var->InitExpr().AcceptVisitor(builtinCallChecker);
+    }
+
+    // TODO : other checks of global vars
   }
 
   void type_check(const FuncDecl& func)
@@ -114,6 +240,10 @@ public:
     ReturnStmtTypeChecker returnStmtTypeChecker(func.ReturnType(), this->ctx);
 
     func.AcceptBodyVisitor(returnStmtTypeChecker);
+
+    BuiltinCallChecker builtinCallChecker(this->ctx);
+
+    func.AcceptBodyVisitor(builtinCallChecker);
   }
 
   void CheckEntryPoints()
@@ -148,13 +278,13 @@ public:
 
     if (pixelSampler) {
       CheckPixelSamplerSignature(*pixelSampler);
-    } else {
+    } else if (mRequireEntryPoints) {
       ctx.MissingPixelSampler();
     }
 
     if (pixelEncoder) {
       CheckPixelEncoderSignature(*pixelEncoder);
-    } else {
+    } else if (mRequireEntryPoints) {
       ctx.MissingPixelEncoder();
     }
   }
@@ -199,16 +329,22 @@ public:
 
 private:
   check_context& ctx;
+
+  bool mRequireEntryPoints;
 };
 
 } // namespace
 
 bool
-check(const std::string& path, const Module& module, std::ostream& es)
+check(const std::string& path,
+      std::string_view source,
+      const Module& module,
+      std::ostream& es,
+      bool requireEntryPoints)
 {
-  check_context ctx(path, module, es);
+  check_context ctx(path, source, module, es);
 
-  checker c(ctx);
+  checker c(ctx, requireEntryPoints);
 
   c.run_all_checks();
 
@@ -1,8 +1,19 @@
 #pragma once
 
 #include <iosfwd>
+#include <string>
+#include <string_view>
 
 class Module;
 
+/// @param source The contents of the file the module was parsed from, which
+/// is used to find the line and column numbers of errors.
+///
+/// @param requireEntryPoints Whether the module has to declare the pixel
+/// sampler and encoder. Modules that are only imported by other modules don't.
 bool
-check(const std::string& path, const Module& module, std::ostream& os);
+check(const std::string& path,
+      std::string_view source,
+      const Module& module,
+      std::ostream& os,
+      bool requireEntryPoints = true);
@@ -0,0 +1,578 @@
+#include "const_fold.h"
+
+#include "decl.h"
+#include "module.h"
+#include "stmt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/// @brief The value of a constant scalar or float vector.
+struct Constant final
+{
+  TypeID typeID;
+
+  std::vector<double> components;
+
+  bool IsScalar() const noexcept
+  {
+    return (typeID == TypeID::Int) || (typeID == TypeID::Float);
+  }
+
+  bool AllEqual(double value) const
+  {
+    return std::all_of(
+      components.begin(), components.end(), [value](double component) {
+        return component == value;
+      });
+  }
+};
+
+auto
+GetFloatVectorType(size_t size) -> std::optional<TypeID>
+{
+  switch (size) {
+    case 1:
+      return TypeID::Float;
+    case 2:
+      return TypeID::Vec2;
+    case 3:
+      return TypeID::Vec3;
+    case 4:
+      return TypeID::Vec4;
+  }
+
+  return {};
+}
+
+bool
+IsFloatScalarOrVector(TypeID typeID) noexcept
+{
+  switch (typeID) {
+    case TypeID::Float:
+    case TypeID::Vec2:
+    case TypeID::Vec3:
+    case TypeID::Vec4:
+      return true;
+    default:
+      break;
+  }
+
+  return false;
+}
+
+/// @brief Evaluates an expression, if it only depends on literals.
+///
+/// @detail Only integer and float scalars and float vectors are evaluated.
+/// Integer results must fit into a 32-bit integer and float results must be
+/// finite, otherwise the expression is left for the generated code to
+/// evaluate.
+class ConstEvaluator final : public ExprVisitor
+{
+public:
+  static auto Evaluate(const Expr& expr) -> std::optional<Constant>
+  {
+    ConstEvaluator evaluator;
+
+    expr.AcceptVisitor(evaluator);
+
+    return std::move(evaluator.mResult);
+  }
+
+  void Visit(const IntLiteral& intLiteral) override
+  {
+    if (intLiteral.Value() <= uint64_t(std::numeric_limits<int32_t>::max()))
+      mResult = Constant{ TypeID::Int, { double(intLiteral.Value()) } };
+  }
+
+  void Visit(const BoolLiteral&) override {}
+
+  void Visit(const FloatLiteral& floatLiteral) override
+  {
+    if (std::isfinite(floatLiteral.Value()))
+      mResult = Constant{ TypeID::Float, { floatLiteral.Value() } };
+  }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    auto left = Evaluate(binaryExpr.LeftExpr());
+    if (!left)
+      return;
+
+    auto right = Evaluate(binaryExpr.RightExpr());
+    if (!right)
+      return;
+
+    if ((left->typeID == TypeID::Int) && (right->typeID == TypeID::Int))
+      EvaluateInt(binaryExpr.GetKind(), *left, *right);
+    else
+      EvaluateFloat(binaryExpr.GetKind(), *left, *right);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    if (unaryExpr.GetKind() != UnaryExpr::Kind::Negate)
+      return;
+
+    mResult = Evaluate(unaryExpr.BaseExpr());
+
+    if (mResult) {
+      for (auto& component : mResult->components)
+        component = -component;
+    }
+  }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef&) override {}
+
+  void Visit(const FuncCall&) override {}
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    auto typeID = typeConstructor.GetType().value().ID();
+
+    if (!IsFloatScalarOrVector(typeID))
+      return;
+
+    auto size = GetVectorComponentCount(typeID).value_or(1);
+
+    std::vector<Constant> args;
+
+    for (const auto& argExpr : typeConstructor.Args()) {
+
+      auto arg = Evaluate(*argExpr);
+
+      if (!arg)
+        return;
+
+      if ((arg->typeID != TypeID::Int) && !IsFloatScalarOrVector(arg->typeID))
+        return;
+
+      args.emplace_back(std::move(*arg));
+    }
+
+    std::vector<double> components;
+
+    if ((args.size() == 1) && args[0].IsScalar()) {
+      components.resize(size, args[0].components[0]);
+    } else {
+      for (const auto& arg : args) {
+        components.insert(
+          components.end(), arg.components.begin(), arg.components.end());
+      }
+    }
+
+    if (components.size() != size)
+      return;
+
+    mResult = Constant{ typeID, std::move(components) };
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    auto base = Evaluate(memberExpr.BaseExpr());
+
+    if (!base || base->IsScalar())
+      return;
+
+    auto swizzle = Swizzle::Make(memberExpr.MemberName().Identifier(),
+                                 base->components.size());
+    if (!swizzle)
+      return;
+
+    auto typeID = GetFloatVectorType(swizzle->Size());
+    if (!typeID)
+      return;
+
+    std::vector<double> components;
+
+    for (auto index : swizzle->Indices())
+      components.emplace_back(base->components[index]);
+
+    mResult = Constant{ *typeID, std::move(components) };
+  }
+
+private:
+  void EvaluateInt(BinaryExpr::Kind kind,
+                   const Constant& left,
+                   const Constant& right)
+  {
+    auto a = int64_t(left.components[0]);
+    auto b = int64_t(right.components[0]);
+
+    int64_t result = 0;
+
+    switch (kind) {
+      case BinaryExpr::Kind::Add:
+        result = a + b;
+        break;
+      case BinaryExpr::Kind::Sub:
+        result = a - b;
+        break;
+      case BinaryExpr::Kind::Mul:
+        result = a * b;
+        break;
+      case BinaryExpr::Kind::Div:
+        if (b == 0)
+          return;
+        result = a / b;
+        break;
+      case BinaryExpr::Kind::Mod:
+        if (b == 0)
+          return;
+        result = a % b;
+        break;
+    }
+
+    if ((result < std::numeric_limits<int32_t>::min()) ||
+        (result > std::numeric_limits<int32_t>::max()))
+      return;
+
+    mResult = Constant{ TypeID::Int, { double(result) } };
+  }
+
+  void EvaluateFloat(BinaryExpr::Kind kind,
+                     const Constant& left,
+                     const Constant& right)
+  {
+    // Integers only mix with float scalars.
+    if ((left.typeID == TypeID::Int) && !right.IsScalar())
+      return;
+
+    if ((right.typeID == TypeID::Int) && !left.IsScalar())
+      return;
+
+    auto size = std::max(left.components.size(), right.components.size());
+
+    if (!left.IsScalar() && !right.IsScalar() &&
+        (left.components.size() != right.components.size()))
+      return;
+
+    auto typeID = GetFloatVectorType(size);
+    if (!typeID)
+      return;
+
+    std::vector<double> components;
+
+    for (size_t i = 0; i < size; i++) {
+
+      auto a = left.components[left.IsScalar() ? 0 : i];
+      auto b = right.components[right.IsScalar() ? 0 : i];
+
+      double result = 0;
+
+      switch (kind) {
+        case BinaryExpr::Kind::Add:
+          result = a + b;
+          break;
+        case BinaryExpr::Kind::Sub:
+          result = a - b;
+          break;
+        case BinaryExpr::Kind::Mul:
+          result = a * b;
+          break;
+        case BinaryExpr::Kind::Div:
+          result = a / b;
+          break;
+        case BinaryExpr::Kind::Mod:
+          return;
+      }
+
+      if (!std::isfinite(result))
+        return;
+
+      components.emplace_back(result);
+    }
+
+    mResult = Constant{ *typeID, std::move(components) };
+  }
+
+  std::optional<Constant> mResult;
+};
+
+/// @brief Indicates whether an expression is already as simple as the
+/// literal that folding it would produce.
+bool
+IsLiteral(const Expr& expr)
+{
+  if (dynamic_cast<const IntLiteral*>(&expr) ||
+      dynamic_cast<const FloatLiteral*>(&expr) ||
+      dynamic_cast<const BoolLiteral*>(&expr))
+    return true;
+
+  if (const auto* unaryExpr = dynamic_cast<const UnaryExpr*>(&expr)) {
+    return (unaryExpr->GetKind() == UnaryExpr::Kind::Negate) &&
+           IsLiteral(unaryExpr->BaseExpr());
+  }
+
+  if (const auto* ctor = dynamic_cast<const TypeConstructor*>(&expr)) {
+    for (const auto& argExpr : ctor->Args()) {
+      if (!IsLiteral(*argExpr))
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+UniqueExprPtr
+MakeLiteral(const Constant& constant, const Location& location)
+{
+  if (constant.typeID == TypeID::Int) {
+
+    auto value = int64_t(constant.components[0]);
+
+    if (value >= 0)
+      return UniqueExprPtr(new IntLiteral(uint64_t(value), location));
+
+    auto* magnitude = new IntLiteral(uint64_t(-value), location);
+
+    return UniqueExprPtr(
+      new UnaryExpr(magnitude, UnaryExpr::Kind::Negate, location));
+  }
+
+  if (constant.typeID == TypeID::Float)
+    return UniqueExprPtr(new FloatLiteral(constant.components[0], location));
+
+  auto* args = new ExprList();
+
+  // Vectors with the same value in each component use the shorter form of the
+  // constructor.
+  if (constant.AllEqual(constant.components[0])) {
+    args->emplace_back(new FloatLiteral(constant.components[0], location));
+  } else {
+    for (auto component : constant.components)
+      args->emplace_back(new FloatLiteral(component, location));
+  }
+
+  return UniqueExprPtr(new TypeConstructor(constant.typeID, args, location));
+}
+
+/// @brief Indicates whether the reciprocal of a number is exact, even when
+/// it is stored in a single precision float.
+bool
+HasExactReciprocal(double value)
+{
+  int exponent = 0;
+
+  auto mantissa = std::frexp(value, &exponent);
+
+  return (std::fabs(mantissa) == 0.5) && (exponent > -125) && (exponent < 127);
+}
+
+class ExprFolder final : public ExprMutator
+{
+public:
+  ExprFolder(MathMode mathMode)
+    : mMathMode(mathMode)
+  {}
+
+  /// @brief Folds an expression whose subexpressions are already folded.
+  ///
+  /// @return The expression to replace the original one with. This may be
+  /// the original expression.
+  UniqueExprPtr Simplify(UniqueExprPtr expr) const
+  {
+    auto type = expr->GetType();
+
+    // Expressions that don't pass type checking are left alone, so that
+    // folding never changes the type of an expression.
+    if (!type)
+      return expr;
+
+    if (!IsLiteral(*expr)) {
+
+      auto constant = ConstEvaluator::Evaluate(*expr);
+
+      if (constant && (constant->typeID == type->ID()))
+        return MakeLiteral(*constant, expr->GetLocation());
+    }
+
+    if (auto* binaryExpr = dynamic_cast<BinaryExpr*>(expr.get()))
+      return SimplifyBinaryExpr(std::move(expr), *binaryExpr, type->ID());
+
+    return expr;
+  }
+
+  void Mutate(FuncCall& funcCall) const override { Fold(funcCall); }
+
+  void Mutate(IntLiteral&) const override {}
+
+  void Mutate(BoolLiteral&) const override {}
+
+  void Mutate(FloatLiteral&) const override {}
+
+  void Mutate(BinaryExpr& binaryExpr) const override { Fold(binaryExpr); }
+
+  void Mutate(UnaryExpr& unaryExpr) const override { Fold(unaryExpr); }
+
+  void Mutate(GroupExpr& groupExpr) const override { Fold(groupExpr); }
+
+  void Mutate(VarRef&) const override {}
+
+  void Mutate(TypeConstructor& typeConstructor) const override
+  {
+    Fold(typeConstructor);
+  }
+
+  void Mutate(MemberExpr& memberExpr) const override { Fold(memberExpr); }
+
+private:
+  template<typename ExprType>
+  void Fold(ExprType& expr) const
+  {
+    expr.Recurse(*this);
+
+    expr.TransformChildren(
+      [this](UniqueExprPtr child) { return Simplify(std::move(child)); });
+  }
+
+  /// @param expr The owner of the binary expression.
+  UniqueExprPtr SimplifyBinaryExpr(UniqueExprPtr expr,
+                                   BinaryExpr& binaryExpr,
+                                   TypeID typeID) const
+  {
+    auto left = ConstEvaluator::Evaluate(binaryExpr.LeftExpr());
+
+    auto right = ConstEvaluator::Evaluate(binaryExpr.RightExpr());
+
+    // Removing an operand is only possible when the other one already has the
+    // type of the result.
+    auto keepsLeft = HasTypeID(binaryExpr.LeftExpr(), typeID);
+
+    auto keepsRight = HasTypeID(binaryExpr.RightExpr(), typeID);
+
+    auto isOne = [](const auto& c) { return c && c->AllEqual(1); };
+
+    // Adding negative zero flips the sign of a zero, so only positive zero
+    // can be removed from a subtraction.
+    auto isZero = [](const auto& c) {
+      return c && c->AllEqual(0) && !std::signbit(c->components[0]);
+    };
+
+    auto fastMath = mMathMode == MathMode::Fast;
+
+    switch (binaryExpr.GetKind()) {
+      case BinaryExpr::Kind::Add:
+        // x + 0 is not x when x is negative zero.
+        if (fastMath && keepsLeft && isZero(right))
+          return binaryExpr.TakeLeftExpr();
+        if (fastMath && keepsRight && isZero(left))
+          return binaryExpr.TakeRightExpr();
+        break;
+      case BinaryExpr::Kind::Sub:
+        if (keepsLeft && isZero(right))
+          return binaryExpr.TakeLeftExpr();
+        break;
+      case BinaryExpr::Kind::Mul:
+        if (keepsLeft && isOne(right))
+          return binaryExpr.TakeLeftExpr();
+        if (keepsRight && isOne(left))
+          return binaryExpr.TakeRightExpr();
+        break;
+      case BinaryExpr::Kind::Div:
+        if (keepsLeft && isOne(right))
+          return binaryExpr.TakeLeftExpr();
+        if (IsFloatScalarOrVector(typeID) && right && right->IsScalar())
+          return SimplifyDivision(std::move(expr), binaryExpr, *right);
+        break;
+      case BinaryExpr::Kind::Mod:
+        break;
+    }
+
+    return expr;
+  }
+
+  UniqueExprPtr SimplifyDivision(UniqueExprPtr expr,
+                                 BinaryExpr& binaryExpr,
+                                 const Constant& divisor) const
+  {
+    auto value = divisor.components[0];
+
+    if (value == 0)
+      return expr;
+
+    if (!HasExactReciprocal(value) && (mMathMode != MathMode::Fast))
+      return expr;
+
+    auto location = binaryExpr.GetLocation();
+
+    auto* reciprocal = new FloatLiteral(1.0 / value, location);
+
+    return UniqueExprPtr(new BinaryExpr(binaryExpr.TakeLeftExpr().release(),
+                                        reciprocal,
+                                        BinaryExpr::Kind::Mul,
+                                        location));
+  }
+
+  static bool HasTypeID(const Expr& expr, TypeID typeID)
+  {
+    auto type = expr.GetType();
+
+    return type && (type->ID() == typeID);
+  }
+
+  MathMode mMathMode;
+};
+
+class StmtFolder final : public StmtMutator
+{
+public:
+  StmtFolder(MathMode mathMode)
+    : mExprFolder(mathMode)
+  {}
+
+  void Mutate(AssignmentStmt& assignmentStmt) override
+  {
+    assignmentStmt.RValue().AcceptMutator(mExprFolder);
+
+    auto rValue = mExprFolder.Simplify(assignmentStmt.TakeRValue());
+
+    assignmentStmt.SetRValue(std::move(rValue));
+  }
+
+  void Mutate(CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Mutate(DeclStmt& declStmt) override
+  {
+    auto& varDecl = declStmt.GetVarDecl();
+
+    if (!varDecl.HasInitExpr())
+      return;
+
+    varDecl.InitExpr().AcceptMutator(mExprFolder);
+
+    varDecl.SetInitExpr(mExprFolder.Simplify(varDecl.TakeInitExpr()));
+  }
+
+  void Mutate(ReturnStmt& returnStmt) override
+  {
+    returnStmt.ReturnValue().AcceptMutator(mExprFolder);
+
+    returnStmt.SetReturnValue(
+      mExprFolder.Simplify(returnStmt.TakeReturnValue()));
+  }
+
+private:
+  ExprFolder mExprFolder;
+};
+
+} // namespace
+
+void
+FoldConstants(Module& module, MathMode mathMode)
+{
+  StmtFolder folder(mathMode);
+
+  for (auto& fn : module.Funcs())
+    fn->AcceptBodyMutator(folder);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "generator.h"
+
+class Module;
+
+/// @brief Evaluates the parts of the module's expressions that only depend on
+/// literals, and removes operations that have no effect on the result.
+///
+/// @detail This folds constant arithmetic, constant vector constructors and
+/// swizzles of constant vectors. It also removes multiplication and division
+/// by one and subtraction of zero. Division by a power of two becomes
+/// multiplication by its reciprocal, since the result is exactly the same.
+///
+/// In fast math mode, division by any other constant also becomes
+/// multiplication by its reciprocal, and adding zero is removed. These don't
+/// give exactly the same result in every case.
+///
+/// @note This should be called after the module has been resolved and
+/// checked, since folding relies on the type of each expression.
+void
+FoldConstants(Module& module, MathMode mathMode);
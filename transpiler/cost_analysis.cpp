@@ -0,0 +1,404 @@
+#include "cost_analysis.h"
+
+#include "decl.h"
+#include "module.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+size_t
+GetComponentCount(TypeID typeID) noexcept
+{
+  switch (typeID) {
+    case TypeID::Void:
+      return 0;
+    case TypeID::Mat2:
+      return 4;
+    case TypeID::Mat3:
+      return 9;
+    case TypeID::Mat4:
+      return 16;
+    default:
+      break;
+  }
+
+  return GetVectorComponentCount(typeID).value_or(1);
+}
+
+/// @brief Gets the number of rows of a square matrix, or nothing if the type
+/// isn't a matrix.
+auto
+GetMatrixSize(TypeID typeID) noexcept -> std::optional<size_t>
+{
+  switch (typeID) {
+    case TypeID::Mat2:
+      return 2;
+    case TypeID::Mat3:
+      return 3;
+    case TypeID::Mat4:
+      return 4;
+    default:
+      break;
+  }
+
+  return std::nullopt;
+}
+
+/// @brief Counts the operations of one function's body, and the calls it
+/// makes to other functions.
+class CostCounter final
+  : public StmtVisitor
+  , public ExprVisitor
+{
+public:
+  CostCounter(const UniformExprAnalysis& uniformExprs,
+              Cost& cost,
+              std::vector<const FuncDecl*>& callees)
+    : mUniformExprs(uniformExprs)
+    , mCost(cost)
+    , mCallees(callees)
+  {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    Count(assignmentStmt.RValue());
+
+    const auto* var = FindAssignedVar(assignmentStmt.LValue());
+
+    // Assigning a component of a varying global still stores to it.
+    if (var && var->IsVaryingGlobal())
+      mCost.varyingStores++;
+    else
+      Count(assignmentStmt.LValue());
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    const auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      Count(varDecl.InitExpr());
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    Count(returnStmt.ReturnValue());
+  }
+
+  void Visit(const IntLiteral&) override {}
+
+  void Visit(const BoolLiteral&) override {}
+
+  void Visit(const FloatLiteral&) override {}
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    Count(binaryExpr.LeftExpr());
+
+    Count(binaryExpr.RightExpr());
+
+    auto leftType = binaryExpr.LeftExpr().GetType();
+
+    auto rightType = binaryExpr.RightExpr().GetType();
+
+    if (!leftType || !rightType)
+      return;
+
+    auto matrixSize = GetMatrixSize(leftType->ID());
+
+    // Multiplying two matrices takes a dot product for each element.
+    if ((binaryExpr.GetKind() == BinaryExpr::Kind::Mul) && matrixSize &&
+        (leftType->ID() == rightType->ID())) {
+      auto n = *matrixSize;
+      mCost.matrixFlops += n * n * ((2 * n) - 1);
+      return;
+    }
+
+    CountComponentOps(binaryExpr.GetType());
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    Count(unaryExpr.BaseExpr());
+
+    CountComponentOps(unaryExpr.GetType());
+  }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef& varRef) override
+  {
+    if (!varRef.HasResolvedVar())
+      return;
+
+    const auto& var = varRef.ResolvedVar();
+
+    if (var.IsUniformGlobal())
+      mCost.uniformLoads++;
+    else if (var.IsVaryingGlobal())
+      mCost.varyingLoads++;
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    for (const auto& arg : funcCall.Args())
+      Count(*arg);
+
+    if (funcCall.IsBuiltin()) {
+      auto type = funcCall.GetType();
+      mCost.transcendentals += type ? GetComponentCount(type->ID()) : 1;
+      return;
+    }
+
+    if (!funcCall.Resolved())
+      return;
+
+    mCost.calls++;
+
+    mCallees.emplace_back(&funcCall.GetFuncDecl());
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    memberExpr.Recurse(*this);
+  }
+
+private:
+  /// @brief Counts an expression, unless it is computed once per frame, in
+  /// which case it only costs a load of the value.
+  void Count(const Expr& expr)
+  {
+    if (mUniformExprs.FindHoistedName(expr)) {
+      mCost.uniformLoads++;
+      return;
+    }
+
+    expr.AcceptVisitor(*this);
+  }
+
+  /// @brief Counts an operation that is done on each component of a value.
+  void CountComponentOps(const std::optional<Type>& type)
+  {
+    if (!type)
+      return;
+
+    auto id = type->ID();
+
+    auto count = GetComponentCount(id);
+
+    if ((id == TypeID::Int) || (id == TypeID::Bool) || IsVecI(id))
+      mCost.intOps += count;
+    else if (GetMatrixSize(id))
+      mCost.matrixFlops += count;
+    else if (id == TypeID::Float)
+      mCost.scalarFlops += count;
+    else
+      mCost.vectorFlops += count;
+  }
+
+  static const VarDecl* FindAssignedVar(const Expr& lValue)
+  {
+    if (const auto* varRef = dynamic_cast<const VarRef*>(&lValue))
+      return varRef->HasResolvedVar() ? &varRef->ResolvedVar() : nullptr;
+
+    if (const auto* memberExpr = dynamic_cast<const MemberExpr*>(&lValue))
+      return FindAssignedVar(memberExpr->BaseExpr());
+
+    return nullptr;
+  }
+
+  const UniformExprAnalysis& mUniformExprs;
+
+  Cost& mCost;
+
+  std::vector<const FuncDecl*>& mCallees;
+};
+
+enum TotalState : char
+{
+  kNotSummed,
+  kSumming,
+  kSummed
+};
+
+void
+PrintCostRow(std::ostream& stream, const char* label, const Cost& cost)
+{
+  stream << std::left << std::setw(8) << label << std::right << std::setw(8)
+         << cost.scalarFlops << std::setw(8) << cost.vectorFlops
+         << std::setw(8) << cost.matrixFlops << std::setw(8) << cost.intOps
+         << std::setw(8) << cost.transcendentals << std::setw(9)
+         << cost.uniformLoads << std::setw(9) << cost.varyingLoads
+         << std::setw(9) << cost.varyingStores << std::setw(7) << cost.calls
+         << std::endl;
+}
+
+} // namespace
+
+Cost&
+Cost::operator+=(const Cost& other) noexcept
+{
+  scalarFlops += other.scalarFlops;
+  vectorFlops += other.vectorFlops;
+  matrixFlops += other.matrixFlops;
+  intOps += other.intOps;
+  transcendentals += other.transcendentals;
+  uniformLoads += other.uniformLoads;
+  varyingLoads += other.varyingLoads;
+  varyingStores += other.varyingStores;
+  calls += other.calls;
+  return *this;
+}
+
+Cost
+CostAnalysis::SampleCost() const
+{
+  Cost cost;
+
+  for (const auto& funcCost : mFuncCosts) {
+    if (funcCost.funcDecl->IsPixelSampler() ||
+        funcCost.funcDecl->IsPixelEncoder())
+      cost += funcCost.total;
+  }
+
+  return cost;
+}
+
+bool
+CostAnalysis::AnalyzeModule()
+{
+  mFuncCosts.clear();
+
+  mCallees.clear();
+
+  mFuncIndices.clear();
+
+  mUniformExprs.Invoke(GetModule());
+
+  for (const auto& func : GetModule().Funcs())
+    AnalyzeFuncDecl(*func);
+
+  mTotalState.assign(mFuncCosts.size(), kNotSummed);
+
+  for (size_t i = 0; i < mFuncCosts.size(); i++)
+    SumTotal(i);
+
+  return true;
+}
+
+bool
+CostAnalysis::AnalyzeVarDecl(const VarDecl&)
+{
+  return true;
+}
+
+bool
+CostAnalysis::AnalyzeFuncDecl(const FuncDecl& funcDecl)
+{
+  mFuncIndices.emplace(&funcDecl, mFuncCosts.size());
+
+  FuncCost funcCost;
+
+  funcCost.funcDecl = &funcDecl;
+
+  mCallees.emplace_back();
+
+  CostCounter counter(mUniformExprs, funcCost.self, mCallees.back());
+
+  funcDecl.AcceptBodyVisitor(counter);
+
+  mFuncCosts.emplace_back(funcCost);
+
+  return true;
+}
+
+void
+CostAnalysis::SumTotal(size_t funcIndex)
+{
+  auto& funcCost = mFuncCosts[funcIndex];
+
+  if (mTotalState[funcIndex] == kSummed)
+    return;
+
+  if (mTotalState[funcIndex] == kSumming) {
+    funcCost.recursive = true;
+    return;
+  }
+
+  mTotalState[funcIndex] = kSumming;
+
+  Cost total = funcCost.self;
+
+  for (const auto* callee : mCallees[funcIndex]) {
+
+    auto it = mFuncIndices.find(callee);
+
+    // Functions of imported modules aren't part of this module's tree.
+    if (it == mFuncIndices.end())
+      continue;
+
+    SumTotal(it->second);
+
+    // The callee's total is incomplete while its cycle is being summed.
+    if (mTotalState[it->second] == kSumming) {
+      funcCost.recursive = true;
+      total += mFuncCosts[it->second].self;
+      continue;
+    }
+
+    if (mFuncCosts[it->second].recursive)
+      funcCost.recursive = true;
+
+    total += mFuncCosts[it->second].total;
+  }
+
+  funcCost.total = total;
+
+  mTotalState[funcIndex] = kSummed;
+}
+
+void
+PrintCostReport(std::ostream& stream, const CostAnalysis& costAnalysis)
+{
+  stream << std::left << std::setw(8) << "" << std::right << std::setw(8)
+         << "scalar" << std::setw(8) << "vector" << std::setw(8) << "matrix"
+         << std::setw(8) << "int" << std::setw(8) << "transc" << std::setw(9)
+         << "uniform" << std::setw(9) << "varying" << std::setw(9) << "stores"
+         << std::setw(7) << "calls" << std::endl;
+
+  for (const auto& funcCost : costAnalysis.FuncCosts()) {
+
+    stream << funcCost.funcDecl->Identifier();
+
+    if (funcCost.recursive)
+      stream << " (recursive, totals are a lower bound)";
+
+    stream << std::endl;
+
+    PrintCostRow(stream, "  self", funcCost.self);
+
+    PrintCostRow(stream, "  total", funcCost.total);
+  }
+
+  auto sampleCost = costAnalysis.SampleCost();
+
+  stream << std::endl;
+
+  PrintCostRow(stream, "sample", sampleCost);
+
+  stream << "flops per sample: " << sampleCost.Flops() << " (plus "
+         << sampleCost.transcendentals << " transcendental components)"
+         << std::endl;
+}
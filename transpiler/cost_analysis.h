@@ -0,0 +1,115 @@
+#pragma once
+
+#include "analysis_pass.h"
+#include "uniform_expr_analysis.h"
+
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+/// @brief An estimate of the work done by one call to a function.
+struct Cost final
+{
+  /// @brief The floating point operations on scalars.
+  size_t scalarFlops = 0;
+
+  /// @brief The floating point operations on the components of vectors.
+  size_t vectorFlops = 0;
+
+  /// @brief The floating point operations of matrix arithmetic.
+  size_t matrixFlops = 0;
+
+  /// @brief The operations on integers and booleans, and their vectors.
+  size_t intOps = 0;
+
+  /// @brief The components computed by transcendental builtin functions,
+  /// which each cost a lot more than an arithmetic operation.
+  size_t transcendentals = 0;
+
+  /// @brief The reads of uniform globals, which the generated code reads
+  /// from the frame's data.
+  size_t uniformLoads = 0;
+
+  /// @brief The reads of varying globals, which the generated code reads
+  /// from the pixel's data.
+  size_t varyingLoads = 0;
+
+  size_t varyingStores = 0;
+
+  /// @brief The calls to functions of the module, not including builtins.
+  size_t calls = 0;
+
+  size_t Flops() const noexcept
+  {
+    return scalarFlops + vectorFlops + matrixFlops;
+  }
+
+  Cost& operator+=(const Cost& other) noexcept;
+};
+
+/// @brief Estimates the cost of each function from the operations in its
+/// body, and the cost of each call to it including the functions it calls.
+///
+/// @detail Each operation is counted once, since there is no control flow.
+/// Expressions that only depend on uniform variables are computed once per
+/// frame by the generated code, so they only count as a load of the value.
+///
+/// @note This should be called on a module that is ready to be generated,
+/// since constant folding changes the operations that are left.
+class CostAnalysis final : public AnalysisPass
+{
+public:
+  struct FuncCost final
+  {
+    const FuncDecl* funcDecl = nullptr;
+
+    /// @brief The cost of the function's own body.
+    Cost self;
+
+    /// @brief The cost of the function's body and of the functions it calls.
+    Cost total;
+
+    /// @brief Whether the function is part of a cycle of calls, in which case
+    /// its total only counts each function of the cycle once.
+    bool recursive = false;
+  };
+
+  /// @brief Gets the cost of each function, in the order of the module.
+  auto FuncCosts() const noexcept -> const std::vector<FuncCost>&
+  {
+    return mFuncCosts;
+  }
+
+  /// @brief Gets the cost of one sample, which is a call to the pixel sampler
+  /// and one to the pixel encoder.
+  Cost SampleCost() const;
+
+protected:
+  bool AnalyzeModule() override;
+
+  bool AnalyzeVarDecl(const VarDecl&) override;
+
+  bool AnalyzeFuncDecl(const FuncDecl&) override;
+
+private:
+  /// @brief Finds the total cost of a function, once the cost of each body is
+  /// known.
+  void SumTotal(size_t funcIndex);
+
+  UniformExprAnalysis mUniformExprs;
+
+  std::vector<FuncCost> mFuncCosts;
+
+  /// @brief The functions called by each function, once per call.
+  std::vector<std::vector<const FuncDecl*>> mCallees;
+
+  std::map<const FuncDecl*, size_t> mFuncIndices;
+
+  /// @brief Whether the total of each function is done, or being found.
+  std::vector<char> mTotalState;
+};
+
+/// @brief Prints the cost of each function as a table, followed by the cost
+/// of one sample.
+void
+PrintCostReport(std::ostream& stream, const CostAnalysis& costAnalysis);
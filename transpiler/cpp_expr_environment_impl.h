@@ -3,14 +3,20 @@
 #include "cpp_expr_generator.h"
 
 #include "module.h"
+#include "uniform_expr_analysis.h"
+#include "varying_liveness_analysis.h"
 
 namespace cpp {
 
 class ExprEnvironmentImpl final : public ExprEnvironment<ExprEnvironmentImpl>
 {
 public:
-  ExprEnvironmentImpl(const Module& module)
+  ExprEnvironmentImpl(const Module& module,
+                      const UniformExprAnalysis* uniformExprs = nullptr,
+                      const VaryingLivenessAnalysis* varyingLiveness = nullptr)
     : mModule(module)
+    , mUniformExprs(uniformExprs)
+    , mVaryingLiveness(varyingLiveness)
   {}
 
   auto GetGlobalsUsageImpl(const FuncCall& funcCall) const
@@ -19,6 +25,9 @@ public:
     if (!funcCall.Resolved())
       return {};
 
+    if (funcCall.IsBuiltin())
+      return GlobalsUsage{ false, false };
+
     const auto& funcDecl = funcCall.GetFuncDecl();
 
     return GlobalsUsage{ funcDecl.ReferencesFrameState(),
@@ -27,16 +36,24 @@ public:
 
   auto GetVarOriginImpl(const VarRef& varRef) const -> std::optional<VarOrigin>
   {
-    for (const auto& var : mModule.GlobalVars()) {
+    // Resolved references tell locals apart from the globals they shadow.
+    const auto* var = varRef.HasResolvedVar()
+                        ? &varRef.ResolvedVar()
+                        : mModule.FindGlobalVar(varRef.GetSymbol());
 
-      if (var->Identifier() != varRef.Identifier())
-        continue;
+    if (!var)
+      return {};
 
-      if (var->IsVaryingGlobal())
-        return VarOrigin::VaryingGlobal;
-      else if (var->IsUniformGlobal())
-        return VarOrigin::UniformGlobal;
-    }
+    // Varying globals that aren't stored with each pixel are declared as
+    // local variables of the pixel sampler.
+    if (var->IsVaryingGlobal() && mVaryingLiveness &&
+        !mVaryingLiveness->IsStored(*var))
+      return VarOrigin::Local;
+
+    if (var->IsVaryingGlobal())
+      return VarOrigin::VaryingGlobal;
+    else if (var->IsUniformGlobal())
+      return VarOrigin::UniformGlobal;
 
     return {};
   }
@@ -71,8 +88,24 @@ public:
     return {};
   }
 
+  auto GetHoistedNameImpl(const Expr& expr) const -> std::optional<std::string>
+  {
+    if (!mUniformExprs)
+      return {};
+
+    return mUniformExprs->FindHoistedName(expr);
+  }
+
 private:
   const Module& mModule;
+
+  /// @brief The expressions hoisted out of the pixel sampler. This is null
+  /// when generating code that isn't part of the pixel sampler.
+  const UniformExprAnalysis* mUniformExprs;
+
+  /// @brief Decides which varying globals are stored with each pixel. When
+  /// this is null, all of them are.
+  const VaryingLivenessAnalysis* mVaryingLiveness;
 };
 
 } // namespace cpp
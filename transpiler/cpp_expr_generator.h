@@ -3,6 +3,7 @@
 #include "expr.h"
 #include "type_environment.h"
 
+#include <charconv>
 #include <sstream>
 
 namespace cpp {
@@ -52,6 +53,16 @@ public:
     return GetDerived().GetVectorComponentCountImpl(expr);
   }
 
+  /// @brief Used to replace expressions that only depend on uniform variables
+  /// with a value that is computed once per frame.
+  ///
+  /// @return The name of the field in the uniform data that holds the value of
+  /// the expression, if it was hoisted.
+  auto GetHoistedName(const Expr& expr) const -> std::optional<std::string>
+  {
+    return GetDerived().GetHoistedNameImpl(expr);
+  }
+
 private:
   const Derived& GetDerived() const noexcept
   {
@@ -84,11 +95,23 @@ public:
 
   void Visit(const FloatLiteral& floatLiteral) override
   {
-    mStream << "float_type(" << floatLiteral.Value() << ")";
+    // The shortest representation that reads back as the same value, so
+    // that folded constants don't lose precision.
+    char buffer[32];
+
+    auto result =
+      std::to_chars(buffer, buffer + sizeof(buffer), floatLiteral.Value());
+
+    mStream << "float_type(";
+    mStream.write(buffer, result.ptr - buffer);
+    mStream << ")";
   }
 
   void Visit(const BinaryExpr& binaryExpr) override
   {
+    if (EncodeHoisted(binaryExpr))
+      return;
+
     binaryExpr.LeftExpr().AcceptVisitor(*this);
 
     switch (binaryExpr.GetKind()) {
@@ -114,9 +137,15 @@ public:
 
   void Visit(const FuncCall& funcCall) override
   {
+    if (EncodeHoisted(funcCall))
+      return;
+
     const auto& args = funcCall.Args();
 
-    mStream << funcCall.Identifier();
+    if (funcCall.IsBuiltin())
+      mStream << "math::" << GetBuiltinName(funcCall.GetBuiltinID());
+    else
+      mStream << funcCall.Identifier();
 
     mStream << '(';
 
@@ -143,6 +172,9 @@ public:
 
   void Visit(const UnaryExpr& unaryExpr) override
   {
+    if (EncodeHoisted(unaryExpr))
+      return;
+
     switch (unaryExpr.GetKind()) {
       case UnaryExpr::Kind::LogicalNot:
         mStream << "!";
@@ -160,6 +192,9 @@ public:
 
   void Visit(const GroupExpr& groupExpr) override
   {
+    if (EncodeHoisted(groupExpr))
+      return;
+
     mStream << '(';
 
     groupExpr.Recurse(*this);
@@ -177,6 +212,7 @@ public:
 
     switch (*origin) {
       case VarOrigin::Local:
+        mStream << varRef.Identifier();
         break;
       case VarOrigin::UniformGlobal:
         mStream << "frame." << varRef.Identifier();
@@ -189,6 +225,9 @@ public:
 
   void Visit(const TypeConstructor& typeConstructor) override
   {
+    if (EncodeHoisted(typeConstructor))
+      return;
+
     switch (typeConstructor.GetType().value().ID()) {
       case TypeID::Void:
         break;
@@ -245,6 +284,9 @@ public:
 
   void Visit(const MemberExpr& memberExpr) override
   {
+    if (EncodeHoisted(memberExpr))
+      return;
+
     const auto& baseExpr = memberExpr.BaseExpr();
 
     const auto& memberName = memberExpr.MemberName().Identifier();
@@ -258,6 +300,17 @@ public:
   }
 
 private:
+  bool EncodeHoisted(const Expr& expr)
+  {
+    auto name = mExprEnv.GetHoistedName(expr);
+    if (!name)
+      return false;
+
+    mStream << "frame." << *name;
+
+    return true;
+  }
+
   void EncodeExprList(const ExprList& exprList)
   {
     for (size_t i = 0; i < exprList.size(); i++) {
@@ -20,7 +20,7 @@ TypePrinter::Visit(const Type& type)
       mStream << "bool";
       break;
     case TypeID::Float:
-      mStream << "float";
+      mStream << "float_type";
       break;
     case TypeID::Vec2:
       mStream << "vec2";
@@ -58,26 +58,254 @@ Generator::Generate(const Module& module)
   if (!module.HasModuleExportDecl())
     return;
 
+  mUniformExprs.Invoke(module);
+
+  mVaryingLiveness.Invoke(module);
+
+  mCallConventions.Invoke(module);
+
   os << "#pragma once" << std::endl;
 
   Blank();
 
+  // The runtime is imported when it is built as a C++20 module.
+  os << "#ifdef PATHWAY_RUNTIME_MODULE" << std::endl;
+  os << "#include <pathway_attributes.h>" << std::endl;
+  os << "import pathway;" << std::endl;
+  os << "#else" << std::endl;
   os << "#include <pathway.h>" << std::endl;
+  os << "#endif" << std::endl;
+
+  if (GetOptions().instrument)
+    os << "#include <pathway_profile.h>" << std::endl;
+
+  if (GetOptions().entryTable)
+    os << "#include <pathway_entry.h>" << std::endl;
+
+  Blank();
+
+  GenerateNamespaceBegin(module);
+
+  GenerateInnerNamespaceDecls(module);
+
+  GenerateNamespaceEnd(module);
+
+  if (GetOptions().entryTable) {
+
+    Blank();
+
+    GenerateEntryTable(module);
+  }
+}
+
+void
+Generator::GenerateSource(const Module& module, const std::string& headerName)
+{
+  if (!module.HasModuleExportDecl())
+    return;
+
+  mUniformExprs.Invoke(module);
+
+  mVaryingLiveness.Invoke(module);
+
+  mCallConventions.Invoke(module);
+
+  os << "#include \"" << headerName << '"' << std::endl;
 
   Blank();
 
+  GenerateNamespaceBegin(module);
+
+  Indent() << "using namespace pathway;" << std::endl;
+
+  GenerateFuncDefs(module);
+
+  Blank();
+
+  GenerateInstantiations("template");
+
+  GenerateNamespaceEnd(module);
+}
+
+void
+Generator::GenerateEntryTable(const Module& module)
+{
+  std::ostringstream nsStream;
+
   const auto& moduleName = module.GetModuleExportDecl().GetModuleName();
 
-  const auto& ids = moduleName.Identifiers();
+  for (const auto& id : moduleName.Identifiers())
+    nsStream << id << "::";
+
+  auto ns = nsStream.str();
+
+  os << "namespace {" << std::endl;
+
+  Blank();
+
+  os << "using pathway_module_frame = pathway::frame<" << ns
+     << "uniform_data<float, int>, " << ns
+     << "varying_data<float, int>, float>;" << std::endl;
+
+  Blank();
+
+  GenerateEntryTableSetUniform(module);
+
+  Blank();
+
+  os << "const pathway_entry_table pathway_module_entry_table{" << std::endl;
+
+  IncreaseIndent();
+
+  Indent() << "PATHWAY_ENTRY_TABLE_VERSION," << std::endl;
+  Indent() << "[]() -> void* { return new (std::nothrow) "
+              "pathway_module_frame(); },"
+           << std::endl;
+  Indent() << "[](void* f) { delete static_cast<pathway_module_frame*>(f); },"
+           << std::endl;
+  Indent() << "[](void* f, size_t w, size_t h) -> int {" << std::endl;
+  Indent() << "  try {" << std::endl;
+  Indent() << "    static_cast<pathway_module_frame*>(f)->resize(w, h);"
+           << std::endl;
+  Indent() << "  } catch (...) {" << std::endl;
+  Indent() << "    return 0;" << std::endl;
+  Indent() << "  }" << std::endl;
+  Indent() << "  return 1;" << std::endl;
+  Indent() << "}," << std::endl;
+  Indent() << "[](void* f) { static_cast<pathway_module_frame*>(f)"
+              "->sample_pixels(); },"
+           << std::endl;
+  Indent() << "[](const void* f, unsigned char* rgb) { static_cast<const "
+              "pathway_module_frame*>(f)->encode_rgb(rgb); },"
+           << std::endl;
+  Indent() << "pathway_module_set_uniform" << std::endl;
 
-  for (const auto& id : ids) {
+  DecreaseIndent();
+
+  os << "};" << std::endl;
+
+  Blank();
+
+  os << "} // namespace" << std::endl;
+
+  Blank();
+
+  os << "extern \"C\" PATHWAY_ENTRY_EXPORT auto" << std::endl;
+  os << "pathway_get_entry_table() -> const pathway_entry_table*" << std::endl;
+  os << '{' << std::endl;
+  os << "  return &pathway_module_entry_table;" << std::endl;
+  os << '}' << std::endl;
+}
+
+void
+Generator::GenerateEntryTableSetUniform(const Module& module)
+{
+  os << "auto" << std::endl;
+  os << "pathway_module_set_uniform(void* f, const char* name, const float* "
+        "values, size_t count) -> int"
+     << std::endl;
+  os << '{' << std::endl;
 
-    os << "namespace " << *id << " {" << std::endl;
+  IncreaseIndent();
+
+  const auto& vars = module.UniformGlobalVars();
+
+  if (vars.empty()) {
+    Indent() << "(void)f;" << std::endl;
+    Indent() << "(void)name;" << std::endl;
+    Indent() << "(void)values;" << std::endl;
+    Indent() << "(void)count;" << std::endl;
+  } else {
+    Indent() << "auto& u = static_cast<pathway_module_frame*>(f)"
+                "->get_uniform_data();"
+             << std::endl;
+  }
+
+  for (const auto& var : vars) {
+
+    auto typeID = var->GetTypeID();
+
+    size_t columns = 1;
+
+    size_t rows = GetVectorComponentCount(typeID).value_or(1);
+
+    switch (typeID) {
+      case TypeID::Mat2:
+        columns = rows = 2;
+        break;
+      case TypeID::Mat3:
+        columns = rows = 3;
+        break;
+      case TypeID::Mat4:
+        columns = rows = 4;
+        break;
+      default:
+        break;
+    }
 
     Blank();
+
+    Indent() << "if (strcmp(name, \"" << var->Identifier() << "\") == 0) {"
+             << std::endl;
+
+    IncreaseIndent();
+
+    Indent() << "if (count != " << (columns * rows) << ')' << std::endl;
+    Indent() << "  return 0;" << std::endl;
+
+    for (size_t i = 0; i < (columns * rows); i++) {
+
+      Indent() << "u." << var->Identifier();
+
+      if (columns > 1)
+        os << ".at<" << (i / rows) << ">()";
+
+      if (rows > 1)
+        os << ".at<" << (i % rows) << ">()";
+
+      if (typeID == TypeID::Bool)
+        os << " = (values[" << i << "] != 0);" << std::endl;
+      else if ((typeID == TypeID::Int) || IsVecI(typeID))
+        os << " = int(values[" << i << "]);" << std::endl;
+      else
+        os << " = values[" << i << "];" << std::endl;
+    }
+
+    Indent() << "return 1;" << std::endl;
+
+    DecreaseIndent();
+
+    Indent() << '}' << std::endl;
   }
 
-  GenerateInnerNamespaceDecls(module);
+  Blank();
+
+  Indent() << "return 0;" << std::endl;
+
+  DecreaseIndent();
+
+  os << '}' << std::endl;
+}
+
+void
+Generator::GenerateNamespaceBegin(const Module& module)
+{
+  const auto& moduleName = module.GetModuleExportDecl().GetModuleName();
+
+  for (const auto& id : moduleName.Identifiers()) {
+
+    os << "namespace " << id << " {" << std::endl;
+
+    Blank();
+  }
+}
+
+void
+Generator::GenerateNamespaceEnd(const Module& module)
+{
+  const auto& moduleName = module.GetModuleExportDecl().GetModuleName();
+
+  const auto& ids = moduleName.Identifiers();
 
   for (auto it = ids.rbegin(); it != ids.rend(); it++) {
 
@@ -85,10 +313,55 @@ Generator::Generate(const Module& module)
 
     Blank();
 
-    os << "} // namespace " << *id << std::endl;
+    os << "} // namespace " << id << std::endl;
   }
 }
 
+void
+Generator::GenerateInstantiations(const char* prefix)
+{
+  for (const auto& types : GetOptions().instantiations) {
+
+    Indent() << prefix << " struct uniform_data<" << types.floatType << ", "
+             << types.intType << ">;" << std::endl;
+
+    Indent() << prefix << " struct varying_data<" << types.floatType << ", "
+             << types.intType << ">;" << std::endl;
+  }
+}
+
+void
+Generator::GenerateProfile(const Module& module)
+{
+  Indent() << "/// Counts the calls and cycles of each function, by index."
+           << std::endl;
+  Indent() << "inline auto module_profile() -> profile&" << std::endl;
+  Indent() << '{' << std::endl;
+
+  IncreaseIndent();
+
+  Indent() << "static profile p{";
+
+  const auto& funcs = module.Funcs();
+
+  for (size_t i = 0; i < funcs.size(); i++)
+    os << ((i == 0) ? " " : ", ") << '"' << funcs[i]->Identifier() << '"';
+
+  os << " };" << std::endl;
+
+  Indent() << "return p;" << std::endl;
+
+  DecreaseIndent();
+
+  Indent() << '}' << std::endl;
+
+  Blank();
+
+  Indent() << "inline thread_local profile::counters module_profile_counters{ "
+              "module_profile() };"
+           << std::endl;
+}
+
 void
 Generator::GenerateTypeAliases()
 {
@@ -107,6 +380,17 @@ Generator::GenerateTypeAliases()
   Indent() << "using mat2 = matrix<float_type, 2, 2>;" << std::endl;
   Indent() << "using mat3 = matrix<float_type, 3, 3>;" << std::endl;
   Indent() << "using mat4 = matrix<float_type, 4, 4>;" << std::endl;
+
+  Blank();
+
+  switch (GetOptions().mathMode) {
+    case MathMode::Precise:
+      Indent() << "using math = precise_math;" << std::endl;
+      break;
+    case MathMode::Fast:
+      Indent() << "using math = fast_math;" << std::endl;
+      break;
+  }
 }
 
 void
@@ -116,6 +400,13 @@ Generator::GenerateInnerNamespaceDecls(const Module& module)
 
   Blank();
 
+  if (GetOptions().instrument) {
+
+    GenerateProfile(module);
+
+    Blank();
+  }
+
   GenerateUniformData(module);
 
   Blank();
@@ -124,6 +415,16 @@ Generator::GenerateInnerNamespaceDecls(const Module& module)
 
   Blank();
 
+  if (!GetOptions().instantiations.empty()) {
+
+    Indent() << "// Defined and instantiated in the generated source file."
+             << std::endl;
+
+    GenerateInstantiations("extern template");
+
+    return;
+  }
+
   Indent() << "// Implementation details below." << std::endl;
 
   GenerateFuncDefs(module);
@@ -148,6 +449,9 @@ Generator::GenerateUniformData(const Module& module)
 
     typePrinter.Visit(var->GetType());
 
+    if (var->HasInitExpr())
+      LineDirective(var->GetNameLocation());
+
     Indent() << typePrinter.String() << ' ' << var->Identifier();
 
     if (var->HasInitExpr()) {
@@ -162,13 +466,88 @@ Generator::GenerateUniformData(const Module& module)
     }
 
     os << ';' << std::endl;
+
+    if (var->HasInitExpr())
+      EndLineDirective();
   }
 
+  GenerateUniformDataPrepare(module);
+
   DecreaseIndent();
 
   os << "};" << std::endl;
 }
 
+void
+Generator::GenerateUniformDataPrepare(const Module& module)
+{
+  const auto& hoistedExprs = mUniformExprs.HoistedExprs();
+
+  if (hoistedExprs.empty())
+    return;
+
+  for (const auto& hoistedExpr : hoistedExprs) {
+
+    Blank();
+
+    TypePrinter typePrinter;
+
+    typePrinter.Visit(hoistedExpr.expr->GetType().value());
+
+    // Hosts that call the pixel sampler themselves may forget to prepare
+    // the data, which shouldn't read indeterminate values.
+    Indent() << typePrinter.String() << ' ' << hoistedExpr.name << " = {};"
+             << std::endl;
+  }
+
+  Blank();
+
+  Indent() << "bool prepared = false;" << std::endl;
+
+  Blank();
+
+  Indent() << "/// Computes the values that only depend on uniform variables."
+           << std::endl;
+  Indent() << "/// Has to be called after the uniform variables are changed and"
+           << std::endl;
+  Indent() << "/// before any pixel is sampled, which 'pathway::frame' does for"
+           << std::endl;
+  Indent() << "/// each frame. The pixel sampler asserts that it was called."
+           << std::endl;
+  Indent() << "void prepare() noexcept" << std::endl;
+  Indent() << '{' << std::endl;
+
+  IncreaseIndent();
+
+  Indent() << "const auto& frame = *this;" << std::endl;
+
+  Blank();
+
+  for (const auto& hoistedExpr : hoistedExprs) {
+
+    ExprEnvironmentImpl exprEnv(module);
+
+    ExprGenerator exprGenerator(exprEnv);
+
+    hoistedExpr.expr->AcceptVisitor(exprGenerator);
+
+    LineDirective(hoistedExpr.expr->GetLocation());
+
+    Indent() << "this->" << hoistedExpr.name << " = " << exprGenerator.String()
+             << ';' << std::endl;
+  }
+
+  EndLineDirective();
+
+  Blank();
+
+  Indent() << "this->prepared = true;" << std::endl;
+
+  DecreaseIndent();
+
+  Indent() << '}' << std::endl;
+}
+
 void
 Generator::GenerateVaryingData(const Module& module)
 {
@@ -187,6 +566,9 @@ Generator::GenerateVaryingData(const Module& module)
 
   for (const auto& var : module.VaryingGlobalVars()) {
 
+    if (!mVaryingLiveness.IsStored(*var))
+      continue;
+
     Blank();
 
     TypePrinter typePrinter;
@@ -208,14 +590,12 @@ Generator::GenerateVaryingData(const Module& module)
     Blank();
 
     if (func->IsPixelSampler()) {
-      Indent() << "auto operator()(const uniform_data_type& frame, vec2 "
-                  "uv_min, vec2 uv_max) noexcept -> void;"
-               << std::endl;
+      Indent() << "auto operator()(" << GetFrameParam(true)
+               << ", vec2 uv_min, vec2 uv_max) noexcept -> void;" << std::endl;
       continue;
     } else if (func->IsPixelEncoder()) {
-      Indent() << "auto operator()(const uniform_data_type& frame) const "
-                  "noexcept -> vec4;"
-               << std::endl;
+      Indent() << "auto operator()(" << GetFrameParam(true)
+               << ") const noexcept -> vec4;" << std::endl;
       continue;
     }
 
@@ -223,7 +603,12 @@ Generator::GenerateVaryingData(const Module& module)
 
     typePrinter.Visit(func->ReturnType());
 
-    Indent() << "auto " << func->Identifier();
+    Indent();
+
+    if (GetOptions().callHints && mCallConventions.IsAlwaysInlined(*func))
+      os << "PATHWAY_ALWAYS_INLINE ";
+
+    os << "auto " << func->Identifier();
 
     GenerateParamList(module, *func);
 
@@ -243,9 +628,9 @@ Generator::GenerateParamList(const Module& module, const FuncDecl& funcDecl)
   std::vector<std::string> paramStrings;
 
   if (funcDecl.ReferencesFrameState())
-    paramStrings.emplace_back("const uniform_data_type& frame");
+    paramStrings.emplace_back(GetFrameParam(true));
   else if (funcDecl.IsEntryPoint())
-    paramStrings.emplace_back("const uniform_data_type&");
+    paramStrings.emplace_back(GetFrameParam(false));
 
   for (const auto& param : funcDecl.GetParamList()) {
 
@@ -253,8 +638,17 @@ Generator::GenerateParamList(const Module& module, const FuncDecl& funcDecl)
 
     typePrinter.Visit(param->GetType());
 
+    // Parameters that are assigned need a copy of their own.
+    auto byValue =
+      !GetOptions().callHints || mCallConventions.IsAssigned(*param);
+
     std::ostringstream paramStream;
-    paramStream << typePrinter.String();
+
+    if (byValue)
+      paramStream << typePrinter.String();
+    else
+      paramStream << "param_t<" << typePrinter.String() << '>';
+
     paramStream << ' ';
     paramStream << param->Identifier();
 
@@ -274,30 +668,46 @@ Generator::GenerateParamList(const Module& module, const FuncDecl& funcDecl)
   os << ')';
 }
 
+std::string
+Generator::GetFrameParam(bool named) const
+{
+  std::string param = "const uniform_data_type&";
+
+  // The uniform data isn't changed while the pixels are sampled and encoded,
+  // so the stores to the varying data can't change it either.
+  if (GetOptions().callHints)
+    param += " PATHWAY_RESTRICT";
+
+  if (named)
+    param += " frame";
+
+  return param;
+}
+
 void
 Generator::GenerateFuncDefs(const Module& module)
 {
-  for (const auto& func : module.Funcs()) {
+  const auto& funcs = module.Funcs();
+
+  for (size_t funcIndex = 0; funcIndex < funcs.size(); funcIndex++) {
+
+    const auto& func = funcs[funcIndex];
 
     Blank();
 
     Indent() << "template <typename float_type, typename int_type>"
              << std::endl;
 
+    LineDirective(func->GetNameLocation());
+
     Indent() << "auto varying_data<float_type, int_type>::";
 
     if (func->IsPixelSampler()) {
-      if (func->ReferencesFrameState())
-        os << "operator()(const uniform_data_type& frame, vec2 uv_min, vec2 "
-              "uv_max) noexcept -> ";
-      else
-        os << "operator()(const uniform_data_type&, vec2 uv_min, vec2 uv_max) "
-              "noexcept -> ";
+      os << "operator()(" << GetFrameParam(func->ReferencesFrameState())
+         << ", vec2 uv_min, vec2 uv_max) noexcept -> ";
     } else if (func->IsPixelEncoder()) {
-      if (func->ReferencesFrameState())
-        os << "operator()(const uniform_data_type& frame) const noexcept -> ";
-      else
-        os << "operator()(const uniform_data_type&) const noexcept -> ";
+      os << "operator()(" << GetFrameParam(func->ReferencesFrameState())
+         << ") const noexcept -> ";
     } else {
       os << func->Identifier();
       GenerateParamList(module, *func);
@@ -310,11 +720,24 @@ Generator::GenerateFuncDefs(const Module& module)
 
     os << typePrinter.String() << std::endl;
 
-    StmtGenerator stmtGenerator(module);
+    StmtGenerator stmtGenerator(
+      module, &mUniformExprs, &mVaryingLiveness, GetLineDirectives());
+
+    if (func->IsPixelSampler())
+      stmtGenerator.DeclareLocals(mVaryingLiveness.SamplerLocals());
+
+    if (func->IsPixelSampler() && func->ReferencesFrameState() &&
+        !mUniformExprs.HoistedExprs().empty())
+      stmtGenerator.RequirePrepared();
+
+    if (GetOptions().instrument)
+      stmtGenerator.Instrument(funcIndex);
 
     func->AcceptBodyVisitor(stmtGenerator);
 
     os << stmtGenerator.String();
+
+    EndLineDirective();
   }
 }
 
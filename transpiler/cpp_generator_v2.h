@@ -1,6 +1,9 @@
 #pragma once
 
 #include "c_based_generator.h"
+#include "call_convention_analysis.h"
+#include "uniform_expr_analysis.h"
+#include "varying_liveness_analysis.h"
 
 namespace cpp {
 
@@ -18,24 +21,65 @@ private:
 class Generator final : public CBasedGenerator
 {
 public:
-  Generator(std::ostream& os)
-    : CBasedGenerator(os)
+  Generator(std::ostream& os, const GeneratorOptions& options = {})
+    : CBasedGenerator(os, options)
   {}
 
   void Generate(const Module& module) override;
 
+  /// @brief Generates the source file that goes with a header generated with
+  /// explicit instantiations, see @ref GeneratorOptions::instantiations.
+  ///
+  /// @param headerName How the source file includes the header.
+  void GenerateSource(const Module& module, const std::string& headerName);
+
 protected:
+  /// @brief Generates the profile that instrumented functions count into.
+  void GenerateProfile(const Module&);
+
   void GenerateTypeAliases();
 
   void GenerateParamList(const Module&, const FuncDecl&);
 
+  /// @brief Gets the parameter that functions take the uniform data by.
+  ///
+  /// @param named Whether the body refers to the parameter.
+  std::string GetFrameParam(bool named) const;
+
   void GenerateUniformData(const Module&);
 
+  void GenerateUniformDataPrepare(const Module&);
+
   void GenerateVaryingData(const Module&);
 
   void GenerateInnerNamespaceDecls(const Module& module);
 
   void GenerateFuncDefs(const Module&);
+
+  /// @brief Generates a declaration or definition of each explicit
+  /// instantiation.
+  ///
+  /// @param prefix Either "extern template" or "template".
+  void GenerateInstantiations(const char* prefix);
+
+  /// @brief Generates the C entry table of 'pathway_entry.h', with the
+  /// templates instantiated for 'float' and 'int'.
+  void GenerateEntryTable(const Module&);
+
+  /// @brief Generates the function of the entry table that sets a uniform
+  /// variable by its name.
+  void GenerateEntryTableSetUniform(const Module&);
+
+  void GenerateNamespaceBegin(const Module&);
+
+  void GenerateNamespaceEnd(const Module&);
+
+private:
+  UniformExprAnalysis mUniformExprs;
+
+  VaryingLivenessAnalysis mVaryingLiveness;
+
+  CallConventionAnalysis mCallConventions;
 };
 
 } // namespace cpp
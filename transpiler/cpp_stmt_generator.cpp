@@ -2,6 +2,8 @@
 
 #include "cpp_expr_environment_impl.h"
 #include "cpp_expr_generator.h"
+#include "decl.h"
+#include "line_directives.h"
 
 // for TypePrinter
 #include "cpp_generator_v2.h"
@@ -17,7 +19,7 @@ StmtGenerator::String() const
 void
 StmtGenerator::Visit(const AssignmentStmt& assignmentStmt)
 {
-  ExprEnvironmentImpl exprEnv(mModule);
+  ExprEnvironmentImpl exprEnv(mModule, mUniformExprs, mVaryingLiveness);
 
   ExprGenerator lExprGen(exprEnv);
   ExprGenerator rExprGen(exprEnv);
@@ -25,6 +27,8 @@ StmtGenerator::Visit(const AssignmentStmt& assignmentStmt)
   assignmentStmt.LValue().AcceptVisitor(lExprGen);
   assignmentStmt.RValue().AcceptVisitor(rExprGen);
 
+  LineDirective(assignmentStmt.GetLocation().begin);
+
   Indent() << lExprGen.String() << " = " << rExprGen.String() << ';'
            << std::endl;
 }
@@ -32,14 +36,53 @@ StmtGenerator::Visit(const AssignmentStmt& assignmentStmt)
 void
 StmtGenerator::Visit(const CompoundStmt& compoundStmt)
 {
+  auto location = compoundStmt.GetLocation();
+
+  LineDirective(location.begin);
+
   Indent() << '{' << std::endl;
 
   mIndentLevel++;
 
+  if (mProfileIndex) {
+    Indent() << "const profile::scope pathway_profile_scope("
+                "module_profile_counters, "
+             << *mProfileIndex << ");" << std::endl;
+  }
+
+  if (mRequirePrepared) {
+    Indent() << "PATHWAY_ASSERT(frame.prepared && \"the uniform data has to be "
+                "prepared\");"
+             << std::endl;
+  }
+
+  for (const auto* var : mLocals) {
+
+    LineDirective(var->GetNameLocation().begin);
+
+    TypePrinter typePrinter;
+
+    typePrinter.Visit(var->GetType());
+
+    Indent() << typePrinter.String() << ' ' << var->Identifier() << ';'
+             << std::endl;
+  }
+
+  // Only the outermost block of the function declares them.
+  mLocals.clear();
+
+  mProfileIndex.reset();
+
+  mRequirePrepared = false;
+
   compoundStmt.Recurse(*this);
 
   mIndentLevel--;
 
+  // The location ends after the closing brace.
+  LineDirective((location.end > location.begin) ? (location.end - 1)
+                                                : location.begin);
+
   Indent() << '}' << std::endl;
 }
 
@@ -52,11 +95,13 @@ StmtGenerator::Visit(const DeclStmt& declStmt)
 
   typePrinter.Visit(varDecl.GetType());
 
+  LineDirective(declStmt.GetLocation().begin);
+
   Indent() << typePrinter.String() << ' ' << varDecl.Identifier();
 
   if (varDecl.HasInitExpr()) {
 
-    ExprEnvironmentImpl exprEnv(mModule);
+    ExprEnvironmentImpl exprEnv(mModule, mUniformExprs, mVaryingLiveness);
 
     ExprGenerator exprGenerator(exprEnv);
 
@@ -71,9 +116,11 @@ StmtGenerator::Visit(const DeclStmt& declStmt)
 void
 StmtGenerator::Visit(const ReturnStmt& returnStmt)
 {
+  LineDirective(returnStmt.GetLocation().begin);
+
   Indent() << "return ";
 
-  ExprEnvironmentImpl exprEnv(mModule);
+  ExprEnvironmentImpl exprEnv(mModule, mUniformExprs, mVaryingLiveness);
 
   ExprGenerator exprGenerator(exprEnv);
 
@@ -82,6 +129,13 @@ StmtGenerator::Visit(const ReturnStmt& returnStmt)
   mStream << exprGenerator.String() << ';' << std::endl;
 }
 
+void
+StmtGenerator::LineDirective(uint32_t offset)
+{
+  if (mLineDirectives)
+    mLineDirectives->Write(mStream, offset);
+}
+
 std::ostream&
 StmtGenerator::Indent()
 {
@@ -2,21 +2,50 @@
 
 #include "stmt.h"
 
+#include <optional>
 #include <sstream>
+#include <vector>
 
+class LineDirectiveWriter;
 class Module;
+class UniformExprAnalysis;
+class VarDecl;
+class VaryingLivenessAnalysis;
 
 namespace cpp {
 
 class StmtGenerator final : public StmtVisitor
 {
 public:
-  StmtGenerator(const Module& module)
+  StmtGenerator(const Module& module,
+                const UniformExprAnalysis* uniformExprs = nullptr,
+                const VaryingLivenessAnalysis* varyingLiveness = nullptr,
+                const LineDirectiveWriter* lineDirectives = nullptr)
     : mModule(module)
+    , mUniformExprs(uniformExprs)
+    , mVaryingLiveness(varyingLiveness)
+    , mLineDirectives(lineDirectives)
   {}
 
   std::string String() const;
 
+  /// @brief Declares variables at the beginning of the function body, before
+  /// any of its statements.
+  void DeclareLocals(const std::vector<const VarDecl*>& vars)
+  {
+    mLocals = vars;
+  }
+
+  /// @brief Times the function body with the module's profile, before any of
+  /// its statements.
+  ///
+  /// @param funcIndex The index of the function in the profile.
+  void Instrument(size_t funcIndex) { mProfileIndex = funcIndex; }
+
+  /// @brief Asserts that the uniform data was prepared, before any of the
+  /// statements of the function body.
+  void RequirePrepared() { mRequirePrepared = true; }
+
   void Visit(const AssignmentStmt&) override;
   void Visit(const CompoundStmt&) override;
   void Visit(const DeclStmt&) override;
@@ -25,11 +54,27 @@ public:
 private:
   std::ostream& Indent();
 
+  /// @brief Attributes the lines that follow to the source line of an
+  /// offset, if line directives are enabled.
+  void LineDirective(uint32_t offset);
+
   std::ostringstream mStream;
 
   size_t mIndentLevel = 0;
 
   const Module& mModule;
+
+  const UniformExprAnalysis* mUniformExprs;
+
+  const VaryingLivenessAnalysis* mVaryingLiveness;
+
+  const LineDirectiveWriter* mLineDirectives;
+
+  std::vector<const VarDecl*> mLocals;
+
+  std::optional<size_t> mProfileIndex;
+
+  bool mRequirePrepared = false;
 };
 
 } // namespace cpp
@@ -3,7 +3,7 @@
 #include <sstream>
 
 void
-ModuleName::Append(std::string* identifier, const Location& location)
+ModuleName::Append(Symbol identifier, const Location& location)
 {
   mIdentifiers.emplace_back(identifier);
 
@@ -17,7 +17,7 @@ ModuleName::ToSingleIdentifier() const
 
   for (size_t i = 0; i < mIdentifiers.size(); i++) {
 
-    stream << *mIdentifiers[i];
+    stream << mIdentifiers[i];
 
     if ((i + 1) < mIdentifiers.size())
       stream << "_";
@@ -26,6 +26,15 @@ ModuleName::ToSingleIdentifier() const
   return stream.str();
 }
 
+Location
+ModuleName::GetLocation() const noexcept
+{
+  if (mLocations.empty())
+    return Location();
+
+  return Location{ mLocations.front().begin, mLocations.back().end };
+}
+
 bool
 VarDecl::IsVaryingGlobal() const
 {
@@ -38,140 +47,16 @@ VarDecl::IsUniformGlobal() const
   return mIsGlobal && mType->IsUniform();
 }
 
-namespace {
-
-class ExprGlobalStateReferenceChecker final : public ExprVisitor
-{
-public:
-  bool ReferencesFrameState() const noexcept { return mReferencesFrameState; }
-  bool ReferencesPixelState() const noexcept { return mReferencesPixelState; }
-
-  void Visit(const BoolLiteral&) override {}
-  void Visit(const IntLiteral&) override {}
-  void Visit(const FloatLiteral&) override {}
-
-  void Visit(const BinaryExpr& binaryExpr) override
-  {
-    binaryExpr.Recurse(*this);
-  }
-
-  void Visit(const FuncCall& funcCall) override
-  {
-    const auto& funcDecl = funcCall.GetFuncDecl();
-
-    if (funcDecl.ReferencesFrameState())
-      mReferencesFrameState = true;
-
-    if (funcDecl.ReferencesPixelState())
-      mReferencesPixelState = true;
-
-    funcCall.Recurse(*this);
-  }
-
-  void Visit(const UnaryExpr& unaryExpr) override { unaryExpr.Recurse(*this); }
-
-  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
-
-  void Visit(const VarRef& varRef) override
-  {
-    if (!varRef.HasResolvedVar())
-      return;
-
-    const auto& var = varRef.ResolvedVar();
-
-    if (!var.IsGlobal())
-      return;
-
-    switch (var.GetVariability()) {
-      case Variability::Unbound:
-      case Variability::Varying:
-        mReferencesPixelState |= true;
-        break;
-      case Variability::Uniform:
-        mReferencesFrameState |= true;
-        break;
-    }
-  }
-
-  void Visit(const TypeConstructor& typeConstructor) override
-  {
-    typeConstructor.Recurse(*this);
-  }
-
-  void Visit(const MemberExpr& memberExpr) override
-  {
-    memberExpr.Recurse(*this);
-  }
-
-private:
-  bool mReferencesFrameState = false;
-  bool mReferencesPixelState = false;
-};
-
-class StmtGlobalStateReferenceChecker final : public StmtVisitor
-{
-public:
-  bool ReferencesFrameState() const noexcept { return mReferencesFrameState; }
-
-  bool ReferencesPixelState() const noexcept { return mReferencesPixelState; }
-
-  void Visit(const AssignmentStmt& assignmentStmt) override
-  {
-    CheckExpr(assignmentStmt.LValue());
-    CheckExpr(assignmentStmt.RValue());
-  }
-
-  void Visit(const DeclStmt& declStmt) override
-  {
-    if (declStmt.GetVarDecl().HasInitExpr())
-      CheckExpr(declStmt.GetVarDecl().InitExpr());
-  }
-
-  void Visit(const ReturnStmt& returnStmt) override
-  {
-    CheckExpr(returnStmt.ReturnValue());
-  }
-
-  void Visit(const CompoundStmt& compoundStmt) override
-  {
-    compoundStmt.Recurse(*this);
-  }
-
-private:
-  void CheckExpr(const Expr& e)
-  {
-    ExprGlobalStateReferenceChecker checker;
-
-    e.AcceptVisitor(checker);
-
-    mReferencesFrameState |= checker.ReferencesFrameState();
-    mReferencesPixelState |= checker.ReferencesPixelState();
-  }
-
-  bool mReferencesFrameState = false;
-  bool mReferencesPixelState = false;
-};
-
-} // namespace
-
 bool
 FuncDecl::ReferencesFrameState() const
 {
-  StmtGlobalStateReferenceChecker checker;
-
-  this->mBody->AcceptVisitor(checker);
-
-  return checker.ReferencesFrameState();
+  return GetEffects().referencesFrameState;
 }
 
 bool
 FuncDecl::ReferencesPixelState() const
 {
-  StmtGlobalStateReferenceChecker checker;
-
-  this->mBody->AcceptVisitor(checker);
-
-  return checker.ReferencesPixelState();
+  return GetEffects().referencesPixelState;
 }
 
 bool
@@ -250,3 +135,14 @@ FuncDecl::GetMangledName() const
 
   return nameStream.str();
 }
+
+const FuncEffects&
+FuncDecl::GetEffects() const
+{
+  if (!mEffects) {
+    ABORT("The effects of function '", Identifier(), "' were accessed before ",
+          "being analyzed.");
+  }
+
+  return *mEffects;
+}
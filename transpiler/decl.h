@@ -4,10 +4,12 @@
 #include "decl_name.h"
 #include "expr.h"
 #include "location.h"
+#include "node_pool.h"
 #include "stmt.h"
 #include "type.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -49,6 +51,8 @@ public:
 class Decl
 {
 public:
+  PATHWAY_POOL_ALLOCATED
+
   virtual ~Decl() = default;
 
   virtual void AcceptVisitor(DeclVisitor&) const = 0;
@@ -63,18 +67,21 @@ using DeclList = std::vector<UniqueDeclPtr>;
 class ModuleName final
 {
 public:
-  void Append(std::string* identifier, const Location& location);
+  void Append(Symbol identifier, const Location& location);
 
   std::string ToSingleIdentifier() const;
 
-  auto Identifiers() const noexcept
-    -> const std::vector<std::unique_ptr<std::string>>&
+  /// @brief Gets the location of the whole name, from the first identifier to
+  /// the last one.
+  Location GetLocation() const noexcept;
+
+  auto Identifiers() const noexcept -> const std::vector<Symbol>&
   {
     return mIdentifiers;
   }
 
 private:
-  std::vector<std::unique_ptr<std::string>> mIdentifiers;
+  std::vector<Symbol> mIdentifiers;
 
   std::vector<Location> mLocations;
 };
@@ -122,10 +129,6 @@ public:
 
   void AcceptMutator(DeclMutator& mutator) override { mutator.Mutate(*this); }
 
-  const DeclList& Body() const noexcept { return *mBody; }
-
-  bool HasBody() const noexcept { return !mBody; }
-
   const ModuleName& GetModuleName() const noexcept
   {
     if (!mName) {
@@ -137,12 +140,19 @@ public:
 
 private:
   std::unique_ptr<ModuleName> mName;
-
-  std::unique_ptr<DeclList> mBody;
 };
 
 using ParamList = std::vector<std::unique_ptr<VarDecl>>;
 
+/// @brief The global state that a function refers to, either directly or
+/// through the functions it calls.
+struct FuncEffects final
+{
+  bool referencesFrameState = false;
+
+  bool referencesPixelState = false;
+};
+
 class FuncDecl final : public Decl
 {
 public:
@@ -166,6 +176,8 @@ public:
 
   bool HasName(const std::string& name) const { return Identifier() == name; }
 
+  Symbol GetSymbol() const noexcept { return mName.GetSymbol(); }
+
   const Type& ReturnType() const noexcept { return *mReturnType; }
 
   const ParamList& GetParamList() const noexcept { return *mParamList; }
@@ -184,12 +196,16 @@ public:
     mBody->AcceptVisitor(visitor);
   }
 
+  /// @note The global state queries are only valid once the effects of the
+  /// function have been analyzed, see @ref AnalyzeEffects.
   bool ReferencesGlobalState() const;
 
   bool ReferencesFrameState() const;
 
   bool ReferencesPixelState() const;
 
+  void SetEffects(const FuncEffects& effects) { mEffects = effects; }
+
   bool IsEntryPoint() const;
 
   bool IsPixelSampler() const;
@@ -204,6 +220,10 @@ private:
   std::unique_ptr<ParamList> mParamList;
 
   std::unique_ptr<Stmt> mBody;
+
+  std::optional<FuncEffects> mEffects;
+
+  const FuncEffects& GetEffects() const;
 };
 
 class VarDecl final : public Decl
@@ -233,7 +253,9 @@ public:
 
   TypeID GetTypeID() const noexcept { return mType->ID(); }
 
-  std::string Identifier() const { return mName.Identifier(); }
+  const std::string& Identifier() const noexcept { return mName.Identifier(); }
+
+  Symbol GetSymbol() const noexcept { return mName.GetSymbol(); }
 
   bool HasIdentifier(const std::string& str) const
   {
@@ -252,6 +274,8 @@ public:
 
   UniqueExprPtr TakeInitExpr() { return std::move(mInitExpr); }
 
+  void SetInitExpr(UniqueExprPtr initExpr) { mInitExpr = std::move(initExpr); }
+
   const Expr& InitExpr() const noexcept { return *mInitExpr; }
 
   Expr& InitExpr() noexcept { return *mInitExpr; }
@@ -1,24 +1,26 @@
 #pragma once
 
 #include "location.h"
+#include "symbol.h"
 
-#include <memory>
 #include <string>
 
 class DeclName final
 {
 public:
-  DeclName(std::string* identifier, const Location& location)
-    : mIdentifier(identifier)
+  DeclName(Symbol symbol, const Location& location)
+    : mSymbol(symbol)
     , mLocation(location)
   {}
 
-  const std::string& Identifier() const noexcept { return *mIdentifier; }
+  const std::string& Identifier() const noexcept { return mSymbol.Name(); }
+
+  Symbol GetSymbol() const noexcept { return mSymbol; }
 
   const Location& GetLocation() const noexcept { return mLocation; }
 
 private:
-  std::unique_ptr<std::string> mIdentifier;
+  Symbol mSymbol;
 
   Location mLocation;
 };
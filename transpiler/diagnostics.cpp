@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "abort.h"
+#include "line_table.h"
 
 #ifdef __unix__
 #include <unistd.h>
@@ -32,6 +33,8 @@ GetSeverity(DiagID diagID) noexcept
     case DiagID::SyntaxError:
     case DiagID::UnresolvedFuncCall:
     case DiagID::UnresolvedVarRef:
+    case DiagID::UnresolvedModuleImport:
+    case DiagID::InvalidModuleInterface:
     case DiagID::DuplicateDecl:
       return Severity::Error;
     case DiagID::OriginalDecl:
@@ -101,13 +104,15 @@ public:
       return;
     }
 
-    auto [path, data] = mFileStack.back();
+    auto& file = mFileStack.back();
 
-    auto loc = diag.GetLocation();
+    const auto& lineTable = file.GetLineTable();
+
+    auto loc = lineTable.Expand(diag.GetLocation());
 
     BeginBoldWhite();
 
-    mStream << path << ':' << diag.GetLocation() << ": ";
+    mStream << file.path << ':' << loc << ": ";
 
     ResetAttribs();
 
@@ -123,9 +128,9 @@ public:
 
     for (size_t line = loc.first_line; line <= loc.last_line; line++) {
 
-      auto lineView = GetLineView(line, data);
+      auto lineView = lineTable.GetLineView(line);
 
-      auto clippedLoc = GetClippedLocation(line, data, loc);
+      auto clippedLoc = GetClippedLocation(line, lineView, loc);
 
       auto indent = AsIndent(clippedLoc.index, lineView);
 
@@ -210,7 +215,32 @@ private:
       mStream << "\x1b[0m";
   }
 
-  std::vector<std::pair<std::string, std::string_view>> mFileStack;
+  /// @brief A file that diagnostics may be observed for.
+  struct File final
+  {
+    File(const std::string& path_, std::string_view data_)
+      : path(path_)
+      , data(data_)
+    {}
+
+    /// @brief Gets the line table of the file, making it the first time a
+    /// diagnostic is observed for the file.
+    const LineTable& GetLineTable()
+    {
+      if (!lineTable)
+        lineTable.emplace(data);
+
+      return *lineTable;
+    }
+
+    std::string path;
+
+    std::string_view data;
+
+    std::optional<LineTable> lineTable;
+  };
+
+  std::vector<File> mFileStack;
 
   std::ostream& mStream;
 
@@ -228,42 +258,16 @@ ConsoleDiagObserver::Make(std::ostream& outStream)
 }
 
 auto
-ConsoleDiagObserver::GetLineView(size_t line, std::string_view data) noexcept
+ConsoleDiagObserver::GetLineView(size_t line, std::string_view data)
   -> std::string_view
 {
-  size_t lineStart = 0;
-
-  size_t currentLine = 1;
-
-  for (size_t i = 0; (i < data.size()) && (currentLine != line); i++) {
-
-    if (data[i] == '\n') {
-
-      lineStart = i + 1;
-
-      currentLine++;
-    }
-  }
-
-  if (currentLine != line)
-    return std::string_view();
-
-  size_t length = data.size() - lineStart;
-
-  for (size_t i = lineStart; i < data.size(); i++) {
-    if ((data[i] == '\r') || (data[i] == '\n')) {
-      length = i - lineStart;
-      break;
-    }
-  }
-
-  return data.substr(lineStart, length);
+  return LineTable(data).GetLineView(line);
 }
 
 auto
 ConsoleDiagObserver::GetClippedLocation(size_t line,
                                         std::string_view data,
-                                        const Location& loc) noexcept
+                                        const LineColumnRange& loc) noexcept
   -> ClippedLineRange
 {
   if ((line < loc.first_line) || (line > loc.last_line))
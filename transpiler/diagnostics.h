@@ -13,6 +13,8 @@ enum class DiagID
   SyntaxError,
   UnresolvedFuncCall,
   UnresolvedVarRef,
+  UnresolvedModuleImport,
+  InvalidModuleInterface,
   DuplicateDecl,
   OriginalDecl
 };
@@ -30,8 +32,6 @@ ToStringView(Severity severity) noexcept;
 Severity
 GetSeverity(DiagID diagID) noexcept;
 
-class Location;
-
 class Diag final
 {
 public:
@@ -86,13 +86,14 @@ public:
   // These methods are only exposed for testing.
 
   /// @brief Gets a view of the entire line in a source file.
-  static auto GetLineView(size_t line, std::string_view data) noexcept
+  static auto GetLineView(size_t line, std::string_view data)
     -> std::string_view;
 
   /// @brief Gets the range of a location, clipped to a single line.
   static auto GetClippedLocation(size_t line,
                                  std::string_view lineData,
-                                 const Location&) noexcept -> ClippedLineRange;
+                                 const LineColumnRange&) noexcept
+    -> ClippedLineRange;
 };
 
 class DiagErrorFilter final
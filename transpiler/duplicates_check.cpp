@@ -5,14 +5,16 @@
 #include "module.h"
 
 #include <map>
+#include <unordered_map>
 
 namespace {
 
 using Duplicate = DuplicatesCheck::Duplicate;
 
-using Scope = std::map<std::string, Location>;
+using Scope = std::unordered_map<Symbol, Location>;
 
-using SymbolTable = std::vector<Scope>;
+/// @brief Maps mangled function names to their declarations.
+using MangledScope = std::map<std::string, Location>;
 
 class GlobalDuplicatesChecker final : public DeclVisitor
 {
@@ -23,7 +25,7 @@ public:
 
   void Visit(const FuncDecl& funcDecl) override
   {
-    auto existingVar = mScope.find(funcDecl.Identifier());
+    auto existingVar = mScope.find(funcDecl.GetSymbol());
 
     if (existingVar != mScope.end()) {
       EmitDuplicate(existingVar->second, funcDecl.GetNameLocation());
@@ -39,7 +41,7 @@ public:
       return;
     }
 
-    mFuncScopeUnmangled.emplace(funcDecl.Identifier(),
+    mFuncScopeUnmangled.emplace(funcDecl.GetSymbol(),
                                 funcDecl.GetNameLocation());
 
     mFuncScope.emplace(mangledName, funcDecl.GetNameLocation());
@@ -47,21 +49,21 @@ public:
 
   void Visit(const VarDecl& varDecl) override
   {
-    auto existingFunc = mFuncScopeUnmangled.find(varDecl.Identifier());
+    auto existingFunc = mFuncScopeUnmangled.find(varDecl.GetSymbol());
 
     if (existingFunc != mFuncScopeUnmangled.end()) {
       EmitDuplicate(existingFunc->second, varDecl.GetNameLocation());
       return;
     }
 
-    auto existing = mScope.find(varDecl.Identifier());
+    auto existing = mScope.find(varDecl.GetSymbol());
 
     if (existing != mScope.end()) {
       EmitDuplicate(existing->second, varDecl.GetNameLocation());
       return;
     }
 
-    mScope.emplace(varDecl.Identifier(), varDecl.GetNameLocation());
+    mScope.emplace(varDecl.GetSymbol(), varDecl.GetNameLocation());
   }
 
   void Visit(const ModuleImportDecl&) override {}
@@ -79,7 +81,7 @@ private:
   /// @brief Contains variables and module names.
   Scope mScope;
 
-  Scope mFuncScope;
+  MangledScope mFuncScope;
 
   Scope mFuncScopeUnmangled;
 
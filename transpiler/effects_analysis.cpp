@@ -0,0 +1,233 @@
+#include "effects_analysis.h"
+
+#include "decl.h"
+#include "flat_tree.h"
+#include "module.h"
+
+#include <map>
+#include <vector>
+
+namespace {
+
+/// @brief The effects a function has on its own, and the functions it calls.
+struct DirectEffects final
+{
+  FuncEffects effects;
+
+  std::vector<const FuncDecl*> callees;
+};
+
+class ExprGlobalStateReferenceChecker final : public ExprVisitor
+{
+public:
+  ExprGlobalStateReferenceChecker(DirectEffects& directEffects)
+    : mDirectEffects(directEffects)
+  {}
+
+  void Visit(const BoolLiteral&) override {}
+  void Visit(const IntLiteral&) override {}
+  void Visit(const FloatLiteral&) override {}
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    binaryExpr.Recurse(*this);
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    if (funcCall.Resolved() && !funcCall.IsBuiltin())
+      mDirectEffects.callees.emplace_back(&funcCall.GetFuncDecl());
+
+    funcCall.Recurse(*this);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override { unaryExpr.Recurse(*this); }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef& varRef) override
+  {
+    if (!varRef.HasResolvedVar())
+      return;
+
+    const auto& var = varRef.ResolvedVar();
+
+    if (!var.IsGlobal())
+      return;
+
+    switch (var.GetVariability()) {
+      case Variability::Unbound:
+      case Variability::Varying:
+        mDirectEffects.effects.referencesPixelState = true;
+        break;
+      case Variability::Uniform:
+        mDirectEffects.effects.referencesFrameState = true;
+        break;
+    }
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    memberExpr.Recurse(*this);
+  }
+
+private:
+  DirectEffects& mDirectEffects;
+};
+
+class StmtGlobalStateReferenceChecker final : public StmtVisitor
+{
+public:
+  StmtGlobalStateReferenceChecker(DirectEffects& directEffects)
+    : mExprChecker(directEffects)
+  {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    assignmentStmt.LValue().AcceptVisitor(mExprChecker);
+    assignmentStmt.RValue().AcceptVisitor(mExprChecker);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    if (declStmt.GetVarDecl().HasInitExpr())
+      declStmt.GetVarDecl().InitExpr().AcceptVisitor(mExprChecker);
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    returnStmt.ReturnValue().AcceptVisitor(mExprChecker);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+private:
+  ExprGlobalStateReferenceChecker mExprChecker;
+};
+
+/// @brief Adds the effects of a callee to those of a caller.
+///
+/// @return Whether the effects of the caller changed.
+bool
+Merge(FuncEffects& caller, const FuncEffects& callee)
+{
+  auto changed =
+    (callee.referencesFrameState && !caller.referencesFrameState) ||
+    (callee.referencesPixelState && !caller.referencesPixelState);
+
+  caller.referencesFrameState |= callee.referencesFrameState;
+
+  caller.referencesPixelState |= callee.referencesPixelState;
+
+  return changed;
+}
+
+} // namespace
+
+void
+AnalyzeEffects(Module& module)
+{
+  std::map<const FuncDecl*, DirectEffects> directEffectsMap;
+
+  std::map<const FuncDecl*, std::vector<const FuncDecl*>> callersMap;
+
+  for (const auto& func : module.Funcs()) {
+
+    auto& directEffects = directEffectsMap[func.get()];
+
+    StmtGlobalStateReferenceChecker checker(directEffects);
+
+    func->AcceptBodyVisitor(checker);
+
+    for (const auto* callee : directEffects.callees)
+      callersMap[callee].emplace_back(func.get());
+  }
+
+  // Each function's effects can only change twice, once for each kind of
+  // state, so this visits each call a bounded number of times.
+  std::vector<const FuncDecl*> pending;
+
+  for (const auto& func : module.Funcs())
+    pending.emplace_back(func.get());
+
+  while (!pending.empty()) {
+
+    const auto* callee = pending.back();
+
+    pending.pop_back();
+
+    const auto& calleeEffects = directEffectsMap[callee].effects;
+
+    for (const auto* caller : callersMap[callee]) {
+      if (Merge(directEffectsMap[caller].effects, calleeEffects))
+        pending.emplace_back(caller);
+    }
+  }
+
+  for (auto& func : module.Funcs())
+    func->SetEffects(directEffectsMap[func.get()].effects);
+}
+
+auto
+AnalyzeEffects(const flat::Tree& tree) -> std::vector<FuncEffects>
+{
+  std::vector<FuncEffects> effects(tree.funcs.size());
+
+  for (const auto& varRef : tree.varRefs) {
+
+    if ((varRef.func == flat::gNoIndex) || (varRef.var == flat::gNoIndex))
+      continue;
+
+    const auto& var = tree.vars[varRef.var];
+
+    if (!var.isGlobal)
+      continue;
+
+    switch (var.variability) {
+      case Variability::Unbound:
+      case Variability::Varying:
+        effects[varRef.func].referencesPixelState = true;
+        break;
+      case Variability::Uniform:
+        effects[varRef.func].referencesFrameState = true;
+        break;
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> callers(tree.funcs.size());
+
+  for (const auto& funcCall : tree.funcCalls) {
+    if ((funcCall.callee != flat::gNoIndex) &&
+        (funcCall.caller != flat::gNoIndex))
+      callers[funcCall.callee].emplace_back(funcCall.caller);
+  }
+
+  // Like the analysis of a module, each function's effects can only change
+  // twice, so this visits each call a bounded number of times.
+  std::vector<uint32_t> pending;
+
+  for (uint32_t i = 0; i < tree.funcs.size(); i++)
+    pending.emplace_back(i);
+
+  while (!pending.empty()) {
+
+    auto callee = pending.back();
+
+    pending.pop_back();
+
+    for (auto caller : callers[callee]) {
+      if (Merge(effects[caller], effects[callee]))
+        pending.emplace_back(caller);
+    }
+  }
+
+  return effects;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "decl.h"
+
+#include <vector>
+
+class Module;
+
+namespace flat {
+struct Tree;
+} // namespace flat
+
+/// @brief Finds the global state that each function refers to, and stores it
+/// on the function declaration.
+///
+/// @detail A function refers to the global state that it uses directly, as
+/// well as the state used by any function it calls. The bodies are only walked
+/// once. The effects are then propagated from callees to callers until
+/// nothing changes, which also handles recursive calls.
+///
+/// @note This should be called after the module has been resolved. Calls
+/// that were not resolved to a single function are ignored.
+void
+AnalyzeEffects(Module& module);
+
+/// @brief Finds the global state that each function of a flat tree refers
+/// to, the same way as the analysis of a module.
+///
+/// @detail Instead of walking each body, this scans the pool of variable
+/// references and the pool of calls once, since each of them knows the
+/// function it's in.
+///
+/// @return The effects of each function, in the order of the tree's pool of
+/// functions.
+auto
+AnalyzeEffects(const flat::Tree& tree) -> std::vector<FuncEffects>;
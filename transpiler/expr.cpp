@@ -2,8 +2,10 @@
 
 #include "decl.h"
 
+#include <array>
+
 auto
-VarRef::GetType() const -> std::optional<Type>
+VarRef::ComputeType() const -> std::optional<Type>
 {
   if (!mResolvedVar)
     return {};
@@ -94,7 +96,7 @@ get_int_vector_member_type(const std::string& pattern, size_t vecSize)
 } // namespace
 
 auto
-MemberExpr::GetType() const -> std::optional<Type>
+MemberExpr::ComputeType() const -> std::optional<Type>
 {
   auto baseType = mBaseExpr->GetType();
   if (!baseType)
@@ -177,7 +179,7 @@ const std::array<CommonTypeInfo, 11> gCommonTypeTable{
 } // namespace
 
 auto
-BinaryExpr::GetType() const -> std::optional<Type>
+BinaryExpr::ComputeType() const -> std::optional<Type>
 {
   auto leftType = mLeftExpr->GetType();
 
@@ -186,20 +188,28 @@ BinaryExpr::GetType() const -> std::optional<Type>
   if (!leftType || !rightType)
     return {};
 
-  if (leftType == rightType)
-    return leftType;
+  auto variability = CommonVariability(leftType->GetVariability(),
+                                       rightType->GetVariability());
+
+  if (leftType->ID() == rightType->ID())
+    return Type(leftType->ID(), variability);
 
   for (const auto& commonTypeEntry : gCommonTypeTable) {
     if (commonTypeEntry.Match(leftType->ID(), rightType->ID()))
-      return Type(commonTypeEntry.CommonType());
+      return Type(commonTypeEntry.CommonType(), variability);
   }
 
   return {};
 }
 
 auto
-FuncCall::GetType() const -> std::optional<Type>
+FuncCall::ComputeType() const -> std::optional<Type>
 {
+  // Builtins are generic over floats and float vectors, so their return type
+  // is that of their first argument.
+  if (IsBuiltin())
+    return mArgs->empty() ? std::optional<Type>() : mArgs->at(0)->GetType();
+
   if (mResolvedFuncs.size() != 1)
     return {};
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "builtins.h"
 #include "decl_name.h"
+#include "node_pool.h"
 #include "type.h"
 
 #include <limits>
@@ -83,6 +85,8 @@ public:
 class Expr
 {
 public:
+  PATHWAY_POOL_ALLOCATED
+
   Expr(const Location& location)
     : mLocation(location)
   {}
@@ -93,12 +97,36 @@ public:
 
   virtual void AcceptVisitor(ExprVisitor& v) const = 0;
 
-  virtual auto GetType() const -> std::optional<Type> = 0;
+  /// @brief Gets the type of the expression.
+  ///
+  /// @detail Once the module has been annotated with @ref AnnotateTypes, this
+  /// reads the stored type. Otherwise, the type is computed from the types of
+  /// the subexpressions.
+  auto GetType() const -> std::optional<Type>
+  {
+    return mTypeAnnotated ? mType : ComputeType();
+  }
+
+  /// @brief Computes the type of the expression and stores it, so that it
+  /// doesn't have to be computed again. The subexpressions should be annotated
+  /// first.
+  void AnnotateType()
+  {
+    mType = ComputeType();
+    mTypeAnnotated = true;
+  }
 
   Location GetLocation() const noexcept { return mLocation; }
 
+protected:
+  virtual auto ComputeType() const -> std::optional<Type> = 0;
+
 private:
   Location mLocation;
+
+  std::optional<Type> mType;
+
+  bool mTypeAnnotated = false;
 };
 
 using UniqueExprPtr = std::unique_ptr<Expr>;
@@ -120,7 +148,7 @@ public:
 
   void AcceptVisitor(ExprVisitor& v) const override { v.Visit(*this); }
 
-  auto GetType() const -> std::optional<Type> override
+  auto ComputeType() const -> std::optional<Type> override
   {
     return Type(TypeID::Int);
   }
@@ -146,7 +174,7 @@ public:
     mutator.Mutate(*this);
   }
 
-  auto GetType() const -> std::optional<Type> override
+  auto ComputeType() const -> std::optional<Type> override
   {
     return Type(TypeID::Bool);
   }
@@ -182,7 +210,7 @@ public:
 
   void AcceptVisitor(ExprVisitor& v) const override { v.Visit(*this); }
 
-  auto GetType() const -> std::optional<Type> override
+  auto ComputeType() const -> std::optional<Type> override
   {
     return Type(TypeID::Float);
   }
@@ -198,7 +226,7 @@ class VarRef final : public Expr
 public:
   VarRef(const std::string& name, const Location& location)
     : Expr(location)
-    , mName(DeclName(new std::string(name), location))
+    , mName(DeclName(Symbol::Intern(name), location))
   {}
 
   VarRef(DeclName&& n)
@@ -223,9 +251,11 @@ public:
 
   const std::string& Identifier() const noexcept { return mName.Identifier(); }
 
+  Symbol GetSymbol() const noexcept { return mName.GetSymbol(); }
+
   void Resolve(const VarDecl* v) { mResolvedVar = v; }
 
-  auto GetType() const -> std::optional<Type> override;
+  auto ComputeType() const -> std::optional<Type> override;
 
 private:
   DeclName mName;
@@ -248,7 +278,9 @@ public:
     mutator.Mutate(*this);
   }
 
-  auto GetType() const -> std::optional<Type> override
+  const Expr& InnerExpr() const noexcept { return *mInnerExpr; }
+
+  auto ComputeType() const -> std::optional<Type> override
   {
     return mInnerExpr->GetType();
   }
@@ -263,6 +295,14 @@ public:
     mInnerExpr->AcceptVisitor(Visitor);
   }
 
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    mInnerExpr = function(std::move(mInnerExpr));
+  }
+
 private:
   UniqueExprPtr mInnerExpr;
 };
@@ -304,9 +344,17 @@ public:
     mBaseExpr->AcceptVisitor(Visitor);
   }
 
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    mBaseExpr = function(std::move(mBaseExpr));
+  }
+
   Kind GetKind() const noexcept { return mKind; }
 
-  auto GetType() const -> std::optional<Type> override
+  auto ComputeType() const -> std::optional<Type> override
   {
     return mBaseExpr->GetType();
   }
@@ -357,7 +405,17 @@ public:
     mRightExpr->AcceptVisitor(Visitor);
   }
 
-  auto GetType() const -> std::optional<Type> override;
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    mLeftExpr = function(std::move(mLeftExpr));
+
+    mRightExpr = function(std::move(mRightExpr));
+  }
+
+  auto ComputeType() const -> std::optional<Type> override;
 
   const Expr& LeftExpr() const noexcept { return *mLeftExpr; }
 
@@ -367,6 +425,10 @@ public:
 
   Expr& RightExpr() noexcept { return *mRightExpr; }
 
+  UniqueExprPtr TakeLeftExpr() { return std::move(mLeftExpr); }
+
+  UniqueExprPtr TakeRightExpr() { return std::move(mRightExpr); }
+
   Kind GetKind() const noexcept { return mKind; }
 
 private:
@@ -402,15 +464,24 @@ public:
 
   const std::string& Identifier() const { return mName.Identifier(); }
 
+  Symbol GetSymbol() const noexcept { return mName.GetSymbol(); }
+
+  /// @note Only valid if the call is not a call to a builtin function.
   const FuncDecl& GetFuncDecl() const { return *mResolvedFuncs.at(0); }
 
-  auto GetType() const -> std::optional<Type> override;
+  auto ComputeType() const -> std::optional<Type> override;
 
   void QueueNameMatches(std::vector<const FuncDecl*> matches)
   {
     mResolvedFuncs = std::move(matches);
   }
 
+  void ResolveBuiltin(BuiltinID builtinID) { mBuiltinID = builtinID; }
+
+  bool IsBuiltin() const noexcept { return mBuiltinID.has_value(); }
+
+  BuiltinID GetBuiltinID() const { return mBuiltinID.value(); }
+
   void Recurse(ExprVisitor& visitor) const
   {
     for (const auto& arg : *mArgs)
@@ -423,7 +494,19 @@ public:
       arg->AcceptMutator(mutator);
   }
 
-  bool Resolved() const { return mResolvedFuncs.size() == 1; }
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    for (auto& arg : *mArgs)
+      arg = function(std::move(arg));
+  }
+
+  bool Resolved() const
+  {
+    return IsBuiltin() || (mResolvedFuncs.size() == 1);
+  }
 
   Location GetNameLocation() const noexcept { return mName.GetLocation(); }
 
@@ -433,6 +516,8 @@ private:
   /// Only one of these are going to be right, which isn't known until type
   /// coercion.
   std::vector<const FuncDecl*> mResolvedFuncs;
+
+  std::optional<BuiltinID> mBuiltinID;
 };
 
 class TypeConstructor final : public Expr
@@ -455,7 +540,7 @@ public:
 
   ExprList& Args() noexcept { return *mArgs; }
 
-  auto GetType() const -> std::optional<Type> override { return mType; }
+  auto ComputeType() const -> std::optional<Type> override { return mType; }
 
   void Recurse(const ExprMutator& mutator)
   {
@@ -469,6 +554,15 @@ public:
       argExpr->AcceptVisitor(Visitor);
   }
 
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    for (auto& argExpr : *mArgs)
+      argExpr = function(std::move(argExpr));
+  }
+
 private:
   Type mType;
 
@@ -512,7 +606,7 @@ public:
 
   const Expr& BaseExpr() const noexcept { return *mBaseExpr; }
 
-  auto GetType() const -> std::optional<Type> override;
+  auto ComputeType() const -> std::optional<Type> override;
 
   const DeclName& MemberName() const noexcept { return mMemberName; }
 
@@ -526,6 +620,14 @@ public:
     mBaseExpr->AcceptVisitor(Visitor);
   }
 
+  /// @brief Replaces each child expression with the one returned by a
+  /// function, which is given ownership of the original.
+  template<typename Function>
+  void TransformChildren(Function function)
+  {
+    mBaseExpr = function(std::move(mBaseExpr));
+  }
+
 private:
   UniqueExprPtr mBaseExpr;
 
@@ -0,0 +1,155 @@
+#include "file_watcher.h"
+
+#include <errno.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+/// @brief How long to wait for more changes after the first one, in
+/// milliseconds.
+constexpr int gSettleTime = 50;
+
+/// @brief Reads the pending events of an inotify instance.
+///
+/// @return The number of events about the watched files, or -1 on error.
+int
+ReadEvents(int fd, const std::map<int, std::set<std::string>>& fileNames)
+{
+  alignas(inotify_event) char buffer[4096];
+
+  auto size = read(fd, buffer, sizeof(buffer));
+
+  if (size < 0)
+    return -1;
+
+  int count = 0;
+
+  for (ssize_t offset = 0; offset < size;) {
+
+    const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+
+    auto it = fileNames.find(event->wd);
+
+    if ((event->len > 0) && (it != fileNames.end()) &&
+        (it->second.count(event->name) > 0))
+      count++;
+
+    offset += sizeof(inotify_event) + event->len;
+  }
+
+  return count;
+}
+
+} // namespace
+
+auto
+FileWatcher::Make(const std::set<std::string>& paths)
+  -> std::unique_ptr<FileWatcher>
+{
+  std::unique_ptr<FileWatcher> watcher(new FileWatcher());
+
+  watcher->mPaths = paths;
+
+  watcher->mFd = inotify_init1(IN_CLOEXEC);
+
+  if (watcher->mFd == -1)
+    return nullptr;
+
+  for (const auto& path : paths) {
+
+    std::string directory(".");
+
+    std::string fileName(path);
+
+    auto slash = path.rfind('/');
+
+    if (slash != std::string::npos) {
+      directory = (slash == 0) ? "/" : path.substr(0, slash);
+      fileName = path.substr(slash + 1);
+    }
+
+    // Watching a directory again gives the descriptor of the first watch.
+    auto wd = inotify_add_watch(
+      watcher->mFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (wd == -1) {
+      if (errno == ENOENT)
+        continue;
+      return nullptr;
+    }
+
+    watcher->mFileNames[wd].emplace(fileName);
+  }
+
+  return watcher;
+}
+
+FileWatcher::~FileWatcher()
+{
+  if (mFd != -1)
+    close(mFd);
+}
+
+bool
+FileWatcher::Wait()
+{
+  for (;;) {
+
+    auto count = ReadEvents(mFd, mFileNames);
+
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    if (count > 0)
+      break;
+  }
+
+  pollfd pollFd{ mFd, POLLIN, 0 };
+
+  for (;;) {
+
+    auto ready = poll(&pollFd, 1, gSettleTime);
+
+    if (ready == 0)
+      return true;
+
+    if (ready < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    if ((ReadEvents(mFd, mFileNames) < 0) && (errno != EINTR))
+      return false;
+  }
+}
+
+#else // __linux__
+
+auto
+FileWatcher::Make(const std::set<std::string>&) -> std::unique_ptr<FileWatcher>
+{
+  errno = ENOSYS;
+  return nullptr;
+}
+
+FileWatcher::~FileWatcher() = default;
+
+bool
+FileWatcher::Wait()
+{
+  errno = ENOSYS;
+  return false;
+}
+
+#endif // __linux__
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+/// @brief Waits for any of a set of files to be changed.
+///
+/// @detail The directory of each file is watched instead of the file itself,
+/// since many editors save a file by writing a new one and renaming it over
+/// the original, which would end a watch on the original file. This also
+/// makes files that don't exist yet trigger a change once they're created.
+///
+/// @note This is only implemented on Linux, where it uses inotify.
+class FileWatcher final
+{
+public:
+  /// @brief Starts watching some files. Files in directories that don't
+  /// exist are ignored.
+  ///
+  /// @return Null if the files can't be watched, in which case errno
+  /// describes why.
+  static auto Make(const std::set<std::string>& paths)
+    -> std::unique_ptr<FileWatcher>;
+
+  FileWatcher(const FileWatcher&) = delete;
+
+  ~FileWatcher();
+
+  /// @brief Blocks until one of the files has been written or replaced.
+  ///
+  /// @detail Saving a file often takes more than one write, so changes that
+  /// come shortly after the first one are waited for as well, and are all
+  /// reported as one change.
+  ///
+  /// @return False if the watch failed, in which case errno describes why.
+  bool Wait();
+
+  /// @brief Gets the paths of the files that were given to @ref Make.
+  const std::set<std::string>& GetPaths() const noexcept { return mPaths; }
+
+private:
+  FileWatcher() = default;
+
+  int mFd = -1;
+
+  std::set<std::string> mPaths;
+
+  /// @brief The names of the files within each watched directory, by the
+  /// descriptor of its watch.
+  std::map<int, std::set<std::string>> mFileNames;
+};
@@ -0,0 +1,394 @@
+#include "flat_tree.h"
+
+#include "abort.h"
+#include "decl.h"
+#include "module.h"
+#include "stmt.h"
+
+#include <unordered_map>
+
+namespace flat {
+
+namespace {
+
+template<typename Node>
+uint32_t
+Append(std::vector<Node>& pool, const Node& node)
+{
+  if (pool.size() > ExprRef::gMaxIndex)
+    ABORT("Too many nodes of one kind for a flat tree.");
+
+  pool.emplace_back(node);
+
+  return uint32_t(pool.size() - 1);
+}
+
+template<typename Node>
+void
+VisitPool(const std::vector<Node>& pool, PoolVisitor& visitor)
+{
+  for (uint32_t i = 0; i < pool.size(); i++)
+    visitor.Visit(pool[i], i);
+}
+
+class Flattener final
+  : public ExprVisitor
+  , public StmtVisitor
+{
+public:
+  explicit Flattener(Tree& tree)
+    : mTree(tree)
+  {}
+
+  void AddFunc(const ::FuncDecl& funcDecl)
+  {
+    mFuncIndices.emplace(&funcDecl, uint32_t(mFuncIndices.size()));
+  }
+
+  void AddGlobalVar(const ::VarDecl& varDecl) { GetVarIndex(varDecl); }
+
+  void FlattenGlobalVar(const ::VarDecl& varDecl)
+  {
+    mCurrentFunc = gNoIndex;
+
+    FlattenVar(varDecl);
+  }
+
+  void FlattenFunc(const ::FuncDecl& funcDecl)
+  {
+    mCurrentFunc = mFuncIndices.at(&funcDecl);
+
+    FuncDecl func;
+
+    func.name = funcDecl.GetSymbol();
+
+    func.returnType = funcDecl.ReturnType().ID();
+
+    func.params.first = uint32_t(mTree.vars.size());
+
+    for (const auto& param : funcDecl.GetParamList())
+      FlattenVar(*param);
+
+    func.params.count = uint32_t(mTree.vars.size()) - func.params.first;
+
+    func.body = FlattenStmt(funcDecl.Body());
+
+    func.nameLocation = funcDecl.GetNameLocation();
+
+    Append(mTree.funcs, func);
+  }
+
+  void Visit(const ::IntLiteral& intLiteral) override
+  {
+    auto index =
+      Append(mTree.intLiterals,
+             IntLiteral{ intLiteral.Value(), intLiteral.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::IntLiteral, index);
+  }
+
+  void Visit(const ::BoolLiteral& boolLiteral) override
+  {
+    auto index =
+      Append(mTree.boolLiterals,
+             BoolLiteral{ boolLiteral.Value(), boolLiteral.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::BoolLiteral, index);
+  }
+
+  void Visit(const ::FloatLiteral& floatLiteral) override
+  {
+    auto index =
+      Append(mTree.floatLiterals,
+             FloatLiteral{ floatLiteral.Value(), floatLiteral.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::FloatLiteral, index);
+  }
+
+  void Visit(const ::VarRef& varRef) override
+  {
+    auto var = varRef.HasResolvedVar() ? GetVarIndex(varRef.ResolvedVar())
+                                       : gNoIndex;
+
+    auto index = Append(
+      mTree.varRefs,
+      VarRef{ varRef.GetSymbol(), var, mCurrentFunc, varRef.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::VarRef, index);
+  }
+
+  void Visit(const ::GroupExpr& groupExpr) override
+  {
+    auto inner = FlattenExpr(groupExpr.InnerExpr());
+
+    auto index = Append(mTree.groupExprs,
+                        GroupExpr{ inner, groupExpr.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::GroupExpr, index);
+  }
+
+  void Visit(const ::UnaryExpr& unaryExpr) override
+  {
+    auto operand = FlattenExpr(unaryExpr.BaseExpr());
+
+    auto index = Append(
+      mTree.unaryExprs,
+      UnaryExpr{ operand, unaryExpr.GetKind(), unaryExpr.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::UnaryExpr, index);
+  }
+
+  void Visit(const ::BinaryExpr& binaryExpr) override
+  {
+    auto left = FlattenExpr(binaryExpr.LeftExpr());
+
+    auto right = FlattenExpr(binaryExpr.RightExpr());
+
+    auto index = Append(mTree.binaryExprs,
+                        BinaryExpr{ left,
+                                    right,
+                                    binaryExpr.GetKind(),
+                                    binaryExpr.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::BinaryExpr, index);
+  }
+
+  void Visit(const ::FuncCall& funcCall) override
+  {
+    FuncCall call;
+
+    call.name = funcCall.GetSymbol();
+
+    call.args = FlattenExprList(funcCall.Args());
+
+    call.isBuiltin = funcCall.IsBuiltin();
+
+    call.callee = (funcCall.Resolved() && !call.isBuiltin)
+                    ? mFuncIndices.at(&funcCall.GetFuncDecl())
+                    : gNoIndex;
+
+    call.caller = mCurrentFunc;
+
+    call.location = funcCall.GetLocation();
+
+    mExprRef = ExprRef(ExprKind::FuncCall, Append(mTree.funcCalls, call));
+  }
+
+  void Visit(const ::TypeConstructor& typeConstructor) override
+  {
+    auto args = FlattenExprList(typeConstructor.Args());
+
+    auto index = Append(mTree.typeConstructors,
+                        TypeConstructor{ typeConstructor.GetType()->ID(),
+                                         args,
+                                         typeConstructor.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::TypeConstructor, index);
+  }
+
+  void Visit(const ::MemberExpr& memberExpr) override
+  {
+    auto base = FlattenExpr(memberExpr.BaseExpr());
+
+    auto index = Append(mTree.memberExprs,
+                        MemberExpr{ base,
+                                    memberExpr.MemberName().GetSymbol(),
+                                    memberExpr.GetLocation() });
+
+    mExprRef = ExprRef(ExprKind::MemberExpr, index);
+  }
+
+  void Visit(const ::AssignmentStmt& assignmentStmt) override
+  {
+    auto lvalue = FlattenExpr(assignmentStmt.LValue());
+
+    auto rvalue = FlattenExpr(assignmentStmt.RValue());
+
+    auto index =
+      Append(mTree.assignmentStmts,
+             AssignmentStmt{ lvalue, rvalue, assignmentStmt.GetLocation() });
+
+    mStmtRef = StmtRef(StmtKind::AssignmentStmt, index);
+  }
+
+  void Visit(const ::CompoundStmt& compoundStmt) override
+  {
+    // The statements are flattened before they're listed, so that the lists
+    // of nested compound statements don't end up in the middle of this one.
+    std::vector<StmtRef> stmts;
+
+    for (const auto& stmt : compoundStmt.Stmts())
+      stmts.emplace_back(FlattenStmt(*stmt));
+
+    Range range{ uint32_t(mTree.stmtLists.size()), uint32_t(stmts.size()) };
+
+    mTree.stmtLists.insert(mTree.stmtLists.end(), stmts.begin(), stmts.end());
+
+    auto index = Append(mTree.compoundStmts,
+                        CompoundStmt{ range, compoundStmt.GetLocation() });
+
+    mStmtRef = StmtRef(StmtKind::CompoundStmt, index);
+  }
+
+  void Visit(const ::DeclStmt& declStmt) override
+  {
+    auto var = FlattenVar(declStmt.GetVarDecl());
+
+    auto index =
+      Append(mTree.declStmts, DeclStmt{ var, declStmt.GetLocation() });
+
+    mStmtRef = StmtRef(StmtKind::DeclStmt, index);
+  }
+
+  void Visit(const ::ReturnStmt& returnStmt) override
+  {
+    auto value = FlattenExpr(returnStmt.ReturnValue());
+
+    auto index = Append(mTree.returnStmts,
+                        ReturnStmt{ value, returnStmt.GetLocation() });
+
+    mStmtRef = StmtRef(StmtKind::ReturnStmt, index);
+  }
+
+private:
+  ExprRef FlattenExpr(const Expr& expr)
+  {
+    expr.AcceptVisitor(*this);
+
+    return mExprRef;
+  }
+
+  StmtRef FlattenStmt(const Stmt& stmt)
+  {
+    stmt.AcceptVisitor(*this);
+
+    return mStmtRef;
+  }
+
+  Range FlattenExprList(const ExprList& exprList)
+  {
+    std::vector<ExprRef> exprs;
+
+    for (const auto& expr : exprList)
+      exprs.emplace_back(FlattenExpr(*expr));
+
+    Range range{ uint32_t(mTree.exprLists.size()), uint32_t(exprs.size()) };
+
+    mTree.exprLists.insert(mTree.exprLists.end(), exprs.begin(), exprs.end());
+
+    return range;
+  }
+
+  /// @brief Gets the index of a variable, reserving it if the variable
+  /// hasn't been flattened yet.
+  uint32_t GetVarIndex(const ::VarDecl& varDecl)
+  {
+    auto it = mVarIndices.find(&varDecl);
+
+    if (it != mVarIndices.end())
+      return it->second;
+
+    auto index = Append(mTree.vars, VarDecl{});
+
+    mVarIndices.emplace(&varDecl, index);
+
+    return index;
+  }
+
+  uint32_t FlattenVar(const ::VarDecl& varDecl)
+  {
+    auto init = varDecl.HasInitExpr() ? FlattenExpr(varDecl.InitExpr())
+                                      : ExprRef();
+
+    auto index = GetVarIndex(varDecl);
+
+    auto& var = mTree.vars[index];
+
+    var.name = varDecl.GetSymbol();
+
+    var.type = varDecl.GetTypeID();
+
+    var.variability = varDecl.GetVariability();
+
+    var.isGlobal = varDecl.IsGlobal();
+
+    var.init = init;
+
+    var.nameLocation = varDecl.GetNameLocation();
+
+    return index;
+  }
+
+  Tree& mTree;
+
+  std::unordered_map<const ::FuncDecl*, uint32_t> mFuncIndices;
+
+  std::unordered_map<const ::VarDecl*, uint32_t> mVarIndices;
+
+  uint32_t mCurrentFunc = gNoIndex;
+
+  ExprRef mExprRef;
+
+  StmtRef mStmtRef;
+};
+
+} // namespace
+
+void
+Tree::VisitPools(PoolVisitor& visitor) const
+{
+  VisitPool(funcs, visitor);
+  VisitPool(vars, visitor);
+  VisitPool(intLiterals, visitor);
+  VisitPool(boolLiterals, visitor);
+  VisitPool(floatLiterals, visitor);
+  VisitPool(varRefs, visitor);
+  VisitPool(groupExprs, visitor);
+  VisitPool(unaryExprs, visitor);
+  VisitPool(binaryExprs, visitor);
+  VisitPool(funcCalls, visitor);
+  VisitPool(typeConstructors, visitor);
+  VisitPool(memberExprs, visitor);
+  VisitPool(assignmentStmts, visitor);
+  VisitPool(compoundStmts, visitor);
+  VisitPool(declStmts, visitor);
+  VisitPool(returnStmts, visitor);
+}
+
+size_t
+Tree::NodeCount() const noexcept
+{
+  return intLiterals.size() + boolLiterals.size() + floatLiterals.size() +
+         varRefs.size() + groupExprs.size() + unaryExprs.size() +
+         binaryExprs.size() + funcCalls.size() + typeConstructors.size() +
+         memberExprs.size() + assignmentStmts.size() + compoundStmts.size() +
+         declStmts.size() + returnStmts.size();
+}
+
+auto
+Flatten(const Module& module) -> Tree
+{
+  Tree tree;
+
+  tree.symbolPool = module.GetSymbolPool();
+
+  Flattener flattener(tree);
+
+  // The declarations are numbered first, so that they keep the order of the
+  // module, and references to ones declared later can be resolved.
+  for (const auto& func : module.Funcs())
+    flattener.AddFunc(*func);
+
+  for (const auto& globalVar : module.GlobalVars())
+    flattener.AddGlobalVar(*globalVar);
+
+  for (const auto& globalVar : module.GlobalVars())
+    flattener.FlattenGlobalVar(*globalVar);
+
+  for (const auto& func : module.Funcs())
+    flattener.FlattenFunc(*func);
+
+  return tree;
+}
+
+} // namespace flat
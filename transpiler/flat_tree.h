@@ -0,0 +1,369 @@
+#pragma once
+
+#include "expr.h"
+#include "location.h"
+#include "symbol.h"
+#include "type.h"
+
+#include <memory>
+#include <vector>
+
+#include <stdint.h>
+
+class Module;
+
+/// @brief A data oriented form of a resolved module, for passes that would
+/// rather scan arrays of nodes than chase pointers through a tree.
+///
+/// @detail Each kind of node is kept in its own pool, which is a vector of
+/// small structures that don't own anything. Nodes refer to each other by 32
+/// bit indices into the pools, and lists of children are ranges of a shared
+/// vector instead of vectors of pointers. Declarations refer to each other by
+/// their indices too, so a resolved variable or a called function is found
+/// without a map.
+///
+/// A tree is made from a module that has been resolved, with @ref Flatten.
+/// It's opt-in: the parser and the other passes still use the pointer tree.
+namespace flat {
+
+/// @brief The index that refers to nothing.
+constexpr uint32_t gNoIndex = UINT32_MAX;
+
+enum class ExprKind : uint8_t
+{
+  IntLiteral,
+  BoolLiteral,
+  FloatLiteral,
+  VarRef,
+  GroupExpr,
+  UnaryExpr,
+  BinaryExpr,
+  FuncCall,
+  TypeConstructor,
+  MemberExpr
+};
+
+enum class StmtKind : uint8_t
+{
+  AssignmentStmt,
+  CompoundStmt,
+  DeclStmt,
+  ReturnStmt
+};
+
+/// @brief Refers to a node by its kind and its index in the pool of that
+/// kind, packed into 32 bits.
+template<typename Kind>
+class NodeRef final
+{
+public:
+  /// @brief The number of bits of the index. The rest hold the kind.
+  static constexpr uint32_t gIndexBits = 28;
+
+  static constexpr uint32_t gMaxIndex = (1u << gIndexBits) - 1;
+
+  /// @brief Makes a reference to nothing.
+  NodeRef() = default;
+
+  NodeRef(Kind kind, uint32_t index) noexcept
+    : mBits((uint32_t(kind) << gIndexBits) | index)
+  {}
+
+  bool IsNull() const noexcept { return mBits == gNoIndex; }
+
+  Kind GetKind() const noexcept { return Kind(mBits >> gIndexBits); }
+
+  uint32_t Index() const noexcept { return mBits & gMaxIndex; }
+
+  bool operator==(NodeRef other) const noexcept { return mBits == other.mBits; }
+
+  bool operator!=(NodeRef other) const noexcept { return mBits != other.mBits; }
+
+private:
+  uint32_t mBits = gNoIndex;
+};
+
+using ExprRef = NodeRef<ExprKind>;
+
+using StmtRef = NodeRef<StmtKind>;
+
+/// @brief A run of consecutive entries in one of the list pools.
+struct Range final
+{
+  uint32_t first = 0;
+
+  uint32_t count = 0;
+};
+
+struct IntLiteral final
+{
+  uint64_t value;
+
+  Location location;
+};
+
+struct BoolLiteral final
+{
+  bool value;
+
+  Location location;
+};
+
+struct FloatLiteral final
+{
+  double value;
+
+  Location location;
+};
+
+struct VarRef final
+{
+  Symbol name;
+
+  /// @brief The index of the variable, or @ref gNoIndex if it wasn't
+  /// resolved.
+  uint32_t var;
+
+  /// @brief The index of the function the reference is in, or @ref gNoIndex
+  /// if it's in the initializer of a global variable.
+  uint32_t func;
+
+  Location location;
+};
+
+struct GroupExpr final
+{
+  ExprRef inner;
+
+  Location location;
+};
+
+struct UnaryExpr final
+{
+  ExprRef operand;
+
+  ::UnaryExpr::Kind op;
+
+  Location location;
+};
+
+struct BinaryExpr final
+{
+  ExprRef left;
+
+  ExprRef right;
+
+  ::BinaryExpr::Kind op;
+
+  Location location;
+};
+
+struct FuncCall final
+{
+  Symbol name;
+
+  /// @brief The arguments, in @ref Tree::exprLists.
+  Range args;
+
+  /// @brief The index of the called function, or @ref gNoIndex if the call
+  /// is to a builtin or wasn't resolved to a single function.
+  uint32_t callee;
+
+  /// @brief The index of the function the call is in, or @ref gNoIndex if
+  /// it's in the initializer of a global variable.
+  uint32_t caller;
+
+  bool isBuiltin;
+
+  Location location;
+};
+
+struct TypeConstructor final
+{
+  TypeID type;
+
+  /// @brief The arguments, in @ref Tree::exprLists.
+  Range args;
+
+  Location location;
+};
+
+struct MemberExpr final
+{
+  ExprRef base;
+
+  Symbol member;
+
+  Location location;
+};
+
+struct AssignmentStmt final
+{
+  ExprRef lvalue;
+
+  ExprRef rvalue;
+
+  Location location;
+};
+
+struct CompoundStmt final
+{
+  /// @brief The statements, in @ref Tree::stmtLists.
+  Range stmts;
+
+  Location location;
+};
+
+struct DeclStmt final
+{
+  uint32_t var;
+
+  Location location;
+};
+
+struct ReturnStmt final
+{
+  ExprRef value;
+
+  Location location;
+};
+
+struct VarDecl final
+{
+  Symbol name;
+
+  TypeID type;
+
+  Variability variability;
+
+  bool isGlobal;
+
+  /// @brief The initializer, which is null if there isn't one.
+  ExprRef init;
+
+  Location nameLocation;
+};
+
+struct FuncDecl final
+{
+  Symbol name;
+
+  TypeID returnType;
+
+  /// @brief The parameters, which are consecutive in @ref Tree::vars.
+  Range params;
+
+  StmtRef body;
+
+  Location nameLocation;
+};
+
+class PoolVisitor;
+
+/// @brief The pools of a flattened module.
+///
+/// @detail The functions and the global variables are in the order that the
+/// module declares them, and the global variables come first in the pool of
+/// variables. A node is added after its children, so a pass that scans a
+/// pool front to back sees the children of a node before the node itself,
+/// when they are of the same kind.
+struct Tree final
+{
+  /// @brief The pool that the names come from, which the tree keeps alive.
+  std::shared_ptr<SymbolPool> symbolPool;
+
+  std::vector<FuncDecl> funcs;
+
+  std::vector<VarDecl> vars;
+
+  std::vector<IntLiteral> intLiterals;
+
+  std::vector<BoolLiteral> boolLiterals;
+
+  std::vector<FloatLiteral> floatLiterals;
+
+  std::vector<VarRef> varRefs;
+
+  std::vector<GroupExpr> groupExprs;
+
+  std::vector<UnaryExpr> unaryExprs;
+
+  std::vector<BinaryExpr> binaryExprs;
+
+  std::vector<FuncCall> funcCalls;
+
+  std::vector<TypeConstructor> typeConstructors;
+
+  std::vector<MemberExpr> memberExprs;
+
+  std::vector<AssignmentStmt> assignmentStmts;
+
+  std::vector<CompoundStmt> compoundStmts;
+
+  std::vector<DeclStmt> declStmts;
+
+  std::vector<ReturnStmt> returnStmts;
+
+  /// @brief The argument lists of the calls and type constructors.
+  std::vector<ExprRef> exprLists;
+
+  /// @brief The statement lists of the compound statements.
+  std::vector<StmtRef> stmtLists;
+
+  /// @brief Visits every node of every pool, one pool after the other, in
+  /// the order that the nodes are stored.
+  void VisitPools(PoolVisitor& visitor) const;
+
+  /// @brief Gets the total number of expressions and statements.
+  size_t NodeCount() const noexcept;
+};
+
+/// @brief Visits the nodes of a tree pool by pool, rather than in the order
+/// of the syntax. Each node is given with its index in its pool. The nodes
+/// that a visitor doesn't override are skipped.
+class PoolVisitor
+{
+public:
+  virtual ~PoolVisitor() = default;
+
+  virtual void Visit(const FuncDecl&, uint32_t) {}
+
+  virtual void Visit(const VarDecl&, uint32_t) {}
+
+  virtual void Visit(const IntLiteral&, uint32_t) {}
+
+  virtual void Visit(const BoolLiteral&, uint32_t) {}
+
+  virtual void Visit(const FloatLiteral&, uint32_t) {}
+
+  virtual void Visit(const VarRef&, uint32_t) {}
+
+  virtual void Visit(const GroupExpr&, uint32_t) {}
+
+  virtual void Visit(const UnaryExpr&, uint32_t) {}
+
+  virtual void Visit(const BinaryExpr&, uint32_t) {}
+
+  virtual void Visit(const FuncCall&, uint32_t) {}
+
+  virtual void Visit(const TypeConstructor&, uint32_t) {}
+
+  virtual void Visit(const MemberExpr&, uint32_t) {}
+
+  virtual void Visit(const AssignmentStmt&, uint32_t) {}
+
+  virtual void Visit(const CompoundStmt&, uint32_t) {}
+
+  virtual void Visit(const DeclStmt&, uint32_t) {}
+
+  virtual void Visit(const ReturnStmt&, uint32_t) {}
+};
+
+/// @brief Makes the flat form of a module.
+///
+/// @note The module should have been resolved. The tree only refers to the
+/// module's symbol pool, so it may outlive the module.
+auto
+Flatten(const Module& module) -> Tree;
+
+} // namespace flat
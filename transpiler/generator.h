@@ -1,25 +1,96 @@
 #pragma once
 
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include <assert.h>
 
+class LineDirectiveWriter;
 class Module;
 
+/// @brief Selects the implementation of the transcendental builtin functions
+/// that the generated code calls.
+enum class MathMode
+{
+  /// Calls into the standard math library.
+  Precise,
+  /// Uses polynomial approximations, which are accurate to a few ULP.
+  Fast
+};
+
+/// @brief A pair of types that the generated templates are instantiated
+/// with, spelled the way they are in C++.
+struct ScalarTypes final
+{
+  std::string floatType;
+
+  std::string intType;
+};
+
+struct GeneratorOptions final
+{
+  MathMode mathMode = MathMode::Precise;
+
+  /// @brief The types to explicitly instantiate the generated templates with.
+  ///
+  /// @detail When this is empty, the header has every definition, and each
+  /// translation unit that includes it instantiates what it uses. Otherwise,
+  /// the header only declares the functions, and the definitions go in a
+  /// source file where they are instantiated once for each of these.
+  std::vector<ScalarTypes> instantiations;
+
+  /// @brief Whether each generated function counts its calls and the cycles
+  /// spent in it, with the profiler in 'pathway_profile.h'.
+  bool instrument = false;
+
+  /// @brief Whether the module defines the C entry table of
+  /// 'pathway_entry.h', so that it can be built into a shared object and
+  /// loaded at run time. The output then has to be compiled as a single
+  /// translation unit.
+  bool entryTable = false;
+
+  /// @brief Whether the generated C++ functions take the parameters that
+  /// they don't assign in the way that suits the size of their type, and
+  /// whether small leaf functions are always inlined. This is only turned off
+  /// to measure what it does.
+  bool callHints = true;
+
+  /// @brief Whether the C SIMD programs are also compiled for newer x86
+  /// instruction sets, which 'pathway_simd.h' selects between at run time.
+  bool isaVariants = false;
+};
+
 class Generator
 {
 public:
-  Generator(std::ostream& os_)
+  Generator(std::ostream& os_, const GeneratorOptions& options = {})
     : os(os_)
+    , mOptions(options)
   {}
 
   virtual ~Generator() = default;
 
   virtual void Generate(const Module&) = 0;
 
+  /// @brief Makes the generator attribute the code of each function and
+  /// statement to its line in the source file.
+  void SetLineDirectives(const LineDirectiveWriter* lineDirectives)
+  {
+    mLineDirectives = lineDirectives;
+  }
+
 protected:
   std::ostream& os;
 
+  const GeneratorOptions& GetOptions() const noexcept { return mOptions; }
+
+  /// @return Null if line directives weren't enabled.
+  const LineDirectiveWriter* GetLineDirectives() const noexcept
+  {
+    return mLineDirectives;
+  }
+
   std::ostream& Indent()
   {
     for (size_t i = 0; i < mIndentLevel; i++)
@@ -38,5 +109,9 @@ protected:
   }
 
 private:
+  GeneratorOptions mOptions;
+
+  const LineDirectiveWriter* mLineDirectives = nullptr;
+
   size_t mIndentLevel = 0;
 };
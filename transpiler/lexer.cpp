@@ -2,10 +2,14 @@
 
 #include "generated/parse.h"
 
-#include <fstream>
+#include <charconv>
 #include <iomanip>
 #include <sstream>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 std::string
 Token::Dump() const
 {
@@ -138,8 +142,8 @@ Token::Dump() const
       stream << std::get<uint64_t>(mData.value());
     else if (std::holds_alternative<double>(mData.value()))
       stream << std::scientific << std::get<double>(mData.value());
-    else if (std::holds_alternative<std::string_view>(mData.value()))
-      stream << std::get<std::string_view>(mData.value());
+    else if (std::holds_alternative<Symbol>(mData.value()))
+      stream << std::get<Symbol>(mData.value());
 
     stream << ')';
   }
@@ -179,51 +183,105 @@ ToLower(char c) noexcept
   return ((c >= 'A') && (c <= 'Z')) ? c + 32 : c;
 }
 
-} // namespace
+bool
+IsSpace(char c) noexcept
+{
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+struct Keyword final
+{
+  std::string_view name;
+
+  int kind = 0;
+};
+
+constexpr Keyword gKeywords[]{
+  { "true", TOK_TRUE },         { "false", TOK_FALSE },
+  { "pi", TOK_PI },             { "infinity", TOK_INFINITY },
+  { "module", TOK_MODULE },     { "import", TOK_IMPORT },
+  { "export", TOK_EXPORT },     { "uniform", TOK_UNIFORM },
+  { "varying", TOK_VARYING },   { "void", TOK_VOID },
+  { "bool", TOK_BOOL },         { "int", TOK_INT },
+  { "float", TOK_FLOAT },       { "vec2", TOK_VEC2 },
+  { "vec3", TOK_VEC3 },         { "vec4", TOK_VEC4 },
+  { "vec2i", TOK_VEC2I },       { "vec3i", TOK_VEC3I },
+  { "vec4i", TOK_VEC4I },       { "mat2", TOK_MAT2 },
+  { "mat3", TOK_MAT3 },         { "mat4", TOK_MAT4 },
+  { "break", TOK_BREAK },       { "continue", TOK_CONTINUE },
+  { "return", TOK_RETURN },     { "if", TOK_IF },
+  { "else", TOK_ELSE },         { "for", TOK_FOR },
+  { "while", TOK_WHILE }
+};
+
+constexpr size_t gMinKeywordLength = 2;
+
+constexpr size_t gMaxKeywordLength = 8;
+
+constexpr size_t gKeywordTableSize = 64;
+
+/// @brief Hashes a name that is between the minimum and maximum keyword
+/// length.
+///
+/// @detail The factors were searched for so that no two keywords have the same
+/// hash. If a keyword is added, the static assertion below will fail until new
+/// factors are found.
+constexpr size_t
+HashKeyword(std::string_view name) noexcept
+{
+  auto first = size_t(static_cast<unsigned char>(name[0]));
+
+  auto last = size_t(static_cast<unsigned char>(name[name.size() - 1]));
+
+  auto secondLast = size_t(static_cast<unsigned char>(name[name.size() - 2]));
 
-Lexer::Lexer()
+  return ((2 * first) + (26 * last) + (9 * secondLast) + name.size()) %
+         gKeywordTableSize;
+}
+
+struct KeywordTable final
+{
+  Keyword entries[gKeywordTableSize]{};
+
+  bool isPerfect = true;
+};
+
+constexpr KeywordTable
+MakeKeywordTable() noexcept
 {
-  auto& idMap = mIdentifierOverrideMap;
+  KeywordTable table;
 
-  idMap["true"] = TOK_TRUE;
-  idMap["false"] = TOK_FALSE;
-  idMap["pi"] = TOK_PI;
-  idMap["infinity"];
+  for (const auto& keyword : gKeywords) {
 
-  idMap["module"] = TOK_MODULE;
-  idMap["import"] = TOK_IMPORT;
-  idMap["export"] = TOK_EXPORT;
+    auto& entry = table.entries[HashKeyword(keyword.name)];
 
-  idMap["uniform"] = TOK_UNIFORM;
-  idMap["varying"] = TOK_VARYING;
+    if (!entry.name.empty())
+      table.isPerfect = false;
 
-  idMap["void"] = TOK_VOID;
-  idMap["bool"] = TOK_BOOL;
-  idMap["int"] = TOK_INT;
-  idMap["float"] = TOK_FLOAT;
+    entry = keyword;
+  }
 
-  idMap["vec2"] = TOK_VEC2;
-  idMap["vec3"] = TOK_VEC3;
-  idMap["vec4"] = TOK_VEC4;
+  return table;
+}
 
-  idMap["vec2i"] = TOK_VEC2I;
-  idMap["vec3i"] = TOK_VEC3I;
-  idMap["vec4i"] = TOK_VEC4I;
+constexpr KeywordTable gKeywordTable = MakeKeywordTable();
 
-  idMap["mat2"] = TOK_MAT2;
-  idMap["mat3"] = TOK_MAT3;
-  idMap["mat4"] = TOK_MAT4;
+static_assert(gKeywordTable.isPerfect, "Keyword hash factors need updating.");
 
-  idMap["break"] = TOK_BREAK;
-  idMap["continue"] = TOK_CONTINUE;
-  idMap["return"] = TOK_RETURN;
+/// @return The token kind of a keyword, or zero if the name isn't a keyword.
+int
+FindKeyword(std::string_view name) noexcept
+{
+  if ((name.size() < gMinKeywordLength) || (name.size() > gMaxKeywordLength))
+    return 0;
 
-  idMap["if"] = TOK_IF;
-  idMap["else"] = TOK_ELSE;
-  idMap["for"] = TOK_FOR;
-  idMap["while"] = TOK_WHILE;
+  const auto& entry = gKeywordTable.entries[HashKeyword(name)];
+
+  return (entry.name == name) ? entry.kind : 0;
 }
 
+} // namespace
+
 std::optional<Token>
 Lexer::Lex()
 {
@@ -308,14 +366,14 @@ Lexer::ProduceIdentifier(size_t length)
 
   auto location = currentContext.AdvanceAndProduceLocation(length);
 
-  auto it = mIdentifierOverrideMap.find(identifier);
+  auto keywordKind = FindKeyword(identifier);
 
-  if (it != mIdentifierOverrideMap.end())
-    return Token(it->second, location);
+  if (keywordKind != 0)
+    return Token(keywordKind, location);
 
   // definitely an identifier at this point.
 
-  return Token(TOK_IDENTIFIER, identifier, location);
+  return Token(TOK_IDENTIFIER, mSymbolPool->Intern(identifier), location);
 }
 
 Token
@@ -325,9 +383,13 @@ Lexer::ProduceInteger(size_t length)
 
   auto view = context.MakeStringView(length);
 
-  std::string dataCopy(view);
+  uint64_t value = 0;
+
+  auto result = std::from_chars(view.data(), view.data() + view.size(), value);
 
-  auto value = strtoul(dataCopy.c_str(), nullptr, 10);
+  // This keeps the value that strtoul gives for out of range literals.
+  if (result.ec != std::errc())
+    value = strtoul(std::string(view).c_str(), nullptr, 10);
 
   auto location = context.AdvanceAndProduceLocation(length);
 
@@ -363,7 +425,7 @@ Lexer::CompleteFloatAfterE(size_t length)
 {
   auto& context = CurrentContext();
 
-  if ((context.Peek(length == '+') || (context.Peek(length == '-')))) {
+  if ((context.Peek(length) == '+') || (context.Peek(length) == '-')) {
     length++;
   }
 
@@ -384,9 +446,14 @@ Lexer::ProduceFloat(size_t length)
 
   auto view = context.MakeStringView(length);
 
-  std::string dataCopy(view);
+  double value = 0;
+
+  auto result = std::from_chars(view.data(), view.data() + view.size(), value);
 
-  auto value = strtod(dataCopy.c_str(), nullptr);
+  // This keeps the value that strtod gives for literals that are too large or
+  // too small to represent, which from_chars leaves unset.
+  if (result.ec != std::errc())
+    value = strtod(std::string(view).c_str(), nullptr);
 
   auto location = context.AdvanceAndProduceLocation(length);
 
@@ -398,34 +465,24 @@ Lexer::FileContext::AdvanceAndProduceLocation(size_t charCount) noexcept
 {
   Location location;
 
-  location.first_line = mCurrentLine;
-
-  location.first_column = mCurrentColumn;
-
-  Advance(charCount - 1);
+  location.begin = uint32_t(mCurrentIndex);
 
-  location.last_line = mCurrentLine;
+  location.end = uint32_t(mCurrentIndex + charCount);
 
-  location.last_column = mCurrentColumn;
-
-  Advance(1);
+  Advance(charCount);
 
   return location;
 }
 
 bool
-Lexer::PushFile(const char* path)
+Lexer::PushFile(const char* path, bool map)
 {
-  std::ifstream file(path);
+  auto buffer = SourceBuffer::Open(path, map);
 
-  if (!file.good())
+  if (!buffer)
     return false;
 
-  std::ostringstream fileStream;
-
-  fileStream << file.rdbuf();
-
-  PushFile(path, fileStream.str());
+  mFileContextStack.emplace_back(path, std::move(buffer));
 
   return true;
 }
@@ -433,9 +490,9 @@ Lexer::PushFile(const char* path)
 void
 Lexer::PushFile(const char* path, std::string data)
 {
-  FileContext fileContext(path, std::move(data));
+  auto buffer = SourceBuffer::FromString(std::move(data));
 
-  mFileContextStack.emplace_back(std::move(fileContext));
+  mFileContextStack.emplace_back(path, std::move(buffer));
 }
 
 void
@@ -481,33 +538,38 @@ Lexer::FileContext::Peek(size_t relOffset) const noexcept
 void
 Lexer::FileContext::Advance(size_t count) noexcept
 {
-  for (size_t i = 0; i < count; i++) {
-
-    auto c = Peek(i);
-
-    if (c == '\n') {
-      mCurrentLine++;
-      mCurrentColumn = 1;
-    } else {
-      mCurrentColumn++;
-    }
-  }
-
   mCurrentIndex += count;
 }
 
 void
 Lexer::FileContext::SkipUseless() noexcept
 {
-  while (!AtEnd()) {
+#ifdef __SSE2__
+  // Most whitespace is indentation, so it is checked sixteen characters at a
+  // time while there are that many left.
+  while ((mCurrentIndex + 16) <= mData.size()) {
 
-    auto c = Peek(0);
+    const auto* ptr = mData.data() + mCurrentIndex;
 
-    if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) {
-      Advance(1);
-      continue;
+    auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+
+    auto isSpace =
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                   _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+
+    auto spaceMask = unsigned(_mm_movemask_epi8(isSpace));
+
+    if (spaceMask != 0xffff) {
+      mCurrentIndex += size_t(__builtin_ctz(~spaceMask));
+      return;
     }
 
-    break;
+    mCurrentIndex += 16;
   }
+#endif // __SSE2__
+
+  while (!AtEnd() && IsSpace(Peek(0)))
+    Advance(1);
 }
@@ -1,15 +1,17 @@
 #pragma once
 
 #include "location.h"
+#include "source_buffer.h"
+#include "symbol.h"
 
-#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
 #include <vector>
 
-using TokenData = std::variant<double, uint64_t, std::string_view>;
+using TokenData = std::variant<double, uint64_t, Symbol>;
 
 class Token final
 {
@@ -26,10 +28,7 @@ public:
 
   double AsDouble() const { return std::get<double>(mData.value()); }
 
-  std::string_view AsStringView() const
-  {
-    return std::get<std::string_view>(mData.value());
-  }
+  Symbol AsSymbol() const { return std::get<Symbol>(mData.value()); }
 
 private:
   friend class Lexer;
@@ -55,11 +54,22 @@ private:
 class Lexer final
 {
 public:
-  Lexer();
+  /// @param symbols The pool that identifiers are interned into. The modules
+  /// that are parsed from the lexer share it.
+  explicit Lexer(std::shared_ptr<SymbolPool> symbols = SymbolPool::Current())
+    : mSymbolPool(std::move(symbols))
+  {}
+
+  const std::shared_ptr<SymbolPool>& GetSymbolPool() const noexcept
+  {
+    return mSymbolPool;
+  }
 
   std::optional<Token> Lex();
 
-  bool PushFile(const char* path);
+  /// @param map Whether the file may be memory mapped. See
+  /// @ref SourceBuffer::Open.
+  bool PushFile(const char* path, bool map = true);
 
   void PushFile(const char* path, std::string data);
 
@@ -85,9 +95,10 @@ private:
   class FileContext final
   {
   public:
-    FileContext(const std::string& path, std::string&& data)
+    FileContext(const std::string& path, std::unique_ptr<SourceBuffer> buffer)
       : mPath(path)
-      , mData(std::move(data))
+      , mBuffer(std::move(buffer))
+      , mData(mBuffer->Data())
     {}
 
     bool AtEnd() const noexcept;
@@ -116,13 +127,13 @@ private:
 
   private:
     std::string mPath;
-    std::string mData;
+    std::unique_ptr<SourceBuffer> mBuffer;
+    /// @brief Refers to the contents of the buffer, which never move.
+    std::string_view mData;
     size_t mCurrentIndex = 0;
-    size_t mCurrentLine = 1;
-    size_t mCurrentColumn = 1;
   };
 
-  std::vector<FileContext> mFileContextStack;
+  std::shared_ptr<SymbolPool> mSymbolPool;
 
-  std::map<std::string_view, int> mIdentifierOverrideMap;
+  std::vector<FileContext> mFileContextStack;
 };
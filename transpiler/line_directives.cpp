@@ -0,0 +1,198 @@
+#include "line_directives.h"
+
+#include <ostream>
+#include <sstream>
+
+namespace {
+
+/// @brief Written in place of the line number of the generated file, which
+/// isn't a valid directive, so that a placeholder left in the output fails
+/// to compile instead of going unnoticed.
+const std::string_view gResetPlaceholder = "#line __PATHWAY_GENERATED_LINE__";
+
+const std::string_view gLineDirective = "#line ";
+
+std::string
+QuoteCString(const std::string& str)
+{
+  std::string quoted = "\"";
+
+  for (char c : str) {
+    if ((c == '"') || (c == '\\'))
+      quoted += '\\';
+    quoted += c;
+  }
+
+  return quoted + '"';
+}
+
+std::string
+QuoteJsonString(const std::string& str)
+{
+  std::ostringstream quoted;
+
+  quoted << '"';
+
+  for (char c : str) {
+    if ((c == '"') || (c == '\\')) {
+      quoted << '\\' << c;
+    } else if ((unsigned char)c < 0x20) {
+      const char* digits = "0123456789abcdef";
+      quoted << "\\u00" << digits[(c >> 4) & 0xf] << digits[c & 0xf];
+    } else {
+      quoted << c;
+    }
+  }
+
+  quoted << '"';
+
+  return quoted.str();
+}
+
+/// @brief Gets the source line of a directive written by @ref
+/// LineDirectiveWriter::Write.
+///
+/// @return Zero if the line isn't one.
+size_t
+ParseSourceLine(std::string_view line)
+{
+  if (line.substr(0, gLineDirective.size()) != gLineDirective)
+    return 0;
+
+  size_t sourceLine = 0;
+
+  for (size_t i = gLineDirective.size(); i < line.size(); i++) {
+
+    if ((line[i] < '0') || (line[i] > '9'))
+      break;
+
+    sourceLine = (sourceLine * 10) + size_t(line[i] - '0');
+  }
+
+  return sourceLine;
+}
+
+} // namespace
+
+LineDirectiveWriter::LineDirectiveWriter(const std::string& path,
+                                         std::string_view data)
+  : mQuotedPath(QuoteCString(path))
+  , mLineTable(data)
+{}
+
+void
+LineDirectiveWriter::Write(std::ostream& stream, uint32_t offset) const
+{
+  stream << gLineDirective << mLineTable.GetLine(offset) << ' ' << mQuotedPath
+         << std::endl;
+}
+
+void
+LineDirectiveWriter::WriteReset(std::ostream& stream) const
+{
+  stream << gResetPlaceholder << std::endl;
+}
+
+auto
+ResolveLineDirectives(std::string& code, const std::string& generatedPath)
+  -> std::vector<SourceMapRange>
+{
+  std::vector<SourceMapRange> ranges;
+
+  std::string resolved;
+
+  resolved.reserve(code.size());
+
+  // Whether the lines are attributed to the source file, in which case they
+  // are counted in the last range.
+  auto inSourceRange = false;
+
+  size_t lineStart = 0;
+
+  for (size_t lineNumber = 1; lineStart < code.size(); lineNumber++) {
+
+    auto lineEnd = code.find('\n', lineStart);
+    if (lineEnd == std::string::npos)
+      lineEnd = code.size();
+
+    std::string_view line(code.data() + lineStart, lineEnd - lineStart);
+
+    lineStart = lineEnd + 1;
+
+    if (line == gResetPlaceholder) {
+      // The directive gives the number of the line after it.
+      resolved += gLineDirective;
+      resolved += std::to_string(lineNumber + 1);
+      resolved += ' ';
+      resolved += QuoteCString(generatedPath);
+      resolved += '\n';
+      inSourceRange = false;
+      continue;
+    }
+
+    resolved += line;
+    resolved += '\n';
+
+    if (auto sourceLine = ParseSourceLine(line)) {
+      ranges.emplace_back(SourceMapRange{ lineNumber + 1, sourceLine, 0 });
+      inSourceRange = true;
+    } else if (inSourceRange) {
+      ranges.back().lineCount++;
+    }
+  }
+
+  // Each line was given a line break, including a last line that had none.
+  if (!code.empty() && (code.back() != '\n'))
+    resolved.pop_back();
+
+  code = std::move(resolved);
+
+  // Directives that immediately follow each other leave empty ranges.
+  std::vector<SourceMapRange> nonEmptyRanges;
+
+  for (const auto& r : ranges) {
+    if (r.lineCount > 0)
+      nonEmptyRanges.emplace_back(r);
+  }
+
+  return nonEmptyRanges;
+}
+
+void
+WriteSourceMap(std::ostream& stream,
+               const std::string& sourcePath,
+               const std::vector<SourceMapFile>& files)
+{
+  stream << "{" << std::endl;
+
+  stream << "  \"version\": 1," << std::endl;
+
+  stream << "  \"source\": " << QuoteJsonString(sourcePath) << ","
+         << std::endl;
+
+  stream << "  \"files\": [";
+
+  for (size_t i = 0; i < files.size(); i++) {
+
+    stream << ((i == 0) ? "" : ",") << std::endl
+           << "    {" << std::endl
+           << "      \"file\": " << QuoteJsonString(files[i].path) << ","
+           << std::endl
+           << "      \"ranges\": [";
+
+    const auto& ranges = files[i].ranges;
+
+    for (size_t j = 0; j < ranges.size(); j++) {
+      stream << ((j == 0) ? "" : ",") << std::endl
+             << "        { \"generated_line\": " << ranges[j].generatedLine
+             << ", \"source_line\": " << ranges[j].sourceLine
+             << ", \"line_count\": " << ranges[j].lineCount << " }";
+    }
+
+    stream << std::endl << "      ]" << std::endl << "    }";
+  }
+
+  stream << std::endl << "  ]" << std::endl;
+
+  stream << "}" << std::endl;
+}
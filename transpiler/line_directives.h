@@ -0,0 +1,70 @@
+#pragma once
+
+#include "line_table.h"
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Writes the '#line' directives that attribute the generated code to
+/// the lines of the source file it came from, so that debuggers, profilers
+/// and sanitizers report the source lines instead of the generated ones.
+class LineDirectiveWriter final
+{
+public:
+  /// @note The writer refers to the data, which has to outlive it.
+  LineDirectiveWriter(const std::string& path, std::string_view data);
+
+  /// @brief Attributes the lines that follow to the line of an offset in the
+  /// source file.
+  void Write(std::ostream& stream, uint32_t offset) const;
+
+  /// @brief Attributes the lines that follow back to the generated file.
+  ///
+  /// @detail The line numbers of the generated file aren't known while it is
+  /// generated, so this writes a placeholder that is replaced by @ref
+  /// ResolveLineDirectives once it is complete.
+  void WriteReset(std::ostream& stream) const;
+
+private:
+  std::string mQuotedPath;
+
+  LineTable mLineTable;
+};
+
+/// @brief A range of generated lines that came from consecutive lines of the
+/// source file. Line numbers start at one.
+struct SourceMapRange final
+{
+  size_t generatedLine = 1;
+
+  size_t sourceLine = 1;
+
+  size_t lineCount = 0;
+};
+
+/// @brief Replaces the placeholders written by @ref
+/// LineDirectiveWriter::WriteReset and finds the lines that came from the
+/// source file.
+///
+/// @param generatedPath The path of the generated file, which the lines that
+/// didn't come from the source file are attributed to.
+auto
+ResolveLineDirectives(std::string& code, const std::string& generatedPath)
+  -> std::vector<SourceMapRange>;
+
+/// @brief The source lines of one of the generated files.
+struct SourceMapFile final
+{
+  std::string path;
+
+  std::vector<SourceMapRange> ranges;
+};
+
+/// @brief Writes a JSON source map, which maps ranges of generated lines back
+/// to the source file, for tools that don't read the '#line' directives.
+void
+WriteSourceMap(std::ostream& stream,
+               const std::string& sourcePath,
+               const std::vector<SourceMapFile>& files);
@@ -0,0 +1,67 @@
+#include "line_table.h"
+
+#include <algorithm>
+
+LineTable::LineTable(std::string_view data)
+  : mData(data)
+{
+  mLineStarts.emplace_back(0);
+
+  for (size_t i = 0; i < data.size(); i++) {
+    if (data[i] == '\n')
+      mLineStarts.emplace_back(uint32_t(i + 1));
+  }
+}
+
+size_t
+LineTable::GetLine(uint32_t offset) const noexcept
+{
+  auto it = std::upper_bound(mLineStarts.begin(), mLineStarts.end(), offset);
+
+  return size_t(it - mLineStarts.begin());
+}
+
+size_t
+LineTable::GetColumn(uint32_t offset) const noexcept
+{
+  return (offset - mLineStarts[GetLine(offset) - 1]) + 1;
+}
+
+LineColumnRange
+LineTable::Expand(const Location& location) const noexcept
+{
+  auto last = (location.end > location.begin) ? location.end - 1
+                                              : location.begin;
+
+  LineColumnRange range;
+
+  range.first_line = GetLine(location.begin);
+
+  range.first_column = GetColumn(location.begin);
+
+  range.last_line = GetLine(last);
+
+  range.last_column = GetColumn(last);
+
+  return range;
+}
+
+std::string_view
+LineTable::GetLineView(size_t line) const noexcept
+{
+  if ((line == 0) || (line > mLineStarts.size()))
+    return std::string_view();
+
+  size_t lineStart = mLineStarts[line - 1];
+
+  size_t length = mData.size() - lineStart;
+
+  for (size_t i = lineStart; i < mData.size(); i++) {
+    if ((mData[i] == '\r') || (mData[i] == '\n')) {
+      length = i - lineStart;
+      break;
+    }
+  }
+
+  return mData.substr(lineStart, length);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "location.h"
+
+#include <string_view>
+#include <vector>
+
+/// @brief Maps the byte offsets of a source file to line and column numbers.
+///
+/// @detail The offset of the start of each line is recorded once, when the
+/// table is made, so that each lookup is a binary search instead of a scan of
+/// the file.
+class LineTable final
+{
+public:
+  /// @note The table refers to the data, which has to outlive it.
+  explicit LineTable(std::string_view data);
+
+  /// @brief Gets the line number of an offset, starting at one.
+  size_t GetLine(uint32_t offset) const noexcept;
+
+  /// @brief Gets the column number of an offset, starting at one.
+  size_t GetColumn(uint32_t offset) const noexcept;
+
+  LineColumnRange Expand(const Location& location) const noexcept;
+
+  /// @brief Gets a view of the entire line, without the line ending.
+  ///
+  /// @return An empty view if the file has no such line.
+  std::string_view GetLineView(size_t line) const noexcept;
+
+  size_t LineCount() const noexcept { return mLineStarts.size(); }
+
+private:
+  std::string_view mData;
+
+  std::vector<uint32_t> mLineStarts;
+};
@@ -4,6 +4,12 @@
 
 void
 Location::Dump(std::ostream& os) const
+{
+  os << begin << " to " << end;
+}
+
+void
+LineColumnRange::Dump(std::ostream& os) const
 {
   os << first_line << ':' << first_column;
 
@@ -13,7 +19,7 @@ Location::Dump(std::ostream& os) const
 }
 
 std::ostream&
-operator<<(std::ostream& os, const Location& l)
+operator<<(std::ostream& os, const LineColumnRange& l)
 {
   os << l.first_line << ':' << l.first_column;
   return os;
@@ -1,10 +1,32 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <iosfwd>
 
+/// @brief A range of characters in a source file.
+///
+/// @detail A location only stores byte offsets into its file, so that it is
+/// cheap to copy into every token and node. The line and column numbers are
+/// looked up in the file's line table when they are needed, which is only
+/// when a diagnostic is printed.
 struct Location final
+{
+  /// @brief The offset of the first character.
+  uint32_t begin = 0;
+
+  /// @brief The offset of one past the last character.
+  uint32_t end = 0;
+
+  /// @note Prints the byte offsets, since the line and column numbers can't
+  /// be known without the file.
+  void Dump(std::ostream&) const;
+};
+
+/// @brief The line and column numbers of a location, all starting at one.
+/// The last line and column refer to the last character of the location.
+struct LineColumnRange final
 {
   size_t first_line = 1;
 
@@ -21,4 +43,4 @@ struct Location final
 };
 
 std::ostream&
-operator<<(std::ostream&, const Location& location);
+operator<<(std::ostream&, const LineColumnRange& range);
@@ -1,19 +1,35 @@
 #include "check.h"
+#include "const_fold.h"
+#include "cost_analysis.h"
+#include "effects_analysis.h"
 #include "diagnostics.h"
+#include "file_watcher.h"
 #include "lexer.h"
+#include "line_directives.h"
 #include "module.h"
 #include "module_consumer.h"
+#include "module_interface.h"
 #include "parse.h"
 #include "resolve.h"
+#include "sha256.h"
+#include "source_buffer.h"
+#include "statistics.h"
+#include "symbol.h"
 #include "syntax_error_observer.h"
+#include "transpile_cache.h"
+#include "type_annotation.h"
 
 #include "duplicates_check.h"
 #include "resolution_check_pass.h"
 
+#include "bytecode_generator.h"
+#include "c_simd_generator.h"
 #include "cpp_generator_v2.h"
 
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <optional>
 #include <set>
 #include <sstream>
 
@@ -69,7 +85,7 @@ public:
 
   bool BeginFile(const char* path)
   {
-    if (!mLexer.PushFile(path)) {
+    if (!mLexer.PushFile(path, mMapFiles)) {
       std::cerr << this->program_name << ": failed to open '" << path << "' ("
                 << strerror(errno) << ')' << std::endl;
       return false;
@@ -95,38 +111,129 @@ public:
     mDiagObserver->EndFile();
   }
 
-  bool Parse() { return ::Parse(mLexer, *this, *this); }
+  bool Parse()
+  {
+    auto success = mPassTimer.Time(
+      "parse", [this]() { return ::Parse(mLexer, *this, *this); });
+
+    // The parser hands over the module before it returns, so the passes are
+    // run afterwards, to keep them out of the time of the parser.
+    if (mModule)
+      RunPasses(std::move(mModule));
+
+    return success;
+  }
 
   bool get_error_flag() const noexcept { return this->error_flag; }
 
   std::set<std::string> Dependencies() const { return mDependencies; }
 
+  /// @brief Gets the files that the output depends on, which are the source
+  /// files and each path that was searched for the interface of an imported
+  /// module, including the ones that didn't have one.
+  std::set<std::string> WatchedPaths() const
+  {
+    auto paths = mDependencies;
+
+    paths.insert(mSearchedPaths.begin(), mSearchedPaths.end());
+
+    return paths;
+  }
+
   void ConsumeModule(std::unique_ptr<Module> module) override
+  {
+    mModule = std::move(module);
+  }
+
+  void RunPasses(std::unique_ptr<Module> module)
   {
     if (this->error_flag)
       return;
 
-    if (!DuplicatesCheck::Check(*module, *mDiagObserver)) {
+    auto imported = mPassTimer.Time("import modules", [&]() {
+      return ImportModules(
+        *module, mModulePaths, *mDiagObserver, &mSearchedPaths);
+    });
+
+    if (!imported) {
       this->error_flag = true;
       return;
     }
 
-    Resolve(*module);
+    auto unique = mPassTimer.Time("duplicates check", [&]() {
+      return DuplicatesCheck::Check(*module, *mDiagObserver);
+    });
+
+    if (!unique) {
+      this->error_flag = true;
+      return;
+    }
 
-    ResolutionCheckPass resolutionCheckPass;
+    mPassTimer.Time("resolve", [&]() { Resolve(*module); });
 
-    if (!resolutionCheckPass.Invoke(*module, *mDiagObserver)) {
+    auto resolved = mPassTimer.Time("resolution check", [&]() {
+      ResolutionCheckPass resolutionCheckPass;
+      return resolutionCheckPass.Invoke(*module, *mDiagObserver);
+    });
+
+    if (!resolved) {
       this->error_flag = true;
       return;
     }
 
-    if (!check(mPathStack.at(0), *module, std::cerr)) {
+    mPassTimer.Time("annotate types", [&]() { AnnotateTypes(*module); });
+
+    auto source = mLexer.GetCurrentFileData();
+
+    auto checked = mPassTimer.Time("check", [&]() {
+      return check(
+        mPathStack.at(0), source, *module, std::cerr, mRequireEntryPoints);
+    });
+
+    if (!checked) {
       this->error_flag = true;
       return;
     }
 
-    if (mCodeGenEnabled)
-      gen->Generate(*module);
+    if (mInterfaceEnabled) {
+      mPassTimer.Time("write interface",
+                      [&]() { mInterface = WriteModuleInterface(*module); });
+    }
+
+    if (!mCodeGenEnabled)
+      return;
+
+    mPassTimer.Time("analyze effects", [&]() { AnalyzeEffects(*module); });
+
+    mPassTimer.Time("fold constants",
+                    [&]() { FoldConstants(*module, mMathMode); });
+
+    if (mLineDirectivesEnabled) {
+
+      mLineDirectives =
+        std::make_unique<LineDirectiveWriter>(mPathStack.at(0), source);
+
+      gen->SetLineDirectives(mLineDirectives.get());
+
+      if (mSourceGen)
+        mSourceGen->SetLineDirectives(mLineDirectives.get());
+    }
+
+    mPassTimer.Time("generate", [&]() { gen->Generate(*module); });
+
+    if (mSourceGen) {
+      mPassTimer.Time("generate source", [&]() {
+        mSourceGen->GenerateSource(*module, mHeaderName);
+      });
+    }
+
+    if (mStatsEnabled)
+      mModuleStats = CollectModuleStats(*module);
+
+    if (mCostAnalysis) {
+      mPassTimer.Time("analyze cost",
+                      [&]() { mCostAnalysis->Invoke(*module); });
+    }
   }
 
   void ObserveSyntaxError(const Location& loc, const char* msg) override
@@ -140,6 +247,69 @@ public:
 
   void DisableCodeGen() { mCodeGenEnabled = false; }
 
+  void SetMathMode(MathMode mathMode) { mMathMode = mathMode; }
+
+  /// @brief Makes the transpiler read the source files into memory instead
+  /// of mapping them, for when they may be rewritten while it runs.
+  void DisableFileMapping() { mMapFiles = false; }
+
+  void SetModulePaths(std::vector<std::string> modulePaths)
+  {
+    mModulePaths = std::move(modulePaths);
+  }
+
+  /// @brief Makes the module an interface only module, which doesn't need
+  /// entry points since it's only meant to be imported.
+  void DisableEntryPoints() { mRequireEntryPoints = false; }
+
+  void EnableInterface() { mInterfaceEnabled = true; }
+
+  /// @brief Makes the generators write '#line' directives, which have to be
+  /// resolved with @ref ResolveLineDirectives once the code is generated.
+  void EnableLineDirectives() { mLineDirectivesEnabled = true; }
+
+  /// @brief Sets the generator of the source file that goes with the header,
+  /// when the definitions are split from it.
+  ///
+  /// @param headerName How the source file includes the header.
+  void SetSourceGenerator(cpp::Generator* sourceGen, std::string headerName)
+  {
+    mSourceGen.reset(sourceGen);
+
+    mHeaderName = std::move(headerName);
+  }
+
+  /// @brief Gets the interface of the module, if it was enabled and the
+  /// module had no errors.
+  const std::string& GetInterface() const noexcept { return mInterface; }
+
+  /// @brief Makes the transpiler collect the statistics of the module, which
+  /// takes another walk over the module once the code is generated.
+  void EnableStats() { mStatsEnabled = true; }
+
+  /// @brief Makes the transpiler estimate the cost of each function once the
+  /// code is generated.
+  void EnableCostAnalysis()
+  {
+    mCostAnalysis = std::make_unique<CostAnalysis>();
+  }
+
+  const PassTimer& GetPassTimer() const noexcept { return mPassTimer; }
+
+  /// @brief Gets the statistics of the module, if they were enabled and the
+  /// code was generated.
+  auto GetModuleStats() const noexcept -> const std::optional<ModuleStats>&
+  {
+    return mModuleStats;
+  }
+
+  /// @brief Gets the cost of each function, if it was enabled and the code
+  /// was generated.
+  const CostAnalysis* GetCostAnalysis() const noexcept
+  {
+    return mCostAnalysis.get();
+  }
+
 private:
   std::vector<std::string> mPathStack;
   std::string program_name;
@@ -150,21 +320,141 @@ private:
   std::set<std::string> mDependencies;
   bool error_flag = false;
   bool mCodeGenEnabled = true;
+
+  MathMode mMathMode = MathMode::Precise;
+
+  bool mMapFiles = true;
+
+  std::vector<std::string> mModulePaths;
+
+  std::set<std::string> mSearchedPaths;
+
+  bool mRequireEntryPoints = true;
+
+  bool mInterfaceEnabled = false;
+
+  std::string mInterface;
+
+  std::unique_ptr<cpp::Generator> mSourceGen;
+
+  bool mLineDirectivesEnabled = false;
+
+  /// @brief Refers to the source file, so it's kept until the generators are
+  /// done with it.
+  std::unique_ptr<LineDirectiveWriter> mLineDirectives;
+
+  std::string mHeaderName;
+
+  /// @brief The module that the parser produced, until the passes run.
+  std::unique_ptr<Module> mModule;
+
+  PassTimer mPassTimer;
+
+  bool mStatsEnabled = false;
+
+  std::optional<ModuleStats> mModuleStats;
+
+  std::unique_ptr<CostAnalysis> mCostAnalysis;
 };
 
 const char* options = R"(
 options:
+  --cache-dir <PATH>    : Keep the outputs in a cache directory, named by the
+                          hash of the sources, options and transpiler. When an
+                          output is already cached, it is copied to the output
+                          path instead of being generated again.
+
+  --cost-report         : Print an estimate of the operations, loads and
+                          stores done by each function, on its own and with
+                          the functions it calls, and by each sample. Values
+                          that are computed once per frame count as a load.
+
+  --entry-table         : Define the C entry table of 'pathway_entry.h' after
+                          the module, so that the output can be compiled on
+                          its own into a shared object and loaded at run time,
+                          for example with 'pathway_jit.h'.
+
+  --emit-interface <PATH>
+                        : Write the interface of the module, which other
+                          modules load when they import it. Without an output
+                          path, the module doesn't need entry points and no
+                          code is generated for it.
+
   -h, --help            : Print this list of options.
 
-  -l, --language <LANG> : Specify the output language.
+  -I, --module-path <DIR>
+                        : Add a directory to search for the interfaces of the
+                          imported modules. The interface of module 'a::b' is
+                          named 'a.b.pti'. Can be given more than once.
+
+  -l, --language <LANG> : Specify the output language, either 'cxx' for a C++
+                          header, 'bytecode' for the virtual machine in
+                          'pathway_vm.h', which renders without compiling the
+                          module, or 'c-simd' for a C source that processes a
+                          batch of pixels per call with GCC or Clang vectors,
+                          rendered with 'pathway_simd.h'.
+
+  --isa-variants        : Also compile the 'c-simd' programs for SSE4.2, AVX2
+                          and AVX-512, so that a module built for the oldest
+                          x86 CPUs uses the newest instruction set that the
+                          CPU it runs on supports.
+
+  --instrument          : Make each generated function count its calls and the
+                          cycles spent in it, per thread. The counts are read
+                          with the 'module_profile()' function of the module's
+                          namespace, which can print a flat profile after each
+                          frame. Requires 'pathway_profile.h' from the runtime.
+
+  --line-directives     : Attribute the generated functions and statements to
+                          their lines in the source file with '#line'
+                          directives, so that debuggers, profilers and
+                          sanitizers report the source lines.
+
+  --math <MODE>         : Selects the implementation of the transcendental
+                          functions. Can be 'precise' (the default) or 'fast'.
+
+  --instantiate <FLOAT_TYPE>,<INT_TYPE>
+                        : Add a pair of scalar types to explicitly instantiate
+                          the generated templates with, in the source file.
+                          Can be given more than once. The default is
+                          'float,int'.
+
+  --no-call-hints       : Pass every parameter of the generated C++ functions
+                          by value and don't mark any of them to be inlined,
+                          for measuring what these hints do.
 
   -o, --output <PATH>   : Specify the output path.
 
+  --source-map <PATH>   : Write a JSON file that maps the lines of the generated
+                          files back to the source file. Implies
+                          '--line-directives'.
+
+  --source-output <PATH>: Write the function definitions to a separate source
+                          file, where they are instantiated once, instead of
+                          in the header. The header only declares them, so
+                          translation units that include it don't instantiate
+                          them again. The source includes the header by its
+                          file name.
+
+  --stats               : Print the size of the module, the data kept for each
+                          frame and pixel, the generated code and the memory
+                          used by the transpiler.
+
+  --stats-json <PATH>   : Write the pass times and the statistics to a JSON
+                          file, for tracking them over time.
+
   --only-if-different   : The output file is only written if it's different from
                           the existing one. Does not have an effect when there
                           is no existing output file.
 
   --syntax-only         : Only checks syntax, does not generate an output file.
+
+  --time-passes         : Print how long parsing and each pass took.
+
+  --watch               : Keep running after the output is written, and write
+                          it again whenever the source or the interface of an
+                          imported module changes. Errors are reported without
+                          stopping. Only available on Linux.
 )";
 
 void
@@ -190,6 +480,91 @@ ReadWholeFile(const char* path)
   return stream.str();
 }
 
+/// @brief Gets the last component of a path.
+std::string
+GetFileName(const std::string& path)
+{
+  auto separator = path.find_last_of("/\\");
+
+  if (separator == std::string::npos)
+    return path;
+
+  return path.substr(separator + 1);
+}
+
+/// @brief Gets the path of the running executable, so that its contents can
+/// be part of the cache key.
+std::string
+GetExecutablePath(const char* argv0)
+{
+#ifdef __linux__
+  (void)argv0;
+  return "/proc/self/exe";
+#else
+  return argv0;
+#endif
+}
+
+/// @brief Adds a field to a cache key. Each field is prefixed with its size,
+/// so that no two different lists of fields hash the same data.
+void
+AddCacheKeyField(Sha256& hash, std::string_view field)
+{
+  hash.Update(std::to_string(field.size()));
+  hash.Update(":");
+  hash.Update(field);
+}
+
+/// @brief Computes the cache key of a run, from everything the output depends
+/// on: the transpiler itself, the options and the contents of the sources.
+///
+/// @note Imported module interfaces aren't part of the key, so runs that
+/// import modules aren't cached.
+///
+/// @param mapFiles Whether the files may be memory mapped.
+///
+/// @return Nothing if one of the inputs couldn't be read, in which case the
+/// output isn't cached.
+std::optional<std::string>
+MakeCacheKey(const char* argv0,
+             const std::string& mainPath,
+             const std::string& lang,
+             const GeneratorOptions& genOptions,
+             bool mapFiles)
+{
+  auto executable =
+    SourceBuffer::Open(GetExecutablePath(argv0).c_str(), mapFiles);
+
+  auto source = SourceBuffer::Open(mainPath.c_str(), mapFiles);
+
+  if (!executable || !source)
+    return {};
+
+  Sha256 hash;
+
+  // This is changed whenever the layout of the cache key changes.
+  AddCacheKeyField(hash, "ptc-cache-3");
+
+  AddCacheKeyField(hash, executable->Data());
+
+  AddCacheKeyField(hash, lang);
+
+  AddCacheKeyField(
+    hash, (genOptions.mathMode == MathMode::Fast) ? "fast" : "precise");
+
+  AddCacheKeyField(hash, genOptions.instrument ? "instrument" : "");
+
+  AddCacheKeyField(hash, genOptions.entryTable ? "entry-table" : "");
+
+  AddCacheKeyField(hash, genOptions.isaVariants ? "isa-variants" : "");
+
+  AddCacheKeyField(hash, genOptions.callHints ? "" : "no-call-hints");
+
+  AddCacheKeyField(hash, source->Data());
+
+  return hash.FinishHex();
+}
+
 bool
 VerifyErrorTest(const std::string& error);
 
@@ -204,6 +579,10 @@ main(int argc, char** argv)
 
   std::string output_path;
 
+  std::string cacheDir;
+
+  GeneratorOptions genOptions;
+
   bool listDependencies = false;
 
   bool onlyIfDifferent = false;
@@ -212,6 +591,26 @@ main(int argc, char** argv)
 
   bool errorTest = false;
 
+  bool watch = false;
+
+  std::vector<std::string> modulePaths;
+
+  std::string interfacePath;
+
+  bool timePasses = false;
+
+  bool printStats = false;
+
+  bool costReport = false;
+
+  std::string statsJsonPath;
+
+  std::string sourcePath;
+
+  bool lineDirectives = false;
+
+  std::string sourceMapPath;
+
   for (int i = 1; i < argc; i++) {
     if ((strcmp(argv[i], "--output") == 0) || (strcmp(argv[i], "-o") == 0)) {
       if ((i + 1) >= argc) {
@@ -221,10 +620,97 @@ main(int argc, char** argv)
       }
       output_path = argv[i + 1];
       i++;
+    } else if (strcmp(argv[i], "--cache-dir") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      cacheDir = argv[i + 1];
+      i++;
+    } else if ((strcmp(argv[i], "--module-path") == 0) ||
+               (strcmp(argv[i], "-I") == 0)) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      modulePaths.emplace_back(argv[i + 1]);
+      i++;
+    } else if (strcmp(argv[i], "--emit-interface") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      interfacePath = argv[i + 1];
+      i++;
+    } else if (strcmp(argv[i], "--instrument") == 0) {
+      genOptions.instrument = true;
+    } else if (strcmp(argv[i], "--entry-table") == 0) {
+      genOptions.entryTable = true;
+    } else if (strcmp(argv[i], "--isa-variants") == 0) {
+      genOptions.isaVariants = true;
+    } else if (strcmp(argv[i], "--no-call-hints") == 0) {
+      genOptions.callHints = false;
+    } else if (strcmp(argv[i], "--line-directives") == 0) {
+      lineDirectives = true;
+    } else if (strcmp(argv[i], "--source-map") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      sourceMapPath = argv[i + 1];
+      lineDirectives = true;
+      i++;
+    } else if (strcmp(argv[i], "--source-output") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      sourcePath = argv[i + 1];
+      i++;
+    } else if (strcmp(argv[i], "--instantiate") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::string types(argv[i + 1]);
+      auto comma = types.find(',');
+      if ((comma == 0) || (comma == std::string::npos) ||
+          ((comma + 1) == types.size())) {
+        std::cerr << argv[0] << ": '" << types
+                  << "' is not a pair of scalar types (expected "
+                     "'<FLOAT_TYPE>,<INT_TYPE>')"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      genOptions.instantiations.emplace_back(
+        ScalarTypes{ types.substr(0, comma), types.substr(comma + 1) });
+      i++;
+    } else if (strcmp(argv[i], "--time-passes") == 0) {
+      timePasses = true;
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      printStats = true;
+    } else if (strcmp(argv[i], "--cost-report") == 0) {
+      costReport = true;
+    } else if (strcmp(argv[i], "--stats-json") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      statsJsonPath = argv[i + 1];
+      i++;
     } else if (strcmp(argv[i], "--only-if-different") == 0) {
       onlyIfDifferent = true;
     } else if (strcmp(argv[i], "--syntax-only") == 0) {
       syntaxOnly = true;
+    } else if (strcmp(argv[i], "--watch") == 0) {
+      watch = true;
     } else if (strcmp(argv[i], "--error-test") == 0) {
       errorTest = true;
     } else if ((strcmp(argv[i], "--language") == 0) ||
@@ -236,6 +722,23 @@ main(int argc, char** argv)
       }
       lang = argv[i + 1];
       i++;
+    } else if (strcmp(argv[i], "--math") == 0) {
+      if ((i + 1) >= argc) {
+        std::cerr << argv[0] << ": '" << argv[i] << "' requires an argument"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (strcmp(argv[i + 1], "precise") == 0) {
+        genOptions.mathMode = MathMode::Precise;
+      } else if (strcmp(argv[i + 1], "fast") == 0) {
+        genOptions.mathMode = MathMode::Fast;
+      } else {
+        std::cerr << argv[0] << ": '" << argv[i + 1]
+                  << "' is not a math mode (expected 'precise' or 'fast')"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      i++;
     } else if (strcmp(argv[i], "--list-dependencies") == 0) {
       listDependencies = true;
     } else if ((strcmp(argv[i], "--help") == 0) ||
@@ -255,8 +758,6 @@ main(int argc, char** argv)
     }
   }
 
-  std::ostringstream output_stream;
-
   if (lang.empty()) {
     std::cerr << argv[0]
               << ": specify output language with '-l' or '--language'"
@@ -264,16 +765,78 @@ main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  std::unique_ptr<Generator> gen;
-
-  if (lang == "cxx") {
-    gen.reset(new cpp::Generator(output_stream));
-  } else {
+  if ((lang != "cxx") && (lang != "bytecode") && (lang != "c-simd")) {
     std::cerr << argv[0] << ": '" << lang << "' is not a supported language."
               << std::endl;
     return EXIT_FAILURE;
   }
 
+  if (!sourcePath.empty() && output_path.empty()) {
+    std::cerr << argv[0] << ": '--source-output' requires an output path"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (lineDirectives && output_path.empty()) {
+    std::cerr << argv[0] << ": '"
+              << (sourceMapPath.empty() ? "--line-directives" : "--source-map")
+              << "' requires an output path" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (sourcePath.empty() && !genOptions.instantiations.empty()) {
+    std::cerr << argv[0] << ": '--instantiate' requires '--source-output'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((lang != "cxx") &&
+      (!sourcePath.empty() || lineDirectives || genOptions.instrument ||
+       genOptions.entryTable || !genOptions.callHints)) {
+    const char* option = "--entry-table";
+    if (!genOptions.callHints)
+      option = "--no-call-hints";
+    else if (!sourcePath.empty())
+      option = "--source-output";
+    else if (lineDirectives)
+      option = "--line-directives";
+    else if (genOptions.instrument)
+      option = "--instrument";
+    std::cerr << argv[0] << ": '" << option << "' only applies to C++"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The vector code only has the C library's functions, which are precise.
+  if ((lang == "c-simd") && (genOptions.mathMode == MathMode::Fast)) {
+    std::cerr << argv[0] << ": '--math fast' isn't supported by 'c-simd'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((lang != "c-simd") && genOptions.isaVariants) {
+    std::cerr << argv[0] << ": '--isa-variants' only applies to 'c-simd'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!sourcePath.empty() && genOptions.entryTable) {
+    std::cerr << argv[0]
+              << ": '--entry-table' can't be combined with '--source-output'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!sourcePath.empty() && genOptions.instantiations.empty())
+    genOptions.instantiations.emplace_back(ScalarTypes{ "float", "int" });
+
+  if (watch && (errorTest || listDependencies)) {
+    std::cerr << argv[0] << ": '--watch' can't be combined with '"
+              << (errorTest ? "--error-test" : "--list-dependencies") << "'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::string main_path;
 
   if (!source_path.empty())
@@ -281,85 +844,332 @@ main(int argc, char** argv)
   else
     main_path = "main.pt";
 
-  std::unique_ptr<ConsoleDiagObserver> diagObserver;
+  TranspileCache cache(cacheDir);
 
-  std::ostringstream errorTestStream;
+  std::unique_ptr<FileWatcher> watcher;
 
-  if (errorTest)
-    diagObserver = ConsoleDiagObserver::Make(errorTestStream);
-  else
-    diagObserver = ConsoleDiagObserver::Make(std::cerr);
+  // The files that the last run depended on. Only the source is known
+  // before the first run, or when the output was cached, which only happens
+  // when no modules can be imported.
+  std::set<std::string> watchedPaths{ main_path };
 
-  Transpiler transpiler(
-    argv[0], gen.release(), std::cout, diagObserver.release());
+  // The watch starts before the first run, so that changes made during it
+  // aren't missed.
+  if (watch) {
 
-  if (listDependencies)
-    transpiler.DisableCodeGen();
+    watcher = FileWatcher::Make(watchedPaths);
 
-  if (!transpiler.BeginFile(main_path.c_str()))
-    return EXIT_FAILURE;
+    if (!watcher) {
+      std::cerr << argv[0] << ": failed to watch '" << main_path << "' ("
+                << strerror(errno) << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Each run starts from scratch, since the transpiler keeps no state that
+  // would be valid after the source changes.
+  auto transpile = [&]() -> int {
+    // The pool keeps its blocks between runs, but the statistics are of this
+    // run only.
+    NodePool::ResetStats();
+
+    // The names are freed with the modules of this run, instead of piling up
+    // for as long as the watch runs.
+    SymbolPool::Scope symbolScope(std::make_shared<SymbolPool>());
+
+    std::ostringstream output_stream;
 
-  transpiler.Parse();
+    std::unique_ptr<Generator> gen;
 
-  transpiler.EndFile();
+    if (lang == "bytecode")
+      gen.reset(new bytecode::Generator(output_stream, genOptions));
+    else if (lang == "c-simd")
+      gen.reset(new csimd::Generator(output_stream, genOptions));
+    else
+      gen.reset(new cpp::Generator(output_stream, genOptions));
 
-  if (errorTest) {
+    std::optional<std::string> cacheKey;
 
-    auto errorTestSuccess = true;
+    if (!cacheDir.empty() && !output_path.empty() && !errorTest &&
+        !listDependencies && !syntaxOnly && modulePaths.empty() &&
+        interfacePath.empty() && !timePasses && !printStats &&
+        statsJsonPath.empty() && sourcePath.empty() && !lineDirectives &&
+        !costReport) {
 
-    if (transpiler.get_error_flag() != true) {
-      std::cerr << "failed to detect error" << std::endl;
-      errorTestSuccess = false;
+      cacheKey = MakeCacheKey(argv[0], main_path, lang, genOptions, !watch);
+
+      if (cacheKey && cache.Fetch(*cacheKey, output_path, onlyIfDifferent))
+        return EXIT_SUCCESS;
     }
 
-    errorTestSuccess &= VerifyErrorTest(errorTestStream.str());
+    std::unique_ptr<ConsoleDiagObserver> diagObserver;
 
-    return errorTestSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
-  }
+    std::ostringstream errorTestStream;
 
-  if (transpiler.get_error_flag())
-    return EXIT_FAILURE;
+    if (errorTest)
+      diagObserver = ConsoleDiagObserver::Make(errorTestStream);
+    else
+      diagObserver = ConsoleDiagObserver::Make(std::cerr);
 
-  if (listDependencies) {
+    Transpiler transpiler(
+      argv[0], gen.release(), std::cout, diagObserver.release());
 
-    auto deps = transpiler.Dependencies();
+    if (listDependencies)
+      transpiler.DisableCodeGen();
 
-    for (const auto& dep : deps)
-      std::cout << dep << std::endl;
+    transpiler.SetMathMode(genOptions.mathMode);
 
-    return EXIT_SUCCESS;
-  }
+    // Editors may truncate and rewrite the source while a watch is running,
+    // which would crash a process that has it mapped.
+    if (watch)
+      transpiler.DisableFileMapping();
 
-  if (syntaxOnly) {
-    return EXIT_SUCCESS;
-  }
+    transpiler.SetModulePaths(modulePaths);
 
-  if (output_path.empty()) {
-    std::cout << output_stream.str();
-    return EXIT_FAILURE;
-  }
+    if (printStats || !statsJsonPath.empty())
+      transpiler.EnableStats();
+
+    if (costReport)
+      transpiler.EnableCostAnalysis();
+
+    std::ostringstream source_stream;
+
+    if (!sourcePath.empty()) {
+      auto* sourceGen = new cpp::Generator(source_stream, genOptions);
+
+      transpiler.SetSourceGenerator(sourceGen, GetFileName(output_path));
+    }
+
+    if (!interfacePath.empty())
+      transpiler.EnableInterface();
+
+    if (lineDirectives)
+      transpiler.EnableLineDirectives();
+
+    if (!interfacePath.empty() && output_path.empty()) {
+      transpiler.DisableEntryPoints();
+      transpiler.DisableCodeGen();
+    }
+
+    if (!transpiler.BeginFile(main_path.c_str()))
+      return EXIT_FAILURE;
+
+    transpiler.Parse();
+
+    transpiler.EndFile();
+
+    watchedPaths = transpiler.WatchedPaths();
+
+    if (timePasses)
+      PrintPassTimings(std::cerr, transpiler.GetPassTimer().Timings());
+
+    if (costReport && transpiler.GetCostAnalysis() &&
+        !transpiler.get_error_flag())
+      PrintCostReport(std::cerr, *transpiler.GetCostAnalysis());
+
+    if (printStats || !statsJsonPath.empty()) {
+
+      TranspileStats stats;
+
+      stats.passTimings = transpiler.GetPassTimer().Timings();
+
+      stats.moduleStats = transpiler.GetModuleStats();
+
+      stats.nodePoolStats = NodePool::GetStats();
+
+      stats.peakMemoryUsage = GetPeakMemoryUsage();
 
-  auto output_str = output_stream.str();
+      stats.outputSize = size_t(output_stream.tellp());
 
-  if (onlyIfDifferent) {
+      if (printStats)
+        PrintStats(std::cerr, stats);
 
-    auto existing = ReadWholeFile(output_path.c_str());
+      std::ostringstream statsJson;
+
+      PrintStatsJson(statsJson, stats);
+
+      if (!statsJsonPath.empty() &&
+          !ReplaceFile(statsJsonPath, statsJson.str())) {
+        std::cerr << argv[0] << ": failed to write '" << statsJsonPath
+                  << "' (" << strerror(errno) << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (errorTest) {
+
+      auto errorTestSuccess = true;
+
+      if (transpiler.get_error_flag() != true) {
+        std::cerr << "failed to detect error" << std::endl;
+        errorTestSuccess = false;
+      }
+
+      errorTestSuccess &= VerifyErrorTest(errorTestStream.str());
+
+      return errorTestSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (transpiler.get_error_flag())
+      return EXIT_FAILURE;
+
+    if (listDependencies) {
+
+      auto deps = transpiler.Dependencies();
+
+      for (const auto& dep : deps)
+        std::cout << dep << std::endl;
 
-    if (existing == output_str)
       return EXIT_SUCCESS;
-  }
+    }
+
+    if (syntaxOnly) {
+      return EXIT_SUCCESS;
+    }
 
-  std::ofstream output_file(output_path.c_str());
+    if (!interfacePath.empty()) {
 
-  if (!output_file.good()) {
-    std::cerr << argv[0] << ": failed to open '" << output_path << "' ("
-              << strerror(errno) << ")" << std::endl;
-    return EXIT_FAILURE;
-  }
+      if (!ReplaceFile(interfacePath, transpiler.GetInterface())) {
+        std::cerr << argv[0] << ": failed to write '" << interfacePath
+                  << "' (" << strerror(errno) << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      if (output_path.empty())
+        return EXIT_SUCCESS;
+    }
+
+    if (output_path.empty()) {
+      std::cout << output_stream.str();
+      return EXIT_FAILURE;
+    }
+
+    auto output_str = output_stream.str();
+
+    auto source_str = source_stream.str();
+
+    if (lineDirectives) {
+
+      std::vector<SourceMapFile> sourceMapFiles;
+
+      sourceMapFiles.emplace_back(SourceMapFile{
+        output_path, ResolveLineDirectives(output_str, output_path) });
+
+      if (!sourcePath.empty()) {
+        sourceMapFiles.emplace_back(SourceMapFile{
+          sourcePath, ResolveLineDirectives(source_str, sourcePath) });
+      }
+
+      std::ostringstream sourceMap;
+
+      WriteSourceMap(sourceMap, main_path, sourceMapFiles);
+
+      if (!sourceMapPath.empty() &&
+          !ReplaceFile(sourceMapPath, sourceMap.str())) {
+        std::cerr << argv[0] << ": failed to write '" << sourceMapPath
+                  << "' (" << strerror(errno) << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (cacheKey)
+      cache.Store(*cacheKey, output_str);
+
+    if (!sourcePath.empty()) {
+
+      if (!onlyIfDifferent ||
+          (ReadWholeFile(sourcePath.c_str()) != source_str)) {
+
+        if (!ReplaceFile(sourcePath, source_str)) {
+          std::cerr << argv[0] << ": failed to write '" << sourcePath << "' ("
+                    << strerror(errno) << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    if (onlyIfDifferent) {
+
+      auto existing = ReadWholeFile(output_path.c_str());
+
+      if (existing == output_str)
+        return EXIT_SUCCESS;
+    }
+
+    // The output is replaced instead of being written in place, so that it's
+    // never partially written.
+    if (!ReplaceFile(output_path, output_str)) {
+      std::cerr << argv[0] << ": failed to write '" << output_path << "' ("
+                << strerror(errno) << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  };
+
+  auto status = transpile();
+
+  if (!watch)
+    return status;
+
+  std::map<std::string, std::optional<std::string>> lastSources;
+
+  // Keeps the contents that the run was started with, and reads the files
+  // that it started to depend on.
+  auto updateSources = [&]() {
+    std::map<std::string, std::optional<std::string>> sources;
 
-  output_file << output_str;
+    for (const auto& path : watchedPaths) {
 
-  return EXIT_SUCCESS;
+      auto it = lastSources.find(path);
+
+      if (it != lastSources.end())
+        sources[path] = std::move(it->second);
+      else
+        sources[path] = ReadWholeFile(path.c_str());
+    }
+
+    lastSources = std::move(sources);
+  };
+
+  updateSources();
+
+  for (;;) {
+
+    // The imports may have changed, and with them the interfaces to watch.
+    if (watcher->GetPaths() != watchedPaths) {
+
+      watcher = FileWatcher::Make(watchedPaths);
+
+      if (!watcher) {
+        std::cerr << argv[0] << ": failed to watch the imported modules of '"
+                  << main_path << "' (" << strerror(errno) << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (!watcher->Wait()) {
+      std::cerr << argv[0] << ": failed to watch '" << main_path << "' ("
+                << strerror(errno) << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Editors often save files that haven't changed, which doesn't need a new
+    // output.
+    std::map<std::string, std::optional<std::string>> sources;
+
+    for (const auto& path : watchedPaths)
+      sources[path] = ReadWholeFile(path.c_str());
+
+    if (sources == lastSources)
+      continue;
+
+    lastSources = std::move(sources);
+
+    transpile();
+
+    updateSources();
+  }
 }
 
 namespace {
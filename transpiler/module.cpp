@@ -1,5 +1,7 @@
 #include "module.h"
 
+#include <algorithm>
+
 void
 Module::AcceptDeclVisitor(DeclVisitor& visitor) const
 {
@@ -13,6 +15,8 @@ Module::AppendFunc(FuncDecl* f)
 {
   mFuncs.emplace_back(f);
 
+  mFuncIndex[f->GetSymbol()].emplace_back(f);
+
   mDeclList.emplace_back(f);
 }
 
@@ -23,6 +27,8 @@ Module::AppendGlobalVar(VarDecl* globalVar)
 
   mGlobalVars.emplace_back(globalVar);
 
+  mGlobalVarIndex.emplace(globalVar->GetSymbol(), globalVar);
+
   switch (globalVar->GetVariability()) {
     case Variability::Uniform:
       mUniformGlobalVars.emplace_back(globalVar);
@@ -44,6 +50,26 @@ Module::AppendModuleImportDecl(ModuleImportDecl* importDecl)
   mDeclList.emplace_back(importDecl);
 }
 
+void
+Module::Import(std::unique_ptr<Module> imported)
+{
+  for (auto& symbolPool : imported->mSymbolPools) {
+    if (std::find(mSymbolPools.begin(), mSymbolPools.end(), symbolPool) ==
+        mSymbolPools.end())
+      mSymbolPools.emplace_back(symbolPool);
+  }
+
+  for (auto& globalVar : imported->mGlobalVars) {
+    mImportedDecls.emplace(globalVar.get());
+    AppendGlobalVar(globalVar.release());
+  }
+
+  for (auto& func : imported->mFuncs) {
+    mImportedDecls.emplace(func.get());
+    AppendFunc(func.release());
+  }
+}
+
 void
 Module::SetModuleExportDecl(ModuleExportDecl* moduleExportDecl)
 {
@@ -52,6 +78,24 @@ Module::SetModuleExportDecl(ModuleExportDecl* moduleExportDecl)
   mDeclList.emplace_back(moduleExportDecl);
 }
 
+auto
+Module::FindFuncs(Symbol name) const -> const std::vector<const FuncDecl*>&
+{
+  static const std::vector<const FuncDecl*> noFuncs;
+
+  auto it = mFuncIndex.find(name);
+
+  return (it == mFuncIndex.end()) ? noFuncs : it->second;
+}
+
+auto
+Module::FindGlobalVar(Symbol name) const -> const VarDecl*
+{
+  auto it = mGlobalVarIndex.find(name);
+
+  return (it == mGlobalVarIndex.end()) ? nullptr : it->second;
+}
+
 std::string
 Module::GetModuleName() const
 {
@@ -2,13 +2,30 @@
 
 #include "abort.h"
 #include "decl.h"
+#include "symbol.h"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class Module final
 {
 public:
+  /// @param symbols The pool of the symbols of the module's declarations,
+  /// which the module keeps alive.
+  explicit Module(
+    std::shared_ptr<SymbolPool> symbols = SymbolPool::Current()) noexcept
+    : mSymbolPools{ std::move(symbols) }
+  {}
+
+  /// @brief Gets the pool that the symbols of the module come from.
+  const std::shared_ptr<SymbolPool>& GetSymbolPool() const noexcept
+  {
+    return mSymbolPools[0];
+  }
+
   void AcceptDeclVisitor(DeclVisitor& v) const;
 
   void AppendFunc(FuncDecl* f);
@@ -17,6 +34,19 @@ public:
 
   void AppendModuleImportDecl(ModuleImportDecl* importDecl);
 
+  /// @brief Moves the functions and global variables of an imported module
+  /// into this one, so that they are resolved and generated like the ones
+  /// declared here.
+  void Import(std::unique_ptr<Module> imported);
+
+  /// @brief Indicates whether a declaration came from an imported module.
+  bool IsImported(const Decl& decl) const
+  {
+    return mImportedDecls.count(&decl) != 0;
+  }
+
+  const auto& ModuleImports() const noexcept { return mModuleImports; }
+
   bool HasModuleExportDecl() const noexcept
   {
     return !mModuleExportDecls.empty();
@@ -30,6 +60,15 @@ public:
 
   const auto& VaryingGlobalVars() const noexcept { return mVaryingGlobalVars; }
 
+  /// @brief Finds all the functions with a given name, in the order they are
+  /// declared in.
+  auto FindFuncs(Symbol name) const -> const std::vector<const FuncDecl*>&;
+
+  /// @brief Finds the first global variable declared with a given name.
+  ///
+  /// @return The variable, or null if there isn't one.
+  auto FindGlobalVar(Symbol name) const -> const VarDecl*;
+
   const ModuleExportDecl& GetModuleExportDecl() const noexcept
   {
     if (mModuleExportDecls.empty()) {
@@ -44,6 +83,11 @@ public:
   std::string GetModuleName() const;
 
 private:
+  /// @brief The pool of the module's symbols, followed by the pools of the
+  /// modules it imported, if they were different. These are declared first
+  /// so that they are destroyed after the declarations that refer to them.
+  std::vector<std::shared_ptr<SymbolPool>> mSymbolPools;
+
   /// @brief Contains the module declarations in the order that they appear in
   /// the file.
   std::vector<const Decl*> mDeclList;
@@ -61,4 +105,12 @@ private:
   std::vector<const VarDecl*> mVaryingGlobalVars;
 
   std::vector<const VarDecl*> mUniformGlobalVars;
+
+  /// @brief Maps names to functions, so that resolving a call doesn't require
+  /// a search through every function.
+  std::unordered_map<Symbol, std::vector<const FuncDecl*>> mFuncIndex;
+
+  std::unordered_map<Symbol, const VarDecl*> mGlobalVarIndex;
+
+  std::unordered_set<const Decl*> mImportedDecls;
 };
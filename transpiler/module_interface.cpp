@@ -0,0 +1,846 @@
+#include "module_interface.h"
+
+#include "decl.h"
+#include "diagnostics.h"
+#include "module.h"
+#include "source_buffer.h"
+
+#include <set>
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+/// @brief Identifies the format of the interface. The number is changed
+/// whenever the format changes, so that old interfaces are rejected instead
+/// of being misread.
+constexpr std::string_view gMagic = "pathway module interface 1";
+
+/// @brief Guards the reader against interfaces nested deeper than any parsed
+/// module could be.
+constexpr size_t gMaxDepth = 10000;
+
+enum class DeclTag : uint8_t
+{
+  VarDecl,
+  FuncDecl
+};
+
+enum class StmtTag : uint8_t
+{
+  AssignmentStmt,
+  CompoundStmt,
+  DeclStmt,
+  ReturnStmt
+};
+
+enum class ExprTag : uint8_t
+{
+  IntLiteral,
+  BoolLiteral,
+  FloatLiteral,
+  BinaryExpr,
+  UnaryExpr,
+  GroupExpr,
+  VarRef,
+  FuncCall,
+  TypeConstructor,
+  MemberExpr
+};
+
+/// @brief Writes the parts of a module. Integers are written in little endian
+/// order and strings are prefixed with their size.
+class InterfaceWriter final
+  : public DeclVisitor
+  , public StmtVisitor
+  , public ExprVisitor
+{
+public:
+  InterfaceWriter(const Module& module)
+    : mModule(module)
+  {}
+
+  std::string TakeData() { return std::move(mData); }
+
+  void WriteModuleName(const ModuleName& moduleName)
+  {
+    WriteU32(moduleName.Identifiers().size());
+
+    for (const auto& identifier : moduleName.Identifiers())
+      WriteString(identifier.Name());
+  }
+
+  void WriteU8(uint8_t value) { mData.push_back(char(value)); }
+
+  void WriteU32(uint32_t value)
+  {
+    for (int i = 0; i < 4; i++)
+      WriteU8(uint8_t(value >> (i * 8)));
+  }
+
+  void WriteU64(uint64_t value)
+  {
+    for (int i = 0; i < 8; i++)
+      WriteU8(uint8_t(value >> (i * 8)));
+  }
+
+  void WriteString(std::string_view str)
+  {
+    WriteU32(str.size());
+
+    mData.append(str);
+  }
+
+  void Visit(const FuncDecl& funcDecl) override
+  {
+    if (mModule.IsImported(funcDecl))
+      return;
+
+    WriteU8(uint8_t(DeclTag::FuncDecl));
+
+    WriteType(funcDecl.ReturnType());
+
+    WriteString(funcDecl.Identifier());
+
+    WriteU32(funcDecl.GetParamList().size());
+
+    for (const auto& param : funcDecl.GetParamList()) {
+      WriteType(param->GetType());
+      WriteString(param->Identifier());
+    }
+
+    funcDecl.AcceptBodyVisitor(*this);
+  }
+
+  void Visit(const VarDecl& varDecl) override
+  {
+    if (mModule.IsImported(varDecl))
+      return;
+
+    WriteU8(uint8_t(DeclTag::VarDecl));
+
+    WriteVarDecl(varDecl);
+  }
+
+  void Visit(const ModuleExportDecl&) override {}
+
+  void Visit(const ModuleImportDecl&) override {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    WriteU8(uint8_t(StmtTag::AssignmentStmt));
+
+    assignmentStmt.LValue().AcceptVisitor(*this);
+
+    assignmentStmt.RValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    WriteU8(uint8_t(StmtTag::CompoundStmt));
+
+    WriteU32(compoundStmt.Stmts().size());
+
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    WriteU8(uint8_t(StmtTag::DeclStmt));
+
+    WriteVarDecl(declStmt.GetVarDecl());
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    WriteU8(uint8_t(StmtTag::ReturnStmt));
+
+    returnStmt.ReturnValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const IntLiteral& intLiteral) override
+  {
+    WriteU8(uint8_t(ExprTag::IntLiteral));
+
+    WriteU64(intLiteral.Value());
+  }
+
+  void Visit(const BoolLiteral& boolLiteral) override
+  {
+    WriteU8(uint8_t(ExprTag::BoolLiteral));
+
+    WriteU8(boolLiteral.Value());
+  }
+
+  void Visit(const FloatLiteral& floatLiteral) override
+  {
+    WriteU8(uint8_t(ExprTag::FloatLiteral));
+
+    auto value = floatLiteral.Value();
+
+    uint64_t bits = 0;
+
+    static_assert(sizeof(bits) == sizeof(value));
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    WriteU64(bits);
+  }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    WriteU8(uint8_t(ExprTag::BinaryExpr));
+
+    WriteU8(uint8_t(binaryExpr.GetKind()));
+
+    binaryExpr.Recurse(*this);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    WriteU8(uint8_t(ExprTag::UnaryExpr));
+
+    WriteU8(uint8_t(unaryExpr.GetKind()));
+
+    unaryExpr.Recurse(*this);
+  }
+
+  void Visit(const GroupExpr& groupExpr) override
+  {
+    WriteU8(uint8_t(ExprTag::GroupExpr));
+
+    groupExpr.Recurse(*this);
+  }
+
+  void Visit(const VarRef& varRef) override
+  {
+    WriteU8(uint8_t(ExprTag::VarRef));
+
+    WriteString(varRef.Identifier());
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    WriteU8(uint8_t(ExprTag::FuncCall));
+
+    WriteString(funcCall.Identifier());
+
+    WriteU32(funcCall.Args().size());
+
+    funcCall.Recurse(*this);
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    WriteU8(uint8_t(ExprTag::TypeConstructor));
+
+    WriteType(*typeConstructor.GetType());
+
+    WriteU32(typeConstructor.Args().size());
+
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    WriteU8(uint8_t(ExprTag::MemberExpr));
+
+    memberExpr.Recurse(*this);
+
+    WriteString(memberExpr.MemberName().Identifier());
+  }
+
+private:
+  void WriteType(const Type& type)
+  {
+    WriteU8(uint8_t(type.ID()));
+
+    WriteU8(uint8_t(type.GetVariability()));
+  }
+
+  void WriteVarDecl(const VarDecl& varDecl)
+  {
+    WriteType(varDecl.GetType());
+
+    WriteString(varDecl.Identifier());
+
+    WriteU8(varDecl.HasInitExpr());
+
+    if (varDecl.HasInitExpr())
+      varDecl.InitExpr().AcceptVisitor(*this);
+  }
+
+  const Module& mModule;
+
+  std::string mData;
+};
+
+/// @brief Reads the parts of a module.
+///
+/// @detail Reading past the end of the data or finding an unknown value sets
+/// an error flag, after which every read returns an empty value, so that the
+/// error only has to be checked once a whole node has been read.
+class InterfaceReader final
+{
+public:
+  InterfaceReader(std::string_view data,
+                  const Location& location,
+                  SymbolPool& symbolPool)
+    : mData(data)
+    , mLocation(location)
+    , mSymbolPool(symbolPool)
+  {}
+
+  bool Failed() const noexcept { return mFailed; }
+
+  bool AtEnd() const noexcept { return mOffset == mData.size(); }
+
+  uint8_t ReadU8()
+  {
+    if (mFailed || (mOffset >= mData.size())) {
+      mFailed = true;
+      return 0;
+    }
+
+    return uint8_t(mData[mOffset++]);
+  }
+
+  uint32_t ReadU32()
+  {
+    uint32_t value = 0;
+
+    for (int i = 0; i < 4; i++)
+      value |= uint32_t(ReadU8()) << (i * 8);
+
+    return value;
+  }
+
+  uint64_t ReadU64()
+  {
+    uint64_t value = 0;
+
+    for (int i = 0; i < 8; i++)
+      value |= uint64_t(ReadU8()) << (i * 8);
+
+    return value;
+  }
+
+  std::string_view ReadString()
+  {
+    auto size = ReadU32();
+
+    if (mFailed || (size > (mData.size() - mOffset))) {
+      mFailed = true;
+      return std::string_view();
+    }
+
+    auto str = mData.substr(mOffset, size);
+
+    mOffset += size;
+
+    return str;
+  }
+
+  DeclName ReadDeclName()
+  {
+    return DeclName(mSymbolPool.Intern(ReadString()), mLocation);
+  }
+
+  ModuleName* ReadModuleName()
+  {
+    auto moduleName = std::make_unique<ModuleName>();
+
+    auto count = ReadU32();
+
+    for (uint32_t i = 0; (i < count) && !mFailed; i++)
+      moduleName->Append(mSymbolPool.Intern(ReadString()), mLocation);
+
+    return mFailed ? nullptr : moduleName.release();
+  }
+
+  Type* ReadType()
+  {
+    auto typeID = ReadU8();
+
+    auto variability = ReadU8();
+
+    if ((typeID > uint8_t(TypeID::Mat4)) ||
+        (variability > uint8_t(Variability::Varying)))
+      mFailed = true;
+
+    if (mFailed)
+      return nullptr;
+
+    return new Type(TypeID(typeID), Variability(variability));
+  }
+
+  VarDecl* ReadVarDecl()
+  {
+    std::unique_ptr<Type> type(ReadType());
+
+    auto name = ReadDeclName();
+
+    UniqueExprPtr initExpr;
+
+    if (ReadU8())
+      initExpr = ReadExpr();
+
+    if (mFailed)
+      return nullptr;
+
+    return new VarDecl(type.release(), std::move(name), initExpr.release());
+  }
+
+  FuncDecl* ReadFuncDecl()
+  {
+    std::unique_ptr<Type> returnType(ReadType());
+
+    auto name = ReadDeclName();
+
+    auto params = std::make_unique<ParamList>();
+
+    auto paramCount = ReadU32();
+
+    for (uint32_t i = 0; (i < paramCount) && !mFailed; i++) {
+
+      std::unique_ptr<Type> paramType(ReadType());
+
+      auto paramName = ReadDeclName();
+
+      if (!mFailed)
+        params->emplace_back(
+          new VarDecl(paramType.release(), std::move(paramName), nullptr));
+    }
+
+    auto body = ReadStmt();
+
+    if (mFailed)
+      return nullptr;
+
+    return new FuncDecl(
+      returnType.release(), std::move(name), params.release(), body.release());
+  }
+
+  UniqueStmtPtr ReadStmt()
+  {
+    DepthGuard depthGuard(*this);
+
+    if (mFailed)
+      return nullptr;
+
+    switch (StmtTag(ReadU8())) {
+      case StmtTag::AssignmentStmt: {
+        auto lValue = ReadExpr();
+        auto rValue = ReadExpr();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<AssignmentStmt>(
+          lValue.release(), rValue.release(), mLocation);
+      }
+      case StmtTag::CompoundStmt: {
+        auto stmts = std::make_unique<StmtList>();
+        auto count = ReadU32();
+        for (uint32_t i = 0; (i < count) && !mFailed; i++)
+          stmts->emplace_back(ReadStmt());
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<CompoundStmt>(stmts.release(), mLocation);
+      }
+      case StmtTag::DeclStmt: {
+        auto* varDecl = ReadVarDecl();
+        if (!varDecl)
+          return nullptr;
+        return std::make_unique<DeclStmt>(varDecl, mLocation);
+      }
+      case StmtTag::ReturnStmt: {
+        auto returnValue = ReadExpr();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<ReturnStmt>(returnValue.release(),
+                                            mLocation);
+      }
+    }
+
+    mFailed = true;
+
+    return nullptr;
+  }
+
+  UniqueExprPtr ReadExpr()
+  {
+    DepthGuard depthGuard(*this);
+
+    if (mFailed)
+      return nullptr;
+
+    switch (ExprTag(ReadU8())) {
+      case ExprTag::IntLiteral: {
+        auto value = ReadU64();
+        return std::make_unique<IntLiteral>(value, mLocation);
+      }
+      case ExprTag::BoolLiteral: {
+        auto value = ReadU8();
+        if (value > 1)
+          break;
+        return std::make_unique<BoolLiteral>(value == 1, mLocation);
+      }
+      case ExprTag::FloatLiteral: {
+        auto bits = ReadU64();
+        double value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        return std::make_unique<FloatLiteral>(value, mLocation);
+      }
+      case ExprTag::BinaryExpr: {
+        auto kind = ReadU8();
+        if (kind > uint8_t(BinaryExpr::Kind::Mod))
+          break;
+        auto left = ReadExpr();
+        auto right = ReadExpr();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<BinaryExpr>(
+          left.release(), right.release(), BinaryExpr::Kind(kind), mLocation);
+      }
+      case ExprTag::UnaryExpr: {
+        auto kind = ReadU8();
+        if (kind > uint8_t(UnaryExpr::Kind::Negate))
+          break;
+        auto base = ReadExpr();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<UnaryExpr>(
+          base.release(), UnaryExpr::Kind(kind), mLocation);
+      }
+      case ExprTag::GroupExpr: {
+        auto inner = ReadExpr();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<GroupExpr>(inner.release(), mLocation);
+      }
+      case ExprTag::VarRef: {
+        auto name = ReadDeclName();
+        return std::make_unique<VarRef>(std::move(name));
+      }
+      case ExprTag::FuncCall: {
+        auto name = ReadDeclName();
+        auto args = ReadExprList();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<FuncCall>(
+          std::move(name), args.release(), mLocation);
+      }
+      case ExprTag::TypeConstructor: {
+        std::unique_ptr<Type> type(ReadType());
+        auto args = ReadExprList();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<TypeConstructor>(
+          *type, args.release(), mLocation);
+      }
+      case ExprTag::MemberExpr: {
+        auto base = ReadExpr();
+        auto member = ReadDeclName();
+        if (mFailed)
+          return nullptr;
+        return std::make_unique<MemberExpr>(
+          base.release(), std::move(member), mLocation);
+      }
+    }
+
+    mFailed = true;
+
+    return nullptr;
+  }
+
+private:
+  /// @brief Counts how deeply nested the node being read is.
+  class DepthGuard final
+  {
+  public:
+    DepthGuard(InterfaceReader& reader)
+      : mReader(reader)
+    {
+      if (++mReader.mDepth > gMaxDepth)
+        mReader.mFailed = true;
+    }
+
+    ~DepthGuard() { mReader.mDepth--; }
+
+  private:
+    InterfaceReader& mReader;
+  };
+
+  auto ReadExprList() -> std::unique_ptr<ExprList>
+  {
+    auto exprList = std::make_unique<ExprList>();
+
+    auto count = ReadU32();
+
+    for (uint32_t i = 0; (i < count) && !mFailed; i++)
+      exprList->emplace_back(ReadExpr());
+
+    return exprList;
+  }
+
+  std::string_view mData;
+
+  size_t mOffset = 0;
+
+  Location mLocation;
+
+  SymbolPool& mSymbolPool;
+
+  size_t mDepth = 0;
+
+  bool mFailed = false;
+};
+
+/// @brief Gets the name of a module the way it is written in the source.
+std::string
+ToSourceName(const ModuleName& moduleName)
+{
+  std::string name;
+
+  for (const auto& identifier : moduleName.Identifiers()) {
+
+    if (!name.empty())
+      name += "::";
+
+    name += identifier.Name();
+  }
+
+  return name;
+}
+
+class ModuleImporter final
+{
+public:
+  ModuleImporter(Module& module,
+                 const std::vector<std::string>& modulePaths,
+                 DiagObserver& diagObserver,
+                 std::set<std::string>* searchedPaths)
+    : mModule(module)
+    , mModulePaths(modulePaths)
+    , mErrorFilter(diagObserver)
+    , mSearchedPaths(searchedPaths)
+  {
+    // A module that imports itself, directly or not, already has its own
+    // declarations.
+    if (module.HasModuleExportDecl()) {
+      mImported.emplace(
+        ToSourceName(module.GetModuleExportDecl().GetModuleName()));
+    }
+  }
+
+  bool Import(const ModuleName& moduleName, const Location& location)
+  {
+    // Names are compared the way they're written, since the names that
+    // identifiers are made of can be the same for different modules.
+    auto name = ToSourceName(moduleName);
+
+    if (!mImported.emplace(name).second)
+      return true;
+
+    auto fileName = GetInterfaceFileName(moduleName);
+
+    std::unique_ptr<SourceBuffer> buffer;
+
+    std::string path;
+
+    for (const auto& modulePath : mModulePaths) {
+
+      path = modulePath + "/" + fileName;
+
+      if (mSearchedPaths)
+        mSearchedPaths->emplace(path);
+
+      buffer = SourceBuffer::Open(path.c_str());
+
+      if (buffer || (errno != ENOENT))
+        break;
+    }
+
+    if (!buffer && ((errno == ENOENT) || mModulePaths.empty())) {
+      Error(location,
+            DiagID::UnresolvedModuleImport,
+            "unable to find module '" + ToSourceName(moduleName) + "'");
+      return false;
+    }
+
+    if (!buffer) {
+      Error(location,
+            DiagID::InvalidModuleInterface,
+            "failed to read '" + path + "' (" + strerror(errno) + ")");
+      return false;
+    }
+
+    auto imported =
+      ReadModuleInterface(buffer->Data(), location, mModule.GetSymbolPool());
+
+    if (!imported) {
+      Error(location,
+            DiagID::InvalidModuleInterface,
+            "'" + path + "' is not a valid module interface");
+      return false;
+    }
+
+    if (!imported->HasModuleExportDecl() ||
+        (ToSourceName(imported->GetModuleExportDecl().GetModuleName()) !=
+         name)) {
+      Error(location,
+            DiagID::InvalidModuleInterface,
+            "'" + path + "' is not the interface of module '" +
+              ToSourceName(moduleName) + "'");
+      return false;
+    }
+
+    for (const auto& importDecl : imported->ModuleImports()) {
+      if (!Import(importDecl->GetModuleName(), location))
+        return false;
+    }
+
+    mModule.Import(std::move(imported));
+
+    return true;
+  }
+
+private:
+  void Error(const Location& location, DiagID id, const std::string& message)
+  {
+    mErrorFilter.EmitDiag(Diag(location, id, message));
+  }
+
+  Module& mModule;
+
+  const std::vector<std::string>& mModulePaths;
+
+  DiagErrorFilter mErrorFilter;
+
+  std::set<std::string>* mSearchedPaths;
+
+  std::set<std::string> mImported;
+};
+
+} // namespace
+
+std::string
+WriteModuleInterface(const Module& module)
+{
+  InterfaceWriter writer(module);
+
+  writer.WriteString(gMagic);
+
+  writer.WriteU8(module.HasModuleExportDecl());
+
+  if (module.HasModuleExportDecl())
+    writer.WriteModuleName(module.GetModuleExportDecl().GetModuleName());
+
+  writer.WriteU32(module.ModuleImports().size());
+
+  for (const auto& importDecl : module.ModuleImports())
+    writer.WriteModuleName(importDecl->GetModuleName());
+
+  size_t declCount = 0;
+
+  for (const auto& globalVar : module.GlobalVars())
+    declCount += module.IsImported(*globalVar) ? 0 : 1;
+
+  for (const auto& func : module.Funcs())
+    declCount += module.IsImported(*func) ? 0 : 1;
+
+  writer.WriteU32(declCount);
+
+  module.AcceptDeclVisitor(writer);
+
+  return writer.TakeData();
+}
+
+auto
+ReadModuleInterface(std::string_view data,
+                    const Location& location,
+                    std::shared_ptr<SymbolPool> symbols)
+  -> std::unique_ptr<Module>
+{
+  InterfaceReader reader(data, location, *symbols);
+
+  if (reader.ReadString() != gMagic)
+    return nullptr;
+
+  auto module = std::make_unique<Module>(std::move(symbols));
+
+  if (reader.ReadU8()) {
+
+    auto* moduleName = reader.ReadModuleName();
+
+    if (!moduleName)
+      return nullptr;
+
+    module->SetModuleExportDecl(new ModuleExportDecl(moduleName));
+  }
+
+  auto importCount = reader.ReadU32();
+
+  for (uint32_t i = 0; (i < importCount) && !reader.Failed(); i++) {
+
+    auto* moduleName = reader.ReadModuleName();
+
+    if (moduleName)
+      module->AppendModuleImportDecl(new ModuleImportDecl(moduleName));
+  }
+
+  auto declCount = reader.ReadU32();
+
+  for (uint32_t i = 0; (i < declCount) && !reader.Failed(); i++) {
+    switch (DeclTag(reader.ReadU8())) {
+      case DeclTag::VarDecl:
+        if (auto* varDecl = reader.ReadVarDecl())
+          module->AppendGlobalVar(varDecl);
+        break;
+      case DeclTag::FuncDecl:
+        if (auto* funcDecl = reader.ReadFuncDecl())
+          module->AppendFunc(funcDecl);
+        break;
+      default:
+        return nullptr;
+    }
+  }
+
+  if (reader.Failed() || !reader.AtEnd())
+    return nullptr;
+
+  return module;
+}
+
+bool
+ImportModules(Module& module,
+              const std::vector<std::string>& modulePaths,
+              DiagObserver& diagObserver,
+              std::set<std::string>* searchedPaths)
+{
+  ModuleImporter importer(module, modulePaths, diagObserver, searchedPaths);
+
+  for (const auto& importDecl : module.ModuleImports()) {
+
+    const auto& moduleName = importDecl->GetModuleName();
+
+    if (!importer.Import(moduleName, moduleName.GetLocation()))
+      return false;
+  }
+
+  return true;
+}
+
+std::string
+GetInterfaceFileName(const ModuleName& moduleName)
+{
+  std::string fileName;
+
+  for (const auto& identifier : moduleName.Identifiers()) {
+    fileName += identifier.Name();
+    fileName += '.';
+  }
+
+  return fileName + "pti";
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "location.h"
+#include "symbol.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DiagObserver;
+class Module;
+class ModuleName;
+
+/// @brief Serializes the declarations of a module into a compact binary
+/// interface, so that the modules importing it don't have to parse it again.
+///
+/// @detail The interface has the module's name, the names of the modules it
+/// imports, and its global variables and functions, with their types and
+/// bodies. Declarations that the module imported itself are left out, since
+/// they are loaded from their own interfaces.
+///
+/// @note This should be called after the module has been checked, so that
+/// only valid modules have interfaces.
+std::string
+WriteModuleInterface(const Module& module);
+
+/// @brief Reads a module interface.
+///
+/// @param location The location given to every node of the module. This is
+/// normally the import declaration, since the interface doesn't refer to
+/// the original sources.
+///
+/// @param symbols The pool that the names of the module are interned into,
+/// which has to be the pool of the module that imports it.
+///
+/// @return Null if the data isn't a valid interface.
+auto
+ReadModuleInterface(std::string_view data,
+                    const Location& location,
+                    std::shared_ptr<SymbolPool> symbols = SymbolPool::Current())
+  -> std::unique_ptr<Module>;
+
+/// @brief Loads the interfaces of the modules imported by a module, and of
+/// the modules they import, and moves their declarations into it.
+///
+/// @detail The interface of a module is the file named by
+/// @ref GetInterfaceFileName, in the first of the module paths that has one.
+/// Each module is only imported once, however many times it is imported.
+///
+/// @param searchedPaths If not null, receives each path that was looked for
+/// an interface, whether it had one or not, since creating or changing any
+/// of them may change what is imported.
+///
+/// @return False if an interface couldn't be found or read, in which case a
+/// diagnostic is emitted.
+bool
+ImportModules(Module& module,
+              const std::vector<std::string>& modulePaths,
+              DiagObserver& diagObserver,
+              std::set<std::string>* searchedPaths = nullptr);
+
+/// @brief Gets the name of the interface file of a module. The names are
+/// joined by periods, which identifiers can't contain, so 'a::b' is 'a.b.pti'
+/// and doesn't clash with 'a_b.pti'.
+std::string
+GetInterfaceFileName(const ModuleName& moduleName);
@@ -0,0 +1,160 @@
+#include "node_pool.h"
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <stdlib.h>
+
+namespace {
+
+/// @brief Every node is aligned to this many bytes, and node sizes are
+/// rounded up to a multiple of it.
+constexpr size_t gGranularity = alignof(max_align_t);
+
+/// @brief Nodes larger than this are allocated from the heap directly.
+constexpr size_t gMaxNodeSize = 512;
+
+constexpr size_t gBlockSize = 64 * 1024;
+
+constexpr size_t gSizeClassCount = gMaxNodeSize / gGranularity;
+
+struct FreeNode final
+{
+  FreeNode* next;
+};
+
+struct SizeClass final
+{
+  /// @brief Nodes that were released and can be handed out again.
+  FreeNode* freeList = nullptr;
+
+  /// @brief The unused part of the most recent block.
+  char* next = nullptr;
+
+  char* end = nullptr;
+};
+
+class Pool final
+{
+public:
+  void* Allocate(size_t sizeClassIndex)
+  {
+    auto& sizeClass = mSizeClasses[sizeClassIndex];
+
+    auto nodeSize = (sizeClassIndex + 1) * gGranularity;
+
+    mStats.allocationCount++;
+
+    mStats.allocatedBytes += nodeSize;
+
+    if (sizeClass.freeList) {
+      auto* node = sizeClass.freeList;
+      sizeClass.freeList = node->next;
+      return node;
+    }
+
+    if (size_t(sizeClass.end - sizeClass.next) < nodeSize) {
+      // Whatever is left of the previous block is too small to be used.
+      mBlocks.emplace_back(new char[gBlockSize]);
+      sizeClass.next = mBlocks.back().get();
+      sizeClass.end = sizeClass.next + gBlockSize;
+      mStats.blockBytes += gBlockSize;
+    }
+
+    auto* node = sizeClass.next;
+
+    sizeClass.next += nodeSize;
+
+    return node;
+  }
+
+  void Release(void* ptr, size_t sizeClassIndex) noexcept
+  {
+    auto& sizeClass = mSizeClasses[sizeClassIndex];
+
+    auto* node = static_cast<FreeNode*>(ptr);
+
+    node->next = sizeClass.freeList;
+
+    sizeClass.freeList = node;
+  }
+
+  void CountLargeAllocation(size_t size) noexcept
+  {
+    mStats.allocationCount++;
+
+    mStats.allocatedBytes += size;
+  }
+
+  const NodePool::Stats& GetStats() const noexcept { return mStats; }
+
+  void ResetStats() noexcept
+  {
+    mStats.allocationCount = 0;
+
+    mStats.allocatedBytes = 0;
+  }
+
+private:
+  SizeClass mSizeClasses[gSizeClassCount];
+
+  std::vector<std::unique_ptr<char[]>> mBlocks;
+
+  NodePool::Stats mStats;
+};
+
+Pool&
+GetPool()
+{
+  // This is never destroyed, since nodes owned by static objects may be
+  // released after the pool would have been.
+  static Pool* pool = new Pool();
+
+  return *pool;
+}
+
+size_t
+GetSizeClassIndex(size_t size)
+{
+  return ((size + gGranularity - 1) / gGranularity) - 1;
+}
+
+} // namespace
+
+void*
+NodePool::Allocate(size_t size)
+{
+  if ((size == 0) || (size > gMaxNodeSize)) {
+    GetPool().CountLargeAllocation(size);
+    return ::operator new(size);
+  }
+
+  return GetPool().Allocate(GetSizeClassIndex(size));
+}
+
+void
+NodePool::Release(void* ptr, size_t size) noexcept
+{
+  if (!ptr)
+    return;
+
+  if ((size == 0) || (size > gMaxNodeSize)) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  GetPool().Release(ptr, GetSizeClassIndex(size));
+}
+
+auto
+NodePool::GetStats() noexcept -> Stats
+{
+  return GetPool().GetStats();
+}
+
+void
+NodePool::ResetStats() noexcept
+{
+  GetPool().ResetStats();
+}
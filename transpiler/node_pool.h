@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+
+/// @brief Allocates the nodes of the syntax tree.
+///
+/// @detail Nodes are carved out of large blocks, one list of blocks for each
+/// size of node, instead of being allocated one at a time from the heap. The
+/// nodes that the parser creates one after the other end up next to each
+/// other in memory, so the passes that walk the tree touch far fewer cache
+/// lines, and freed nodes are reused by the next node of the same size.
+///
+/// This is only an allocator. The tree is still linked by pointers and walked
+/// by the visitors. Passes that would rather scan arrays of nodes that refer
+/// to each other by index can use the flat form of a module, in
+/// 'flat_tree.h'. The blocks are never returned to the heap, since the
+/// released nodes are reused by the next module that is transpiled.
+///
+/// @note The pool is not thread safe. The transpiler only builds syntax trees
+/// on one thread.
+class NodePool final
+{
+public:
+  struct Stats final
+  {
+    /// @brief The number of nodes allocated since the statistics were
+    /// reset, including the ones that were released.
+    size_t allocationCount = 0;
+
+    /// @brief The total size of the nodes allocated since the statistics
+    /// were reset.
+    size_t allocatedBytes = 0;
+
+    /// @brief The size of the blocks that nodes are carved out of, including
+    /// the ones kept from before the statistics were reset. Nodes that are
+    /// too large for a block are not included.
+    size_t blockBytes = 0;
+  };
+
+  static void* Allocate(size_t size);
+
+  static void Release(void* ptr, size_t size) noexcept;
+
+  static Stats GetStats() noexcept;
+
+  /// @brief Resets the allocation counts, so that a program that transpiles
+  /// more than once can report them for each run.
+  static void ResetStats() noexcept;
+};
+
+/// @brief Makes a class and the classes derived from it allocate their
+/// instances from the node pool.
+///
+/// @note The class must have a virtual destructor, so that the size passed to
+/// the delete operator is the size of the derived class.
+#define PATHWAY_POOL_ALLOCATED                                                 \
+  static void* operator new(size_t size) { return NodePool::Allocate(size); }  \
+                                                                               \
+  static void operator delete(void* ptr, size_t size) noexcept                 \
+  {                                                                            \
+    NodePool::Release(ptr, size);                                              \
+  }
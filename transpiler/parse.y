@@ -3,9 +3,22 @@
 #include "module_consumer.h"
 #include "syntax_error_observer.h"
 
-#include "generated/lex.h"
 #include "generated/parse.h"
 
+// Locations are byte ranges, so a rule spans from the start of its first
+// symbol to the end of its last one. An empty rule is an empty range at the end
+// of the symbol before it.
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                        \
+  do {                                                                         \
+    if (N) {                                                                   \
+      (Current).begin = YYRHSLOC(Rhs, 1).begin;                                \
+      (Current).end = YYRHSLOC(Rhs, N).end;                                    \
+    } else {                                                                   \
+      (Current).begin = YYRHSLOC(Rhs, 0).end;                                  \
+      (Current).end = YYRHSLOC(Rhs, 0).end;                                    \
+    }                                                                          \
+  } while (0)
+
 namespace {
 
 void yyerror(const Location* location,
@@ -33,7 +46,7 @@ int yylex(SemanticValue* value, Location* location, Lexer& lexer)
   }
 
   if (token->Kind() == TOK_IDENTIFIER) {
-    value->asString = new std::string(token->AsStringView());
+    value->asSymbol = token->AsSymbol();
   } else if (token->Kind() == TOK_INT_LITERAL) {
     value->asInt = token->AsInt();
   } else if (token->Kind() == TOK_FLOAT_LITERAL) {
@@ -92,7 +105,7 @@ class SyntaxErrorObserver;
 %token<asBool> TRUE "true"
 %token<asBool> FALSE "false"
 
-%token<asString> IDENTIFIER "identifier"
+%token<asSymbol> IDENTIFIER "identifier"
 
 %token RETURN "return"
 %token BREAK "break"
@@ -165,7 +178,6 @@ class SyntaxErrorObserver;
 
 %type <asModule> module
 
-%destructor { delete $$; } IDENTIFIER
 
 %destructor { delete $$; } type
 
@@ -201,7 +213,7 @@ file: module END
 
 module: func
        {
-         $$ = new Module();
+         $$ = new Module(lexer.GetSymbolPool());
          $$->AppendFunc($1);
        }
        | module func
@@ -216,12 +228,12 @@ module: func
        }
        | var_decl
        {
-         $$ = new Module();
+         $$ = new Module(lexer.GetSymbolPool());
          $$->AppendGlobalVar($1);
        }
        | module_export_decl
        {
-         $$ = new Module();
+         $$ = new Module(lexer.GetSymbolPool());
          $$->SetModuleExportDecl($1);
        }
        | module module_export_decl
@@ -231,7 +243,7 @@ module: func
        }
        | module_import_decl
        {
-         $$ = new Module();
+         $$ = new Module(lexer.GetSymbolPool());
          $$->AppendModuleImportDecl($1);
        }
        | module module_import_decl
@@ -351,24 +363,24 @@ stmt_list: stmt
 
 assignment_stmt: unary_expr '=' expr ';'
                {
-                 $$ = new AssignmentStmt($1, $3);
+                 $$ = new AssignmentStmt($1, $3, @$);
                }
                ;
 
 decl_stmt: var_decl
          {
-           $$ = new DeclStmt($1);
+           $$ = new DeclStmt($1, @$);
          }
 
 return_stmt: RETURN expr ';'
            {
-             $$ = new ReturnStmt($2);
+             $$ = new ReturnStmt($2, @$);
            }
            ;
 
 compound_stmt: '{' stmt_list '}'
              {
-               $$ = new CompoundStmt($2);
+               $$ = new CompoundStmt($2, @$);
              }
              ;
 
@@ -2,16 +2,16 @@
 
 #include "module.h"
 
-#include <map>
+#include <unordered_map>
 
 namespace {
 
 class Scope final
 {
 public:
-  void Define(const VarDecl* v) { mVarMap.emplace(v->Identifier(), v); }
+  void Define(const VarDecl* v) { mVarMap.emplace(v->GetSymbol(), v); }
 
-  auto FindVar(const std::string& name) const -> const VarDecl*
+  auto FindVar(Symbol name) const -> const VarDecl*
   {
     auto it = mVarMap.find(name);
 
@@ -19,7 +19,7 @@ public:
   }
 
 private:
-  std::map<std::string, const VarDecl*> mVarMap;
+  std::unordered_map<Symbol, const VarDecl*> mVarMap;
 };
 
 class SymbolTable final
@@ -45,19 +45,12 @@ public:
     mLocalScopes.back().Define(v);
   }
 
-  auto FindFuncs(const std::string& name) const -> std::vector<const FuncDecl*>
+  auto FindFuncs(Symbol name) const -> const std::vector<const FuncDecl*>&
   {
-    std::vector<const FuncDecl*> matches;
-
-    for (const auto& func : mModule.Funcs()) {
-      if (func->HasName(name))
-        matches.emplace_back(func.get());
-    }
-
-    return matches;
+    return mModule.FindFuncs(name);
   }
 
-  const VarDecl* FindVar(const std::string& name) const
+  const VarDecl* FindVar(Symbol name) const
   {
     for (auto it = mLocalScopes.rbegin(); it != mLocalScopes.rend(); it++) {
 
@@ -66,12 +59,7 @@ public:
         return var;
     }
 
-    for (const auto& var : mModule.GlobalVars()) {
-      if (var->HasIdentifier(name))
-        return var.get();
-    }
-
-    return nullptr;
+    return mModule.FindGlobalVar(name);
   }
 
 private:
@@ -99,7 +87,13 @@ public:
 
   void Mutate(FuncCall& funcCall) const override
   {
-    funcCall.QueueNameMatches(mSymbolTable.FindFuncs(funcCall.Identifier()));
+    auto matches = mSymbolTable.FindFuncs(funcCall.GetSymbol());
+
+    // Functions declared in the module shadow the builtin functions.
+    if (matches.empty())
+      ResolveBuiltin(funcCall);
+    else
+      funcCall.QueueNameMatches(std::move(matches));
 
     funcCall.Recurse(*this);
   }
@@ -110,7 +104,7 @@ public:
 
   void Mutate(VarRef& varRef) const override
   {
-    const auto* var = mSymbolTable.FindVar(varRef.Identifier());
+    const auto* var = mSymbolTable.FindVar(varRef.GetSymbol());
 
     if (!var)
       return;
@@ -129,6 +123,21 @@ public:
   }
 
 private:
+  static void ResolveBuiltin(FuncCall& funcCall)
+  {
+    auto builtinID = FindBuiltin(funcCall.Identifier());
+
+    if (!builtinID)
+      return;
+
+    // A mismatch in the argument count leaves the call unresolved, so that
+    // it is reported like any other unknown function.
+    if (GetBuiltinParamCount(*builtinID) != funcCall.Args().size())
+      return;
+
+    funcCall.ResolveBuiltin(*builtinID);
+  }
+
   const SymbolTable& mSymbolTable;
 };
 
@@ -6,6 +6,7 @@
 #include "location.h"
 #include "module.h"
 #include "stmt.h"
+#include "symbol.h"
 #include "type.h"
 
 union SemanticValue
@@ -32,7 +33,7 @@ union SemanticValue
 
   Expr* asExpr;
 
-  std::string* asString;
+  Symbol asSymbol;
 
   TypeID asTypeID;
 
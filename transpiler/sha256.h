@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Computes SHA-256 digests, which are used to identify the inputs of
+/// a transpiler run.
+class Sha256 final
+{
+public:
+  using Digest = std::array<uint8_t, 32>;
+
+  Sha256();
+
+  void Update(std::string_view data);
+
+  /// @brief Finishes the digest. The object shouldn't be updated afterwards.
+  Digest Finish();
+
+  /// @brief Finishes the digest and formats it as lower case hexadecimal.
+  std::string FinishHex();
+
+private:
+  void ProcessBlock(const uint8_t* block);
+
+  std::array<uint32_t, 8> mState;
+
+  std::array<uint8_t, 64> mBuffer{};
+
+  size_t mBufferSize = 0;
+
+  uint64_t mTotalSize = 0;
+};
@@ -0,0 +1,117 @@
+#include "source_buffer.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// @brief Locations store 32-bit offsets, so larger files can't be lexed.
+constexpr size_t gMaxFileSize = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+auto
+SourceBuffer::Open(const char* path, bool map)
+  -> std::unique_ptr<SourceBuffer>
+{
+#ifdef __unix__
+  if (!map)
+    return ReadFile(path);
+
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+    return nullptr;
+
+  struct stat info;
+
+  if (fstat(fd, &info) != 0) {
+    int error = errno;
+    close(fd);
+    errno = error;
+    return nullptr;
+  }
+
+  // Things like pipes can't be mapped, so they're read like any other stream.
+  if (S_ISREG(info.st_mode) && (info.st_size > 0)) {
+
+    if (size_t(info.st_size) > gMaxFileSize) {
+      close(fd);
+      errno = EFBIG;
+      return nullptr;
+    }
+
+    auto size = size_t(info.st_size);
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    int error = errno;
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+      errno = error;
+      return nullptr;
+    }
+
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->mMapping = mapping;
+    buffer->mMappingSize = size;
+    buffer->mData = std::string_view(static_cast<const char*>(mapping), size);
+    return buffer;
+  }
+
+  close(fd);
+#endif // __unix__
+
+  return ReadFile(path);
+}
+
+auto
+SourceBuffer::ReadFile(const char* path) -> std::unique_ptr<SourceBuffer>
+{
+  std::ifstream file(path, std::ios::binary);
+
+  if (!file.good())
+    return nullptr;
+
+  std::ostringstream fileStream;
+
+  fileStream << file.rdbuf();
+
+  auto data = fileStream.str();
+
+  if (data.size() > gMaxFileSize) {
+    errno = EFBIG;
+    return nullptr;
+  }
+
+  return FromString(std::move(data));
+}
+
+auto
+SourceBuffer::FromString(std::string data) -> std::unique_ptr<SourceBuffer>
+{
+  std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+  buffer->mOwnedData = std::move(data);
+  buffer->mData = buffer->mOwnedData;
+  return buffer;
+}
+
+SourceBuffer::~SourceBuffer()
+{
+#ifdef __unix__
+  if (mMapping)
+    munmap(mMapping, mMappingSize);
+#endif // __unix__
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+/// @brief The contents of a source file.
+///
+/// @detail Files that are opened from a path are memory mapped where the
+/// platform allows it, so that their contents are never copied. The contents
+/// stay at the same address for the lifetime of the buffer.
+class SourceBuffer final
+{
+public:
+  /// @brief Opens a file.
+  ///
+  /// @param map Whether the file may be memory mapped. Files that other
+  /// programs may rewrite while the buffer is alive shouldn't be, since
+  /// reading a mapped file after it is truncated raises SIGBUS.
+  ///
+  /// @return Null if the file could not be opened, in which case errno
+  /// describes why.
+  static auto Open(const char* path, bool map = true)
+    -> std::unique_ptr<SourceBuffer>;
+
+  /// @brief Makes a buffer that owns a copy of some data that is already in
+  /// memory.
+  static auto FromString(std::string data) -> std::unique_ptr<SourceBuffer>;
+
+  SourceBuffer(const SourceBuffer&) = delete;
+
+  ~SourceBuffer();
+
+  std::string_view Data() const noexcept { return mData; }
+
+private:
+  SourceBuffer() = default;
+
+  static auto ReadFile(const char* path) -> std::unique_ptr<SourceBuffer>;
+
+  /// @brief The data, if it is not mapped.
+  std::string mOwnedData;
+
+  void* mMapping = nullptr;
+
+  size_t mMappingSize = 0;
+
+  std::string_view mData;
+};
@@ -0,0 +1,346 @@
+#include "statistics.h"
+
+#include "module.h"
+#include "uniform_expr_analysis.h"
+#include "varying_liveness_analysis.h"
+
+#include <iomanip>
+#include <ostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+class NodeCounter final
+  : public DeclVisitor
+  , public StmtVisitor
+  , public ExprVisitor
+{
+public:
+  NodeCounter(ModuleStats& stats)
+    : mStats(stats)
+  {}
+
+  void Visit(const FuncDecl& funcDecl) override
+  {
+    mStats.funcCount++;
+
+    funcDecl.AcceptBodyVisitor(*this);
+  }
+
+  void Visit(const VarDecl& varDecl) override
+  {
+    mStats.globalVarCount++;
+
+    if (varDecl.HasInitExpr())
+      varDecl.InitExpr().AcceptVisitor(*this);
+  }
+
+  void Visit(const ModuleExportDecl&) override {}
+
+  void Visit(const ModuleImportDecl&) override {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    mStats.stmtCount++;
+
+    assignmentStmt.LValue().AcceptVisitor(*this);
+
+    assignmentStmt.RValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    mStats.stmtCount++;
+
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    mStats.stmtCount++;
+
+    if (declStmt.GetVarDecl().HasInitExpr())
+      declStmt.GetVarDecl().InitExpr().AcceptVisitor(*this);
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    mStats.stmtCount++;
+
+    returnStmt.ReturnValue().AcceptVisitor(*this);
+  }
+
+  void Visit(const IntLiteral&) override { mStats.exprCount++; }
+
+  void Visit(const BoolLiteral&) override { mStats.exprCount++; }
+
+  void Visit(const FloatLiteral&) override { mStats.exprCount++; }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    mStats.exprCount++;
+
+    binaryExpr.Recurse(*this);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    mStats.exprCount++;
+
+    unaryExpr.Recurse(*this);
+  }
+
+  void Visit(const GroupExpr& groupExpr) override
+  {
+    mStats.exprCount++;
+
+    groupExpr.Recurse(*this);
+  }
+
+  void Visit(const VarRef&) override { mStats.exprCount++; }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    mStats.exprCount++;
+
+    funcCall.Recurse(*this);
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    mStats.exprCount++;
+
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    mStats.exprCount++;
+
+    memberExpr.Recurse(*this);
+  }
+
+private:
+  ModuleStats& mStats;
+};
+
+size_t
+GetScalarCount(TypeID typeID) noexcept
+{
+  switch (typeID) {
+    case TypeID::Void:
+      return 0;
+    case TypeID::Mat2:
+      return 4;
+    case TypeID::Mat3:
+      return 9;
+    case TypeID::Mat4:
+      return 16;
+    default:
+      break;
+  }
+
+  return GetVectorComponentCount(typeID).value_or(1);
+}
+
+/// @brief Gets the size of a value, with 32-bit floats and integers.
+size_t
+GetByteSize(TypeID typeID) noexcept
+{
+  auto scalarSize = (typeID == TypeID::Bool) ? 1 : 4;
+
+  return GetScalarCount(typeID) * scalarSize;
+}
+
+} // namespace
+
+ModuleStats
+CollectModuleStats(const Module& module)
+{
+  ModuleStats stats;
+
+  NodeCounter counter(stats);
+
+  module.AcceptDeclVisitor(counter);
+
+  for (const auto* var : module.UniformGlobalVars()) {
+    stats.uniformDataScalars += GetScalarCount(var->GetTypeID());
+    stats.uniformDataBytes += GetByteSize(var->GetTypeID());
+  }
+
+  UniformExprAnalysis uniformExprs;
+
+  uniformExprs.Invoke(module);
+
+  for (const auto& hoistedExpr : uniformExprs.HoistedExprs()) {
+
+    auto type = hoistedExpr.expr->GetType();
+
+    if (!type)
+      continue;
+
+    stats.uniformDataScalars += GetScalarCount(type->ID());
+    stats.uniformDataBytes += GetByteSize(type->ID());
+  }
+
+  VaryingLivenessAnalysis varyingLiveness;
+
+  varyingLiveness.Invoke(module);
+
+  for (const auto* var : module.VaryingGlobalVars()) {
+
+    if (!varyingLiveness.IsStored(*var))
+      continue;
+
+    stats.varyingDataScalars += GetScalarCount(var->GetTypeID());
+    stats.varyingDataBytes += GetByteSize(var->GetTypeID());
+  }
+
+  return stats;
+}
+
+size_t
+GetPeakMemoryUsage() noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+#ifdef __APPLE__
+  return size_t(usage.ru_maxrss);
+#else
+  // Linux reports the size in kilobytes.
+  return size_t(usage.ru_maxrss) * 1024;
+#endif
+
+#else
+  return 0;
+#endif
+}
+
+void
+PrintPassTimings(std::ostream& stream,
+                 const std::vector<PassTimer::Timing>& timings)
+{
+  double total = 0;
+
+  stream << std::left << std::setw(24) << "pass" << std::right << std::setw(12)
+         << "time (ms)" << std::endl;
+
+  for (const auto& timing : timings) {
+
+    stream << std::left << std::setw(24) << timing.passName << std::right
+           << std::fixed << std::setprecision(3) << std::setw(12)
+           << timing.milliseconds << std::endl;
+
+    total += timing.milliseconds;
+  }
+
+  stream << std::left << std::setw(24) << "total" << std::right << std::fixed
+         << std::setprecision(3) << std::setw(12) << total << std::endl;
+}
+
+void
+PrintStats(std::ostream& stream, const TranspileStats& stats)
+{
+  if (stats.moduleStats) {
+
+    const auto& moduleStats = *stats.moduleStats;
+
+    stream << "functions: " << moduleStats.funcCount << std::endl;
+
+    stream << "global variables: " << moduleStats.globalVarCount << std::endl;
+
+    stream << "statements: " << moduleStats.stmtCount << std::endl;
+
+    stream << "expressions: " << moduleStats.exprCount << std::endl;
+
+    stream << "uniform_data: " << moduleStats.uniformDataScalars
+           << " scalars (" << moduleStats.uniformDataBytes << " bytes)"
+           << std::endl;
+
+    stream << "varying_data: " << moduleStats.varyingDataScalars
+           << " scalars (" << moduleStats.varyingDataBytes
+           << " bytes per pixel)" << std::endl;
+  }
+
+  const auto& nodePoolStats = stats.nodePoolStats;
+
+  stream << "node allocations: " << nodePoolStats.allocationCount << " ("
+         << nodePoolStats.allocatedBytes << " bytes, "
+         << nodePoolStats.blockBytes << " bytes of blocks)" << std::endl;
+
+  stream << "generated code: " << stats.outputSize << " bytes" << std::endl;
+
+  stream << "peak memory usage: " << stats.peakMemoryUsage << " bytes"
+         << std::endl;
+}
+
+void
+PrintStatsJson(std::ostream& stream, const TranspileStats& stats)
+{
+  stream << "{" << std::endl;
+
+  stream << "  \"passes\": [";
+
+  for (size_t i = 0; i < stats.passTimings.size(); i++) {
+
+    const auto& timing = stats.passTimings[i];
+
+    // Pass names are fixed strings that never need escaping.
+    stream << ((i == 0) ? "" : ",") << std::endl
+           << "    { \"name\": \"" << timing.passName
+           << "\", \"milliseconds\": " << std::fixed << std::setprecision(3)
+           << timing.milliseconds << " }";
+  }
+
+  stream << std::endl << "  ]," << std::endl;
+
+  stream << "  \"module\": ";
+
+  if (stats.moduleStats) {
+
+    const auto& moduleStats = *stats.moduleStats;
+
+    stream << "{" << std::endl
+           << "    \"functions\": " << moduleStats.funcCount << "," << std::endl
+           << "    \"global_variables\": " << moduleStats.globalVarCount << ","
+           << std::endl
+           << "    \"statements\": " << moduleStats.stmtCount << ","
+           << std::endl
+           << "    \"expressions\": " << moduleStats.exprCount << ","
+           << std::endl
+           << "    \"uniform_data_scalars\": "
+           << moduleStats.uniformDataScalars << "," << std::endl
+           << "    \"uniform_data_bytes\": " << moduleStats.uniformDataBytes
+           << "," << std::endl
+           << "    \"varying_data_scalars\": "
+           << moduleStats.varyingDataScalars << "," << std::endl
+           << "    \"varying_data_bytes\": " << moduleStats.varyingDataBytes
+           << std::endl
+           << "  }," << std::endl;
+  } else {
+    stream << "null," << std::endl;
+  }
+
+  const auto& nodePoolStats = stats.nodePoolStats;
+
+  stream << "  \"node_pool\": {" << std::endl
+         << "    \"allocations\": " << nodePoolStats.allocationCount << ","
+         << std::endl
+         << "    \"allocated_bytes\": " << nodePoolStats.allocatedBytes << ","
+         << std::endl
+         << "    \"block_bytes\": " << nodePoolStats.blockBytes << std::endl
+         << "  }," << std::endl;
+
+  stream << "  \"output_bytes\": " << stats.outputSize << "," << std::endl;
+
+  stream << "  \"peak_memory_bytes\": " << stats.peakMemoryUsage << std::endl;
+
+  stream << "}" << std::endl;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "node_pool.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Module;
+
+/// @brief Measures the wall clock time of each pass.
+class PassTimer final
+{
+public:
+  struct Timing final
+  {
+    std::string passName;
+
+    double milliseconds = 0;
+  };
+
+  /// @brief Runs a pass and records how long it took.
+  ///
+  /// @return Whatever the pass returns.
+  template<typename Func>
+  auto Time(const char* passName, Func func) -> decltype(func())
+  {
+    Stopwatch stopwatch(*this, passName);
+
+    return func();
+  }
+
+  /// @brief Gets the time of each pass, in the order they ran.
+  auto Timings() const noexcept -> const std::vector<Timing>&
+  {
+    return mTimings;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief Records the time of a pass when it goes out of scope, so that
+  /// passes that return early are recorded as well.
+  class Stopwatch final
+  {
+  public:
+    Stopwatch(PassTimer& timer, const char* passName)
+      : mTimer(timer)
+      , mPassName(passName)
+      , mStart(Clock::now())
+    {}
+
+    ~Stopwatch()
+    {
+      std::chrono::duration<double, std::milli> elapsed = Clock::now() - mStart;
+
+      mTimer.mTimings.emplace_back(Timing{ mPassName, elapsed.count() });
+    }
+
+  private:
+    PassTimer& mTimer;
+
+    const char* mPassName;
+
+    Clock::time_point mStart;
+  };
+
+  std::vector<Timing> mTimings;
+};
+
+/// @brief The size of a module and of the data the generated code keeps.
+struct ModuleStats final
+{
+  size_t funcCount = 0;
+
+  size_t globalVarCount = 0;
+
+  size_t stmtCount = 0;
+
+  size_t exprCount = 0;
+
+  /// @brief The number of scalars in the data kept for each frame, including
+  /// the values hoisted out of the pixel sampler.
+  size_t uniformDataScalars = 0;
+
+  /// @brief The number of scalars in the data kept for each pixel.
+  size_t varyingDataScalars = 0;
+
+  /// @brief The size of the data kept for each frame with 32-bit scalars,
+  /// not counting padding.
+  size_t uniformDataBytes = 0;
+
+  /// @brief The size of the data kept for each pixel with 32-bit scalars, not
+  /// counting padding. Vectorized code keeps this much for each lane.
+  size_t varyingDataBytes = 0;
+};
+
+/// @brief Counts the nodes of a module and measures the data that the
+/// generated code keeps for it.
+///
+/// @note This should be called on a module that is ready to be generated,
+/// since the data depends on what the analysis passes find.
+ModuleStats
+CollectModuleStats(const Module& module);
+
+/// @brief Gets the most memory the process has used so far, in bytes.
+///
+/// @return Zero if the platform doesn't report it.
+size_t
+GetPeakMemoryUsage() noexcept;
+
+/// @brief Everything reported by the '--time-passes' and '--stats' options.
+struct TranspileStats final
+{
+  std::vector<PassTimer::Timing> passTimings;
+
+  /// @brief Missing if the module had errors.
+  std::optional<ModuleStats> moduleStats;
+
+  NodePool::Stats nodePoolStats;
+
+  size_t peakMemoryUsage = 0;
+
+  size_t outputSize = 0;
+};
+
+void
+PrintPassTimings(std::ostream& stream,
+                 const std::vector<PassTimer::Timing>& timings);
+
+void
+PrintStats(std::ostream& stream, const TranspileStats& stats);
+
+/// @brief Prints the timings and statistics as a JSON object, so that they
+/// can be tracked over time by other tools.
+void
+PrintStatsJson(std::ostream& stream, const TranspileStats& stats);
@@ -2,8 +2,9 @@
 
 #include "decl.h"
 
-DeclStmt::DeclStmt(VarDecl* v_)
-  : mVarDecl(v_)
+DeclStmt::DeclStmt(VarDecl* v_, const Location& location)
+  : Stmt(location)
+  , mVarDecl(v_)
 {}
 
 DeclStmt::DeclStmt(DeclStmt&&) = default;
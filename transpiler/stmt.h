@@ -1,6 +1,8 @@
 #pragma once
 
 #include "expr.h"
+#include "location.h"
+#include "node_pool.h"
 #include "type.h"
 
 #include <memory>
@@ -42,11 +44,22 @@ public:
 class Stmt
 {
 public:
+  PATHWAY_POOL_ALLOCATED
+
+  Stmt(const Location& location)
+    : mLocation(location)
+  {}
+
   virtual ~Stmt() = default;
 
   virtual void AcceptVisitor(StmtVisitor& v) const = 0;
 
   virtual void AcceptMutator(StmtMutator& m) = 0;
+
+  Location GetLocation() const noexcept { return mLocation; }
+
+private:
+  Location mLocation;
 };
 
 using UniqueStmtPtr = std::unique_ptr<Stmt>;
@@ -56,8 +69,9 @@ using StmtList = std::vector<std::unique_ptr<Stmt>>;
 class AssignmentStmt final : public Stmt
 {
 public:
-  AssignmentStmt(Expr* lValue, Expr* rValue)
-    : mLValue(lValue)
+  AssignmentStmt(Expr* lValue, Expr* rValue, const Location& location)
+    : Stmt(location)
+    , mLValue(lValue)
     , mRValue(rValue)
   {}
 
@@ -71,6 +85,10 @@ public:
   const Expr& LValue() const noexcept { return *mLValue; }
   const Expr& RValue() const noexcept { return *mRValue; }
 
+  UniqueExprPtr TakeRValue() { return std::move(mRValue); }
+
+  void SetRValue(UniqueExprPtr rValue) { mRValue = std::move(rValue); }
+
 private:
   UniqueExprPtr mLValue;
   UniqueExprPtr mRValue;
@@ -79,14 +97,17 @@ private:
 class CompoundStmt final : public Stmt
 {
 public:
-  CompoundStmt(StmtList* stmts_)
-    : stmts(stmts_)
+  CompoundStmt(StmtList* stmts_, const Location& location)
+    : Stmt(location)
+    , stmts(stmts_)
   {}
 
   void AcceptVisitor(StmtVisitor& v) const override { v.Visit(*this); }
 
   void AcceptMutator(StmtMutator& m) override { m.Mutate(*this); }
 
+  const StmtList& Stmts() const noexcept { return *stmts; }
+
   void Recurse(StmtVisitor& v) const
   {
     for (auto& innerStmt : *stmts)
@@ -108,7 +129,7 @@ class VarDecl;
 class DeclStmt final : public Stmt
 {
 public:
-  DeclStmt(VarDecl* v_);
+  DeclStmt(VarDecl* v_, const Location& location);
 
   DeclStmt(DeclStmt&&);
 
@@ -129,8 +150,9 @@ private:
 class ReturnStmt final : public Stmt
 {
 public:
-  ReturnStmt(Expr* rv)
-    : mReturnValue(rv)
+  ReturnStmt(Expr* rv, const Location& location)
+    : Stmt(location)
+    , mReturnValue(rv)
   {}
 
   void AcceptVisitor(StmtVisitor& v) const override { v.Visit(*this); }
@@ -141,6 +163,13 @@ public:
 
   Expr& ReturnValue() noexcept { return *mReturnValue; }
 
+  UniqueExprPtr TakeReturnValue() { return std::move(mReturnValue); }
+
+  void SetReturnValue(UniqueExprPtr returnValue)
+  {
+    mReturnValue = std::move(returnValue);
+  }
+
 private:
   UniqueExprPtr mReturnValue;
 };
@@ -0,0 +1,76 @@
+#include "symbol.h"
+
+#include <ostream>
+
+namespace {
+
+thread_local std::shared_ptr<SymbolPool> gCurrentPool;
+
+SymbolPool&
+GetCurrentPool()
+{
+  return gCurrentPool ? *gCurrentPool : *SymbolPool::Current();
+}
+
+} // namespace
+
+Symbol
+Symbol::Intern(std::string_view name)
+{
+  return GetCurrentPool().Intern(name);
+}
+
+SymbolPool::Scope::Scope(std::shared_ptr<SymbolPool> pool)
+  : mPrevious(std::move(gCurrentPool))
+{
+  gCurrentPool = std::move(pool);
+}
+
+SymbolPool::Scope::~Scope()
+{
+  gCurrentPool = std::move(mPrevious);
+}
+
+std::shared_ptr<SymbolPool>
+SymbolPool::Current()
+{
+  if (gCurrentPool)
+    return gCurrentPool;
+
+  static auto processPool = std::make_shared<SymbolPool>();
+
+  return processPool;
+}
+
+Symbol
+SymbolPool::Intern(std::string_view name)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  auto it = mNames.find(name);
+
+  if (it == mNames.end()) {
+
+    auto str = std::make_unique<std::string>(name);
+
+    std::string_view key(*str);
+
+    it = mNames.emplace(key, std::move(str)).first;
+  }
+
+  return Symbol(it->second.get());
+}
+
+size_t
+SymbolPool::Size() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  return mNames.size();
+}
+
+std::ostream&
+operator<<(std::ostream& stream, Symbol symbol)
+{
+  return stream << symbol.Name();
+}
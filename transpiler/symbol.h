@@ -0,0 +1,110 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// @brief An interned identifier.
+///
+/// @detail Each distinct name is stored once in a @ref SymbolPool, so symbols
+/// are compared and hashed by address instead of by their characters, and
+/// copying one never allocates. Symbols from different pools never compare
+/// equal, even if they have the same name.
+class Symbol final
+{
+public:
+  /// @brief Gets the symbol of a name from the pool of the current
+  /// compilation, adding the name to the pool the first time it is seen.
+  ///
+  /// @see SymbolPool::Current
+  static Symbol Intern(std::string_view name);
+
+  /// @note The symbol is left uninitialized, so that it can be a member of the
+  /// parser's semantic value union.
+  Symbol() = default;
+
+  const std::string& Name() const noexcept { return *mName; }
+
+  bool operator==(Symbol other) const noexcept { return mName == other.mName; }
+
+  bool operator!=(Symbol other) const noexcept { return mName != other.mName; }
+
+  size_t Hash() const noexcept { return std::hash<const void*>()(mName); }
+
+private:
+  friend class SymbolPool;
+
+  explicit Symbol(const std::string* name)
+    : mName(name)
+  {}
+
+  const std::string* mName;
+};
+
+/// @brief Owns the names of the symbols of a compilation.
+///
+/// @detail A symbol refers to the name in its pool, so the pool has to outlive
+/// the symbols. The lexer and the modules share the ownership of the pool
+/// that their symbols come from, so the names are freed once the last module
+/// of a compilation is destroyed.
+///
+/// The pool grows with every distinct name interned into it and is never
+/// cleared, so a program that compiles more than once, such as a watch or a
+/// preview, should make a pool for each compilation with a @ref Scope.
+///
+/// @note Interning is guarded by a mutex, since the process wide pool that is
+/// used outside of a scope may be shared by several threads.
+class SymbolPool final
+{
+public:
+  /// @brief Makes a pool the current one of this thread, until the scope
+  /// ends.
+  class Scope final
+  {
+  public:
+    explicit Scope(std::shared_ptr<SymbolPool> pool);
+
+    Scope(const Scope&) = delete;
+
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope();
+
+  private:
+    std::shared_ptr<SymbolPool> mPrevious;
+  };
+
+  /// @brief Gets the pool of the innermost scope on this thread, or the
+  /// process wide pool if there is no scope.
+  static std::shared_ptr<SymbolPool> Current();
+
+  /// @brief Gets the symbol of a name, adding the name to the pool the first
+  /// time it is seen.
+  Symbol Intern(std::string_view name);
+
+  /// @brief Gets the number of distinct names in the pool.
+  size_t Size() const;
+
+private:
+  mutable std::mutex mMutex;
+
+  // The keys refer to the strings owned by the values, which never move.
+  std::unordered_map<std::string_view, std::unique_ptr<std::string>> mNames;
+};
+
+std::ostream&
+operator<<(std::ostream&, Symbol symbol);
+
+namespace std {
+
+template<>
+struct hash<Symbol>
+{
+  size_t operator()(Symbol symbol) const noexcept { return symbol.Hash(); }
+};
+
+} // namespace std
@@ -0,0 +1,167 @@
+#include "transpile.h"
+
+#include "bytecode_generator.h"
+#include "c_simd_generator.h"
+#include "check.h"
+#include "const_fold.h"
+#include "cpp_generator_v2.h"
+#include "diagnostics.h"
+#include "duplicates_check.h"
+#include "effects_analysis.h"
+#include "lexer.h"
+#include "module.h"
+#include "module_consumer.h"
+#include "module_interface.h"
+#include "parse.h"
+#include "resolution_check_pass.h"
+#include "resolve.h"
+#include "symbol.h"
+#include "syntax_error_observer.h"
+#include "type_annotation.h"
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+class StringTranspiler final
+  : public ModuleConsumer
+  , public SyntaxErrorObserver
+{
+public:
+  explicit StringTranspiler(DiagObserver& diagObserver)
+    : mDiagObserver(diagObserver)
+  {}
+
+  void ConsumeModule(std::unique_ptr<Module> module) override
+  {
+    mModule = std::move(module);
+  }
+
+  void ObserveSyntaxError(const Location& loc, const char* msg) override
+  {
+    mErrorFlag = true;
+
+    Diag diag(loc, DiagID::SyntaxError, msg);
+
+    mDiagObserver.Observe(diag);
+  }
+
+  bool GetErrorFlag() const noexcept { return mErrorFlag; }
+
+  std::unique_ptr<Module> TakeModule() { return std::move(mModule); }
+
+private:
+  DiagObserver& mDiagObserver;
+
+  std::unique_ptr<Module> mModule;
+
+  bool mErrorFlag = false;
+};
+
+/// @brief Runs the passes that come before code generation.
+///
+/// @return False if the module has errors.
+bool
+RunPasses(Module& module,
+          std::string_view source,
+          const TranspileOptions& options,
+          DiagObserver& diagObserver,
+          std::ostream& checkStream)
+{
+  if (!ImportModules(module, options.modulePaths, diagObserver))
+    return false;
+
+  if (!DuplicatesCheck::Check(module, diagObserver))
+    return false;
+
+  Resolve(module);
+
+  ResolutionCheckPass resolutionCheckPass;
+
+  if (!resolutionCheckPass.Invoke(module, diagObserver))
+    return false;
+
+  AnnotateTypes(module);
+
+  if (!check(options.path, source, module, checkStream))
+    return false;
+
+  AnalyzeEffects(module);
+
+  FoldConstants(module, options.genOptions.mathMode);
+
+  return true;
+}
+
+} // namespace
+
+auto
+TranspileString(std::string_view source, const TranspileOptions& options)
+  -> TranspileResult
+{
+  // The syntax trees are allocated from a pool that isn't thread safe.
+  static std::mutex mutex;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Each call has its own names, which are freed with its module.
+  SymbolPool::Scope symbolScope(std::make_shared<SymbolPool>());
+
+  std::ostringstream diagStream;
+
+  auto diagObserver = ConsoleDiagObserver::Make(diagStream);
+
+  diagObserver->SetColorEnabled(false);
+
+  Lexer lexer;
+
+  lexer.PushFile(options.path.c_str(), std::string(source));
+
+  auto data = lexer.GetCurrentFileData();
+
+  diagObserver->BeginFile(options.path, data);
+
+  StringTranspiler transpiler(*diagObserver);
+
+  Parse(lexer, transpiler, transpiler);
+
+  auto module = transpiler.TakeModule();
+
+  TranspileResult result;
+
+  if (module && !transpiler.GetErrorFlag() &&
+      RunPasses(*module, data, options, *diagObserver, diagStream)) {
+
+    // The output is a single file, so the definitions stay in the header.
+    auto genOptions = options.genOptions;
+
+    genOptions.instantiations.clear();
+
+    std::ostringstream outputStream;
+
+    std::unique_ptr<Generator> gen;
+
+    if (options.language == OutputLanguage::Bytecode)
+      gen.reset(new bytecode::Generator(outputStream, genOptions));
+    else if (options.language == OutputLanguage::CSimd)
+      gen.reset(new csimd::Generator(outputStream, genOptions));
+    else
+      gen.reset(new cpp::Generator(outputStream, genOptions));
+
+    gen->Generate(*module);
+
+    result.success = true;
+
+    result.output = outputStream.str();
+  }
+
+  diagObserver->EndFile();
+
+  lexer.PopFile();
+
+  result.diagnostics = diagStream.str();
+
+  return result;
+}
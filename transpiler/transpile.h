@@ -0,0 +1,57 @@
+#pragma once
+
+#include "generator.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class OutputLanguage
+{
+  /// A C++ header, for the runtime in 'pathway.h'.
+  Cxx,
+  /// Bytecode, for the virtual machine in 'pathway_vm.h'.
+  Bytecode,
+  /// C with vector extensions, for the frame in 'pathway_simd.h'.
+  CSimd
+};
+
+struct TranspileOptions final
+{
+  OutputLanguage language = OutputLanguage::Cxx;
+
+  GeneratorOptions genOptions;
+
+  /// @brief The directories to search for the interfaces of imported
+  /// modules.
+  std::vector<std::string> modulePaths;
+
+  /// @brief The path that diagnostics refer to the source by. The source
+  /// isn't read from it.
+  std::string path = "main.pt";
+};
+
+struct TranspileResult final
+{
+  bool success = false;
+
+  /// @brief The generated code, if the source had no errors.
+  std::string output;
+
+  /// @brief The diagnostics of the source, formatted the way 'ptc' prints
+  /// them, without colors.
+  std::string diagnostics;
+};
+
+/// @brief Transpiles a module that is held in memory, without touching the
+/// file system, other than for the interfaces of imported modules.
+///
+/// @detail This runs the same passes as 'ptc', for programs that generate
+/// code at run time, such as a preview that reloads a module whenever it is
+/// edited.
+///
+/// @note This may be called from several threads, but the calls run one at a
+/// time, since the syntax trees share a pool.
+auto
+TranspileString(std::string_view source, const TranspileOptions& options = {})
+  -> TranspileResult;
@@ -0,0 +1,181 @@
+#include "transpile_cache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include <errno.h>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// @brief Gets a name for a temporary file next to a path, which is unique to
+/// this process so that parallel runs don't write the same temporary file.
+std::string
+GetTemporaryPath(const std::string& path)
+{
+  std::ostringstream stream;
+
+  stream << path << ".tmp";
+
+#ifdef __unix__
+  stream << '.' << getpid();
+#endif
+
+  return stream.str();
+}
+
+bool
+HaveSameContents(const std::string& pathA, const std::string& pathB)
+{
+  std::error_code error;
+
+  if (fs::equivalent(pathA, pathB, error))
+    return true;
+
+  if (error || (fs::file_size(pathA, error) != fs::file_size(pathB, error)))
+    return false;
+
+  if (error)
+    return false;
+
+  std::ifstream fileA(pathA, std::ios::binary);
+
+  std::ifstream fileB(pathB, std::ios::binary);
+
+  std::ostringstream dataA;
+
+  std::ostringstream dataB;
+
+  dataA << fileA.rdbuf();
+
+  dataB << fileB.rdbuf();
+
+  return fileA.good() && fileB.good() && (dataA.str() == dataB.str());
+}
+
+} // namespace
+
+TranspileCache::TranspileCache(std::string directory)
+  : mDirectory(std::move(directory))
+{}
+
+bool
+TranspileCache::Fetch(const std::string& key,
+                      const std::string& outputPath,
+                      bool onlyIfDifferent) const
+{
+  auto entryPath = GetEntryPath(key);
+
+  std::error_code error;
+
+  if (!fs::is_regular_file(entryPath, error))
+    return false;
+
+  if (onlyIfDifferent && fs::exists(outputPath, error) &&
+      HaveSameContents(entryPath, outputPath))
+    return true;
+
+  auto temporaryPath = GetTemporaryPath(outputPath);
+
+  fs::remove(temporaryPath, error);
+
+  // The output is a copy rather than a hard link, since a link would share
+  // the modification time and permissions of the entry. An output older than
+  // its inputs makes build systems run the transpiler on every build, and an
+  // output that was cached before could look older than the files built
+  // from it.
+  fs::copy_file(entryPath, temporaryPath, error);
+
+  if (error)
+    return false;
+
+  fs::permissions(
+    temporaryPath, fs::perms::owner_write, fs::perm_options::add, error);
+
+  if (!error)
+    fs::last_write_time(temporaryPath, fs::file_time_type::clock::now(), error);
+
+  if (error) {
+    fs::remove(temporaryPath, error);
+    return false;
+  }
+
+  fs::rename(temporaryPath, outputPath, error);
+
+  if (error) {
+    fs::remove(temporaryPath, error);
+    return false;
+  }
+
+  return true;
+}
+
+void
+TranspileCache::Store(const std::string& key, std::string_view output) const
+{
+  auto entryPath = GetEntryPath(key);
+
+  std::error_code error;
+
+  fs::create_directories(fs::path(entryPath).parent_path(), error);
+
+  if (error)
+    return;
+
+  if (!ReplaceFile(entryPath, output))
+    return;
+
+  fs::permissions(entryPath,
+                  fs::perms::owner_read | fs::perms::group_read |
+                    fs::perms::others_read,
+                  error);
+}
+
+std::string
+TranspileCache::GetEntryPath(const std::string& key) const
+{
+  return (fs::path(mDirectory) / key.substr(0, 2) / key).string();
+}
+
+bool
+ReplaceFile(const std::string& path, std::string_view data)
+{
+  auto temporaryPath = GetTemporaryPath(path);
+
+  {
+    std::ofstream file(temporaryPath, std::ios::binary);
+
+    if (!file.good())
+      return false;
+
+    file.write(data.data(), std::streamsize(data.size()));
+
+    file.close();
+
+    if (!file.good()) {
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+
+  fs::rename(temporaryPath, path, error);
+
+  if (error) {
+    auto renameError = error.value();
+    fs::remove(temporaryPath, error);
+    errno = renameError;
+    return false;
+  }
+
+  return true;
+}
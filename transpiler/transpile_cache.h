@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/// @brief A directory of transpiler outputs, named by the hash of everything
+/// that went into making them.
+///
+/// @detail Each entry is stored in a subdirectory named after the first two
+/// characters of its key, so that no single directory gets too large. Entries
+/// are written to a temporary file and renamed into place, so a cache shared
+/// by parallel runs never has partially written entries.
+class TranspileCache final
+{
+public:
+  explicit TranspileCache(std::string directory);
+
+  /// @brief Copies a cached output to the output path.
+  ///
+  /// @detail The output is a writable copy of the entry, which is modified
+  /// now rather than when the entry was stored, so that build systems that
+  /// compare it with its inputs see that it is up to date. The output is
+  /// replaced by renaming, so it is never partially written.
+  ///
+  /// @param onlyIfDifferent Whether to leave the output alone when it already
+  /// has the same contents as the entry.
+  ///
+  /// @return True if there was an entry for the key and the output has its
+  /// contents.
+  bool Fetch(const std::string& key,
+             const std::string& outputPath,
+             bool onlyIfDifferent) const;
+
+  /// @brief Adds an output to the cache. Errors are ignored, since a missing
+  /// entry only means the output gets generated again next time.
+  ///
+  /// @note Entries are read only, to keep them from being edited by mistake.
+  void Store(const std::string& key, std::string_view output) const;
+
+private:
+  std::string GetEntryPath(const std::string& key) const;
+
+  std::string mDirectory;
+};
+
+/// @brief Replaces a file with new contents by writing them to a temporary
+/// file and renaming it over the original.
+///
+/// @detail The original file is never opened for writing, so programs that
+/// read it meanwhile see either the old or the new contents.
+///
+/// @return False if the file couldn't be written, in which case errno
+/// describes why.
+bool
+ReplaceFile(const std::string& path, std::string_view data);
@@ -16,7 +16,7 @@ GetVectorComponentCount(TypeID typeID) noexcept -> std::optional<size_t>
       break;
     case TypeID::Vec2:
     case TypeID::Vec2i:
-      return 1;
+      return 2;
     case TypeID::Vec3:
     case TypeID::Vec3i:
       return 3;
@@ -126,6 +126,18 @@ operator<<(std::ostream& os, Variability variability)
   return os;
 }
 
+Variability
+CommonVariability(Variability a, Variability b) noexcept
+{
+  if ((a == Variability::Varying) || (b == Variability::Varying))
+    return Variability::Varying;
+
+  if ((a == Variability::Uniform) && (b == Variability::Uniform))
+    return Variability::Uniform;
+
+  return Variability::Unbound;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const Type& type)
 {
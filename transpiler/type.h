@@ -42,6 +42,11 @@ enum class Variability
 std::ostream&
 operator<<(std::ostream&, Variability variability);
 
+/// @brief Gets the variability of a value computed from two other values.
+/// The result is only uniform if both values are uniform.
+Variability
+CommonVariability(Variability a, Variability b) noexcept;
+
 class Type final
 {
 public:
@@ -0,0 +1,104 @@
+#include "type_annotation.h"
+
+#include "decl.h"
+#include "module.h"
+
+namespace {
+
+/// @brief Annotates the subexpressions of an expression before the expression
+/// itself, so that computing each type only reads the stored types of the
+/// subexpressions.
+class ExprAnnotator final : public ExprMutator
+{
+public:
+  void Mutate(FuncCall& funcCall) const override { Annotate(funcCall); }
+
+  void Mutate(IntLiteral& intLiteral) const override
+  {
+    intLiteral.AnnotateType();
+  }
+
+  void Mutate(BoolLiteral& boolLiteral) const override
+  {
+    boolLiteral.AnnotateType();
+  }
+
+  void Mutate(FloatLiteral& floatLiteral) const override
+  {
+    floatLiteral.AnnotateType();
+  }
+
+  void Mutate(BinaryExpr& binaryExpr) const override { Annotate(binaryExpr); }
+
+  void Mutate(UnaryExpr& unaryExpr) const override { Annotate(unaryExpr); }
+
+  void Mutate(GroupExpr& groupExpr) const override { Annotate(groupExpr); }
+
+  void Mutate(VarRef& varRef) const override { varRef.AnnotateType(); }
+
+  void Mutate(TypeConstructor& typeConstructor) const override
+  {
+    Annotate(typeConstructor);
+  }
+
+  void Mutate(MemberExpr& memberExpr) const override { Annotate(memberExpr); }
+
+private:
+  template<typename ExprType>
+  void Annotate(ExprType& expr) const
+  {
+    expr.Recurse(*this);
+
+    expr.AnnotateType();
+  }
+};
+
+class StmtAnnotator final : public StmtMutator
+{
+public:
+  void Mutate(AssignmentStmt& assignmentStmt) override
+  {
+    assignmentStmt.LValue().AcceptMutator(mExprAnnotator);
+
+    assignmentStmt.RValue().AcceptMutator(mExprAnnotator);
+  }
+
+  void Mutate(CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Mutate(DeclStmt& declStmt) override
+  {
+    auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      varDecl.InitExpr().AcceptMutator(mExprAnnotator);
+  }
+
+  void Mutate(ReturnStmt& returnStmt) override
+  {
+    returnStmt.ReturnValue().AcceptMutator(mExprAnnotator);
+  }
+
+private:
+  ExprAnnotator mExprAnnotator;
+};
+
+} // namespace
+
+void
+AnnotateTypes(Module& module)
+{
+  ExprAnnotator exprAnnotator;
+
+  for (auto& globalVar : module.GlobalVars()) {
+    if (globalVar->HasInitExpr())
+      globalVar->InitExpr().AcceptMutator(exprAnnotator);
+  }
+
+  StmtAnnotator stmtAnnotator;
+
+  for (auto& fn : module.Funcs())
+    fn->AcceptBodyMutator(stmtAnnotator);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+class Module;
+
+/// @brief Computes the type of every expression in the module once, and
+/// stores it on the expression, so that later passes can get the type of any
+/// expression without computing the types of its subexpressions again.
+///
+/// @note This should be called after the module has been resolved, since the
+/// types of variable references and function calls come from the
+/// declarations they resolve to. Passes that change the module afterwards have
+/// to keep the type of each expression they replace.
+void
+AnnotateTypes(Module& module);
@@ -4,6 +4,8 @@
 #include "expr.h"
 #include "type_environment.h"
 
+#include <array>
+
 /// @brief The job of this class is to compute the type of an expression
 /// belonging to an abstract type environment. The type environment is
 /// abstracted for the purpose of testing.
@@ -41,6 +43,16 @@ public:
 
   void Visit(const FuncCall& funcCall) override
   {
+    if (funcCall.IsBuiltin()) {
+
+      const auto& args = funcCall.Args();
+
+      if (!args.empty())
+        args[0]->AcceptVisitor(*this);
+
+      return;
+    }
+
     const auto& funcDecl = funcCall.GetFuncDecl();
 
     mType = funcDecl.ReturnType();
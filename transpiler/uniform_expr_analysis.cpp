@@ -0,0 +1,460 @@
+#include "uniform_expr_analysis.h"
+
+#include "decl.h"
+#include "module.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+/// @brief Prints the structure of an expression, so that two expressions
+/// that compute the same value can be identified.
+class ExprKeyPrinter final : public ExprVisitor
+{
+public:
+  std::string String() const { return mStream.str(); }
+
+  void Visit(const IntLiteral& intLiteral) override
+  {
+    mStream << "i:" << intLiteral.Value();
+  }
+
+  void Visit(const BoolLiteral& boolLiteral) override
+  {
+    mStream << "b:" << boolLiteral.Value();
+  }
+
+  void Visit(const FloatLiteral& floatLiteral) override
+  {
+    mStream << "f:" << std::setprecision(17) << floatLiteral.Value();
+  }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    mStream << "(bin:" << int(binaryExpr.GetKind()) << ' ';
+    binaryExpr.LeftExpr().AcceptVisitor(*this);
+    mStream << ' ';
+    binaryExpr.RightExpr().AcceptVisitor(*this);
+    mStream << ')';
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    mStream << "(un:" << int(unaryExpr.GetKind()) << ' ';
+    unaryExpr.Recurse(*this);
+    mStream << ')';
+  }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef& varRef) override
+  {
+    mStream << "v:" << varRef.Identifier();
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    mStream << "(call:" << funcCall.Identifier();
+    VisitList(funcCall.Args());
+    mStream << ')';
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    mStream << "(ctor:" << typeConstructor.GetType().value().ID();
+    VisitList(typeConstructor.Args());
+    mStream << ')';
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    mStream << "(mem:" << memberExpr.MemberName().Identifier() << ' ';
+    memberExpr.Recurse(*this);
+    mStream << ')';
+  }
+
+private:
+  void VisitList(const ExprList& exprList)
+  {
+    for (const auto& expr : exprList) {
+      mStream << ' ';
+      expr->AcceptVisitor(*this);
+    }
+  }
+
+  std::ostringstream mStream;
+};
+
+/// @brief Ordered so that combining expressions is a matter of taking the
+/// maximum value.
+enum class ExprClass
+{
+  /// Only literals.
+  Constant,
+  /// Literals and uniform globals.
+  Uniform,
+  /// Anything that may change from one pixel to the next.
+  Varying
+};
+
+/// @brief Classifies each expression and collects the largest uniform ones.
+class UniformExprFinder final : public ExprVisitor
+{
+public:
+  /// @brief Searches an expression that appears in a statement.
+  void Search(const Expr& expr)
+  {
+    if (Classify(expr) == ExprClass::Uniform)
+      Collect(expr);
+  }
+
+  auto Candidates() const noexcept -> const std::vector<const Expr*>&
+  {
+    return mCandidates;
+  }
+
+  void Visit(const IntLiteral&) override { mClass = ExprClass::Constant; }
+
+  void Visit(const BoolLiteral&) override { mClass = ExprClass::Constant; }
+
+  void Visit(const FloatLiteral&) override { mClass = ExprClass::Constant; }
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    Combine({ &binaryExpr.LeftExpr(), &binaryExpr.RightExpr() });
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override
+  {
+    Combine({ &unaryExpr.BaseExpr() });
+  }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef& varRef) override
+  {
+    auto isUniform =
+      varRef.HasResolvedVar() && varRef.ResolvedVar().IsUniformGlobal();
+
+    mClass = isUniform ? ExprClass::Uniform : ExprClass::Varying;
+  }
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    // Calls to module functions may read or write varying state, so only
+    // their arguments can be hoisted.
+    Combine(funcCall.Args(), !funcCall.IsBuiltin());
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    Combine(typeConstructor.Args());
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    Combine({ &memberExpr.BaseExpr() });
+  }
+
+private:
+  ExprClass Classify(const Expr& expr)
+  {
+    expr.AcceptVisitor(*this);
+    return mClass;
+  }
+
+  /// @param varying Whether the parent expression varies regardless of the
+  /// expressions it is made of.
+  template<typename ExprContainer>
+  void Combine(const ExprContainer& exprs, bool varying = false)
+  {
+    std::vector<ExprClass> classes;
+
+    auto combined = varying ? ExprClass::Varying : ExprClass::Constant;
+
+    for (const auto& expr : exprs) {
+      classes.emplace_back(Classify(*expr));
+      combined = std::max(combined, classes.back());
+    }
+
+    // Once the expression is known to vary, its uniform parts are as large as
+    // they are going to get.
+    if (combined == ExprClass::Varying) {
+      size_t i = 0;
+      for (const auto& expr : exprs) {
+        if (classes[i++] == ExprClass::Uniform)
+          Collect(*expr);
+      }
+    }
+
+    mClass = combined;
+  }
+
+  void Combine(std::initializer_list<const Expr*> exprs)
+  {
+    Combine<std::initializer_list<const Expr*>>(exprs);
+  }
+
+  void Collect(const Expr& expr)
+  {
+    if (!IsTrivial(expr) && expr.GetType())
+      mCandidates.emplace_back(&expr);
+  }
+
+  /// @brief Indicates whether an expression is as cheap to compute as it is
+  /// to read back from a hoisted value.
+  static bool IsTrivial(const Expr& expr)
+  {
+    if (dynamic_cast<const VarRef*>(&expr))
+      return true;
+
+    if (const auto* memberExpr = dynamic_cast<const MemberExpr*>(&expr))
+      return IsTrivial(memberExpr->BaseExpr());
+
+    if (const auto* unaryExpr = dynamic_cast<const UnaryExpr*>(&expr))
+      return IsTrivial(unaryExpr->BaseExpr());
+
+    return false;
+  }
+
+  ExprClass mClass = ExprClass::Constant;
+
+  std::vector<const Expr*> mCandidates;
+};
+
+class StmtUniformExprFinder final : public StmtVisitor
+{
+public:
+  auto Candidates() const noexcept -> const std::vector<const Expr*>&
+  {
+    return mExprFinder.Candidates();
+  }
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    mExprFinder.Search(assignmentStmt.RValue());
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    const auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      mExprFinder.Search(varDecl.InitExpr());
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    mExprFinder.Search(returnStmt.ReturnValue());
+  }
+
+private:
+  UniformExprFinder mExprFinder;
+};
+
+/// @brief Finds the module functions called by an expression.
+class ExprCallFinder final : public ExprVisitor
+{
+public:
+  ExprCallFinder(std::vector<const FuncDecl*>& callees)
+    : mCallees(callees)
+  {}
+
+  void Visit(const IntLiteral&) override {}
+
+  void Visit(const BoolLiteral&) override {}
+
+  void Visit(const FloatLiteral&) override {}
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    binaryExpr.Recurse(*this);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override { unaryExpr.Recurse(*this); }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef&) override {}
+
+  void Visit(const FuncCall& funcCall) override
+  {
+    if (funcCall.Resolved() && !funcCall.IsBuiltin())
+      mCallees.emplace_back(&funcCall.GetFuncDecl());
+
+    funcCall.Recurse(*this);
+  }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    memberExpr.Recurse(*this);
+  }
+
+private:
+  std::vector<const FuncDecl*>& mCallees;
+};
+
+class StmtCallFinder final : public StmtVisitor
+{
+public:
+  StmtCallFinder(std::vector<const FuncDecl*>& callees)
+    : mExprFinder(callees)
+  {}
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    assignmentStmt.LValue().AcceptVisitor(mExprFinder);
+    assignmentStmt.RValue().AcceptVisitor(mExprFinder);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    const auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      varDecl.InitExpr().AcceptVisitor(mExprFinder);
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    returnStmt.ReturnValue().AcceptVisitor(mExprFinder);
+  }
+
+private:
+  ExprCallFinder mExprFinder;
+};
+
+/// @brief Finds all the functions that can be reached from the entry points
+/// accepted by the predicate, including the entry points themselves.
+template<typename Predicate>
+std::set<const FuncDecl*>
+FindReachableFuncs(const Module& module, Predicate predicate)
+{
+  std::vector<const FuncDecl*> pending;
+
+  for (const auto& func : module.Funcs()) {
+    if (predicate(*func))
+      pending.emplace_back(func.get());
+  }
+
+  std::set<const FuncDecl*> reachable;
+
+  while (!pending.empty()) {
+
+    const auto* func = pending.back();
+
+    pending.pop_back();
+
+    if (!reachable.emplace(func).second)
+      continue;
+
+    StmtCallFinder callFinder(pending);
+
+    func->AcceptBodyVisitor(callFinder);
+  }
+
+  return reachable;
+}
+
+} // namespace
+
+auto
+UniformExprAnalysis::FindHoistedName(const Expr& expr) const
+  -> std::optional<std::string>
+{
+  auto it = mHoistedExprMap.find(&expr);
+  if (it == mHoistedExprMap.end())
+    return {};
+
+  return mHoistedExprs[it->second].name;
+}
+
+bool
+UniformExprAnalysis::AnalyzeModule()
+{
+  const auto& module = GetModule();
+
+  auto samplerFuncs = FindReachableFuncs(
+    module, [](const FuncDecl& func) { return func.IsPixelSampler(); });
+
+  auto encoderFuncs = FindReachableFuncs(
+    module, [](const FuncDecl& func) { return func.IsPixelEncoder(); });
+
+  mSamplerFuncs.clear();
+
+  for (const auto* func : samplerFuncs) {
+    if (encoderFuncs.count(func) == 0)
+      mSamplerFuncs.emplace(func);
+  }
+
+  mHoistedExprs.clear();
+
+  mHoistedKeyMap.clear();
+
+  mHoistedExprMap.clear();
+
+  return AnalysisPass::AnalyzeModule();
+}
+
+bool
+UniformExprAnalysis::AnalyzeVarDecl(const VarDecl&)
+{
+  return true;
+}
+
+bool
+UniformExprAnalysis::AnalyzeFuncDecl(const FuncDecl& funcDecl)
+{
+  if (mSamplerFuncs.count(&funcDecl) == 0)
+    return true;
+
+  StmtUniformExprFinder finder;
+
+  funcDecl.AcceptBodyVisitor(finder);
+
+  for (const auto* expr : finder.Candidates())
+    Hoist(*expr);
+
+  return true;
+}
+
+void
+UniformExprAnalysis::Hoist(const Expr& expr)
+{
+  ExprKeyPrinter keyPrinter;
+
+  expr.AcceptVisitor(keyPrinter);
+
+  auto key = keyPrinter.String();
+
+  auto it = mHoistedKeyMap.find(key);
+
+  if (it == mHoistedKeyMap.end()) {
+
+    auto index = mHoistedExprs.size();
+
+    mHoistedExprs.emplace_back(
+      HoistedExpr{ &expr, "hoisted_" + std::to_string(index) });
+
+    it = mHoistedKeyMap.emplace(key, index).first;
+  }
+
+  mHoistedExprMap.emplace(&expr, it->second);
+}
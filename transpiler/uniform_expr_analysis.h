@@ -0,0 +1,68 @@
+#pragma once
+
+#include "analysis_pass.h"
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+class Expr;
+
+/// @brief Finds the expressions, in the pixel sampler and the functions it
+/// calls, that only depend on uniform global variables.
+///
+/// @detail Since these expressions have the same value for every pixel, they
+/// can be computed once per frame instead of once per pixel. Only the largest
+/// of these expressions are recorded, so an expression is never hoisted along
+/// with one of its subexpressions. Expressions that are just a reference to a
+/// uniform variable (or a swizzle of one) aren't worth hoisting, and are left
+/// alone.
+///
+/// Functions that are also reachable from the pixel encoder are not analyzed,
+/// since the pixel encoder may run without the hoisted values being prepared.
+class UniformExprAnalysis final : public AnalysisPass
+{
+public:
+  struct HoistedExpr final
+  {
+    /// @brief The first expression found with this value. Any other
+    /// expression that is structurally the same shares this entry.
+    const Expr* expr;
+
+    /// @brief The name of the field that holds the value of the expression.
+    std::string name;
+  };
+
+  auto HoistedExprs() const noexcept -> const std::vector<HoistedExpr>&
+  {
+    return mHoistedExprs;
+  }
+
+  /// @brief Finds the hoisted value that an expression should be replaced
+  /// with.
+  ///
+  /// @return The name of the field holding the value, if there is one.
+  auto FindHoistedName(const Expr& expr) const -> std::optional<std::string>;
+
+protected:
+  bool AnalyzeModule() override;
+
+  bool AnalyzeVarDecl(const VarDecl&) override;
+
+  bool AnalyzeFuncDecl(const FuncDecl&) override;
+
+private:
+  void Hoist(const Expr& expr);
+
+  std::set<const FuncDecl*> mSamplerFuncs;
+
+  std::vector<HoistedExpr> mHoistedExprs;
+
+  /// @brief Maps the structure of each hoisted expression, printed as a
+  /// string, to its index in the list of hoisted expressions.
+  std::map<std::string, size_t> mHoistedKeyMap;
+
+  std::map<const Expr*, size_t> mHoistedExprMap;
+};
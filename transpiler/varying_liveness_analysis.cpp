@@ -0,0 +1,187 @@
+#include "varying_liveness_analysis.h"
+
+#include "decl.h"
+#include "module.h"
+
+namespace {
+
+/// @brief Finds the global variables that an expression refers to.
+class ExprGlobalVarFinder final : public ExprVisitor
+{
+public:
+  ExprGlobalVarFinder(std::vector<const VarDecl*>& vars)
+    : mVars(vars)
+  {}
+
+  void Visit(const IntLiteral&) override {}
+
+  void Visit(const BoolLiteral&) override {}
+
+  void Visit(const FloatLiteral&) override {}
+
+  void Visit(const BinaryExpr& binaryExpr) override
+  {
+    binaryExpr.Recurse(*this);
+  }
+
+  void Visit(const UnaryExpr& unaryExpr) override { unaryExpr.Recurse(*this); }
+
+  void Visit(const GroupExpr& groupExpr) override { groupExpr.Recurse(*this); }
+
+  void Visit(const VarRef& varRef) override
+  {
+    if (varRef.HasResolvedVar() && varRef.ResolvedVar().IsGlobal())
+      mVars.emplace_back(&varRef.ResolvedVar());
+  }
+
+  void Visit(const FuncCall& funcCall) override { funcCall.Recurse(*this); }
+
+  void Visit(const TypeConstructor& typeConstructor) override
+  {
+    typeConstructor.Recurse(*this);
+  }
+
+  void Visit(const MemberExpr& memberExpr) override
+  {
+    memberExpr.Recurse(*this);
+  }
+
+private:
+  std::vector<const VarDecl*>& mVars;
+};
+
+/// @brief Records, for each global variable, whether the first time a
+/// function accesses it is a read or an assignment.
+///
+/// @detail Since there is no control flow, the statements are simply checked
+/// in the order they appear.
+class StmtGlobalVarAccessFinder final : public StmtVisitor
+{
+public:
+  auto ReadVars() const noexcept -> const std::set<const VarDecl*>&
+  {
+    return mReadVars;
+  }
+
+  auto WrittenVars() const noexcept -> const std::set<const VarDecl*>&
+  {
+    return mWrittenVars;
+  }
+
+  void Visit(const AssignmentStmt& assignmentStmt) override
+  {
+    Read(assignmentStmt.RValue());
+
+    const auto* varRef = dynamic_cast<const VarRef*>(&assignmentStmt.LValue());
+
+    // Assigning a part of a variable, like a vector component, keeps the value
+    // of the other parts.
+    if (!varRef) {
+      Read(assignmentStmt.LValue());
+      return;
+    }
+
+    if (!varRef->HasResolvedVar() || !varRef->ResolvedVar().IsGlobal())
+      return;
+
+    const auto* var = &varRef->ResolvedVar();
+
+    if (mReadVars.count(var) == 0)
+      mWrittenVars.emplace(var);
+  }
+
+  void Visit(const CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Visit(const DeclStmt& declStmt) override
+  {
+    const auto& varDecl = declStmt.GetVarDecl();
+
+    if (varDecl.HasInitExpr())
+      Read(varDecl.InitExpr());
+  }
+
+  void Visit(const ReturnStmt& returnStmt) override
+  {
+    Read(returnStmt.ReturnValue());
+  }
+
+private:
+  void Read(const Expr& expr)
+  {
+    std::vector<const VarDecl*> vars;
+
+    ExprGlobalVarFinder finder(vars);
+
+    expr.AcceptVisitor(finder);
+
+    for (const auto* var : vars) {
+      if (mWrittenVars.count(var) == 0)
+        mReadVars.emplace(var);
+    }
+  }
+
+  std::set<const VarDecl*> mReadVars;
+
+  std::set<const VarDecl*> mWrittenVars;
+};
+
+} // namespace
+
+bool
+VaryingLivenessAnalysis::IsStored(const VarDecl& varDecl) const
+{
+  return mStoredVars.count(&varDecl) != 0;
+}
+
+bool
+VaryingLivenessAnalysis::AnalyzeModule()
+{
+  mStoredVars.clear();
+
+  mSamplerWrittenVars.clear();
+
+  mSamplerLocals.clear();
+
+  auto success = AnalysisPass::AnalyzeModule();
+
+  for (const auto* var : GetModule().VaryingGlobalVars()) {
+    if (!IsStored(*var) && mSamplerWrittenVars.count(var))
+      mSamplerLocals.emplace_back(var);
+  }
+
+  return success;
+}
+
+bool
+VaryingLivenessAnalysis::AnalyzeVarDecl(const VarDecl&)
+{
+  return true;
+}
+
+bool
+VaryingLivenessAnalysis::AnalyzeFuncDecl(const FuncDecl& funcDecl)
+{
+  StmtGlobalVarAccessFinder accessFinder;
+
+  funcDecl.AcceptBodyVisitor(accessFinder);
+
+  for (const auto* var : accessFinder.ReadVars()) {
+    if (var->IsVaryingGlobal())
+      mStoredVars.emplace(var);
+  }
+
+  for (const auto* var : accessFinder.WrittenVars()) {
+    if (!var->IsVaryingGlobal())
+      continue;
+
+    if (funcDecl.IsPixelSampler())
+      mSamplerWrittenVars.emplace(var);
+    else
+      mStoredVars.emplace(var);
+  }
+
+  return true;
+}
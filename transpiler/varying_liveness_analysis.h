@@ -0,0 +1,49 @@
+#pragma once
+
+#include "analysis_pass.h"
+
+#include <set>
+#include <vector>
+
+/// @brief Finds the varying global variables that have to be stored with
+/// each pixel.
+///
+/// @detail A varying global variable is only stored with each pixel if its
+/// value may be needed after the pixel sampler returns. That is the case when
+/// a function other than the pixel sampler refers to it, or when the pixel
+/// sampler may read it before assigning it a value, which would read the
+/// value from the previous frame.
+///
+/// The other variables are only temporaries of the pixel sampler, and can be
+/// declared as its local variables. Variables that are not referred to at all
+/// are neither stored nor declared.
+class VaryingLivenessAnalysis final : public AnalysisPass
+{
+public:
+  /// @brief Indicates whether a varying global variable is stored with each
+  /// pixel.
+  bool IsStored(const VarDecl& varDecl) const;
+
+  /// @brief Gets the varying global variables that are declared as local
+  /// variables of the pixel sampler, in the order they are declared in the
+  /// module.
+  auto SamplerLocals() const noexcept -> const std::vector<const VarDecl*>&
+  {
+    return mSamplerLocals;
+  }
+
+protected:
+  bool AnalyzeModule() override;
+
+  bool AnalyzeVarDecl(const VarDecl&) override;
+
+  bool AnalyzeFuncDecl(const FuncDecl&) override;
+
+private:
+  std::set<const VarDecl*> mStoredVars;
+
+  /// @brief The variables that the pixel sampler assigns before reading.
+  std::set<const VarDecl*> mSamplerWrittenVars;
+
+  std::vector<const VarDecl*> mSamplerLocals;
+};
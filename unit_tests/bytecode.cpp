@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "bytecode_generator.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+#include "pathway_vm.h"
+
+#include <sstream>
+
+namespace {
+
+std::string
+MakeBytecode(const std::string& source)
+{
+  auto module = StringToAnalyzedModule(source);
+
+  std::ostringstream stream;
+
+  bytecode::Generator generator(stream);
+
+  generator.Generate(*module);
+
+  return stream.str();
+}
+
+auto
+ParseBytecode(const std::string& bytecode)
+  -> std::unique_ptr<pathway::vm::program>
+{
+  return pathway::vm::program::parse(
+    reinterpret_cast<const unsigned char*>(bytecode.data()), bytecode.size());
+}
+
+const char* gSource = "export module m;\n"
+                      "uniform float gain = 2.0;\n"
+                      "uniform vec3 tint = vec3(0.25, 0.5, 1.0);\n"
+                      "vec3 color;\n"
+                      "float scale(float x) { return x * gain; }\n"
+                      "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                      "  color = tint * scale(uv_min.x);\n"
+                      "  color.z = gain * 0.25;\n"
+                      "}\n"
+                      "vec4 encode_pixel() {\n"
+                      "  return vec4(color, 1.0);\n"
+                      "}\n";
+
+} // namespace
+
+TEST(Bytecode, RendersPixels)
+{
+  auto program = ParseBytecode(MakeBytecode(gSource));
+
+  ASSERT_NE(program, nullptr);
+
+  pathway::vm::frame frame(*program);
+
+  frame.resize(2, 1);
+
+  frame.sample_pixels();
+
+  unsigned char rgb[6]{};
+
+  frame.encode_rgb(rgb);
+
+  EXPECT_EQ(rgb[0], 0);
+  EXPECT_EQ(rgb[1], 0);
+  EXPECT_EQ(rgb[2], 127);
+
+  EXPECT_EQ(rgb[3], 63);
+  EXPECT_EQ(rgb[4], 127);
+  EXPECT_EQ(rgb[5], 127);
+}
+
+TEST(Bytecode, SetsUniforms)
+{
+  auto program = ParseBytecode(MakeBytecode(gSource));
+
+  ASSERT_NE(program, nullptr);
+
+  pathway::vm::frame frame(*program);
+
+  EXPECT_TRUE(frame.set_uniform("gain", { 4.0f }));
+
+  EXPECT_FALSE(frame.set_uniform("gain", { 1, 2 }));
+
+  EXPECT_FALSE(frame.set_uniform("color", { 1.0f, 1.0f, 1.0f }));
+
+  frame.resize(2, 1);
+
+  frame.sample_pixels();
+
+  unsigned char rgb[6]{};
+
+  frame.encode_rgb(rgb);
+
+  // The value that only depends on 'gain' is computed again for the frame.
+  EXPECT_EQ(rgb[2], 255);
+
+  EXPECT_EQ(rgb[3], 127);
+  EXPECT_EQ(rgb[4], 255);
+  EXPECT_EQ(rgb[5], 255);
+}
+
+TEST(Bytecode, RejectsMalformedBytecode)
+{
+  auto bytecode = MakeBytecode(gSource);
+
+  EXPECT_EQ(ParseBytecode(bytecode.substr(0, bytecode.size() - 4)), nullptr);
+
+  auto badMagic = bytecode;
+
+  badMagic[0] = 'X';
+
+  EXPECT_EQ(ParseBytecode(badMagic), nullptr);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "c_simd_generator.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+#include <sstream>
+
+namespace {
+
+std::string
+MakeSource(const std::string& source, const GeneratorOptions& options = {})
+{
+  auto module = StringToAnalyzedModule(source);
+
+  std::ostringstream stream;
+
+  csimd::Generator generator(stream, options);
+
+  generator.Generate(*module);
+
+  return stream.str();
+}
+
+const char* gSource = "export module m;\n"
+                      "uniform float gain = 2.0;\n"
+                      "uniform int count = 3;\n"
+                      "vec3 color;\n"
+                      "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                      "  float unused = uv_max.y * 7.0;\n"
+                      "  color = vec3(uv_min.x * gain);\n"
+                      "}\n"
+                      "vec4 encode_pixel() {\n"
+                      "  return vec4(color, 1.0);\n"
+                      "}\n";
+
+} // namespace
+
+TEST(CSimd, DescribesModule)
+{
+  auto source = MakeSource(gSource);
+
+  EXPECT_NE(source.find("#include <pathway_simd.h>"), std::string::npos);
+
+  EXPECT_NE(source.find("const struct pathway_simd_module m_module"),
+            std::string::npos);
+
+  EXPECT_NE(source.find("{ \"gain\", 0, 1, 0 }"), std::string::npos);
+
+  EXPECT_NE(source.find("{ \"count\", 1, 1, 1 }"), std::string::npos);
+}
+
+TEST(CSimd, EmitsVectorCode)
+{
+  auto source = MakeSource(gSource);
+
+  EXPECT_NE(source.find("static void\nm_sample("), std::string::npos);
+
+  EXPECT_NE(source.find("const pw_f32 r"), std::string::npos);
+
+  // Values that are never stored aren't computed.
+  EXPECT_EQ(source.find("0x1.cp+2f"), std::string::npos);
+}
+
+TEST(CSimd, EmitsIsaVariants)
+{
+  EXPECT_EQ(MakeSource(gSource).find("PATHWAY_SIMD_TARGET_"),
+            std::string::npos);
+
+  GeneratorOptions options;
+
+  options.isaVariants = true;
+
+  auto source = MakeSource(gSource, options);
+
+  EXPECT_NE(source.find("static void PATHWAY_SIMD_TARGET_AVX2\nm_sample_avx2("),
+            std::string::npos);
+
+  // The baseline comes first, and the others are only compiled for x86.
+  auto baseline = source.find("{ PATHWAY_SIMD_ISA_BASELINE, { m_init,");
+
+  auto x86 = source.find("#if PATHWAY_SIMD_X86", baseline);
+
+  auto avx512 = source.find("{ PATHWAY_SIMD_ISA_AVX512, { m_init_avx512,");
+
+  EXPECT_NE(baseline, std::string::npos);
+
+  EXPECT_LT(baseline, x86);
+
+  EXPECT_LT(x86, avx512);
+
+  EXPECT_NE(avx512, std::string::npos);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "call_convention_analysis.h"
+#include "decl.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+TEST(CallConventionAnalysis, FindsAssignedParams)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 c;\n"
+                           "vec3 f(vec3 a, vec3 b) {\n"
+                           "  a.x = b.y;\n"
+                           "  return a + b;\n"
+                           "}\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = f(vec3(uv_min.x), vec3(uv_max.y));\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, 1.0);\n"
+                           "}\n");
+
+  CallConventionAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto* f = FindFunc(*module, "f");
+
+  ASSERT_NE(f, nullptr);
+
+  ASSERT_EQ(f->GetParamList().size(), 2);
+
+  EXPECT_TRUE(analysis.IsAssigned(*f->GetParamList()[0]));
+
+  EXPECT_FALSE(analysis.IsAssigned(*f->GetParamList()[1]));
+}
+
+TEST(CallConventionAnalysis, InlinesSmallLeafFuncs)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 c;\n"
+                           "vec3 leaf(vec3 v) { return v * 2.0; }\n"
+                           "vec3 caller(vec3 v) { return leaf(v) + v; }\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = caller(vec3(uv_min.x, uv_max.y, 0.0));\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, 1.0);\n"
+                           "}\n");
+
+  CallConventionAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto* leaf = FindFunc(*module, "leaf");
+
+  const auto* caller = FindFunc(*module, "caller");
+
+  const auto* sampler = FindFunc(*module, "sample_pixel");
+
+  ASSERT_NE(leaf, nullptr);
+
+  ASSERT_NE(caller, nullptr);
+
+  ASSERT_NE(sampler, nullptr);
+
+  EXPECT_TRUE(analysis.IsAlwaysInlined(*leaf));
+
+  EXPECT_FALSE(analysis.IsAlwaysInlined(*caller));
+
+  EXPECT_FALSE(analysis.IsAlwaysInlined(*sampler));
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "const_fold.h"
+#include "cpp_generator_v2.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+#include <sstream>
+
+namespace {
+
+/// @brief Folds the constants in a function that returns the given
+/// expression, and generates the C++ for it.
+///
+/// @return The generated return statement.
+std::string
+FoldReturnValue(const std::string& returnType,
+                const std::string& expr,
+                MathMode mathMode = MathMode::Precise)
+{
+  auto module =
+    StringToAnalyzedModule("export module m;\n"
+                           "float x;\n"
+                           "vec3 v;\n"
+                           "int i;\n" +
+                           returnType + " f() {\n" + "  return " + expr +
+                           ";\n"
+                           "}\n");
+
+  FoldConstants(*module, mathMode);
+
+  std::ostringstream stream;
+
+  GeneratorOptions options;
+
+  options.mathMode = mathMode;
+
+  cpp::Generator generator(stream, options);
+
+  generator.Generate(*module);
+
+  auto code = stream.str();
+
+  auto begin = code.find("  return ");
+  if (begin == std::string::npos)
+    return "";
+
+  begin += 9;
+
+  return code.substr(begin, code.find(';', begin) - begin);
+}
+
+} // namespace
+
+TEST(ConstFold, FoldsArithmetic)
+{
+  EXPECT_EQ(FoldReturnValue("float", "x * (2.0 * 3.0 + 1.0)"),
+            "this->x * float_type(7)");
+
+  EXPECT_EQ(FoldReturnValue("float", "1.0 / 3.0"),
+            "float_type(0.3333333333333333)");
+
+  EXPECT_EQ(FoldReturnValue("int", "7 / 2 - 10"), "-int_type(7)");
+
+  EXPECT_EQ(FoldReturnValue("float", "2 * 0.25"), "float_type(0.5)");
+}
+
+TEST(ConstFold, LeavesUnsafeArithmetic)
+{
+  EXPECT_EQ(FoldReturnValue("int", "i / 0"), "this->i / int_type(0)");
+
+  EXPECT_EQ(FoldReturnValue("float", "1.0 / 0.0"),
+            "float_type(1) / float_type(0)");
+
+  EXPECT_EQ(FoldReturnValue("int", "65536 * 65536"),
+            "int_type(65536) * int_type(65536)");
+}
+
+TEST(ConstFold, FoldsVectors)
+{
+  EXPECT_EQ(FoldReturnValue("vec3", "vec3(1.0, vec2(2.0, 3.0)).zyx"),
+            "vector_constructor<3>::make(float_type(3), float_type(2), "
+            "float_type(1))");
+
+  EXPECT_EQ(FoldReturnValue("vec3", "vec3(0.5) * 2.0"),
+            "vector_constructor<3>::make(float_type(1))");
+
+  EXPECT_EQ(FoldReturnValue("float", "vec2(1.0, 4.0).y"), "float_type(4)");
+}
+
+TEST(ConstFold, RemovesIdentities)
+{
+  EXPECT_EQ(FoldReturnValue("float", "x * 1.0"), "this->x");
+
+  EXPECT_EQ(FoldReturnValue("float", "1.0 * x"), "this->x");
+
+  EXPECT_EQ(FoldReturnValue("vec3", "v / 1.0"), "this->v");
+
+  EXPECT_EQ(FoldReturnValue("float", "x - 0.0"), "this->x");
+
+  // Only removed in fast math mode, since -0 + 0 is +0.
+  EXPECT_EQ(FoldReturnValue("float", "x + 0.0"),
+            "this->x + float_type(0)");
+
+  EXPECT_EQ(FoldReturnValue("float", "x + 0.0", MathMode::Fast), "this->x");
+
+  // The result would be an integer otherwise.
+  EXPECT_EQ(FoldReturnValue("float", "i * 1.0"),
+            "this->i * float_type(1)");
+}
+
+TEST(ConstFold, DivisionByConstant)
+{
+  EXPECT_EQ(FoldReturnValue("vec3", "v / 4.0"), "this->v * float_type(0.25)");
+
+  EXPECT_EQ(FoldReturnValue("float", "x / 3.0"), "this->x / float_type(3)");
+
+  EXPECT_EQ(FoldReturnValue("float", "x / 3.0", MathMode::Fast),
+            "this->x * float_type(0.3333333333333333)");
+
+  EXPECT_EQ(FoldReturnValue("int", "i / 2"), "this->i / int_type(2)");
+}
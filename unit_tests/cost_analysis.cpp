@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "cost_analysis.h"
+#include "decl.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+#include <sstream>
+
+namespace {
+
+auto
+FindFuncCost(const CostAnalysis& analysis, const FuncDecl* funcDecl)
+  -> const CostAnalysis::FuncCost*
+{
+  for (const auto& funcCost : analysis.FuncCosts()) {
+    if (funcCost.funcDecl == funcDecl)
+      return &funcCost;
+  }
+
+  return nullptr;
+}
+
+} // namespace
+
+TEST(CostAnalysis, SumsCallees)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 c;\n"
+                           "vec3 f(vec3 v) { return v * 2.0 + v; }\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = f(vec3(uv_min.x, 0.0, 0.0)) * uv_max.x;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, 1.0);\n"
+                           "}\n");
+
+  CostAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto* f = FindFuncCost(analysis, FindFunc(*module, "f"));
+
+  ASSERT_NE(f, nullptr);
+
+  EXPECT_EQ(f->self.vectorFlops, 6);
+
+  const auto* sampler =
+    FindFuncCost(analysis, FindFunc(*module, "sample_pixel"));
+
+  ASSERT_NE(sampler, nullptr);
+
+  EXPECT_EQ(sampler->self.vectorFlops, 3);
+
+  EXPECT_EQ(sampler->self.calls, 1);
+
+  EXPECT_EQ(sampler->self.varyingStores, 1);
+
+  EXPECT_EQ(sampler->total.vectorFlops, 9);
+
+  EXPECT_FALSE(sampler->recursive);
+
+  auto sampleCost = analysis.SampleCost();
+
+  EXPECT_EQ(sampleCost.vectorFlops, 9);
+
+  EXPECT_EQ(sampleCost.varyingLoads, 1);
+
+  EXPECT_EQ(sampleCost.varyingStores, 1);
+}
+
+TEST(CostAnalysis, CountsHoistedExprsAsLoads)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float c;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = uv_min.x * (a * 2.0 + 1.0);\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, c, c, 1.0);\n"
+                           "}\n");
+
+  CostAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto* sampler =
+    FindFuncCost(analysis, FindFunc(*module, "sample_pixel"));
+
+  ASSERT_NE(sampler, nullptr);
+
+  EXPECT_EQ(sampler->self.scalarFlops, 1);
+
+  EXPECT_EQ(sampler->self.uniformLoads, 1);
+}
+
+TEST(CostAnalysis, CountsMatrixProducts)
+{
+  auto module =
+    StringToAnalyzedModule("mat3 square(mat3 m) { return m * m; }\n"
+                           "float c;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = uv_min.x;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, c, c, 1.0);\n"
+                           "}\n");
+
+  CostAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto* square = FindFuncCost(analysis, FindFunc(*module, "square"));
+
+  ASSERT_NE(square, nullptr);
+
+  EXPECT_EQ(square->self.matrixFlops, 45);
+
+  std::ostringstream report;
+
+  PrintCostReport(report, analysis);
+
+  EXPECT_NE(report.str().find("square"), std::string::npos);
+}
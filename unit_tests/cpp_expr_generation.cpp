@@ -35,6 +35,11 @@ public:
     return mExpectedVectorType;
   }
 
+  auto GetHoistedNameImpl(const Expr&) const -> std::optional<std::string>
+  {
+    return {};
+  }
+
   void DefineVarOrigin(const std::string& name, cpp::VarOrigin origin)
   {
     mVarOriginMap.emplace(name, origin);
@@ -164,6 +169,25 @@ TEST(CppExpr, FuncCall)
   EXPECT_EQ(out, "foo(int_type(2))");
 }
 
+TEST(CppExpr, BuiltinFuncCall)
+{
+  FakeExprEnv env;
+
+  auto expr = StringToExpr("exp(2.0)");
+
+  auto* funcCall = dynamic_cast<FuncCall*>(expr.get());
+
+  ASSERT_NE(funcCall, nullptr);
+
+  funcCall->ResolveBuiltin(BuiltinID::Exp);
+
+  cpp::ExprGenerator<FakeExprEnv> generator(env);
+
+  expr->AcceptVisitor(generator);
+
+  EXPECT_EQ(generator.String(), "math::exp(float_type(2))");
+}
+
 TEST(CppExpr, MulExpr_2)
 {
   FakeExprEnv env;
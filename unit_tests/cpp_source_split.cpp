@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "cpp_generator_v2.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+#include <sstream>
+
+namespace {
+
+const char* gSource = "export module m;\n"
+                      "float f(float x) { return x * 2.0; }\n";
+
+GeneratorOptions
+MakeOptions()
+{
+  GeneratorOptions options;
+
+  options.instantiations.emplace_back(ScalarTypes{ "float", "int" });
+
+  return options;
+}
+
+} // namespace
+
+TEST(CppSourceSplit, HeaderDeclaresInstantiations)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  ASSERT_NE(module, nullptr);
+
+  std::ostringstream stream;
+
+  cpp::Generator generator(stream, MakeOptions());
+
+  generator.Generate(*module);
+
+  auto header = stream.str();
+
+  EXPECT_NE(header.find("extern template struct varying_data<float, int>;"),
+            std::string::npos);
+
+  // The definitions are only in the source file.
+  EXPECT_EQ(header.find("return x * "), std::string::npos);
+}
+
+TEST(CppSourceSplit, SourceDefinesInstantiations)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  ASSERT_NE(module, nullptr);
+
+  std::ostringstream stream;
+
+  cpp::Generator generator(stream, MakeOptions());
+
+  generator.GenerateSource(*module, "m.h");
+
+  auto source = stream.str();
+
+  EXPECT_EQ(source.find("#include \"m.h\""), 0);
+
+  EXPECT_NE(source.find("return x * "), std::string::npos);
+
+  EXPECT_NE(source.find("\ntemplate struct varying_data<float, int>;"),
+            std::string::npos);
+}
+
+TEST(CppSourceSplit, UsesScalarTypesOfInstantiation)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  ASSERT_NE(module, nullptr);
+
+  GeneratorOptions options;
+
+  options.instantiations.emplace_back(ScalarTypes{ "double", "long" });
+
+  std::ostringstream stream;
+
+  cpp::Generator generator(stream, options);
+
+  generator.Generate(*module);
+
+  auto header = stream.str();
+
+  EXPECT_NE(header.find("extern template struct varying_data<double, long>;"),
+            std::string::npos);
+
+  // The float type of the module is that of the instantiation.
+  EXPECT_NE(header.find("noexcept -> float_type;"), std::string::npos);
+
+  EXPECT_EQ(header.find("<float>"), std::string::npos);
+}
@@ -4,14 +4,14 @@
 
 TEST(Diagnostics, GetClippedLocation)
 {
-  Location loc1{ 1, 7, 1, 7 };
+  LineColumnRange loc1{ 1, 7, 1, 7 };
 
   auto range1 = ConsoleDiagObserver::GetClippedLocation(1, " line 1", loc1);
 
   EXPECT_EQ(range1.index, 6);
   EXPECT_EQ(range1.length, 1);
 
-  Location loc2{ 2, 2, 3, 5 };
+  LineColumnRange loc2{ 2, 2, 3, 5 };
 
   auto range2 = ConsoleDiagObserver::GetClippedLocation(2, " line 2", loc2);
   auto range3 = ConsoleDiagObserver::GetClippedLocation(3, " line 3", loc2);
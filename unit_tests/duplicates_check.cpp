@@ -1,56 +1,73 @@
 #include <gtest/gtest.h>
 
 #include "duplicates_check.h"
+#include "line_table.h"
 #include "string_to_module.h"
 
 TEST(DuplicatesCheck, DuplicateGlobalVar)
 {
-  auto module = StringToModule("int a = 2;\n"
-                               "int a = 3;\n");
+  std::string source = "int a = 2;\n"
+                       "int a = 3;\n";
+
+  auto module = StringToModule(source);
+
+  LineTable lineTable(source);
 
   auto duplicates = DuplicatesCheck::Run(*module);
 
   ASSERT_EQ(duplicates.size(), 1);
 
-  EXPECT_EQ(duplicates[0].originalLocation.first_line, 1);
-  EXPECT_EQ(duplicates[0].duplicateLocation.last_line, 2);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].originalLocation.begin), 1);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].duplicateLocation.begin), 2);
 }
 
 TEST(DuplicatesCheck, DuplicateGlobalVar2)
 {
-  auto module = StringToModule("int a() { return 0; }\n"
-                               "int a = 3;\n");
+  std::string source = "int a() { return 0; }\n"
+                       "int a = 3;\n";
+
+  auto module = StringToModule(source);
+
+  LineTable lineTable(source);
 
   auto duplicates = DuplicatesCheck::Run(*module);
 
   ASSERT_EQ(duplicates.size(), 1);
 
-  EXPECT_EQ(duplicates[0].originalLocation.first_line, 1);
-  EXPECT_EQ(duplicates[0].duplicateLocation.last_line, 2);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].originalLocation.begin), 1);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].duplicateLocation.begin), 2);
 }
 
 TEST(DuplicatesCheck, DuplicateFunc)
 {
-  auto module = StringToModule("int a() { return 0; }\n"
-                               "int a() { return 0; }\n");
+  std::string source = "int a() { return 0; }\n"
+                       "int a() { return 0; }\n";
+
+  auto module = StringToModule(source);
+
+  LineTable lineTable(source);
 
   auto duplicates = DuplicatesCheck::Run(*module);
 
   ASSERT_EQ(duplicates.size(), 1);
 
-  EXPECT_EQ(duplicates[0].originalLocation.first_line, 1);
-  EXPECT_EQ(duplicates[0].duplicateLocation.last_line, 2);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].originalLocation.begin), 1);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].duplicateLocation.begin), 2);
 }
 
 TEST(DuplicatesCheck, DuplicateFunc2)
 {
-  auto module = StringToModule("int a = 0;\n"
-                               "int a() { return 0; }\n");
+  std::string source = "int a = 0;\n"
+                       "int a() { return 0; }\n";
+
+  auto module = StringToModule(source);
+
+  LineTable lineTable(source);
 
   auto duplicates = DuplicatesCheck::Run(*module);
 
   ASSERT_EQ(duplicates.size(), 1);
 
-  EXPECT_EQ(duplicates[0].originalLocation.first_line, 1);
-  EXPECT_EQ(duplicates[0].duplicateLocation.last_line, 2);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].originalLocation.begin), 1);
+  EXPECT_EQ(lineTable.GetLine(duplicates[0].duplicateLocation.begin), 2);
 }
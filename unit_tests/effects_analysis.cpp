@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "effects_analysis.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+TEST(EffectsAnalysis, DirectReferences)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float b;\n"
+                           "float f() { return a; }\n"
+                           "float g() { return b; }\n"
+                           "float h(float x) { return x * 2.0; }\n");
+
+  EXPECT_TRUE(FindFunc(*module, "f")->ReferencesFrameState());
+  EXPECT_FALSE(FindFunc(*module, "f")->ReferencesPixelState());
+
+  EXPECT_FALSE(FindFunc(*module, "g")->ReferencesFrameState());
+  EXPECT_TRUE(FindFunc(*module, "g")->ReferencesPixelState());
+
+  EXPECT_FALSE(FindFunc(*module, "h")->ReferencesGlobalState());
+}
+
+TEST(EffectsAnalysis, TransitiveReferences)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float b;\n"
+                           "float f() { return a; }\n"
+                           "float g() { return f() + b; }\n"
+                           "float h(float x) { return g() * x; }\n"
+                           "float k(float x) { return exp(x); }\n");
+
+  const auto* h = FindFunc(*module, "h");
+
+  EXPECT_TRUE(h->ReferencesFrameState());
+  EXPECT_TRUE(h->ReferencesPixelState());
+
+  EXPECT_FALSE(FindFunc(*module, "k")->ReferencesGlobalState());
+}
+
+TEST(EffectsAnalysis, RecursiveCalls)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float f(float x) { return g(x); }\n"
+                           "float g(float x) { return f(x) * a; }\n");
+
+  EXPECT_TRUE(FindFunc(*module, "f")->ReferencesFrameState());
+  EXPECT_TRUE(FindFunc(*module, "g")->ReferencesFrameState());
+
+  EXPECT_FALSE(FindFunc(*module, "f")->ReferencesPixelState());
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include "decl.h"
+#include "effects_analysis.h"
+#include "flat_tree.h"
+#include "module.h"
+
+#include "string_to_module.h"
+
+namespace {
+
+const char* gSource = "uniform float a;\n"
+                      "vec3 color;\n"
+                      "float f(float x) { return x * a; }\n"
+                      "float g(float x) { return f(x) + 1.0; }\n"
+                      "float h(float x) { return -x; }\n"
+                      "float r(float x) { return s(x); }\n"
+                      "float s(float x) { return r(x) * a; }\n"
+                      "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                      "  float y = g(uv_min.x);\n"
+                      "  color = vec3(y, h(y), (uv_max.y));\n"
+                      "}\n"
+                      "vec4 encode_pixel() {\n"
+                      "  return vec4(color, 1.0);\n"
+                      "}\n";
+
+uint32_t
+FindFuncIndex(const flat::Tree& tree, const char* name)
+{
+  for (uint32_t i = 0; i < tree.funcs.size(); i++) {
+    if (tree.funcs[i].name.Name() == name)
+      return i;
+  }
+
+  return flat::gNoIndex;
+}
+
+class NodeCounter final : public flat::PoolVisitor
+{
+public:
+  void Visit(const flat::BinaryExpr&, uint32_t index) override
+  {
+    EXPECT_EQ(index, binaryExprCount);
+
+    binaryExprCount++;
+  }
+
+  void Visit(const flat::FuncCall&, uint32_t index) override
+  {
+    EXPECT_EQ(index, funcCallCount);
+
+    funcCallCount++;
+  }
+
+  uint32_t binaryExprCount = 0;
+
+  uint32_t funcCallCount = 0;
+};
+
+} // namespace
+
+TEST(FlatTree, PacksKindAndIndex)
+{
+  flat::ExprRef ref(flat::ExprKind::MemberExpr, flat::ExprRef::gMaxIndex);
+
+  EXPECT_FALSE(ref.IsNull());
+
+  EXPECT_EQ(ref.GetKind(), flat::ExprKind::MemberExpr);
+
+  EXPECT_EQ(ref.Index(), flat::ExprRef::gMaxIndex);
+
+  EXPECT_TRUE(flat::ExprRef().IsNull());
+
+  EXPECT_EQ(sizeof(flat::ExprRef), 4);
+}
+
+TEST(FlatTree, FlattensDeclsInOrder)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  auto tree = flat::Flatten(*module);
+
+  ASSERT_EQ(tree.funcs.size(), module->Funcs().size());
+
+  for (size_t i = 0; i < tree.funcs.size(); i++)
+    EXPECT_EQ(tree.funcs[i].name, module->Funcs()[i]->GetSymbol());
+
+  // The global variables come first, then the parameters and locals.
+  EXPECT_EQ(tree.vars[0].name.Name(), "a");
+  EXPECT_EQ(tree.vars[0].variability, Variability::Uniform);
+  EXPECT_TRUE(tree.vars[0].isGlobal);
+
+  EXPECT_EQ(tree.vars[1].name.Name(), "color");
+
+  const auto& sampler = tree.funcs[FindFuncIndex(tree, "sample_pixel")];
+
+  ASSERT_EQ(sampler.params.count, 2);
+
+  EXPECT_EQ(tree.vars[sampler.params.first].name.Name(), "uv_min");
+  EXPECT_EQ(tree.vars[sampler.params.first + 1].name.Name(), "uv_max");
+  EXPECT_FALSE(tree.vars[sampler.params.first].isGlobal);
+
+  ASSERT_EQ(sampler.body.GetKind(), flat::StmtKind::CompoundStmt);
+
+  const auto& body = tree.compoundStmts[sampler.body.Index()];
+
+  ASSERT_EQ(body.stmts.count, 2);
+
+  EXPECT_EQ(tree.stmtLists[body.stmts.first].GetKind(),
+            flat::StmtKind::DeclStmt);
+
+  EXPECT_EQ(tree.stmtLists[body.stmts.first + 1].GetKind(),
+            flat::StmtKind::AssignmentStmt);
+}
+
+TEST(FlatTree, ResolvesReferencesToIndices)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  auto tree = flat::Flatten(*module);
+
+  auto g = FindFuncIndex(tree, "g");
+
+  auto f = FindFuncIndex(tree, "f");
+
+  bool foundCall = false;
+
+  for (const auto& funcCall : tree.funcCalls) {
+    if (funcCall.caller == g) {
+      EXPECT_EQ(funcCall.callee, f);
+      EXPECT_FALSE(funcCall.isBuiltin);
+      foundCall = true;
+    }
+  }
+
+  EXPECT_TRUE(foundCall);
+
+  for (const auto& varRef : tree.varRefs) {
+    ASSERT_NE(varRef.var, flat::gNoIndex);
+    EXPECT_EQ(tree.vars[varRef.var].name, varRef.name);
+  }
+
+  // The arguments of 'vec3(y, h(y), (uv_max.y))' are consecutive.
+  ASSERT_EQ(tree.typeConstructors.size(), 2);
+
+  const auto& args = tree.typeConstructors[0].args;
+
+  ASSERT_EQ(args.count, 3);
+
+  EXPECT_EQ(tree.exprLists[args.first].GetKind(), flat::ExprKind::VarRef);
+  EXPECT_EQ(tree.exprLists[args.first + 1].GetKind(), flat::ExprKind::FuncCall);
+  EXPECT_EQ(tree.exprLists[args.first + 2].GetKind(),
+            flat::ExprKind::GroupExpr);
+}
+
+TEST(FlatTree, VisitsPoolsInOrder)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  auto tree = flat::Flatten(*module);
+
+  NodeCounter counter;
+
+  tree.VisitPools(counter);
+
+  EXPECT_EQ(counter.binaryExprCount, tree.binaryExprs.size());
+
+  EXPECT_EQ(counter.funcCallCount, tree.funcCalls.size());
+
+  EXPECT_GT(tree.NodeCount(), tree.binaryExprs.size());
+}
+
+TEST(FlatTree, AnalyzesEffectsLikeModule)
+{
+  auto module = StringToAnalyzedModule(gSource);
+
+  auto tree = flat::Flatten(*module);
+
+  auto effects = AnalyzeEffects(tree);
+
+  ASSERT_EQ(effects.size(), module->Funcs().size());
+
+  for (size_t i = 0; i < effects.size(); i++) {
+
+    const auto& func = *module->Funcs()[i];
+
+    EXPECT_EQ(effects[i].referencesFrameState, func.ReferencesFrameState())
+      << func.Identifier();
+
+    EXPECT_EQ(effects[i].referencesPixelState, func.ReferencesPixelState())
+      << func.Identifier();
+  }
+
+  EXPECT_TRUE(effects[FindFuncIndex(tree, "r")].referencesFrameState);
+
+  EXPECT_FALSE(effects[FindFuncIndex(tree, "h")].referencesFrameState);
+}
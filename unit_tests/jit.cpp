@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "transpile.h"
+
+#include "pathway_jit.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class JitTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    mDirectory = fs::temp_directory_path() / "pathway_jit_test";
+
+    fs::remove_all(mDirectory);
+
+    fs::create_directories(mDirectory);
+  }
+
+  void TearDown() override { fs::remove_all(mDirectory); }
+
+  auto MakeCompiler() const -> pathway::jit::compiler
+  {
+    pathway::jit::compiler_options options;
+
+    options.command = PATHWAY_JIT_COMPILER;
+
+    options.flags = "-std=c++17 -O0";
+
+    options.include_dir = PATHWAY_RUNTIME_DIR;
+
+    options.cache_dir = mDirectory.string();
+
+    return pathway::jit::compiler(options);
+  }
+
+  static auto Generate(const char* color) -> std::string
+  {
+    TranspileOptions options;
+
+    options.genOptions.entryTable = true;
+
+    std::string source = "export module m;\n"
+                         "uniform float gain = 1.0;\n"
+                         "vec3 color;\n"
+                         "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                         "  color = ";
+
+    source += color;
+
+    source += " * gain;\n"
+              "}\n"
+              "vec4 encode_pixel() {\n"
+              "  return vec4(color, 1.0);\n"
+              "}\n";
+
+    auto result = TranspileString(source, options);
+
+    EXPECT_TRUE(result.success) << result.diagnostics;
+
+    return result.output;
+  }
+
+  fs::path mDirectory;
+};
+
+} // namespace
+
+TEST_F(JitTest, ReloadsModule)
+{
+  auto compiler = MakeCompiler();
+
+  std::string error;
+
+  auto first = compiler.build(Generate("vec3(0.25, 0.5, 0.0)"), error);
+
+  ASSERT_NE(first, nullptr) << error;
+
+  pathway::jit::frame frame;
+
+  ASSERT_TRUE(frame.load(first));
+
+  EXPECT_TRUE(frame.resize(1, 1));
+
+  EXPECT_TRUE(frame.set_uniform("gain", { 2.0f }));
+
+  EXPECT_FALSE(frame.set_uniform("color", { 1.0f, 1.0f, 1.0f }));
+
+  unsigned char rgb[3]{};
+
+  frame.sample_pixels();
+
+  frame.encode_rgb(rgb);
+
+  EXPECT_EQ(rgb[0], 127);
+  EXPECT_EQ(rgb[1], 255);
+  EXPECT_EQ(rgb[2], 0);
+
+  auto second = compiler.build(Generate("vec3(0.0, 0.125, 0.25)"), error);
+
+  ASSERT_NE(second, nullptr) << error;
+
+  // The size and the uniform values carry over to the new module.
+  ASSERT_TRUE(frame.load(second));
+
+  frame.sample_pixels();
+
+  frame.encode_rgb(rgb);
+
+  EXPECT_EQ(rgb[0], 0);
+  EXPECT_EQ(rgb[1], 63);
+  EXPECT_EQ(rgb[2], 127);
+}
+
+TEST_F(JitTest, CachesModules)
+{
+  auto source = Generate("vec3(1.0)");
+
+  std::string error;
+
+  {
+    auto compiler = MakeCompiler();
+
+    auto lib = compiler.build(source, error);
+
+    ASSERT_NE(lib, nullptr) << error;
+
+    EXPECT_EQ(compiler.build(source, error), lib);
+  }
+
+  std::vector<fs::path> objects;
+
+  for (const auto& entry : fs::directory_iterator(mDirectory))
+    objects.emplace_back(entry.path());
+
+  ASSERT_EQ(objects.size(), 1);
+
+  EXPECT_EQ(objects[0].extension(), ".so");
+
+  // Another compiler finds the object that the first one compiled.
+  auto time = fs::last_write_time(objects[0]);
+
+  auto compiler = MakeCompiler();
+
+  EXPECT_NE(compiler.build(source, error), nullptr) << error;
+
+  EXPECT_EQ(fs::last_write_time(objects[0]), time);
+}
+
+TEST_F(JitTest, ReportsCompileErrors)
+{
+  auto compiler = MakeCompiler();
+
+  std::string error;
+
+  EXPECT_EQ(compiler.build("this is not C++", error), nullptr);
+
+  EXPECT_NE(error.find("failed to compile"), std::string::npos);
+}
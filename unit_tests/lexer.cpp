@@ -23,32 +23,56 @@ Lex(const std::string& data)
 
 TEST(Lexer, Identifier)
 {
-  EXPECT_EQ(Lex("azAZ_09 "), "IDENTIFIER:(azAZ_09):(1:1 to 1:7)");
-  EXPECT_EQ(Lex("AZaz_09 "), "IDENTIFIER:(AZaz_09):(1:1 to 1:7)");
-  EXPECT_EQ(Lex("_azAZ09 "), "IDENTIFIER:(_azAZ09):(1:1 to 1:7)");
+  EXPECT_EQ(Lex("azAZ_09 "), "IDENTIFIER:(azAZ_09):(0 to 7)");
+  EXPECT_EQ(Lex("AZaz_09 "), "IDENTIFIER:(AZaz_09):(0 to 7)");
+  EXPECT_EQ(Lex("_azAZ09 "), "IDENTIFIER:(_azAZ09):(0 to 7)");
 
-  EXPECT_EQ(Lex("int "), "INT:(1:1 to 1:3)");
-  EXPECT_EQ(Lex("float "), "FLOAT:(1:1 to 1:5)");
-  EXPECT_EQ(Lex("uniform "), "UNIFORM:(1:1 to 1:7)");
+  EXPECT_EQ(Lex("int "), "INT:(0 to 3)");
+  EXPECT_EQ(Lex("float "), "FLOAT:(0 to 5)");
+  EXPECT_EQ(Lex("uniform "), "UNIFORM:(0 to 7)");
 }
 
 TEST(Lexer, IntLiteral)
 {
-  EXPECT_EQ(Lex("azAZ_09 "), "IDENTIFIER:(azAZ_09):(1:1 to 1:7)");
-  EXPECT_EQ(Lex("AZaz_09 "), "IDENTIFIER:(AZaz_09):(1:1 to 1:7)");
-  EXPECT_EQ(Lex("_azAZ09 "), "IDENTIFIER:(_azAZ09):(1:1 to 1:7)");
+  EXPECT_EQ(Lex("azAZ_09 "), "IDENTIFIER:(azAZ_09):(0 to 7)");
+  EXPECT_EQ(Lex("AZaz_09 "), "IDENTIFIER:(AZaz_09):(0 to 7)");
+  EXPECT_EQ(Lex("_azAZ09 "), "IDENTIFIER:(_azAZ09):(0 to 7)");
 
   // TODO test for error handling in int literals
 }
 
 TEST(Lexer, FloatLiteral)
 {
-  EXPECT_EQ(Lex("0. "), "FLOAT_LITERAL:(0.000000e+00):(1:1 to 1:2)");
-  EXPECT_EQ(Lex("0.1 "), "FLOAT_LITERAL:(1.000000e-01):(1:1 to 1:3)");
-  EXPECT_EQ(Lex("1.2e2 "), "FLOAT_LITERAL:(1.200000e+02):(1:1 to 1:5)");
-  EXPECT_EQ(Lex("12.34e+56 "), "FLOAT_LITERAL:(1.234000e+57):(1:1 to 1:9)");
-  EXPECT_EQ(Lex("78.91e-23 "), "FLOAT_LITERAL:(7.891000e-22):(1:1 to 1:9)");
-  EXPECT_EQ(Lex("45e6 "), "FLOAT_LITERAL:(4.500000e+07):(1:1 to 1:4)");
+  EXPECT_EQ(Lex("0. "), "FLOAT_LITERAL:(0.000000e+00):(0 to 2)");
+  EXPECT_EQ(Lex("0.1 "), "FLOAT_LITERAL:(1.000000e-01):(0 to 3)");
+  EXPECT_EQ(Lex("1.2e2 "), "FLOAT_LITERAL:(1.200000e+02):(0 to 5)");
+  EXPECT_EQ(Lex("12.34e+56 "), "FLOAT_LITERAL:(1.234000e+57):(0 to 9)");
+  EXPECT_EQ(Lex("78.91e-23 "), "FLOAT_LITERAL:(7.891000e-22):(0 to 9)");
+  EXPECT_EQ(Lex("45e6 "), "FLOAT_LITERAL:(4.500000e+07):(0 to 4)");
+  EXPECT_EQ(Lex("1e+5 "), "FLOAT_LITERAL:(1.000000e+05):(0 to 4)");
+  EXPECT_EQ(Lex("1e-5 "), "FLOAT_LITERAL:(1.000000e-05):(0 to 4)");
 
   // TODO test for error handling in floating point literals
 }
+
+TEST(Lexer, Keyword)
+{
+  EXPECT_EQ(Lex("infinity "), "INFINITY:(0 to 8)");
+  EXPECT_EQ(Lex("continue "), "CONTINUE:(0 to 8)");
+  EXPECT_EQ(Lex("vec3i "), "VEC3I:(0 to 5)");
+  EXPECT_EQ(Lex("vec4i "), "VEC4I:(0 to 5)");
+  EXPECT_EQ(Lex("if "), "IF:(0 to 2)");
+
+  // Names that hash like a keyword, or contain one, are still identifiers.
+  EXPECT_EQ(Lex("vec5i "), "IDENTIFIER:(vec5i):(0 to 5)");
+  EXPECT_EQ(Lex("iff "), "IDENTIFIER:(iff):(0 to 3)");
+  EXPECT_EQ(Lex("continued "), "IDENTIFIER:(continued):(0 to 9)");
+}
+
+TEST(Lexer, Whitespace)
+{
+  EXPECT_EQ(Lex(" \t\r\n  x"), "IDENTIFIER:(x):(6 to 7)");
+  EXPECT_EQ(Lex("\n                                   x"),
+            "IDENTIFIER:(x):(36 to 37)");
+  EXPECT_EQ(Lex("                "), "");
+}
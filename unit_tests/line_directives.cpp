@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "line_directives.h"
+
+#include <sstream>
+
+TEST(LineDirectives, ResolvesPlaceholders)
+{
+  LineDirectiveWriter writer("dir/main.pt", "a\nb\nc\n");
+
+  std::ostringstream stream;
+
+  stream << "x" << std::endl;
+
+  writer.Write(stream, 2);
+
+  stream << "y" << std::endl << "z" << std::endl;
+
+  writer.WriteReset(stream);
+
+  stream << "w" << std::endl;
+
+  auto code = stream.str();
+
+  auto ranges = ResolveLineDirectives(code, "out.h");
+
+  EXPECT_EQ(code,
+            "x\n"
+            "#line 2 \"dir/main.pt\"\n"
+            "y\n"
+            "z\n"
+            "#line 6 \"out.h\"\n"
+            "w\n");
+
+  ASSERT_EQ(ranges.size(), 1);
+
+  EXPECT_EQ(ranges[0].generatedLine, 3);
+
+  EXPECT_EQ(ranges[0].sourceLine, 2);
+
+  EXPECT_EQ(ranges[0].lineCount, 2);
+}
+
+TEST(LineDirectives, QuotesPaths)
+{
+  LineDirectiveWriter writer("a\\\"b.pt", "");
+
+  std::ostringstream stream;
+
+  writer.Write(stream, 0);
+
+  EXPECT_EQ(stream.str(), "#line 1 \"a\\\\\\\"b.pt\"\n");
+}
+
+TEST(LineDirectives, SkipsEmptyRanges)
+{
+  std::string code = "#line 4 \"main.pt\"\n"
+                     "#line 5 \"main.pt\"\n"
+                     "x\n";
+
+  auto ranges = ResolveLineDirectives(code, "out.h");
+
+  ASSERT_EQ(ranges.size(), 1);
+
+  EXPECT_EQ(ranges[0].generatedLine, 3);
+
+  EXPECT_EQ(ranges[0].sourceLine, 5);
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "line_table.h"
+
+TEST(LineTable, GetLineAndColumn)
+{
+  LineTable lineTable("ab\n"
+                      "\n"
+                      "cde\n");
+
+  EXPECT_EQ(lineTable.LineCount(), 4);
+
+  EXPECT_EQ(lineTable.GetLine(0), 1);
+  EXPECT_EQ(lineTable.GetColumn(0), 1);
+
+  EXPECT_EQ(lineTable.GetLine(2), 1);
+  EXPECT_EQ(lineTable.GetColumn(2), 3);
+
+  EXPECT_EQ(lineTable.GetLine(3), 2);
+  EXPECT_EQ(lineTable.GetColumn(3), 1);
+
+  EXPECT_EQ(lineTable.GetLine(6), 3);
+  EXPECT_EQ(lineTable.GetColumn(6), 3);
+}
+
+TEST(LineTable, Expand)
+{
+  LineTable lineTable("float a;\n"
+                      "int bc;\n");
+
+  Location loc{ 13, 15 };
+
+  auto range = lineTable.Expand(loc);
+
+  EXPECT_EQ(range.first_line, 2);
+  EXPECT_EQ(range.first_column, 5);
+  EXPECT_EQ(range.last_line, 2);
+  EXPECT_EQ(range.last_column, 6);
+}
+
+TEST(LineTable, GetLineView)
+{
+  LineTable lineTable("one\r\n"
+                      "two\n"
+                      "three");
+
+  EXPECT_EQ(lineTable.GetLineView(1), "one");
+  EXPECT_EQ(lineTable.GetLineView(2), "two");
+  EXPECT_EQ(lineTable.GetLineView(3), "three");
+  EXPECT_EQ(lineTable.GetLineView(4), "");
+}
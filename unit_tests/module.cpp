@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+
+#include "string_to_module.h"
+
+TEST(Module, FindFuncs)
+{
+  auto module = StringToModule("float f(float x) { return x; }\n"
+                               "float g() { return 1.0; }\n"
+                               "float f(vec2 x) { return x.x; }\n");
+
+  const auto& matches = module->FindFuncs(Symbol::Intern("f"));
+
+  ASSERT_EQ(matches.size(), 2);
+
+  EXPECT_EQ(matches[0], module->Funcs()[0].get());
+
+  EXPECT_EQ(matches[1], module->Funcs()[2].get());
+
+  EXPECT_EQ(module->FindFuncs(Symbol::Intern("g")).size(), 1);
+
+  EXPECT_TRUE(module->FindFuncs(Symbol::Intern("h")).empty());
+}
+
+TEST(Module, FindGlobalVar)
+{
+  auto module = StringToModule("uniform float a;\n"
+                               "vec3 b;\n"
+                               "float a;\n");
+
+  EXPECT_EQ(module->FindGlobalVar(Symbol::Intern("a")), module->GlobalVars()[0].get());
+
+  EXPECT_EQ(module->FindGlobalVar(Symbol::Intern("b")), module->GlobalVars()[1].get());
+
+  EXPECT_EQ(module->FindGlobalVar(Symbol::Intern("c")), nullptr);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "module_interface.h"
+
+#include "string_to_module.h"
+
+namespace {
+
+const char* gSource = "export module a::b;\n"
+                      "import module c;\n"
+                      "uniform float scale = 2.0;\n"
+                      "vec3 color;\n"
+                      "float f(float x, vec2 y) {\n"
+                      "  float z = -(x + y.x) * scale / 3.0;\n"
+                      "  color = vec3(z, 1, true);\n"
+                      "  return g(z % 2, infinity);\n"
+                      "}\n";
+
+} // namespace
+
+TEST(ModuleInterface, RoundTrip)
+{
+  auto module = StringToModule(gSource);
+
+  ASSERT_NE(module, nullptr);
+
+  auto data = WriteModuleInterface(*module);
+
+  Location location{ 4, 9 };
+
+  auto imported = ReadModuleInterface(data, location);
+
+  ASSERT_NE(imported, nullptr);
+
+  EXPECT_EQ(imported->GetModuleName(), "a_b");
+
+  ASSERT_EQ(imported->ModuleImports().size(), 1);
+
+  EXPECT_EQ(imported->ModuleImports()[0]->GetModuleName().ToSingleIdentifier(),
+            "c");
+
+  ASSERT_EQ(imported->GlobalVars().size(), 2);
+
+  EXPECT_EQ(imported->GlobalVars()[0]->GetType(),
+            Type(TypeID::Float, Variability::Uniform));
+
+  EXPECT_TRUE(imported->GlobalVars()[0]->HasInitExpr());
+
+  ASSERT_EQ(imported->FindFuncs(Symbol::Intern("f")).size(), 1);
+
+  const auto* func = imported->FindFuncs(Symbol::Intern("f"))[0];
+
+  ASSERT_EQ(func->GetParamList().size(), 2);
+
+  EXPECT_EQ(func->GetParamList()[1]->GetTypeID(), TypeID::Vec2);
+
+  EXPECT_EQ(func->GetNameLocation().begin, location.begin);
+
+  EXPECT_EQ(func->GetNameLocation().end, location.end);
+
+  // Nothing is lost, so the interface of the imported module is the same.
+  EXPECT_EQ(WriteModuleInterface(*imported), data);
+}
+
+TEST(ModuleInterface, RejectsInvalidData)
+{
+  auto module = StringToModule(gSource);
+
+  ASSERT_NE(module, nullptr);
+
+  auto data = WriteModuleInterface(*module);
+
+  EXPECT_EQ(ReadModuleInterface("", Location()), nullptr);
+
+  for (size_t size = 0; size < data.size(); size++)
+    EXPECT_EQ(ReadModuleInterface(data.substr(0, size), Location()), nullptr);
+
+  EXPECT_EQ(ReadModuleInterface(data + " ", Location()), nullptr);
+}
+
+TEST(ModuleInterface, LeavesOutImportedDecls)
+{
+  auto library = StringToModule("export module lib;\n"
+                                "float f() { return 1.0; }\n");
+
+  auto module = StringToModule("export module app;\n"
+                               "import module lib;\n"
+                               "float g() { return f(); }\n");
+
+  ASSERT_NE(library, nullptr);
+
+  ASSERT_NE(module, nullptr);
+
+  module->Import(std::move(library));
+
+  ASSERT_EQ(module->Funcs().size(), 2);
+
+  auto imported = ReadModuleInterface(WriteModuleInterface(*module), Location());
+
+  ASSERT_NE(imported, nullptr);
+
+  ASSERT_EQ(imported->Funcs().size(), 1);
+
+  EXPECT_EQ(imported->Funcs()[0]->Identifier(), "g");
+}
+
+TEST(ModuleInterface, NamesFilesUniquely)
+{
+  auto nested = StringToModule("export module a::b;\n");
+
+  auto flat = StringToModule("export module a_b;\n");
+
+  ASSERT_NE(nested, nullptr);
+
+  ASSERT_NE(flat, nullptr);
+
+  const auto& nestedName = nested->GetModuleExportDecl().GetModuleName();
+
+  const auto& flatName = flat->GetModuleExportDecl().GetModuleName();
+
+  EXPECT_EQ(GetInterfaceFileName(nestedName), "a.b.pti");
+
+  EXPECT_EQ(GetInterfaceFileName(flatName), "a_b.pti");
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "node_pool.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+bool
+IsAligned(const void* ptr)
+{
+  return (uintptr_t(ptr) % alignof(max_align_t)) == 0;
+}
+
+} // namespace
+
+TEST(NodePool, ReusesReleasedNodes)
+{
+  auto* a = NodePool::Allocate(40);
+
+  auto* b = NodePool::Allocate(40);
+
+  EXPECT_NE(a, b);
+
+  NodePool::Release(a, 40);
+
+  NodePool::Release(b, 40);
+
+  // The last node released is the first one handed out again.
+  auto* c = NodePool::Allocate(40);
+
+  auto* d = NodePool::Allocate(40);
+
+  EXPECT_EQ(c, b);
+
+  EXPECT_EQ(d, a);
+
+  NodePool::Release(c, 40);
+
+  NodePool::Release(d, 40);
+}
+
+TEST(NodePool, ReusesNodesOnlyForTheirSize)
+{
+  auto* a = NodePool::Allocate(40);
+
+  NodePool::Release(a, 40);
+
+  auto* b = NodePool::Allocate(200);
+
+  EXPECT_NE(a, b);
+
+  auto* c = NodePool::Allocate(40);
+
+  EXPECT_EQ(a, c);
+
+  NodePool::Release(b, 200);
+
+  NodePool::Release(c, 40);
+}
+
+TEST(NodePool, AlignsEachSize)
+{
+  std::vector<std::pair<void*, size_t>> nodes;
+
+  for (size_t size = 1; size <= 512; size++) {
+
+    // Two of each, so that the second one is carved after the first.
+    for (int i = 0; i < 2; i++) {
+
+      auto* node = NodePool::Allocate(size);
+
+      ASSERT_NE(node, nullptr);
+
+      EXPECT_TRUE(IsAligned(node)) << size;
+
+      memset(node, int(size & 0xff), size);
+
+      nodes.emplace_back(node, size);
+    }
+  }
+
+  // No node overlaps another one.
+  for (const auto& node : nodes) {
+
+    const auto* bytes = static_cast<const unsigned char*>(node.first);
+
+    for (size_t i = 0; i < node.second; i++)
+      ASSERT_EQ(bytes[i], (node.second & 0xff)) << node.second;
+  }
+
+  for (const auto& node : nodes)
+    NodePool::Release(node.first, node.second);
+}
+
+TEST(NodePool, AllocatesLargeNodesFromTheHeap)
+{
+  auto before = NodePool::GetStats();
+
+  auto* a = NodePool::Allocate(4096);
+
+  ASSERT_NE(a, nullptr);
+
+  EXPECT_TRUE(IsAligned(a));
+
+  memset(a, 0xff, 4096);
+
+  auto after = NodePool::GetStats();
+
+  EXPECT_EQ(after.allocationCount, before.allocationCount + 1);
+
+  EXPECT_EQ(after.allocatedBytes, before.allocatedBytes + 4096);
+
+  EXPECT_EQ(after.blockBytes, before.blockBytes);
+
+  NodePool::Release(a, 4096);
+}
+
+TEST(NodePool, ResetsStats)
+{
+  auto* a = NodePool::Allocate(40);
+
+  auto before = NodePool::GetStats();
+
+  NodePool::ResetStats();
+
+  auto after = NodePool::GetStats();
+
+  EXPECT_EQ(after.allocationCount, 0);
+
+  EXPECT_EQ(after.allocatedBytes, 0);
+
+  // The blocks are still there.
+  EXPECT_EQ(after.blockBytes, before.blockBytes);
+
+  NodePool::Release(a, 40);
+}
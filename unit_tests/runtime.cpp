@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include "pathway.h"
+#include "pathway_profile.h"
+
+#include <thread>
 
 using namespace pathway;
 
@@ -215,3 +218,186 @@ TEST(Runtime, FrameSample)
   EXPECT_EQ(rgbBuffer[16], 212);
   EXPECT_EQ(rgbBuffer[17], 76);
 }
+
+namespace {
+
+struct PreparedUniformData final
+{
+  void prepare() noexcept { mPrepareCount++; }
+
+  int mPrepareCount = 0;
+};
+
+struct PreparedVaryingData final
+{
+  auto operator()(const PreparedUniformData&) const noexcept -> vec3<float>
+  {
+    return make_vec3(mValue, mValue, mValue);
+  }
+
+  void operator()(const PreparedUniformData& uniformData,
+                  const vec2<float>&,
+                  const vec2<float>&) noexcept
+  {
+    mValue = float(uniformData.mPrepareCount);
+  }
+
+  float mValue = 0;
+};
+
+} // namespace
+
+TEST(Runtime, FramePreparesUniformData)
+{
+  pathway::frame<PreparedUniformData, PreparedVaryingData, float> frame;
+
+  frame.resize(2, 2);
+
+  frame.sample_pixels();
+
+  EXPECT_EQ(frame.get_uniform_data().mPrepareCount, 1);
+
+  unsigned char rgbBuffer[12];
+
+  frame.encode_rgb(rgbBuffer);
+
+  EXPECT_EQ(rgbBuffer[0], 255);
+  EXPECT_EQ(rgbBuffer[11], 255);
+}
+
+namespace {
+
+auto
+UlpDistance(float a, float b) -> uint32_t
+{
+  int32_t ia = 0;
+  int32_t ib = 0;
+  memcpy(&ia, &a, sizeof(a));
+  memcpy(&ib, &b, sizeof(b));
+  ia = (ia < 0) ? (INT32_MIN - ia) : ia;
+  ib = (ib < 0) ? (INT32_MIN - ib) : ib;
+  return (ia > ib) ? uint32_t(ia - ib) : uint32_t(ib - ia);
+}
+
+} // namespace
+
+TEST(Runtime, FastExp)
+{
+  for (float x = -87.0f; x < 88.0f; x += 0.0137f)
+    EXPECT_LE(UlpDistance(fast_math::exp(x), std::exp(x)), 1u) << x;
+}
+
+TEST(Runtime, FastLog)
+{
+  for (float x = 1e-30f; x < 1e30f; x *= 1.0173f)
+    EXPECT_LE(UlpDistance(fast_math::log(x), std::log(x)), 1u) << x;
+}
+
+TEST(Runtime, FastSinCos)
+{
+  for (float x = -3.14159f; x < 3.14159f; x += 0.00137f) {
+    EXPECT_LE(UlpDistance(fast_math::sin(x), std::sin(x)), 2u) << x;
+    EXPECT_LE(UlpDistance(fast_math::cos(x), std::cos(x)), 2u) << x;
+  }
+
+  for (float x = -8000.0f; x < 8000.0f; x += 0.731f) {
+    EXPECT_NEAR(fast_math::sin(x), std::sin(x), 1e-7f) << x;
+    EXPECT_NEAR(fast_math::cos(x), std::cos(x), 1e-7f) << x;
+  }
+}
+
+TEST(Runtime, FastAtan2)
+{
+  for (float y = -10.0f; y < 10.0f; y += 0.173f) {
+    for (float x = -10.0f; x < 10.0f; x += 0.191f)
+      EXPECT_LE(UlpDistance(fast_math::atan2(y, x), std::atan2(y, x)), 3u);
+  }
+}
+
+TEST(Runtime, FastPow)
+{
+  for (float x = 0.01f; x < 100.0f; x *= 1.37f) {
+    for (float y = -8.0f; y < 8.0f; y += 0.29f) {
+      float expected = std::pow(x, y);
+      float bound = 2.0f + 2.0f * std::fabs(y * std::log(x));
+      EXPECT_LE(float(UlpDistance(fast_math::pow(x, y), expected)), bound);
+    }
+  }
+}
+
+TEST(Runtime, FastVectorMath)
+{
+  auto v = fast_math::exp(make_vec3(0.0f, 1.0f, 2.0f));
+  EXPECT_EQ(v.at<0>(), 1.0f);
+  EXPECT_LE(UlpDistance(v.at<1>(), std::exp(1.0f)), 1u);
+  EXPECT_LE(UlpDistance(v.at<2>(), std::exp(2.0f)), 1u);
+}
+
+TEST(Runtime, FastSpecialValues)
+{
+  const float inf = std::numeric_limits<float>::infinity();
+
+  EXPECT_EQ(fast_math::exp(inf), inf);
+  EXPECT_EQ(fast_math::exp(-inf), 0.0f);
+  EXPECT_EQ(fast_math::exp(0.0f), 1.0f);
+  EXPECT_TRUE(std::isnan(fast_math::exp(NAN)));
+
+  EXPECT_EQ(fast_math::log(0.0f), -inf);
+  EXPECT_EQ(fast_math::log(inf), inf);
+  EXPECT_TRUE(std::isnan(fast_math::log(-1.0f)));
+
+  EXPECT_EQ(fast_math::pow(-2.0f, 3.0f), -8.0f);
+  EXPECT_EQ(fast_math::pow(-2.0f, 2.0f), 4.0f);
+  EXPECT_TRUE(std::isnan(fast_math::pow(-2.0f, 0.5f)));
+  EXPECT_EQ(fast_math::pow(0.0f, 2.0f), 0.0f);
+  EXPECT_EQ(fast_math::pow(0.0f, -1.0f), inf);
+  EXPECT_EQ(fast_math::pow(0.0f, 0.0f), 1.0f);
+
+  EXPECT_FLOAT_EQ(fast_math::atan2(1.0f, 0.0f), 1.5707963f);
+  EXPECT_FLOAT_EQ(fast_math::atan2(-1.0f, 0.0f), -1.5707963f);
+  EXPECT_FLOAT_EQ(fast_math::atan2(0.0f, -1.0f), 3.1415927f);
+  EXPECT_EQ(fast_math::atan2(0.0f, 0.0f), 0.0f);
+}
+
+TEST(Runtime, ProfileMergesThreads)
+{
+  profile p{ "f", "g" };
+
+  auto run = [&p]() {
+    profile::counters counters(p);
+
+    profile::scope f(counters, 0);
+
+    {
+      profile::scope g(counters, 1);
+    }
+
+    {
+      profile::scope g(counters, 1);
+    }
+  };
+
+  run();
+
+  std::thread thread(run);
+
+  thread.join();
+
+  auto entries = p.merge();
+
+  ASSERT_EQ(entries.size(), 2);
+
+  EXPECT_STREQ(entries[0].name, "f");
+  EXPECT_EQ(entries[0].calls, 2);
+  EXPECT_EQ(entries[1].calls, 4);
+
+  // The callee's cycles only count toward the caller's total.
+  EXPECT_EQ(entries[0].total_cycles,
+            entries[0].self_cycles + entries[1].total_cycles);
+
+  EXPECT_EQ(entries[1].total_cycles, entries[1].self_cycles);
+
+  p.reset();
+
+  EXPECT_EQ(p.merge()[0].calls, 0);
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "sha256.h"
+
+#include <string>
+
+namespace {
+
+std::string
+Hash(std::string_view data)
+{
+  Sha256 hash;
+
+  hash.Update(data);
+
+  return hash.FinishHex();
+}
+
+} // namespace
+
+TEST(Sha256, KnownDigests)
+{
+  EXPECT_EQ(Hash(""),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+  EXPECT_EQ(Hash("abc"),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  EXPECT_EQ(Hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(Sha256, SplitUpdates)
+{
+  std::string data(1000, 'a');
+
+  Sha256 hash;
+
+  for (size_t i = 0; i < data.size(); i += 7)
+    hash.Update(std::string_view(data).substr(i, 7));
+
+  EXPECT_EQ(hash.FinishHex(), Hash(data));
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "statistics.h"
+
+#include "string_to_module.h"
+
+TEST(Statistics, CollectModuleStats)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "uniform float b;\n"
+                           "vec3 c;\n"
+                           "float unused;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = vec3(uv_min.x * (a * b + 1.0));\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, 1.0);\n"
+                           "}\n");
+
+  auto stats = CollectModuleStats(*module);
+
+  EXPECT_EQ(stats.funcCount, 2);
+
+  EXPECT_EQ(stats.globalVarCount, 4);
+
+  // Each body is a compound statement holding one statement.
+  EXPECT_EQ(stats.stmtCount, 4);
+
+  EXPECT_EQ(stats.exprCount, 14);
+
+  // The two uniform variables, and the hoisted value of 'a * b + 1.0'.
+  EXPECT_EQ(stats.uniformDataScalars, 3);
+
+  EXPECT_EQ(stats.uniformDataBytes, 12);
+
+  // Only 'c' is read after the pixel sampler returns.
+  EXPECT_EQ(stats.varyingDataScalars, 3);
+
+  EXPECT_EQ(stats.varyingDataBytes, 12);
+}
+
+TEST(Statistics, PassTimer)
+{
+  PassTimer timer;
+
+  EXPECT_EQ(timer.Time("a", []() { return 42; }), 42);
+
+  timer.Time("b", []() {});
+
+  ASSERT_EQ(timer.Timings().size(), 2);
+
+  EXPECT_EQ(timer.Timings()[0].passName, "a");
+
+  EXPECT_EQ(timer.Timings()[1].passName, "b");
+
+  EXPECT_GE(timer.Timings()[0].milliseconds, 0);
+}
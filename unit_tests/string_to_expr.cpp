@@ -17,7 +17,9 @@ public:
   void ObserveSyntaxError(const Location& location,
                           const char* message) override
   {
-    std::cerr << "TEST ERROR: " << location << message;
+    std::cerr << "TEST ERROR: ";
+    location.Dump(std::cerr);
+    std::cerr << message;
   }
 };
 
@@ -1,10 +1,13 @@
 #include "string_to_module.h"
 
+#include "effects_analysis.h"
 #include "lexer.h"
 #include "module.h"
 #include "module_consumer.h"
 #include "parse.h"
+#include "resolve.h"
 #include "syntax_error_observer.h"
+#include "type_annotation.h"
 
 #include <iostream>
 
@@ -16,7 +19,9 @@ public:
   void ObserveSyntaxError(const Location& location,
                           const char* message) override
   {
-    std::cerr << "TEST ERROR: " << location << message;
+    std::cerr << "TEST ERROR: ";
+    location.Dump(std::cerr);
+    std::cerr << message;
   }
 };
 
@@ -51,3 +56,31 @@ StringToModule(const std::string& source) -> std::unique_ptr<Module>
 
   return saver.TakeModule();
 }
+
+auto
+StringToAnalyzedModule(const std::string& source) -> std::unique_ptr<Module>
+{
+  auto module = StringToModule(source);
+
+  Resolve(*module);
+
+  AnnotateTypes(*module);
+
+  AnalyzeEffects(*module);
+
+  return module;
+}
+
+auto
+FindFunc(const Module& module, const char* name) -> const FuncDecl*
+{
+  const auto& funcs = module.FindFuncs(Symbol::Intern(name));
+
+  return funcs.empty() ? nullptr : funcs[0];
+}
+
+auto
+FindVar(const Module& module, const char* name) -> const VarDecl*
+{
+  return module.FindGlobalVar(Symbol::Intern(name));
+}
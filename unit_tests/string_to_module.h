@@ -7,3 +7,21 @@
 
 auto
 StringToModule(const std::string& source) -> std::unique_ptr<Module>;
+
+/// @brief Parses a module and runs the passes that the analyses and the
+/// generators expect to have run: name resolution, type annotation and the
+/// effects analysis.
+auto
+StringToAnalyzedModule(const std::string& source) -> std::unique_ptr<Module>;
+
+/// @brief Finds the first function declared with a given name.
+///
+/// @return The function, or null if there isn't one.
+auto
+FindFunc(const Module& module, const char* name) -> const FuncDecl*;
+
+/// @brief Finds the first global variable declared with a given name.
+///
+/// @return The variable, or null if there isn't one.
+auto
+FindVar(const Module& module, const char* name) -> const VarDecl*;
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "symbol.h"
+
+#include "string_to_module.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Symbol, SameNameSameSymbol)
+{
+  std::string name = "color";
+
+  auto a = Symbol::Intern(name);
+
+  auto b = Symbol::Intern("color");
+
+  EXPECT_EQ(a, b);
+
+  EXPECT_EQ(&a.Name(), &b.Name());
+
+  EXPECT_EQ(a.Hash(), b.Hash());
+}
+
+TEST(Symbol, DifferentNameDifferentSymbol)
+{
+  auto a = Symbol::Intern("color");
+
+  auto b = Symbol::Intern("colour");
+
+  EXPECT_NE(a, b);
+
+  EXPECT_EQ(a.Name(), "color");
+
+  EXPECT_EQ(b.Name(), "colour");
+}
+
+TEST(SymbolPool, ScopeSetsCurrentPool)
+{
+  auto outer = Symbol::Intern("color");
+
+  auto pool = std::make_shared<SymbolPool>();
+
+  {
+    SymbolPool::Scope scope(pool);
+
+    EXPECT_EQ(SymbolPool::Current(), pool);
+
+    auto inner = Symbol::Intern("color");
+
+    EXPECT_NE(inner, outer);
+
+    EXPECT_EQ(inner, pool->Intern("color"));
+
+    EXPECT_EQ(pool->Size(), 1);
+  }
+
+  EXPECT_NE(SymbolPool::Current(), pool);
+
+  EXPECT_EQ(Symbol::Intern("color"), outer);
+}
+
+TEST(SymbolPool, ModuleKeepsPoolAlive)
+{
+  std::unique_ptr<Module> module;
+
+  {
+    SymbolPool::Scope scope(std::make_shared<SymbolPool>());
+
+    module = StringToModule("float f(float x) { return x; }\n");
+  }
+
+  ASSERT_TRUE(module);
+
+  EXPECT_EQ(module->GetSymbolPool().use_count(), 1);
+
+  EXPECT_EQ(module->Funcs()[0]->GetSymbol().Name(), "f");
+
+  EXPECT_EQ(module->FindFuncs(module->GetSymbolPool()->Intern("f")).size(), 1);
+}
+
+TEST(SymbolPool, InternsFromSeveralThreads)
+{
+  auto pool = std::make_shared<SymbolPool>();
+
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([pool] {
+      for (int j = 0; j < 1000; j++)
+        pool->Intern("name_" + std::to_string(j));
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(pool->Size(), 1000);
+}
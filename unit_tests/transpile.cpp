@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include "transpile.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* gSource = "export module a::b;\n"
+                      "uniform mat2 transform;\n"
+                      "vec3 color;\n"
+                      "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                      "  color = vec3(uv_min, 1.0);\n"
+                      "}\n"
+                      "vec4 encode_pixel() {\n"
+                      "  return vec4(color, 1.0);\n"
+                      "}\n";
+
+} // namespace
+
+TEST(TranspileString, GeneratesModule)
+{
+  auto result = TranspileString(gSource);
+
+  EXPECT_TRUE(result.success);
+
+  EXPECT_EQ(result.diagnostics, "");
+
+  EXPECT_NE(result.output.find("namespace b {"), std::string::npos);
+
+  EXPECT_EQ(result.output.find("pathway_get_entry_table"), std::string::npos);
+}
+
+TEST(TranspileString, GeneratesEntryTable)
+{
+  TranspileOptions options;
+
+  options.genOptions.entryTable = true;
+
+  auto result = TranspileString(gSource, options);
+
+  ASSERT_TRUE(result.success) << result.diagnostics;
+
+  EXPECT_NE(result.output.find("pathway_get_entry_table"), std::string::npos);
+
+  EXPECT_NE(result.output.find("pathway::frame<a::b::uniform_data"),
+            std::string::npos);
+
+  EXPECT_NE(result.output.find("u.transform.at<1>().at<0>() = values[2];"),
+            std::string::npos);
+}
+
+TEST(TranspileString, ReportsErrors)
+{
+  TranspileOptions options;
+
+  options.path = "shader.pt";
+
+  auto result = TranspileString(
+    "export module m;\n"
+    "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+    "  undefined_var = 1.0;\n"
+    "}\n",
+    options);
+
+  EXPECT_FALSE(result.success);
+
+  EXPECT_EQ(result.output, "");
+
+  EXPECT_NE(result.diagnostics.find("shader.pt"), std::string::npos);
+}
+
+TEST(TranspileString, ReportsBuiltinArgTypes)
+{
+  const char* bodies[]{ "  c = vec3(exp(1), 0.0, 0.0);\n",
+                        "  c = pow(vec3(uv_min, 1.0), 2.0);\n",
+                        "  c = sin(vec3i(1, 2, 3));\n" };
+
+  for (const auto* body : bodies) {
+
+    std::string source = "export module m;\n"
+                         "vec3 c;\n"
+                         "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n";
+
+    source += body;
+
+    source += "}\n"
+              "vec4 encode_pixel() {\n"
+              "  return vec4(c, 1.0);\n"
+              "}\n";
+
+    auto result = TranspileString(source);
+
+    EXPECT_FALSE(result.success) << body;
+
+    EXPECT_NE(result.diagnostics.find("argument of"), std::string::npos)
+      << result.diagnostics;
+  }
+}
+
+TEST(TranspileString, RequiresPreparedUniformData)
+{
+  auto result =
+    TranspileString("export module m;\n"
+                    "uniform float a;\n"
+                    "float c;\n"
+                    "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                    "  c = uv_min.x * (a * 2.0 + 1.0);\n"
+                    "}\n"
+                    "vec4 encode_pixel() {\n"
+                    "  return vec4(c, c, c, 1.0);\n"
+                    "}\n");
+
+  ASSERT_TRUE(result.success) << result.diagnostics;
+
+  EXPECT_NE(result.output.find("hoisted_0 = {};"), std::string::npos);
+
+  EXPECT_NE(result.output.find("PATHWAY_ASSERT(frame.prepared"),
+            std::string::npos);
+}
+
+TEST(TranspileString, RunsFromSeveralThreads)
+{
+  auto expected = TranspileString(gSource);
+
+  std::vector<TranspileResult> results(8);
+
+  std::vector<std::thread> threads;
+
+  for (auto& result : results)
+    threads.emplace_back([&result] { result = TranspileString(gSource); });
+
+  for (auto& thread : threads)
+    thread.join();
+
+  for (const auto& result : results) {
+
+    EXPECT_TRUE(result.success) << result.diagnostics;
+
+    EXPECT_EQ(result.output, expected.output);
+  }
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "transpile_cache.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string
+ReadFile(const fs::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+
+  std::ostringstream stream;
+
+  stream << file.rdbuf();
+
+  return stream.str();
+}
+
+class TranspileCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    mDirectory = fs::temp_directory_path() / "pathway_transpile_cache_test";
+
+    fs::remove_all(mDirectory);
+
+    fs::create_directories(mDirectory);
+  }
+
+  void TearDown() override { fs::remove_all(mDirectory); }
+
+  fs::path mDirectory;
+};
+
+} // namespace
+
+TEST_F(TranspileCacheTest, FetchMissingEntry)
+{
+  TranspileCache cache((mDirectory / "cache").string());
+
+  auto outputPath = (mDirectory / "out.h").string();
+
+  EXPECT_FALSE(cache.Fetch("0123", outputPath, false));
+
+  EXPECT_FALSE(fs::exists(outputPath));
+}
+
+TEST_F(TranspileCacheTest, StoreAndFetch)
+{
+  TranspileCache cache((mDirectory / "cache").string());
+
+  cache.Store("abcd", "int x;\n");
+
+  auto outputPath = (mDirectory / "out.h").string();
+
+  ASSERT_TRUE(cache.Fetch("abcd", outputPath, false));
+
+  EXPECT_EQ(ReadFile(outputPath), "int x;\n");
+
+  // Replacing the output doesn't change the entry.
+  ASSERT_TRUE(ReplaceFile(outputPath, "int y;\n"));
+
+  auto otherOutputPath = (mDirectory / "other.h").string();
+
+  ASSERT_TRUE(cache.Fetch("abcd", otherOutputPath, true));
+
+  EXPECT_EQ(ReadFile(otherOutputPath), "int x;\n");
+}
+
+TEST_F(TranspileCacheTest, FetchMakesNewOutput)
+{
+  TranspileCache cache((mDirectory / "cache").string());
+
+  cache.Store("abcd", "int x;\n");
+
+  auto entryPath = mDirectory / "cache" / "ab" / "abcd";
+
+  // As if the entry was stored long before its inputs last changed.
+  auto storeTime = fs::last_write_time(entryPath) - std::chrono::hours(1);
+
+  fs::last_write_time(entryPath, storeTime);
+
+  auto outputPath = mDirectory / "out.h";
+
+  ASSERT_TRUE(cache.Fetch("abcd", outputPath.string(), false));
+
+  EXPECT_GT(fs::last_write_time(outputPath), storeTime);
+
+  EXPECT_EQ(fs::hard_link_count(outputPath), 1);
+
+  EXPECT_NE(fs::status(outputPath).permissions() & fs::perms::owner_write,
+            fs::perms::none);
+}
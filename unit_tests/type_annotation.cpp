@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "resolve.h"
+#include "type_annotation.h"
+
+#include "string_to_module.h"
+
+namespace {
+
+class ReturnValueFinder final : public StmtMutator
+{
+public:
+  Expr* ReturnValue() noexcept { return mReturnValue; }
+
+  void Mutate(AssignmentStmt&) override {}
+
+  void Mutate(CompoundStmt& compoundStmt) override
+  {
+    compoundStmt.Recurse(*this);
+  }
+
+  void Mutate(DeclStmt&) override {}
+
+  void Mutate(ReturnStmt& returnStmt) override
+  {
+    mReturnValue = &returnStmt.ReturnValue();
+  }
+
+private:
+  Expr* mReturnValue = nullptr;
+};
+
+} // namespace
+
+TEST(TypeAnnotation, AnnotatesNestedExprs)
+{
+  auto module = StringToModule("vec3 v;\n"
+                               "float x;\n"
+                               "vec3 f() { return (v.zyx * x).xyz; }\n");
+
+  Resolve(*module);
+
+  AnnotateTypes(*module);
+
+  ReturnValueFinder finder;
+
+  module->Funcs()[0]->AcceptBodyMutator(finder);
+
+  ASSERT_NE(finder.ReturnValue(), nullptr);
+
+  auto type = finder.ReturnValue()->GetType();
+
+  ASSERT_TRUE(type);
+
+  EXPECT_EQ(type->ID(), TypeID::Vec3);
+}
+
+TEST(TypeAnnotation, StoresType)
+{
+  auto module = StringToModule("vec3 v;\n"
+                               "float x;\n"
+                               "float f() { return x; }\n");
+
+  Resolve(*module);
+
+  AnnotateTypes(*module);
+
+  ReturnValueFinder finder;
+
+  module->Funcs()[0]->AcceptBodyMutator(finder);
+
+  auto* varRef = dynamic_cast<VarRef*>(finder.ReturnValue());
+
+  ASSERT_NE(varRef, nullptr);
+
+  // Changing the declaration doesn't change the stored type.
+  varRef->Resolve(module->GlobalVars()[0].get());
+
+  EXPECT_EQ(varRef->GetType()->ID(), TypeID::Float);
+}
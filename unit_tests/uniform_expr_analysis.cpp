@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "stmt.h"
+#include "uniform_expr_analysis.h"
+
+#include "string_to_module.h"
+
+TEST(UniformExprAnalysis, HoistsLargestUniformExpr)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "uniform float b;\n"
+                           "float c;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = uv_min.x * (a * b + 1.0);\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, c, c, 1.0);\n"
+                           "}\n");
+
+  UniformExprAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  const auto& hoistedExprs = analysis.HoistedExprs();
+
+  ASSERT_EQ(hoistedExprs.size(), 1);
+
+  EXPECT_EQ(hoistedExprs[0].name, "hoisted_0");
+
+  EXPECT_NE(dynamic_cast<const GroupExpr*>(hoistedExprs[0].expr), nullptr);
+
+  EXPECT_EQ(analysis.FindHoistedName(*hoistedExprs[0].expr), "hoisted_0");
+}
+
+TEST(UniformExprAnalysis, SharesIdenticalExprs)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float c;\n"
+                           "float d;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = uv_min.x * exp(a);\n"
+                           "  d = uv_max.y * exp(a);\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, d, 0.0, 1.0);\n"
+                           "}\n");
+
+  UniformExprAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_EQ(analysis.HoistedExprs().size(), 1);
+}
+
+TEST(UniformExprAnalysis, IgnoresTrivialExprs)
+{
+  auto module =
+    StringToAnalyzedModule("uniform vec3 a;\n"
+                           "vec3 c;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = a * uv_min.x + a.zyx;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(c, 1.0);\n"
+                           "}\n");
+
+  UniformExprAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_EQ(analysis.HoistedExprs().size(), 0);
+}
+
+TEST(UniformExprAnalysis, IgnoresFuncsCalledByEncoder)
+{
+  auto module =
+    StringToAnalyzedModule("uniform float a;\n"
+                           "float c;\n"
+                           "float f(float x) {\n"
+                           "  return x * exp(a);\n"
+                           "}\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  c = f(uv_min.x);\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(f(c), 0.0, 0.0, 1.0);\n"
+                           "}\n");
+
+  UniformExprAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_EQ(analysis.HoistedExprs().size(), 0);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "module.h"
+#include "varying_liveness_analysis.h"
+
+#include "string_to_module.h"
+
+TEST(VaryingLivenessAnalysis, DemotesSamplerTemporaries)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 color;\n"
+                           "vec3 tmp;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  tmp = vec3(uv_min, 1.0);\n"
+                           "  color = tmp * 0.5;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(color, 1.0);\n"
+                           "}\n");
+
+  VaryingLivenessAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_TRUE(analysis.IsStored(*FindVar(*module, "color")));
+
+  EXPECT_FALSE(analysis.IsStored(*FindVar(*module, "tmp")));
+
+  ASSERT_EQ(analysis.SamplerLocals().size(), 1);
+
+  EXPECT_EQ(analysis.SamplerLocals()[0], FindVar(*module, "tmp"));
+}
+
+TEST(VaryingLivenessAnalysis, KeepsVarsReadBeforeAssignment)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 color;\n"
+                           "vec3 sum;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  sum = sum + vec3(uv_min, 1.0);\n"
+                           "  color = sum;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(color, 1.0);\n"
+                           "}\n");
+
+  VaryingLivenessAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_TRUE(analysis.IsStored(*FindVar(*module, "sum")));
+
+  EXPECT_TRUE(analysis.SamplerLocals().empty());
+}
+
+TEST(VaryingLivenessAnalysis, KeepsPartiallyAssignedVars)
+{
+  auto module =
+    StringToAnalyzedModule("vec3 color;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  color.x = uv_min.x;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(0.0, 0.0, 0.0, 1.0);\n"
+                           "}\n");
+
+  VaryingLivenessAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_TRUE(analysis.IsStored(*FindVar(*module, "color")));
+}
+
+TEST(VaryingLivenessAnalysis, KeepsVarsUsedByOtherFuncs)
+{
+  auto module =
+    StringToAnalyzedModule("float a;\n"
+                           "float b;\n"
+                           "float f() {\n"
+                           "  return a * 2.0;\n"
+                           "}\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  a = uv_min.x;\n"
+                           "  b = f();\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(b, b, b, 1.0);\n"
+                           "}\n");
+
+  VaryingLivenessAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_TRUE(analysis.IsStored(*FindVar(*module, "a")));
+
+  EXPECT_TRUE(analysis.IsStored(*FindVar(*module, "b")));
+}
+
+TEST(VaryingLivenessAnalysis, DropsUnusedVars)
+{
+  auto module =
+    StringToAnalyzedModule("float unused;\n"
+                           "void sample_pixel(vec2 uv_min, vec2 uv_max) {\n"
+                           "  float x = uv_min.x;\n"
+                           "}\n"
+                           "vec4 encode_pixel() {\n"
+                           "  return vec4(0.0, 0.0, 0.0, 1.0);\n"
+                           "}\n");
+
+  VaryingLivenessAnalysis analysis;
+
+  analysis.Invoke(*module);
+
+  EXPECT_FALSE(analysis.IsStored(*FindVar(*module, "unused")));
+
+  EXPECT_TRUE(analysis.SamplerLocals().empty());
+}